@@ -0,0 +1,17 @@
+#version 440
+
+in vec2 fragUV;
+
+layout(location = 0) out vec4 fragColor;
+
+uniform sampler2DArray MyTextures;
+uniform float Layer; // The layer of MyTextures this object is drawn with
+
+void main()
+{
+	vec2 uv = fragUV;
+	uv.y = 1.0 - uv.y;
+
+    vec4 textureColor = texture(MyTextures, vec3(uv, Layer));
+    fragColor = vec4(textureColor.rgb, 1.0);
+}
@@ -1,10 +1,12 @@
 #version 440
 
+in vec4 lineColor;
+
 layout(location = 0) out vec4 fragColor;
 
 uniform vec4 LineColor;
 
 void main()
 {
-    fragColor = LineColor;
+    fragColor = LineColor * lineColor;
 }
@@ -1,13 +1,16 @@
 #version 440
 
-in vec2 vertPosition;
+in vec3 vertPosition;
+in vec4 vertColor;
 
-out vec2 fragUV;
+out vec4 lineColor;
 
 uniform mat4 World;
+uniform mat4 View;
 uniform mat4 Projection;
 
 void main()
 {
-    gl_Position = Projection * World * vec4(vertPosition, 0.0, 1.0);
+    lineColor = vertColor;
+    gl_Position = Projection * View * World * vec4(vertPosition, 1.0);
 }
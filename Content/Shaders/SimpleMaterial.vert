@@ -1,8 +1,6 @@
 #version 440
 
 in vec3 vertPosition;
-in vec3 vertNormal;
-in vec3 vertTangent;
 in vec2 vertUV;
 
 out vec2 fragUV;
@@ -10,9 +8,10 @@ out vec2 fragUV;
 uniform mat4 World;
 uniform mat4 View;
 uniform mat4 Projection;
+uniform vec4 UVRange; // The offset (xy) and scale (zw) that expand the mesh's quantized UVs
 
 void main()
 {
-    fragUV = vertUV;
+    fragUV = UVRange.xy + vertUV * UVRange.zw;
     gl_Position = Projection * View * World * vec4(vertPosition, 1.0);
 }
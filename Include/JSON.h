@@ -255,6 +255,8 @@ namespace json
     };
 
     class Value;
+    class ValueBuilder;
+    class ValueWriter;
 
     // Represents a JSON object which is of the form {string:value, string:value, ...} Where string is the "key" name and is
     // of the form "" or "characters". Value is either of: string, number, object, array, boolean, null
@@ -385,6 +387,10 @@ namespace json
             Array							mArrayVal;
             bool 							mBoolVal;
 
+            // Deserialize and Serialize work on the underlying objects and arrays directly, so they never copy them
+            friend class ValueBuilder;
+            friend class ValueWriter;
+
         public:
 
             Value() 					: mValueType(NULLVal), mIntVal(0), mFloatVal(0), mDoubleVal(0), mBoolVal(false) {}
@@ -480,6 +486,10 @@ namespace json
     // json::Array, json::Object, or a json::Value that has an Array or Object as its underlying type. 
     std::string Serialize(const Value& obj);
 
+    // The same as above, but writes into the given buffer. The buffer is cleared first but keeps its memory, so a buffer that is
+    // re-used for many values stops allocating once it has grown large enough.
+    void		Serialize(const Value& obj, std::string& buffer);
+
     // If there is an error, Value will be NULLVal. Pass in a valid JSON string (such as one returned from Serialize, or obtained
     // elsewhere) to receive a Value in return that represents the JSON structure. Check the type of Value by calling GetType().
     // It will be ObjectVal or ArrayVal (or NULLVal if invalid JSON). The Value class contains the operator [] for indexing in the
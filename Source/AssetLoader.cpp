@@ -0,0 +1,144 @@
+#include "AssetLoader.hpp"
+#include <algorithm>
+#include <chrono>
+
+#define ASSET_UPLOAD_PIECE_SIZE ( 256 * 1024 ) // The most bytes handed to the GPU at once while keeping to the budget
+
+std::mutex                                AssetLoader::_decodedMutex;
+std::deque<std::shared_ptr<AssetRequest>> AssetLoader::_decoded;
+std::deque<std::shared_ptr<AssetRequest>> AssetLoader::_uploading;
+size_t                                    AssetLoader::_pendingCount = 0;
+
+// Removes a request from a queue, if it is in it
+static void RemoveRequest( std::deque<std::shared_ptr<AssetRequest>>& queue, const std::shared_ptr<AssetRequest>& request )
+{
+    auto search = std::find( queue.begin(), queue.end(), request );
+    if ( search != queue.end() )
+    {
+        queue.erase( search );
+    }
+}
+
+// Create a new asset request
+AssetRequest::AssetRequest()
+    : _state( AssetState::Loading )
+    , _isDecoded( false )
+{
+}
+
+// Destroy this asset request
+AssetRequest::~AssetRequest()
+{
+}
+
+// Get the state of this request's asset
+AssetState AssetRequest::GetState() const
+{
+    return _state;
+}
+
+// Hand the rest of a request's asset to the GPU and finish it
+void AssetLoader::Complete( const std::shared_ptr<AssetRequest>& request )
+{
+    if ( request->_isDecoded )
+    {
+        while ( !request->UploadPiece( static_cast<size_t>( -1 ) ) )
+        {
+        }
+    }
+    Publish( request );
+}
+
+// Get the number of assets that are still loading
+size_t AssetLoader::GetPendingCount()
+{
+    return _pendingCount;
+}
+
+// Start loading an asset
+void AssetLoader::Load( const std::shared_ptr<AssetRequest>& request )
+{
+    ++_pendingCount;
+
+    std::shared_ptr<AssetRequest> captured = request;
+    request->_decodeJob = JobSystem::Schedule( [ captured ]()
+    {
+        captured->_isDecoded = captured->Decode();
+
+        // The lock also makes sure the main thread sees everything the decode wrote
+        std::lock_guard<std::mutex> lock( _decodedMutex );
+        _decoded.push_back( captured );
+    } );
+}
+
+// Publish a request's asset
+void AssetLoader::Publish( const std::shared_ptr<AssetRequest>& request )
+{
+    bool isLoaded = request->_isDecoded;
+    request->_state = isLoaded ? AssetState::Loaded : AssetState::Failed;
+    --_pendingCount;
+
+    request->Finish( isLoaded );
+}
+
+// Drop every asset that is still loading
+void AssetLoader::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock( _decodedMutex );
+        _decoded.clear();
+    }
+    _uploading.clear();
+    _pendingCount = 0;
+}
+
+// Move the decoded requests on to the upload queue
+void AssetLoader::TakeDecoded()
+{
+    std::lock_guard<std::mutex> lock( _decodedMutex );
+    _uploading.insert( _uploading.end(), _decoded.begin(), _decoded.end() );
+    _decoded.clear();
+}
+
+// Hand decoded assets to the GPU
+void AssetLoader::Update( float budget )
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>( std::chrono::duration<float>( budget ) );
+
+    TakeDecoded();
+
+    // Finish the oldest asset first, so assets become usable as soon as possible
+    bool hasUploaded = false;
+    while ( !_uploading.empty() && ( !hasUploaded || Clock::now() < deadline ) )
+    {
+        std::shared_ptr<AssetRequest> request = _uploading.front();
+        hasUploaded = true;
+
+        if ( !request->_isDecoded || request->UploadPiece( ASSET_UPLOAD_PIECE_SIZE ) )
+        {
+            // Take the request out first, as the asset's callbacks may load more assets
+            _uploading.pop_front();
+            Publish( request );
+        }
+    }
+}
+
+// Finish loading an asset straight away
+void AssetLoader::Wait( const std::shared_ptr<AssetRequest>& request )
+{
+    if ( request->_state != AssetState::Loading )
+    {
+        return;
+    }
+
+    // The job only finishes once it has queued the request, so it's always in one of the queues
+    JobSystem::Wait( request->_decodeJob );
+    {
+        std::lock_guard<std::mutex> lock( _decodedMutex );
+        RemoveRequest( _decoded, request );
+    }
+    RemoveRequest( _uploading, request );
+
+    Complete( request );
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include "Config.hpp"
+#include "JobSystem.hpp"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// <summary>
+/// Defines the states an asset can be in.
+/// </summary>
+enum class AssetState
+{
+    Loading,
+    Loaded,
+    Failed
+};
+
+/// <summary>
+/// Defines a request to load an asset. The asset's file is read and decoded on a worker thread, and
+/// the result is then handed to the GPU a piece at a time on the main thread.
+/// </summary>
+class AssetRequest
+{
+    friend class AssetLoader;
+
+    ImplementNonCopyableClass( AssetRequest );
+    ImplementNonMovableClass( AssetRequest );
+
+    JobHandle  _decodeJob;
+    AssetState _state;     // Only used on the main thread
+    bool       _isDecoded; // Written by the decoding worker before the request is handed back
+
+protected:
+    /// <summary>
+    /// Creates a new asset request.
+    /// </summary>
+    AssetRequest();
+
+    /// <summary>
+    /// Reads and decodes the asset. Called on a worker thread, so it must not touch the GPU.
+    /// </summary>
+    /// <returns>True if the asset was decoded, false if not.</returns>
+    virtual bool Decode() = 0;
+
+    /// <summary>
+    /// Hands the next piece of the decoded asset to the GPU. Called on the main thread.
+    /// </summary>
+    /// <param name="maxBytes">The most bytes to hand over.</param>
+    /// <returns>True once the whole asset has been handed over, false if there is more to do.</returns>
+    virtual bool UploadPiece( size_t maxBytes ) = 0;
+
+    /// <summary>
+    /// Publishes the asset once it has finished loading. Called on the main thread.
+    /// </summary>
+    /// <param name="isLoaded">True if the asset was loaded, false if it failed.</param>
+    virtual void Finish( bool isLoaded ) = 0;
+
+public:
+    /// <summary>
+    /// Destroys this asset request.
+    /// </summary>
+    virtual ~AssetRequest();
+
+    /// <summary>
+    /// Gets the state of this request's asset.
+    /// </summary>
+    AssetState GetState() const;
+};
+
+template<class T> class AssetHandle;
+
+/// <summary>
+/// Defines a request to load a specific type of asset.
+/// </summary>
+template<class T> class TypedAssetRequest : public AssetRequest
+{
+    friend class AssetLoader;
+    friend class AssetHandle<T>;
+
+public:
+    /// <summary>
+    /// Defines a function to call once the asset has finished loading. It is given null if the asset failed.
+    /// </summary>
+    typedef std::function<void( const std::shared_ptr<T>& )> Callback;
+
+private:
+    std::vector<Callback> _callbacks;
+
+    /// <summary>
+    /// Publishes the asset and calls everything waiting on it.
+    /// </summary>
+    /// <param name="isLoaded">True if the asset was loaded, false if it failed.</param>
+    void Finish( bool isLoaded ) override;
+
+protected:
+    std::shared_ptr<T> _asset; // Set by UploadPiece, but only handed out once the upload finishes
+
+public:
+    /// <summary>
+    /// Gets the asset, or null if it is still loading or failed to load.
+    /// </summary>
+    std::shared_ptr<T> GetAsset() const;
+
+    /// <summary>
+    /// Calls a function once the asset has finished loading, or straight away if it already has.
+    /// </summary>
+    /// <param name="callback">The function.</param>
+    void AddCallback( Callback callback );
+};
+
+/// <summary>
+/// Defines a handle to an asset that may still be loading. Handles are only meant to be used on the
+/// main thread.
+/// </summary>
+template<class T> class AssetHandle
+{
+    friend class AssetLoader;
+
+    std::shared_ptr<TypedAssetRequest<T>> _request;
+
+public:
+    /// <summary>
+    /// Creates a null handle, which is always finished and never has an asset.
+    /// </summary>
+    AssetHandle();
+
+    /// <summary>
+    /// Creates a handle to a request.
+    /// </summary>
+    /// <param name="request">The request.</param>
+    explicit AssetHandle( std::shared_ptr<TypedAssetRequest<T>> request );
+
+    /// <summary>
+    /// Gets the asset, or null if it is still loading or failed to load.
+    /// </summary>
+    std::shared_ptr<T> Get() const;
+
+    /// <summary>
+    /// Gets the state of the asset. Null handles have always failed.
+    /// </summary>
+    AssetState GetState() const;
+
+    /// <summary>
+    /// Checks to see if the asset has finished loading, whether or not it succeeded.
+    /// </summary>
+    bool IsDone() const;
+
+    /// <summary>
+    /// Checks to see if nothing but this handle holds the asset, so letting go of the handle frees it.
+    /// Assets that are still loading are always held by the loader.
+    /// </summary>
+    bool IsUnique() const;
+
+    /// <summary>
+    /// Calls a function on the main thread once the asset has finished loading, or straight away if it
+    /// already has. The function is given null if the asset failed to load.
+    /// </summary>
+    /// <param name="callback">The function.</param>
+    void OnFinished( typename TypedAssetRequest<T>::Callback callback ) const;
+};
+
+/// <summary>
+/// Defines a static asset loader. Files are read and decoded on the job system's workers, so the main
+/// thread only has to hand the results to the GPU, which it does a piece at a time within a budget
+/// every frame so that loading never stalls the window.
+/// </summary>
+class AssetLoader
+{
+    ImplementStaticClass( AssetLoader );
+
+    static std::mutex _decodedMutex;
+    static std::deque<std::shared_ptr<AssetRequest>> _decoded;   // Requests the workers have finished with
+    static std::deque<std::shared_ptr<AssetRequest>> _uploading; // Requests being handed to the GPU, oldest first
+    static size_t _pendingCount;                                   // Only used on the main thread
+
+    /// <summary>
+    /// Hands the rest of a request's asset to the GPU and finishes it.
+    /// </summary>
+    /// <param name="request">The request.</param>
+    static void Complete( const std::shared_ptr<AssetRequest>& request );
+
+    /// <summary>
+    /// Publishes a request's asset once it has been handed to the GPU, or once it has failed.
+    /// </summary>
+    /// <param name="request">The request.</param>
+    static void Publish( const std::shared_ptr<AssetRequest>& request );
+
+    /// <summary>
+    /// Moves the requests the workers have finished with on to the upload queue.
+    /// </summary>
+    static void TakeDecoded();
+
+public:
+    /// <summary>
+    /// Starts loading an asset.
+    /// </summary>
+    /// <param name="request">The asset's request.</param>
+    static void Load( const std::shared_ptr<AssetRequest>& request );
+
+    /// <summary>
+    /// Finishes loading an asset straight away, waiting for it to be decoded and handing all of it to the GPU.
+    /// </summary>
+    /// <param name="request">The asset's request.</param>
+    static void Wait( const std::shared_ptr<AssetRequest>& request );
+
+    /// <summary>
+    /// Finishes loading an asset straight away, waiting for it to be decoded and handing all of it to the GPU.
+    /// </summary>
+    /// <param name="handle">The asset's handle.</param>
+    template<class T> static void Wait( const AssetHandle<T>& handle );
+
+    /// <summary>
+    /// Gets the number of assets that are still loading.
+    /// </summary>
+    static size_t GetPendingCount();
+
+    /// <summary>
+    /// Hands decoded assets to the GPU. Called once a frame on the main thread.
+    /// </summary>
+    /// <param name="budget">The time to spend, in seconds. At least one piece is always handed over, so loading never stops.</param>
+    static void Update( float budget );
+
+    /// <summary>
+    /// Drops every asset that is still loading. Call this once the job system has been shut down.
+    /// </summary>
+    static void Shutdown();
+};
+
+#include "AssetLoader.inl"
@@ -0,0 +1,93 @@
+// Publish the asset and call everything waiting on it
+template<class T> void TypedAssetRequest<T>::Finish( bool isLoaded )
+{
+    if ( !isLoaded )
+    {
+        _asset = nullptr;
+    }
+
+    // Callbacks may add more callbacks or wait on other assets, so work from our own copy
+    std::vector<Callback> callbacks;
+    callbacks.swap( _callbacks );
+    for ( auto& callback : callbacks )
+    {
+        callback( _asset );
+    }
+}
+
+// Get the asset
+template<class T> std::shared_ptr<T> TypedAssetRequest<T>::GetAsset() const
+{
+    return ( GetState() == AssetState::Loaded ) ? _asset : nullptr;
+}
+
+// Call a function once the asset has finished loading
+template<class T> void TypedAssetRequest<T>::AddCallback( Callback callback )
+{
+    if ( GetState() == AssetState::Loading )
+    {
+        _callbacks.push_back( std::move( callback ) );
+    }
+    else
+    {
+        callback( GetAsset() );
+    }
+}
+
+// Create a null handle
+template<class T> AssetHandle<T>::AssetHandle()
+{
+}
+
+// Create a handle to a request
+template<class T> AssetHandle<T>::AssetHandle( std::shared_ptr<TypedAssetRequest<T>> request )
+    : _request( std::move( request ) )
+{
+}
+
+// Get the asset
+template<class T> std::shared_ptr<T> AssetHandle<T>::Get() const
+{
+    return _request ? _request->GetAsset() : nullptr;
+}
+
+// Get the state of the asset
+template<class T> AssetState AssetHandle<T>::GetState() const
+{
+    return _request ? _request->GetState() : AssetState::Failed;
+}
+
+// Check to see if the asset has finished loading
+template<class T> bool AssetHandle<T>::IsDone() const
+{
+    return GetState() != AssetState::Loading;
+}
+
+// Check to see if nothing but this handle holds the asset
+template<class T> bool AssetHandle<T>::IsUnique() const
+{
+    return !_request
+        || ( _request.use_count() == 1 && ( !_request->_asset || _request->_asset.use_count() == 1 ) );
+}
+
+// Call a function once the asset has finished loading
+template<class T> void AssetHandle<T>::OnFinished( typename TypedAssetRequest<T>::Callback callback ) const
+{
+    if ( _request )
+    {
+        _request->AddCallback( std::move( callback ) );
+    }
+    else
+    {
+        callback( nullptr );
+    }
+}
+
+// Finish loading an asset straight away
+template<class T> void AssetLoader::Wait( const AssetHandle<T>& handle )
+{
+    if ( handle._request )
+    {
+        Wait( std::static_pointer_cast<AssetRequest>( handle._request ) );
+    }
+}
@@ -2,10 +2,19 @@
 #include "Time.hpp"
 #include "Input.hpp"
 #include "Physics.hpp"
+#include "SceneLoader.hpp"
+#include "Texture2DArray.hpp"
+#include <algorithm>
 
 #define BALL_SIZE 2.0f
-#define TABLE_TEXTURE "Textures\\Tabel_Texture.png"
+#define TABLE_SCENE "Scenes\\Table.json"
 #define MAX_FORCE 10000.0f
+#define AIM_ASSIST_ANGLE 2.0f	// In degrees
+#define AIM_ASSIST_DISTANCE 150.0f
+#define CAMERA_RADIUS 0.5f
+#define MAX_RACK_ROWS 35	// The largest rack, set up by F7
+#define SHOT_START_TIMEOUT 0.5f	// How long a shot can go without moving the table before the turn is scored anyway
+#define BALL_TEXTURE_COUNT 16	// The cue ball's texture, then one for each numbered ball
 
 Input* inputController;
 vec2 mouseClickPos = inputController->GetMousePosition();
@@ -13,14 +22,15 @@ vec2 mouseClickPos = inputController->GetMousePosition();
 BilliardGameManager::BilliardGameManager()
 {
 	_Game = Game::GetInstance();
+	_BallPool.reserve(MAX_RACK_ROWS * (MAX_RACK_ROWS + 1) / 2);
 
 	// Add a text renderer
 	GameObject* textObject = _Game->AddGameObject("TableTextRenderer");
 	TextMaterial* textMaterial = textObject->AddComponent<TextMaterial>();
 	_TextRenderer = textObject->AddComponent<TextRenderer>();
 
-	std::shared_ptr<Font> font = std::make_shared<Font>();
-	assert(font->LoadFromFile("Fonts\\OpenSans-Regular.ttf"));
+	std::shared_ptr<Font> font = Font::FromFile("Fonts\\OpenSans-Regular.ttf");
+	assert(font);
 	_TextRenderer->SetFont(font);
 	_TextRenderer->SetFontSize(16U);
 	textMaterial->SetTextColor(vec4(0, 0, 0, 1));
@@ -28,6 +38,12 @@ BilliardGameManager::BilliardGameManager()
 	textObject->GetTransform()->SetPosition(glm::vec3(500, 10, 0));
 
 
+	// Aim line
+	GameObject* aimLineObject = _Game->AddGameObject("AimLine");
+	aimLineObject->AddComponent<LineMaterial>();
+	_AimLine = aimLineObject->AddComponent<LineRenderer>();
+
+
 	// Default Camera
 	_camTopDown = _Game->AddGameObject("Top Down Camera");
 	Camera* camera = _camTopDown->AddComponent<Camera>();
@@ -62,29 +78,74 @@ BilliardGameManager::~BilliardGameManager()
 
 void BilliardGameManager::CreateTable()
 {
-	// Create the table
+	// Create the table and its pockets
+
+	std::vector<GameObject*> tableObjects;
+	SceneLoader::Load(TABLE_SCENE, tableObjects);
+
+	// Creates a function pointer to be subscribed to the event listeners of the pocket colliders
+	std::function<void(GameObject*)> func = std::bind(&BilliardGameManager::HandlePocketCollision, this, _1);
+
+	for (GameObject* object : tableObjects)
+	{
+		if (object->GetName() == "Table")
+		{
+			_Table = object;
+		}
+		else if (object->GetName().substr(0, 6) == "Pocket")
+		{
+			// Add the HandlePocketCollision function pointer to the event listener of the pocket.
+			object->GetEventListener()->AddEventListener("OnCollide", func);
+			_PocketColliders.push_back(object);
+		}
+	}
+
+	// The table's own triangles give the cushions and pocket jaws their real shape, but if they couldn't be loaded the table is left without a rigid body
+	if (_Table == nullptr)
+	{
+		_Table = _Game->AddGameObject("Table");
+	}
+	if (_Table->GetComponent<RigidBody>() == nullptr)
+	{
+		CreateTableBoxes();
+	}
+
 
-	_Table = _Game->AddGameObject("Table");
-	SimpleMaterial* tableMaterial = _Table->AddComponent<SimpleMaterial>();
-	MeshRenderer* tableMeshRenderer = _Table->AddComponent<MeshRenderer>();
+	// The balls only ever roll across the table, so simulate them in its plane.
+	// In the planar mode the plane itself keeps the balls on the table, so the floor is never tested.
+	Physics::SetPlaneHeight(BALL_SIZE * 0.5f);
+	Physics::SetSimulationMode(SimulationMode::Planar);
 
-	tableMeshRenderer->SetMesh(MeshLoader::Load("Models\\Pool_Table.fbx"));
-	tableMeshRenderer->SetMaterial(tableMaterial);
-	tableMaterial->SetMyTexture(Texture2D::FromFile(TABLE_TEXTURE));
 
+	// Turn notifications
 
-	// Create the table colliders
+	// The physics tells us when the balls start and stop moving, and when one leaves the table, so we never have to check every ball ourselves
+	Physics::SetTableBounds(vec3(-50, -1000, -25), vec3(50, 1000, 25));
 
+	std::function<void()> onTableMoving = std::bind(&BilliardGameManager::HandleTableMoving, this);
+	std::function<void()> onTableSettled = std::bind(&BilliardGameManager::HandleTableSettled, this);
+	std::function<void(GameObject*)> onBallLeftTable = std::bind(&BilliardGameManager::HandleBallLeftTable, this, _1);
+
+	EventListener* physicsEvents = Physics::GetEventListener();
+	physicsEvents->AddEventListener("OnTableMoving", onTableMoving);
+	physicsEvents->AddEventListener("OnTableSettled", onTableSettled);
+	physicsEvents->AddEventListener("OnBodyLeftTable", onBallLeftTable);
+}
+
+// Creates box colliders that roughly follow the table's floor and cushions
+void BilliardGameManager::CreateTableBoxes()
+{
 	// The table floor
 	GameObject* tableFloor = _Table->AddChild("TableFloor");
 	BoxCollider* tableFloorCollider = tableFloor->AddComponent<BoxCollider>();
 	RigidBody* tableFloorRigidbody = tableFloor->AddComponent<RigidBody>();
 
 	tableFloorRigidbody->SetMass(0.0f);
+	tableFloorCollider->SetSize(glm::vec3(1));
 
-
+	// The floor's top sits where the balls rest
 	tableFloor->GetTransform()->SetScale(vec3(100, 1, 50));
-	tableFloor->GetTransform()->SetPosition(vec3(0, -1.25, 0));
+	tableFloor->GetTransform()->SetPosition(vec3(0, -0.5f, 0));
 
 	_TableColliders.push_back(tableFloor);
 
@@ -129,64 +190,80 @@ void BilliardGameManager::CreateTable()
 		}
 		_TableColliders.push_back(tableWall);
 	}
+}
 
+// Creates the numbered ball kept in the given slot of the pool
+GameObject* BilliardGameManager::CreateBall(unsigned int index)
+{
+	GameObject* ball = _Game->AddGameObject("Ball_" + std::to_string(index));
+	LayeredMaterial* material = ball->AddComponent<LayeredMaterial>();
+	MeshRenderer* meshRenderer = ball->AddComponent<MeshRenderer>();
+	SphereCollider* collider = ball->AddComponent<SphereCollider>();
+	RigidBody* rigidBody = ball->AddComponent<RigidBody>();
 
-	// Pocket Colliders
+	collider->SetRadius(BALL_SIZE* 0.5f);
+	rigidBody->SetMass(1.0f);
 
-	// Creates a function pointer to be subscribed to the event listeners of the pocket colliders
-	std::function<void(GameObject*)> func = std::bind(&BilliardGameManager::HandlePocketCollision, this, _1);
+	meshRenderer->SetMaterial(material);
 
-	// Create the pockets
-	for (int i = 0; i < 6; i++)
-	{
-		GameObject* pocket = _Game->AddGameObject("Pocket_" + std::to_string(i));
+	// Finds the texture of the ball based on its place in the rack
+	LoadBallAssets(ball, index % (BALL_TEXTURE_COUNT - 1) + 1);
 
+	ball->GetTransform()->SetScale(vec3(BALL_SIZE));
+	return ball;
+}
 
-		SphereCollider* pocketCollider = pocket->AddComponent<SphereCollider>();
-		RigidBody* pocketRigidbody = pocket->AddComponent<RigidBody>();
-
-		pocketCollider->SetRadius(4);
-		pocketRigidbody->SetMass(0.0f);
-		pocketRigidbody->SetIsMovable(false);
-
-		/*
-		SimpleMaterial* pocketMaterial = pocket->AddComponent<SimpleMaterial>();
-		MeshRenderer* pocketMeshRenderer = pocket->AddComponent<MeshRenderer>();
-		pocketMeshRenderer->SetMesh(MeshLoader::Load("Models\\Sphere.obj"));
-		pocketMeshRenderer->SetMaterial(pocketMaterial);
-		pocketMaterial->SetMyTexture(Texture2D::FromFile("Textures\\Cue-Ball.png"));
-		*/
+// Starts loading a ball's mesh and texture, handing them to the ball once they're ready so the table can be drawn in the meantime
+void BilliardGameManager::LoadBallAssets(GameObject* ball, unsigned int layer)
+{
+	GameObjectHandle handle = ball->GetHandle();
+	VertexLayout layout = ball->GetComponent<LayeredMaterial>()->GetVertexLayout();
 
-		pocket->GetTransform()->SetScale(vec3(4, 4, 4));
+	MeshLoader::LoadAsync("Models\\Sphere.obj", layout).OnFinished([handle](const std::shared_ptr<Mesh>& mesh)
+	{
+		GameObject* ball = Game::GetInstance()->Find(handle);
+		if (ball)
+		{
+			ball->GetComponent<MeshRenderer>()->SetMesh(mesh);
+		}
+	});
 
-		// Add the HandlePocketCollision function pointer to the event listener of the pocket.
-		pocket->GetEventListener()->AddEventListener("OnCollide", func);
+	// Every ball's texture is a layer of one array, so all of the balls are drawn with the same texture bound
+	std::vector<std::string> texNames;
+	texNames.push_back("Textures\\Cue-Ball.png");
+	for (unsigned int i = 1; i < BALL_TEXTURE_COUNT; i++)
+	{
+		texNames.push_back("Textures\\" + std::to_string(i) + "-Ball.png");
+	}
 
+	Texture2DArray::FromFilesAsync(texNames).OnFinished([handle, layer](const std::shared_ptr<Texture2DArray>& textures)
+	{
+		if (!textures)
+		{
+			std::cout << "Failed to load the ball textures ;_;" << std::endl;
+			return;
+		}
 
-		switch (i)
+		GameObject* ball = Game::GetInstance()->Find(handle);
+		if (ball)
 		{
-		case 0:
-			pocket->GetTransform()->SetPosition(vec3(50, 0, 25));
-			break;
-		case 1:
-			pocket->GetTransform()->SetPosition(vec3(0, 0, 25));
-			break;
-		case 2:
-			pocket->GetTransform()->SetPosition(vec3(-50, 0, 25));
-			break;
-		case 3:
-			pocket->GetTransform()->SetPosition(vec3(50, 0, -25));
-			break;
-		case 4:
-			pocket->GetTransform()->SetPosition(vec3(0, 0, -25));
-			break;
-		case 5:
-			pocket->GetTransform()->SetPosition(vec3(-50, 0, -25));
-			break;
+			ball->GetComponent<LayeredMaterial>()->SetTextures(textures, layer);
 		}
+	});
+}
 
-		_PocketColliders.push_back(pocket);
-	}
+// Puts a ball back on the table at rest
+void BilliardGameManager::ResetBall(GameObject* ball, vec3 position)
+{
+	RigidBody* rigidBody = ball->GetComponent<RigidBody>();
+
+	ball->GetTransform()->SetPosition(position);
+	rigidBody->SetVelocity(vec3(0));
+	rigidBody->SetAcceleration(vec3(0));
+	ball->SetActive(true);
+
+	// Pocketed balls were taken out of the simulation
+	Physics::RegisterRigidbody(rigidBody);
 }
 
 // Places the pool balls into starting position
@@ -199,7 +276,7 @@ void BilliardGameManager::PreparePoolBalls(int rows)
     if (_Cueball == nullptr)
     {
 		_Cueball = _Game->AddGameObject("Cueball");
-		SimpleMaterial* material = _Cueball->AddComponent<SimpleMaterial>();
+		LayeredMaterial* material = _Cueball->AddComponent<LayeredMaterial>();
 		MeshRenderer* meshRenderer = _Cueball->AddComponent<MeshRenderer>();
 		SphereCollider* collider = _Cueball->AddComponent<SphereCollider>();
 		RigidBody* rigidBody = _Cueball->AddComponent<RigidBody>();
@@ -208,59 +285,35 @@ void BilliardGameManager::PreparePoolBalls(int rows)
 
         rigidBody->SetMass(1.0f);
 
-        meshRenderer->SetMesh(MeshLoader::Load("Models\\Sphere.obj"));
         meshRenderer->SetMaterial(material);
 
-		material->SetMyTexture(Texture2D::FromFile("Textures\\Cue-Ball.png"));
+		LoadBallAssets(_Cueball, 0);
+		_Cueball->GetTransform()->SetScale(vec3(BALL_SIZE));
     }
 
 	// Puts the Cueball in the proper position and makes sure it is at rest
-	_Cueball->GetTransform()->SetPosition(vec3(-11, BALL_SIZE * 0.5f, 0));
-	_Cueball->GetTransform()->SetScale(vec3(BALL_SIZE));
-	_Cueball->GetComponent<RigidBody>()->SetVelocity(vec3(0));
-	_Cueball->GetComponent<RigidBody>()->SetAcceleration(vec3(0));
-	_Cueball->SetActive(true);
-
-	// Remove existing numbered balls to create them a new
-    for (GameObject* ball : _Balls)
+	ResetBall(_Cueball, vec3(-11, BALL_SIZE * 0.5f, 0));
+
+	// Put the last rack's balls away. They stay in the pool, so only balls this rack has never needed are created.
+	// Pooled balls leave the simulation too, so queries and predictions can't hit them.
+    for (GameObject* ball : _BallPool)
     {
-        _Game->Destroy(ball);
+        ball->SetActive(false);
+        Physics::UnregisterRigidbody(ball->GetComponent<RigidBody>());
     }
     _Balls.clear();
 
-    // Creates and place the numbered balls
+    // Places the numbered balls
     for (int row = 1; row <= rows; row++)
     {
         for (int i = 0; i < row; i++)
         {
-            GameObject* ball = _Game->AddGameObject("Ball_" + std::to_string(row) + '_' + std::to_string(i));
-            Transform* transform = ball->GetTransform();
-            SimpleMaterial* material = ball->AddComponent<SimpleMaterial>();
-            MeshRenderer* meshRenderer = ball->AddComponent<MeshRenderer>();
-            SphereCollider* collider = ball->AddComponent<SphereCollider>();
-            RigidBody* rigidBody = ball->AddComponent<RigidBody>();
-
-            collider->SetRadius(BALL_SIZE* 0.5f);
-            rigidBody->SetMass(1.0f);
-
-            meshRenderer->SetMesh(MeshLoader::Load("Models\\Sphere.obj"));
-            meshRenderer->SetMaterial(material);
-
-			// Finds the texture of the ball based on the current one selected
-            std::string texName = "Textures\\" + std::to_string((_Balls.size()) % 15 + 1) + "-Ball.png";
-            std::cout << "Loading " << texName << "... ";
-
-            std::shared_ptr<Texture2D> texture = Texture2D::FromFile(texName);
-            if (texture)
-            {
-                material->SetMyTexture(texture);
-                std::cout << "Done." << std::endl;
-            }
-            else
-            {
-                std::cout << "Failed. ;_;" << std::endl;
-            }
-
+			unsigned int index = _Balls.size();
+			if (index == _BallPool.size())
+			{
+				_BallPool.push_back(CreateBall(index));
+			}
+			GameObject* ball = _BallPool[index];
 
             //float xPos = (-(row - 1) * 0.7f + i * 1.4f) * BALL_SIZE;
             //float zPos = (row * 0.8f) * BALL_SIZE;
@@ -268,9 +321,7 @@ void BilliardGameManager::PreparePoolBalls(int rows)
             float xPos = (row * 0.8f) * BALL_SIZE;
             float zPos = (-(row - 1) * 0.7f + i * 1.4f) * BALL_SIZE;
 
-            transform->SetPosition(vec3(xPos, BALL_SIZE * 0.5f, zPos));
-            transform->SetScale(vec3(BALL_SIZE));
-
+            ResetBall(ball, vec3(xPos, BALL_SIZE * 0.5f, zPos));
             _Balls.push_back(ball);
         }
     }
@@ -282,87 +333,341 @@ void BilliardGameManager::PreparePoolBalls(int rows)
 	_camFollower->GetComponent<SmoothFollow>()->SetTarget(_Cueball->GetTransform());
 	_camTracker->GetComponent<Tracker>()->SetTarget(_Cueball->GetTransform());
 
+	// Any prediction made for the old table is no longer valid
+	_ShotPredictor.Cancel();
+	_AimLine->ClearLines();
 
-	// Line rendering
-    GameObject* line = _Game->AddGameObject("Line");
-    LineMaterial* lineMaterial = line->AddComponent<LineMaterial>();
-    MeshRenderer* lineMeshRenderer = line->AddComponent<MeshRenderer>();
+	// Start a new turn
+	_IsCueballPocketed = false;
+	SetState(TurnState::Aiming);
+}
+
+// Gets the force a shot released at the given mouse position would apply
+vec3 BilliardGameManager::GetShotForce(vec2 mousePosition)
+{
+	vec2 mousePosDifference = mouseClickPos - mousePosition;
+	mousePosDifference *= 4.0f;
+	mousePosDifference = glm::clamp(mousePosDifference, -MAX_FORCE, MAX_FORCE);
 
-    lineMeshRenderer->SetMaterial(lineMaterial);
+	return ApplyAimAssist(vec3(mousePosDifference.x, 0, mousePosDifference.y));
 }
 
-void BilliardGameManager::Update()
+// Lines a shot up with the center of the ball it is already almost aimed at
+vec3 BilliardGameManager::ApplyAimAssist(vec3 force)
 {
-	_IsTableSettled = true;
-    for (unsigned int i = 0; i < _Balls.size(); i++)
-    {
-		// Checks if the table is settled
-		if (!_Balls[i]->GetComponent<RigidBody>()->IsAtRest())
+	float strength = glm::length(force);
+	if (strength == 0.0f)
+	{
+		return force;
+	}
+
+	// Find the first thing the cue ball would run into. The cast is a touch thinner than a ball so it doesn't scrape along the table.
+	vec3 direction = force / strength;
+	vec3 cuePosition = _Cueball->GetTransform()->GetPosition();
+	RaycastHit hit;
+	if (!Physics::SphereCast(cuePosition, BALL_SIZE * 0.45f, direction, AIM_ASSIST_DISTANCE, hit))
+	{
+		return force;
+	}
+
+	// Only snap onto numbered balls
+	GameObject* target = hit.HitCollider->GetGameObject();
+	if (target->GetName().substr(0, 4) != "Ball")
+	{
+		return force;
+	}
+
+	vec3 toTarget = target->GetTransform()->GetPosition() - cuePosition;
+	toTarget.y = 0;
+	float distance = glm::length(toTarget);
+	if (distance == 0.0f || glm::dot(direction, toTarget / distance) < glm::cos(glm::radians(AIM_ASSIST_ANGLE)))
+	{
+		return force;
+	}
+
+	return toTarget / distance * strength;
+}
+
+// Makes the ball under the mouse the cameras' target
+void BilliardGameManager::PickBall(vec2 mousePosition)
+{
+	GameWindow* window = GameWindow::GetCurrentWindow();
+	if (!window || !_ActiveCamera)
+	{
+		return;
+	}
+
+	// Un-project the mouse onto the near and far planes
+	vec2 ndc(2.0f * mousePosition.x / window->GetWidth() - 1.0f, 1.0f - 2.0f * mousePosition.y / window->GetHeight());
+	mat4 inverseViewProjection = glm::inverse(_ActiveCamera->GetProjection() * _ActiveCamera->GetView());
+	vec4 nearPoint = inverseViewProjection * vec4(ndc, -1, 1);
+	vec4 farPoint = inverseViewProjection * vec4(ndc, 1, 1);
+	vec3 origin = vec3(nearPoint) / nearPoint.w;
+	vec3 direction = vec3(farPoint) / farPoint.w - origin;
+
+	RaycastHit hit;
+	if (!Physics::Raycast(origin, direction, glm::length(direction), hit))
+	{
+		return;
+	}
+
+	GameObject* picked = hit.HitCollider->GetGameObject();
+	if (picked == _Cueball)
+	{
+		_camFollower->GetComponent<SmoothFollow>()->SetTarget(_Cueball->GetTransform());
+		_camTracker->GetComponent<Tracker>()->SetTarget(_Cueball->GetTransform());
+		return;
+	}
+
+	for (unsigned int i = 0; i < _Balls.size(); i++)
+	{
+		if (_Balls[i] == picked)
 		{
-			_IsTableSettled = false;
+			_TargetBallIndex = i;
+			_camFollower->GetComponent<SmoothFollow>()->SetTarget(picked->GetTransform());
+			_camTracker->GetComponent<Tracker>()->SetTarget(picked->GetTransform());
+			return;
 		}
+	}
+}
 
-		// Checks if any of the balls exceeded bounds
-		vec3 position = _Balls[i]->GetTransform()->GetPosition();
-        if (glm::abs(position.x) > 50.0f
-            || glm::abs(position.z) > 25.0f)
-        {
-			_Game->Destroy(_Balls[i]);
-			_Balls.erase(_Balls.begin() + i);
-            i--;
-        }
-    }
-	_IsTableSettled = _IsTableSettled && _Cueball->GetComponent<RigidBody>()->IsAtRest();
+// Pulls the following camera in front of anything between it and its target
+void BilliardGameManager::UpdateCameraCollision()
+{
+	Transform* target = _camFollower->GetComponent<SmoothFollow>()->GetTarget();
+	if (!target)
+	{
+		return;
+	}
 
-    // Reset table
-    if (Input::WasKeyPressed(Key::F1))
-    {
-        PreparePoolBalls(5);
-    }
-    else if (Input::WasKeyPressed(Key::F2))
-    {
-        PreparePoolBalls(10);
-    }
-    else if (Input::WasKeyPressed(Key::F3))
-    {
-        PreparePoolBalls(15);
-    }
-    else if (Input::WasKeyPressed(Key::F4))
-    {
-        PreparePoolBalls(20);
-    }
-    else if (Input::WasKeyPressed(Key::F5))
-    {
-        PreparePoolBalls(25);
-    }
-    else if (Input::WasKeyPressed(Key::F6))
-    {
-        PreparePoolBalls(30);
-    }
-    else if (Input::WasKeyPressed(Key::F7))
+	// The target's own collider is ignored, as the cast starts inside it
+	Transform* cameraTransform = _camFollower->GetTransform();
+	vec3 from = target->GetPosition();
+	vec3 toCamera = cameraTransform->GetPosition() - from;
+	float distance = glm::length(toCamera);
+
+	RaycastHit hit;
+	if (distance > 0.0f && Physics::SphereCast(from, CAMERA_RADIUS, toCamera, distance, hit))
+	{
+		cameraTransform->SetPosition(from + toCamera / distance * hit.Distance);
+	}
+}
+
+// Requests a new prediction if the aim has changed
+void BilliardGameManager::UpdateAimPrediction()
+{
+	vec3 force = GetShotForce(inputController->GetMousePosition());
+	if (force == _LastAimForce)
+	{
+		return;
+	}
+	_LastAimForce = force;
+
+	// Snapshot the table and give the cue ball the velocity the shot would give it on the next step
+	RigidBody* cueRigidBody = _Cueball->GetComponent<RigidBody>();
+	Physics::CaptureSnapshot(_AimSnapshot, _AimSnapshotOwners);
+	for (unsigned int i = 0; i < _AimSnapshotOwners.size(); i++)
+	{
+		if (_AimSnapshotOwners[i] == cueRigidBody)
+		{
+			float invMass = (_AimSnapshot[i].Mass == 0.0f) ? 0.0f : (1.0f / _AimSnapshot[i].Mass);
+			_AimSnapshot[i].Velocity += force * invMass * Time::GetElapsedTime();
+
+			// This cancels whatever the predictor was still working on
+			_ShotPredictor.Predict(_AimSnapshot, i, Physics::GetSimulationMode(), Physics::GetPlaneHeight());
+			return;
+		}
+	}
+}
+
+// Lines up and takes a shot
+void BilliardGameManager::UpdateAiming()
+{
+	if (Input::WasButtonPressed(MouseButton::Left))
+	{
+		mouseClickPos = inputController->GetMousePosition();
+		_LastAimForce = vec3(0);
+	}
+	if (Input::IsButtonDown(MouseButton::Left))
+	{
+		UpdateAimPrediction();
+	}
+    if (Input::WasButtonReleased(MouseButton::Left))
     {
-        PreparePoolBalls(35);
+        std::cout << "mouseX" << mouseClickPos.x << std::endl;
+        std::cout << "mouseY" << mouseClickPos.y << std::endl;
+        vec2 mouseReleasePos = inputController->GetMousePosition();
+
+		_ShotPredictor.Cancel();
+		_AimLine->ClearLines();
+
+		// Releasing without pulling back doesn't take a shot
+		vec3 force = GetShotForce(mouseReleasePos);
+		if (force != vec3(0))
+		{
+			_Cueball->GetComponent<RigidBody>()->AddForce(force);
+			SetState(TurnState::ShotInFlight);
+		}
     }
 
+	// Show the newest finished prediction, if there is one
+	if (_ShotPredictor.TryGetPrediction(_AimPrediction))
+	{
+		_AimLine->ClearLines();
+		_AimLine->AddLineStrip(_AimPrediction.CuePath, vec4(1, 1, 1, 1));
+		_AimLine->AddLineStrip(_AimPrediction.ObjectPath, vec4(1, 1, 0, 1));
+	}
+}
+
+// Rebuilds the text shown on screen
+void BilliardGameManager::UpdateText()
+{
+	static const char* StateNames[] = { "Aiming", "Shot in flight", "Settling", "Scoring" };
+
+	_TextRenderer->SetText(std::to_string(_Score) + '/' + std::to_string(_Balls.size())
+		+ "\nTurn: " + StateNames[static_cast<int>(_State)]
+		+ "\nCamera Mode: " + _ActiveCamera->GetGameObject()->GetName()
+		+ "\nSimulation: " + (Physics::GetSimulationMode() == SimulationMode::Planar ? "Planar" : "3D")
+		);
+	_IsTextDirty = false;
+}
+
+// Moves the turn on to the given state
+void BilliardGameManager::SetState(TurnState state)
+{
+	_State = state;
+	_StateTime = 0.0f;
+	_IsTextDirty = true;
+}
+
+// Decides what happens once the table has settled after a shot
+void BilliardGameManager::ScoreTurn()
+{
+	if (_IsCueballPocketed)
+	{
+		if (_Score == _Balls.size())
+		{
+			std::printf("You Win");
+		}
+		else
+		{
+			std::printf("Cueball entered pocket before the others.");
+		}
+
+		// Racking the balls starts the next turn
+		PreparePoolBalls();
+		return;
+	}
+
+	SetState(TurnState::Aiming);
+}
+
+// Called by the physics when the table starts moving
+void BilliardGameManager::HandleTableMoving()
+{
+	if (_State == TurnState::ShotInFlight)
+	{
+		SetState(TurnState::Settling);
+	}
+}
+
+// Called by the physics when every ball on the table has stopped
+void BilliardGameManager::HandleTableSettled()
+{
+	// The turn is scored on our next update, rather than in the middle of the physics update
+	if (_State == TurnState::Settling)
+	{
+		SetState(TurnState::Scoring);
+	}
+}
+
+// Called by the physics when a ball ends a step outside of the table
+void BilliardGameManager::HandleBallLeftTable(GameObject* gameObject)
+{
+	if (gameObject == _Cueball)
+	{
+		_IsCueballPocketed = true;
+		_Cueball->SetActive(false);
+		return;
+	}
+
+	auto search = std::find(_Balls.begin(), _Balls.end(), gameObject);
+	if (search != _Balls.end())
+	{
+		// The ball goes back to the pool for the next rack
+		gameObject->SetActive(false);
+		Physics::UnregisterRigidbody(gameObject->GetComponent<RigidBody>());
+		_Balls.erase(search);
+		_IsTextDirty = true;
+	}
+}
+
+void BilliardGameManager::Update()
+{
+	_StateTime += Time::GetElapsedTime();
+
+	// Move the turn along. Everything else it waits on is sent to us by the physics.
+	switch (_State)
+	{
+	case TurnState::Aiming:
+		UpdateAiming();
+		break;
+	case TurnState::ShotInFlight:
+		// A shot too soft to move anything never starts the table moving
+		if (_StateTime > SHOT_START_TIMEOUT)
+		{
+			SetState(TurnState::Scoring);
+		}
+		break;
+	case TurnState::Scoring:
+		ScoreTurn();
+		break;
+	default:
+		break;
+	}
+
+    // Reset table. F1 racks five rows, and each key after it racks five more.
+	static const Key RackKeys[] = { Key::F1, Key::F2, Key::F3, Key::F4, Key::F5, Key::F6, Key::F7 };
+	for (int i = 0; i < 7; i++)
+	{
+		if (Input::WasKeyPressed(RackKeys[i]))
+		{
+			PreparePoolBalls(5 * (i + 1));
+			break;
+		}
+	}
+
 
     // Change camera mode
     if (Input::WasKeyPressed(Key::Num1))
     {
         _ActiveCamera = _camTopDown->GetComponent < Camera>();
+		_IsTextDirty = true;
     }
     else if (Input::WasKeyPressed(Key::Num2))
     {
 		_ActiveCamera = _camFollower->GetComponent < Camera>();
+		_IsTextDirty = true;
     }
     else if (Input::WasKeyPressed(Key::Num3))
     {
 		_ActiveCamera = _camTracker->GetComponent < Camera>();
+		_IsTextDirty = true;
     }
     else if (Input::WasKeyPressed(Key::Num4))
     {
 		_ActiveCamera = _camFPS->GetComponent < Camera>();
+		_IsTextDirty = true;
     }
 
+	// Switch between the planar and full 3D simulations (e.g. for jump shots)
+	if (Input::WasKeyPressed(Key::J))
+	{
+		bool isPlanar = (Physics::GetSimulationMode() == SimulationMode::Planar);
+		Physics::SetSimulationMode(isPlanar ? SimulationMode::Spatial : SimulationMode::Planar);
+		_IsTextDirty = true;
+	}
+
 	// Change camera target
     if (Input::WasKeyReleased(Key::Up))
     {
@@ -384,29 +689,20 @@ void BilliardGameManager::Update()
 		_camTracker->GetComponent<Tracker>()->SetTarget(_Cueball->GetTransform());
     }
 
+	UpdateCameraCollision();
+
     // Mouse stuff
-	if (Input::WasButtonPressed(MouseButton::Left))
+	if (Input::WasButtonPressed(MouseButton::Right))
 	{
-		mouseClickPos = inputController->GetMousePosition();
+		PickBall(inputController->GetMousePosition());
 	}
-    if (Input::WasButtonReleased(MouseButton::Left))
-    {
-        std::cout << "mouseX" << mouseClickPos.x << std::endl;
-        std::cout << "mouseY" << mouseClickPos.y << std::endl;
-        vec2 mouseReleasePos = inputController->GetMousePosition();
-        vec2 mousePosDifference = mouseClickPos - mouseReleasePos;
-		mousePosDifference *= 4.0f;
-		glm::clamp(mousePosDifference, -MAX_FORCE, MAX_FORCE);
-		
-        _Cueball->GetComponent<RigidBody>()->AddForce(vec3(mousePosDifference.x, 0, mousePosDifference.y));
-    }
 
 
-	// Sets the text
-	_TextRenderer->SetText(std::to_string(_Score) + '/' + std::to_string(_Balls.size())
-		+ "\nIs table settled: " + (_IsTableSettled ? "Yes" : "No")
-		+ "\nCamera Mode: " + _ActiveCamera->GetGameObject()->GetName()
-		);
+	// Only rebuild the text when something it shows has changed
+	if (_IsTextDirty)
+	{
+		UpdateText();
+	}
 }
 
 /*
@@ -420,17 +716,9 @@ void BilliardGameManager::HandlePocketCollision(GameObject* gameObject)
 	// Checks if game object is the Cueball
 	if (name == "Cueball")
     {
-		_Cueball->GetComponent<RigidBody>()->SetPosition(vec3(-11, BALL_SIZE * 0.5f, 0));
-		if (_Score == _Balls.size())
-		{
-			std::printf("You Win");
-			PreparePoolBalls();
-		}
-		else
-		{
-			std::printf("Cueball entered pocket before the others.");
-			PreparePoolBalls();
-		}
+		// The turn ends once the rest of the table settles
+		_IsCueballPocketed = true;
+		_Cueball->SetActive(false);
     }
 	// Checks if the game object is a numbered ball
 	else if (name.substr(0,4) == "Ball")	// The first four characters of the name of the numbered balls is "Ball"
@@ -438,6 +726,7 @@ void BilliardGameManager::HandlePocketCollision(GameObject* gameObject)
 		// Place ball over wall
 		gameObject->GetTransform()->SetPosition(vec3(-50 + _Score * BALL_SIZE, 10, -25));
 		_Score++;
+		_IsTextDirty = true;
 		gameObject->GetComponent<RigidBody>()->SetVelocity(vec3(0));
 
 		// Removes object from simulation
@@ -2,11 +2,21 @@
 #include "Components.hpp"
 #include "MeshLoader.hpp"
 #include "Game.hpp"
+#include "ShotPredictor.hpp"
 
 class Game;
 
 class BilliardGameManager
 {
+	// The steps of a turn
+	enum class TurnState
+	{
+		Aiming,			// Waiting for the player to take a shot
+		ShotInFlight,	// The shot was taken, but the physics hasn't reported the table moving yet
+		Settling,		// Waiting for every ball to stop
+		Scoring			// Every ball has stopped, so the turn can be scored
+	};
+
 	Game* _Game = nullptr;
 
 	GameObject* _Table = nullptr;
@@ -15,6 +25,7 @@ class BilliardGameManager
 
 	GameObject* _Cueball = nullptr;
 	vector<GameObject*> _Balls = vector<GameObject*>();	// List of numbered balls. DOES NOT INCLUDE Cueball.
+	vector<GameObject*> _BallPool = vector<GameObject*>();	// Every numbered ball created so far, reused by each new rack
 
 	// Cameras
 	GameObject* _camTopDown;	// Static camera. Looks upon the table
@@ -24,12 +35,41 @@ class BilliardGameManager
 	int _TargetBallIndex;	// The index of the currently target ball.
 	Camera* _ActiveCamera;	// The camera currently being drawn for
 
-	bool _IsTableSettled = false;
+	// Turns
+	TurnState _State = TurnState::Aiming;
+	float _StateTime = 0.0f;	// How long we've been in the current state
+	bool _IsCueballPocketed = false;	// Set when the cue ball is pocketed or leaves the table, and handled once the table settles
 
 	int _Score = 0;
 
 	// Text
 	TextRenderer* _TextRenderer;
+	bool _IsTextDirty = true;	// Set when anything shown by the text changes
+
+	// Aiming
+	LineRenderer* _AimLine;	// Draws the predicted paths of the pending shot
+	ShotPredictor _ShotPredictor;	// Fast-forwards the pending shot on a worker thread
+	ShotPredictor::Prediction _AimPrediction;
+	vector<SimulationBody> _AimSnapshot;
+	vector<RigidBody*> _AimSnapshotOwners;
+	vec3 _LastAimForce = vec3(0);
+
+	void CreateTableBoxes();	// Creates box colliders for the table, used if the table's mesh can't be collided with
+	GameObject* CreateBall(unsigned int index);	// Creates the numbered ball kept in the given slot of the pool
+	void LoadBallAssets(GameObject* ball, unsigned int layer);	// Loads a ball's mesh and its layer of the ball textures in the background
+	void ResetBall(GameObject* ball, vec3 position);	// Puts a ball back on the table at rest
+	vec3 GetShotForce(vec2 mousePosition);	// Gets the force a shot released at the given mouse position would apply
+	vec3 ApplyAimAssist(vec3 force);	// Lines a shot up with the center of the ball it is already almost aimed at
+	void PickBall(vec2 mousePosition);	// Makes the ball under the mouse the cameras' target
+	void UpdateCameraCollision();	// Pulls the following camera in front of anything between it and its target
+	void UpdateAimPrediction();	// Requests a new prediction if the aim has changed
+	void UpdateAiming();	// Lines up and takes a shot
+	void UpdateText();	// Rebuilds the text shown on screen
+	void SetState(TurnState state);	// Moves the turn on to the given state
+	void ScoreTurn();	// Decides what happens once the table has settled after a shot
+	void HandleTableMoving();	// Subscribed to the "OnTableMoving" event of the physics
+	void HandleTableSettled();	// Subscribed to the "OnTableSettled" event of the physics
+	void HandleBallLeftTable(GameObject*);	// Subscribed to the "OnBodyLeftTable" event of the physics
 
 public:
 	BilliardGameManager();
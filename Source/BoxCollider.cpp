@@ -34,13 +34,13 @@ glm::vec3 BoxCollider::GetGlobalCenter() const
 // Gets the maximum point of this collider
 glm::vec3 BoxCollider::GetMaxPoint() const
 {
-    return GetGlobalCenter() + _size * 0.5f;
+    return GetGlobalCenter() + GetSize() * 0.5f;
 }
 
 // Gets the minimum point of this collider
 glm::vec3 BoxCollider::GetMinPoint() const
 {
-    return GetGlobalCenter() - _size * 0.5f;
+    return GetGlobalCenter() - GetSize() * 0.5f;
 }
 
 // Gets this box collider's size
@@ -9,6 +9,7 @@
 /// </summary>
 class BoxCollider : public Collider
 {
+    ImplementComponent( BoxCollider, Collider );
     glm::vec3 _center;
     glm::vec3 _size;
 
@@ -1,4 +1,5 @@
 #include "Camera.h"
+#include <limits>
 
 Camera::Camera(GameObject* gameObject)
 	: Component(gameObject)
@@ -107,6 +108,24 @@ glm::mat4  Camera::GetProjection() const
 	return m_m4Projection;
 }
 
+// Gets how many pixels a sphere's radius covers on screen.
+float Camera::GetProjectedRadius(glm::vec3 a_v3Center, float a_fRadius) const
+{
+	float fPixelsPerUnit = m_m4Projection[1][1] * GameWindow::GetCurrentWindow()->GetHeight() * 0.5f;
+	if (m_bOrthogonal)
+	{
+		return a_fRadius * fPixelsPerUnit;
+	}
+
+	// Spheres the camera is inside of or right up against are as big as they get
+	float fDepth = -(m_m4View * glm::vec4(a_v3Center, 1.0f)).z;
+	if (fDepth <= a_fRadius)
+	{
+		return std::numeric_limits<float>::max();
+	}
+	return a_fRadius * fPixelsPerUnit / fDepth;
+}
+
 void Camera::LookAtDirection(glm::vec3 a_v3Direction)
 {
 	// Makes sure the new direction vector actually points somewhere.
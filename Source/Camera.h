@@ -7,6 +7,7 @@
 class Camera :
 	public Component
 {
+	ImplementComponent(Camera, Component);
 private:
 	glm::mat4 m_m4Projection;	// Projection Matrix
 	glm::mat4 m_m4View;		// View Matrix
@@ -44,6 +45,11 @@ public:
 	glm::mat4 GetView() const;
 	glm::mat4 GetProjection() const;
 
+	///<summary>
+	/// Gets how many pixels a sphere's radius covers on screen, for picking levels of detail.
+	///</summary>
+	float GetProjectedRadius(glm::vec3 a_v3Center, float a_fRadius) const;
+
 	glm::vec3 GetPosition();
 	void SetPosition(glm::vec3 a_v3Position);	// Sets the position, but does not change the orientation
 
@@ -4,6 +4,7 @@
 class CameraManager
 	: public Component
 {
+	ImplementComponent(CameraManager, Component);
 	std::vector<Camera*> cameras;
 	int activeCameraIndex;
 
@@ -1,5 +1,6 @@
 #include "Collider.hpp"
 #include "BoxCollider.hpp"
+#include "MeshCollider.hpp"
 #include "SphereCollider.hpp"
 #include "Physics.hpp"
 #include <iostream>
@@ -42,6 +43,12 @@ bool Collider::CollidesWith( Collider* const other )
             SphereCollider* thatSphere = dynamic_cast<SphereCollider*>( other );
             return Physics::AreColliding( thisBox, thatSphere );
         }
+        // If the other collider is a mesh, then do box-mesh collision
+        else if ( other->GetColliderType() == ColliderType::Mesh )
+        {
+            MeshCollider* thatMesh = dynamic_cast<MeshCollider*>( other );
+            return Physics::AreColliding( thisBox, thatMesh );
+        }
     }
     else if ( _colliderType == ColliderType::Sphere )
     {
@@ -60,6 +67,35 @@ bool Collider::CollidesWith( Collider* const other )
             SphereCollider* thatSphere = dynamic_cast<SphereCollider*>( other );
             return Physics::AreColliding( thisSphere, thatSphere );
         }
+        // If the other collider is a mesh, then do mesh-sphere collision
+        else if ( other->GetColliderType() == ColliderType::Mesh )
+        {
+            MeshCollider* thatMesh = dynamic_cast<MeshCollider*>( other );
+            return Physics::AreColliding( thatMesh, thisSphere );
+        }
+    }
+    else if ( _colliderType == ColliderType::Mesh )
+    {
+        // Get ourselves as a mesh
+        MeshCollider* thisMesh = dynamic_cast<MeshCollider*>( this );
+
+        // If the other collider is a box, then do box-mesh collision
+        if ( other->GetColliderType() == ColliderType::Box )
+        {
+            BoxCollider* thatBox = dynamic_cast<BoxCollider*>( other );
+            return Physics::AreColliding( thatBox, thisMesh );
+        }
+        // If the other collider is a sphere, then do mesh-sphere collision
+        else if ( other->GetColliderType() == ColliderType::Sphere )
+        {
+            SphereCollider* thatSphere = dynamic_cast<SphereCollider*>( other );
+            return Physics::AreColliding( thisMesh, thatSphere );
+        }
+        // Static meshes never need to be tested against each other
+        else if ( other->GetColliderType() == ColliderType::Mesh )
+        {
+            return false;
+        }
     }
 
 #if defined( _DEBUG ) || defined( DEBUG )
@@ -10,7 +10,8 @@ enum class ColliderType
 {
     Unknown = 0,
     Box     = ( 1 << 0 ),
-    Sphere  = ( 1 << 1 )
+    Sphere  = ( 1 << 1 ),
+    Mesh    = ( 1 << 2 )
 };
 
 /// <summary>
@@ -18,6 +19,7 @@ enum class ColliderType
 /// </summary>
 class Collider : public Component
 {
+    ImplementComponent( Collider, Component );
 protected:
     const ColliderType _colliderType;
 
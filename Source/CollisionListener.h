@@ -5,6 +5,7 @@
 class CollisionListener :
 	public Component
 {
+	ImplementComponent(CollisionListener, Component);
 public:
 	CollisionListener();
 	~CollisionListener();
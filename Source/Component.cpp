@@ -2,8 +2,11 @@
 
 // Create a new component
 Component::Component( GameObject* gameObject )
-    : _gameObject( gameObject )
+    : _typeMask( 0 )
+    , _pool( nullptr )
+    , _gameObject( gameObject )
     , _isEnabled( true )
+    , _usesLateUpdate( false )
     , _isDrawable( false )
 {
 }
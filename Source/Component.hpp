@@ -1,5 +1,8 @@
 #pragma once
 
+#include "ComponentType.hpp"
+
+class ComponentPool;
 class GameObject;
 
 /// <summary>
@@ -7,6 +10,11 @@ class GameObject;
 /// </summary>
 class Component
 {
+    friend class GameObject; // The game object records our type mask and pool
+
+    ComponentTypeMask _typeMask;
+    ComponentPool* _pool;
+
 protected:
     GameObject* const _gameObject;
     bool _isEnabled;
@@ -14,6 +22,8 @@ protected:
     bool _isDrawable;
 
 public:
+    typedef Component ComponentClass;
+
     /// <summary>
     /// Creates a new component.
     /// </summary>
@@ -35,6 +45,14 @@ public:
     /// </summary>
     GameObject* GetGameObject();
 
+    /// <summary>
+    /// Gets the mask of this component's type and every component type it derives from.
+    /// </summary>
+    inline ComponentTypeMask GetTypeMask() const
+    {
+        return _typeMask;
+    }
+
     /// <summary>
     /// Checks to see if this component is enabled.
     /// </summary>
@@ -0,0 +1,154 @@
+#include "ComponentPool.hpp"
+#include "Component.hpp"
+#include "GameObject.hpp"
+
+ComponentPool* ComponentPool::_pools[ MAX_COMPONENT_TYPES ];
+std::vector<ComponentPool*> ComponentPool::_updateOrder;
+
+// Create a new component pool
+ComponentPool::ComponentPool( ComponentTypeId typeId, ComponentTypeMask typeMask, size_t stride )
+    : _typeId( typeId )
+    , _typeMask( typeMask )
+    , _stride( stride )
+    , _firstFreeChunk( 0 )
+    , _count( 0 )
+{
+}
+
+// Destroy this component pool
+ComponentPool::~ComponentPool()
+{
+    // Destroy any components that are still alive
+    for ( auto& chunk : _chunks )
+    {
+        for ( unsigned int slot = 0; slot < COMPONENT_CHUNK_SIZE; ++slot )
+        {
+            if ( chunk.LiveMask & ( 1ULL << slot ) )
+            {
+                GetItem( chunk, slot )->~Component();
+            }
+        }
+        delete[] chunk.Items;
+    }
+}
+
+// Reserve a slot for a new component
+void* ComponentPool::Allocate()
+{
+    // Find the first chunk with room, adding a new chunk if they are all full
+    while ( _firstFreeChunk < _chunks.size() && _chunks[ _firstFreeChunk ].LiveMask == ~0ULL )
+    {
+        ++_firstFreeChunk;
+    }
+    if ( _firstFreeChunk == _chunks.size() )
+    {
+        Chunk chunk;
+        chunk.Items = new unsigned char[ _stride * COMPONENT_CHUNK_SIZE ];
+        chunk.LiveMask = 0;
+        _chunks.push_back( chunk );
+    }
+
+    // Take the first free slot in the chunk
+    Chunk& chunk = _chunks[ _firstFreeChunk ];
+    unsigned int slot = 0;
+    while ( chunk.LiveMask & ( 1ULL << slot ) )
+    {
+        ++slot;
+    }
+
+    chunk.LiveMask |= ( 1ULL << slot );
+    ++_count;
+    return chunk.Items + slot * _stride;
+}
+
+// Destroy a component in this pool
+void ComponentPool::Destroy( Component* component )
+{
+    unsigned char* address = reinterpret_cast<unsigned char*>( component );
+    size_t chunkSize = _stride * COMPONENT_CHUNK_SIZE;
+
+    for ( size_t index = 0; index < _chunks.size(); ++index )
+    {
+        Chunk& chunk = _chunks[ index ];
+        unsigned char* items = chunk.Items;
+        if ( address < items || address >= items + chunkSize )
+        {
+            continue;
+        }
+
+        unsigned int slot = static_cast<unsigned int>( ( address - items ) / _stride );
+        assert( ( chunk.LiveMask & ( 1ULL << slot ) ) && "Component destroyed twice" );
+
+        component->~Component();
+        chunk.LiveMask &= ~( 1ULL << slot );
+        --_count;
+
+        if ( index < _firstFreeChunk )
+        {
+            _firstFreeChunk = index;
+        }
+        return;
+    }
+
+    assert( false && "Component does not belong to this pool" );
+}
+
+// Get the number of live components
+size_t ComponentPool::GetCount() const
+{
+    return _count;
+}
+
+// Get the mask of the stored type
+ComponentTypeMask ComponentPool::GetTypeMask() const
+{
+    return _typeMask;
+}
+
+// Check to see if a component should be updated
+bool ComponentPool::IsUpdatable( const Component* component )
+{
+    return component->IsEnabled() && component->GetGameObject()->IsActiveInHierarchy();
+}
+
+// Perform the late update on every pool
+void ComponentPool::LateUpdateAll()
+{
+    for ( size_t index = 0; index < _updateOrder.size(); ++index )
+    {
+        _updateOrder[ index ]->LateUpdate();
+    }
+}
+
+// Update every pool
+void ComponentPool::UpdateAll()
+{
+    for ( size_t index = 0; index < _updateOrder.size(); ++index )
+    {
+        _updateOrder[ index ]->Update();
+    }
+}
+
+// Perform the late update on every enabled component
+void ComponentPool::LateUpdate()
+{
+    ForEach<Component>( []( Component* component )
+    {
+        if ( component->UsesLateUpdate() && IsUpdatable( component ) )
+        {
+            component->LateUpdate();
+        }
+    } );
+}
+
+// Update every enabled component
+void ComponentPool::Update()
+{
+    ForEach<Component>( []( Component* component )
+    {
+        if ( IsUpdatable( component ) )
+        {
+            component->Update();
+        }
+    } );
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "Config.hpp"
+#include "ComponentType.hpp"
+#include <vector>
+
+class Component;
+class GameObject;
+
+/// <summary>
+/// The number of components kept in a single chunk.
+/// </summary>
+#define COMPONENT_CHUNK_SIZE 64
+
+/// <summary>
+/// Defines the storage for every component of a single type. Components are kept contiguously in
+/// fixed-size chunks, so they never move once created and can be iterated without chasing pointers.
+/// </summary>
+class ComponentPool
+{
+    ImplementNonCopyableClass( ComponentPool );
+    ImplementNonMovableClass( ComponentPool );
+
+    /// <summary>
+    /// Defines a chunk of components.
+    /// </summary>
+    struct Chunk
+    {
+        unsigned char*     Items;
+        unsigned long long LiveMask; // One bit per slot that holds a live component
+    };
+
+    static ComponentPool* _pools[ MAX_COMPONENT_TYPES ];
+    static std::vector<ComponentPool*> _updateOrder;
+
+    const ComponentTypeId _typeId;
+    const ComponentTypeMask _typeMask;
+    const size_t _stride;
+    std::vector<Chunk> _chunks;
+    size_t _firstFreeChunk;
+    size_t _count;
+
+    /// <summary>
+    /// Creates a new component pool.
+    /// </summary>
+    /// <param name="typeId">The ID of the type stored in this pool.</param>
+    /// <param name="typeMask">The mask of the stored type and every type it derives from.</param>
+    /// <param name="stride">The size of the stored type.</param>
+    ComponentPool( ComponentTypeId typeId, ComponentTypeMask typeMask, size_t stride );
+
+    /// <summary>
+    /// Reserves a slot for a new component.
+    /// </summary>
+    void* Allocate();
+
+    /// <summary>
+    /// Gets the component in the given slot of a chunk.
+    /// </summary>
+    /// <param name="chunk">The chunk.</param>
+    /// <param name="slot">The slot.</param>
+    inline Component* GetItem( const Chunk& chunk, unsigned int slot ) const
+    {
+        return reinterpret_cast<Component*>( chunk.Items + slot * _stride );
+    }
+
+    /// <summary>
+    /// Checks to see if a component should be updated.
+    /// </summary>
+    /// <param name="component">The component.</param>
+    static bool IsUpdatable( const Component* component );
+
+public:
+    /// <summary>
+    /// Destroys this component pool.
+    /// </summary>
+    ~ComponentPool();
+
+    /// <summary>
+    /// Gets the pool for the given component type, creating it if it does not exist yet.
+    /// </summary>
+    template<class T> static ComponentPool* GetPool();
+
+    /// <summary>
+    /// Calls a function for every live component of the given base type, across every pool.
+    /// </summary>
+    /// <param name="func">The function, taking a T*.</param>
+    template<class T, class TFunc> static void ForEachOfType( TFunc func );
+
+    /// <summary>
+    /// Performs the late update on every enabled component, one pool at a time.
+    /// </summary>
+    static void LateUpdateAll();
+
+    /// <summary>
+    /// Updates every enabled component, one pool at a time.
+    /// </summary>
+    static void UpdateAll();
+
+    /// <summary>
+    /// Creates a new component in this pool.
+    /// </summary>
+    /// <param name="gameObject">The game object the component belongs to.</param>
+    template<class T> T* Create( GameObject* gameObject );
+
+    /// <summary>
+    /// Destroys a component in this pool.
+    /// </summary>
+    /// <param name="component">The component.</param>
+    void Destroy( Component* component );
+
+    /// <summary>
+    /// Calls a function for every live component in this pool.
+    /// </summary>
+    /// <param name="func">The function, taking a T*.</param>
+    template<class T, class TFunc> void ForEach( TFunc func );
+
+    /// <summary>
+    /// Calls a function for every live component in this pool, one chunk per job. The function must
+    /// not create or destroy components, nor touch state shared with other components.
+    /// </summary>
+    /// <param name="func">The function, taking a T*.</param>
+    template<class T, class TFunc> void ParallelForEach( TFunc func );
+
+    /// <summary>
+    /// Gets the number of live components in this pool.
+    /// </summary>
+    size_t GetCount() const;
+
+    /// <summary>
+    /// Gets the mask of the stored type and every type it derives from.
+    /// </summary>
+    ComponentTypeMask GetTypeMask() const;
+
+    /// <summary>
+    /// Performs the late update on every enabled component in this pool.
+    /// </summary>
+    void LateUpdate();
+
+    /// <summary>
+    /// Updates every enabled component in this pool.
+    /// </summary>
+    void Update();
+};
+
+#include "ComponentPool.inl"
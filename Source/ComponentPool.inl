@@ -0,0 +1,81 @@
+#include "JobSystem.hpp"
+#include <assert.h>
+#include <new>
+
+// Get the pool for the given component type
+template<class T> ComponentPool* ComponentPool::GetPool()
+{
+    ComponentTypeId typeId = ComponentType<T>::Id;
+    if ( !_pools[ typeId ] )
+    {
+        // Pools live for the rest of the program, as game objects can outlive any static owner
+        ComponentPool* pool = new ComponentPool( typeId, ComponentType<T>::GetMask(), sizeof( T ) );
+        _pools[ typeId ] = pool;
+        _updateOrder.push_back( pool );
+    }
+    return _pools[ typeId ];
+}
+
+// Call a function for every live component of the given base type
+template<class T, class TFunc> void ComponentPool::ForEachOfType( TFunc func )
+{
+    ComponentTypeMask typeBit = ( 1U << ComponentType<T>::Id );
+    for ( size_t index = 0; index < _updateOrder.size(); ++index )
+    {
+        ComponentPool* pool = _updateOrder[ index ];
+        if ( pool->_typeMask & typeBit )
+        {
+            pool->ForEach<T>( func );
+        }
+    }
+}
+
+// Create a new component in this pool
+template<class T> T* ComponentPool::Create( GameObject* gameObject )
+{
+    assert( ComponentType<T>::Id == _typeId && "Component created in the wrong pool" );
+
+    void* slot = Allocate();
+    T* component = new ( slot ) T( gameObject );
+
+    // Slots are read back as components, so the component base must sit at the start of the object
+    assert( static_cast<void*>( static_cast<Component*>( component ) ) == slot );
+    return component;
+}
+
+// Call a function for every live component in this pool
+template<class T, class TFunc> void ComponentPool::ForEach( TFunc func )
+{
+    // Component memory never moves, so components created or destroyed by the function are safe
+    for ( size_t index = 0; index < _chunks.size(); ++index )
+    {
+        for ( unsigned int slot = 0; slot < COMPONENT_CHUNK_SIZE; ++slot )
+        {
+            // Look the chunk up again each time, as the function may have added a chunk
+            const Chunk& chunk = _chunks[ index ];
+            if ( chunk.LiveMask & ( 1ULL << slot ) )
+            {
+                func( static_cast<T*>( GetItem( chunk, slot ) ) );
+            }
+        }
+    }
+}
+
+// Call a function for every live component in this pool, one chunk per job
+template<class T, class TFunc> void ComponentPool::ParallelForEach( TFunc func )
+{
+    JobSystem::ParallelFor( _chunks.size(), 1, [ this, &func ]( size_t begin, size_t end )
+    {
+        for ( size_t index = begin; index < end; ++index )
+        {
+            const Chunk& chunk = _chunks[ index ];
+            for ( unsigned int slot = 0; slot < COMPONENT_CHUNK_SIZE; ++slot )
+            {
+                if ( chunk.LiveMask & ( 1ULL << slot ) )
+                {
+                    func( static_cast<T*>( GetItem( chunk, slot ) ) );
+                }
+            }
+        }
+    } );
+}
@@ -0,0 +1,18 @@
+#include "ComponentType.hpp"
+#include <assert.h>
+
+ComponentTypeId ComponentRegistry::_typeCount = 0;
+const ComponentTypeId ComponentType<Component>::Id = ComponentRegistry::Register();
+
+// Get the number of registered component types
+ComponentTypeId ComponentRegistry::GetTypeCount()
+{
+    return _typeCount;
+}
+
+// Register a new component type
+ComponentTypeId ComponentRegistry::Register()
+{
+    assert( _typeCount < MAX_COMPONENT_TYPES && "Too many component types" );
+    return _typeCount++;
+}
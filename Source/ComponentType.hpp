@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Config.hpp"
+#include <type_traits>
+
+class Component;
+
+/// <summary>
+/// The most component types that can be registered.
+/// </summary>
+#define MAX_COMPONENT_TYPES 32
+
+/// <summary>
+/// Declares a component's type and the component type it derives from. Every component must
+/// start its class body with this so that it gets its own type ID.
+/// </summary>
+/// <param name="Class">The class name.</param>
+/// <param name="Base">The component class this class derives from.</param>
+#define ImplementComponent(Class, Base) \
+public: \
+    typedef Class ComponentClass; \
+    typedef Base BaseComponent; \
+private:
+
+/// <summary>
+/// Defines a dense, per-type integer ID for a component type.
+/// </summary>
+typedef unsigned int ComponentTypeId;
+
+/// <summary>
+/// Defines a set of component types, one bit per type ID.
+/// </summary>
+typedef unsigned int ComponentTypeMask;
+
+/// <summary>
+/// Defines a static class that hands out component type IDs.
+/// </summary>
+class ComponentRegistry
+{
+    ImplementStaticClass( ComponentRegistry );
+
+    static ComponentTypeId _typeCount;
+
+public:
+    /// <summary>
+    /// Gets the number of component types that have been registered.
+    /// </summary>
+    static ComponentTypeId GetTypeCount();
+
+    /// <summary>
+    /// Registers a new component type, returning its ID.
+    /// </summary>
+    static ComponentTypeId Register();
+};
+
+/// <summary>
+/// Defines the type information for a component type. IDs are assigned during static initialization.
+/// </summary>
+template<class T> struct ComponentType
+{
+    static_assert( std::is_same<typename T::ComponentClass, T>::value, "Component is missing ImplementComponent" );
+
+    /// <summary>
+    /// The type's ID.
+    /// </summary>
+    static const ComponentTypeId Id;
+
+    /// <summary>
+    /// Gets the mask containing this type and every component type it derives from.
+    /// </summary>
+    inline static ComponentTypeMask GetMask()
+    {
+        return ( 1U << Id ) | ComponentType<typename T::BaseComponent>::GetMask();
+    }
+};
+
+/// <summary>
+/// Defines the type information for the base component type.
+/// </summary>
+template<> struct ComponentType<Component>
+{
+    /// <summary>
+    /// The type's ID.
+    /// </summary>
+    static const ComponentTypeId Id;
+
+    /// <summary>
+    /// Gets the mask containing this type.
+    /// </summary>
+    inline static ComponentTypeMask GetMask()
+    {
+        return ( 1U << Id );
+    }
+};
+
+template<class T> const ComponentTypeId ComponentType<T>::Id = ComponentRegistry::Register();
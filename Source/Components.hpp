@@ -12,11 +12,12 @@
 // Rendering
 #include "MeshRenderer.hpp"
 #include "TextRenderer.hpp"
-//#include "LineRenderer.hpp"
+#include "LineRenderer.hpp"
 
 // Materials
 #include "Material.hpp"
 #include "SimpleMaterial.hpp"
+#include "LayeredMaterial.hpp"
 #include "TextMaterial.hpp"
 #include "LineMaterial.hpp"
 
@@ -25,5 +26,6 @@
 
 // Collider
 #include "BoxCollider.hpp"
+#include "MeshCollider.hpp"
 #include "SphereCollider.hpp"
 
@@ -54,7 +54,7 @@ class EventListener
     typedef std::map<std::string, FunctionCollection> FunctionCollectionMap;
 
 private:
-    FunctionCollectionMap _functions;
+    std::unique_ptr<FunctionCollectionMap> _functions; // Only created once a listener is added, as most objects never get one
 
     /// <summary>
     /// Calls all of the listeners in the given function collection, providing the given arguments.
@@ -10,7 +10,7 @@ template<typename... Args> void EventListener::CallListeners( FunctionCollection
     for ( ; i != j; ++i )
     {
         const BaseFunction& f = *i->second;
-        std::function<Func> func = static_cast<const Function<Func>&>( f ).Func;
+        const std::function<Func>& func = static_cast<const Function<Func>&>( f ).Func;
         func( std::forward<Args>( args )... );
     }
 }
@@ -27,12 +27,27 @@ template<typename T> void EventListener::AddEventListener( const std::string& ev
     std::type_index index( typeid( T ) );
     std::shared_ptr<BaseFunction> function = std::make_shared<Function<T>>( func );
 
-    FunctionCollection& collection = _functions[ eventName ];
+    if ( !_functions )
+    {
+        _functions.reset( new FunctionCollectionMap() );
+    }
+
+    FunctionCollection& collection = ( *_functions )[ eventName ];
     collection.insert( FunctionCollection::value_type( index, std::move( function ) ) );
 }
 
 // Fires all listeners for a given event
 template<typename... Args> void EventListener::FireEvent( const std::string& eventName, Args&&... args )
 {
-    CallListeners( _functions[ eventName ], std::forward<Args>( args )... );
+    // Don't add an empty collection for events nobody is listening to
+    if ( !_functions )
+    {
+        return;
+    }
+
+    auto search = _functions->find( eventName );
+    if ( search != _functions->end() )
+    {
+        CallListeners( search->second, std::forward<Args>( args )... );
+    }
 }
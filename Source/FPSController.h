@@ -7,6 +7,7 @@
 class FPSController :
 	public Component
 {
+	ImplementComponent(FPSController, Component);
 private:
 	Camera* m_pCamera;
 
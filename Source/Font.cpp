@@ -16,7 +16,7 @@
 #   include <iostream>
 #endif
 
-// Helper macro for a Font's FreeType library
+// Helper macro for the shared FreeType library
 #define _myLibrary reinterpret_cast<FT_Library>( _library )
 
 // Helper macro for a Font's FreeType font face
@@ -92,10 +92,37 @@ FloatRect Font::GlyphPage::GetNormalizedRect( const UintRect& rect )
 
 #pragma endregion
 
+std::unordered_map<std::string, std::weak_ptr<Font>> Font::_fontCache;
+void* Font::_library = nullptr;
+unsigned int Font::_faceCount = 0;
+
+// Load a font from a file, sharing it if it's already loaded
+std::shared_ptr<Font> Font::FromFile( const std::string& fname )
+{
+    // We don't need to re-load fonts that are still in use
+    auto search = _fontCache.find( fname );
+    if ( search != _fontCache.end() )
+    {
+        std::shared_ptr<Font> font = search->second.lock();
+        if ( font )
+        {
+            return font;
+        }
+    }
+
+    std::shared_ptr<Font> font = std::make_shared<Font>();
+    if ( !font->LoadFromFile( fname ) )
+    {
+        return nullptr;
+    }
+
+    _fontCache[ fname ] = font;
+    return font;
+}
+
 // Creates a new, empty font
 Font::Font()
     : _fontName( "" )
-    , _library( nullptr )
     , _fontFace( nullptr )
 {
 }
@@ -213,10 +240,13 @@ void Font::Dispose()
     {
         FT_Done_Face( _myFontFace );
         _fontFace = nullptr;
+        --_faceCount;
     }
+    _file.Close();
+    _pages.clear();
 
-    // Cleanup the library
-    if ( _library )
+    // Cleanup the library once the last face is gone
+    if ( _library && _faceCount == 0 )
     {
         FT_Done_FreeType( _myLibrary );
         _library = nullptr;
@@ -412,27 +442,32 @@ bool Font::LoadFromFile( const std::string& fname )
     // Remove any loaded information
     Dispose();
 
-    // Attempt to create our FreeType library
-    FT_Library library;
-    if ( 0 != FT_Init_FreeType( &library ) )
+    // Attempt to create the shared FreeType library, if no other font has
+    if ( !_library )
     {
+        FT_Library library;
+        if ( 0 != FT_Init_FreeType( &library ) )
+        {
 #if defined( _DEBUG ) || defined( DEBUG )
-        std::cout << "Failed to initialize FreeType for '" << fname << "'." << std::endl;
+            std::cout << "Failed to initialize FreeType for '" << fname << "'." << std::endl;
 #endif
-        return false;
+            return false;
+        }
+        _library = library;
     }
-    _library = library;
 
-    // Attempt to load the font face
+    // Attempt to load the font face from the mapped file, which may be packed into the content archive
     FT_Face fontFace;
-    if ( 0 != FT_New_Face( library, fname.c_str(), 0, &fontFace ) )
+    if ( !_file.Open( fname ) || 0 != FT_New_Memory_Face( _myLibrary, reinterpret_cast<const FT_Byte*>( _file.GetData() ), static_cast<FT_Long>( _file.GetSize() ), 0, &fontFace ) )
     {
 #if defined( _DEBUG ) || defined( DEBUG )
         std::cout << "Failed to create font face for '" << fname << "'." << std::endl;
 #endif
+        Dispose();
         return false;
     }
     _fontFace = fontFace;
+    ++_faceCount;
 
     // Get the font name
     _fontName = fontFace->family_name ? fontFace->family_name : "N/A";
@@ -485,6 +520,5 @@ bool Font::SetCurrentSize( unsigned int size )
 // Check if we have valid data
 Font::operator bool() const
 {
-    return ( _fontFace != nullptr )
-        && ( _library != nullptr );
+    return _fontFace != nullptr;
 }
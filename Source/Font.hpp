@@ -9,14 +9,17 @@
 ************************************************************************************/
 
 #include "Config.hpp"
+#include "MappedFile.hpp"
 #include "Rect.hpp"
 #include "Texture2D.hpp"
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 /// <summary>
-/// Defines a font.
+/// Defines a font. Fonts loaded from the same file are shared, along with their glyph pages, and
+/// every font shares a single FreeType library.
 /// </summary>
 class Font
 {
@@ -115,11 +118,15 @@ class Font
 #pragma endregion
 
 private:
+    static std::unordered_map<std::string, std::weak_ptr<Font>> _fontCache;
+    static void* _library;
+    static unsigned int _faceCount;
+
     GlyphPageTable _pages;
     std::vector<unsigned char> _pixelBuffer;
     std::string _fontName;
-    void* _library;
     void* _fontFace;
+    MappedFile _file; // FreeType reads the face from this for as long as it lives
 
 private:
     /// <summary>
@@ -170,6 +177,14 @@ private:
     Glyph LoadGlyph( char ch, unsigned int size );
 
 public:
+    /// <summary>
+    /// Loads a font from a file, sharing it with everything else using the same file. The font is
+    /// unloaded once nothing uses it.
+    /// </summary>
+    /// <param name="fname">The file to load.</param>
+    /// <returns>The font, or null if it couldn't be loaded.</returns>
+    static std::shared_ptr<Font> FromFile( const std::string& fname );
+
     /// <summary>
     /// Creates a new font.
     /// </summary>
@@ -7,9 +7,14 @@
 #include "RigidBody.h"
 #include "Physics.hpp"
 #include "RenderManager.hpp"
+#include "JobSystem.hpp"
+#include "AssetLoader.hpp"
+#include "GpuResourceManager.hpp"
 
 #define BALL_SIZE 2.0f
+#define ASSET_UPLOAD_BUDGET 0.002f // The time spent handing loaded assets to the GPU each frame, in seconds
 //#define USE_OPENGL_DEBUG
+//#define RUN_JOBS_INLINE
 
 std::shared_ptr<Game> Game::_instance = nullptr;
 
@@ -51,6 +56,15 @@ Game::Game()
 // Destroys the game instance
 Game::~Game()
 {
+    // Give every game object back to the pool while the window's context still exists
+    for ( auto& slot : _gameObjects )
+    {
+        _gameObjectPool.Destroy( slot.Object );
+        slot.Object = nullptr;
+    }
+    _gameObjects.clear();
+    _gameObjectCache.clear();
+
     _window = nullptr;
 }
 
@@ -61,17 +75,36 @@ GameObject* Game::AddGameObject( const std::string& name )
     auto search = _gameObjectCache.find( name );
     if ( search != _gameObjectCache.end() )
     {
-        return search->second.get();
+        return _gameObjects[ search->second ].Object;
+    }
+
+    // Reuse a free slot if there is one
+    unsigned int index = 0;
+    if ( _freeSlots.empty() )
+    {
+        index = static_cast<unsigned int>( _gameObjects.size() );
+
+        GameObjectSlot slot;
+        slot.Object = nullptr;
+        slot.Generation = 0;
+        slot.IsDestroying = false;
+        _gameObjects.push_back( slot );
+    }
+    else
+    {
+        index = _freeSlots.back();
+        _freeSlots.pop_back();
     }
 
     // Create the game object
-    std::shared_ptr<GameObject> go = std::make_shared<GameObject>( name );
+    GameObjectSlot& slot = _gameObjects[ index ];
+    slot.Object = _gameObjectPool.Create( name );
+    slot.Object->_handle = GameObjectHandle( index, slot.Generation );
 
     // Record the game object
-    _gameObjects.push_back( go );
-    _gameObjectCache[ name ] = go;
+    _gameObjectCache[ name ] = index;
 
-    return go.get();
+    return slot.Object;
 }
 
 // Destroys the given game object
@@ -82,38 +115,96 @@ bool Game::Destroy( GameObject* gameObject )
         return false;
     }
 
-    // Find the game object in the cache
+    return Destroy( gameObject->GetHandle() );
+}
+
+// Destroys the game object the given handle refers to
+bool Game::Destroy( GameObjectHandle handle )
+{
+    GameObject* gameObject = Find( handle );
+    if ( !gameObject )
+    {
+        return false;
+    }
+
+    // Free up the name now so a replacement can be added this frame
     auto search = _gameObjectCache.find( gameObject->GetName() );
-    if ( search != _gameObjectCache.end() )
+    if ( search != _gameObjectCache.end() && search->second == handle.Index )
     {
-        _gameObjectCache.erase( gameObject->GetName() );
+        _gameObjectCache.erase( search );
     }
-    else
+
+    // Keep the game object alive until the end of the frame, as it may still be in use
+    gameObject->SetActive( false );
+    _gameObjects[ handle.Index ].IsDestroying = true;
+    _destroyQueue.push_back( handle.Index );
+
+    return true;
+}
+
+// Finds the game object a handle refers to
+GameObject* Game::Find( GameObjectHandle handle ) const
+{
+    if ( handle.Index >= _gameObjects.size() )
     {
-        return false;
+        return nullptr;
     }
 
-    // Now remove the game object from the list
-    for ( auto iter = _gameObjects.begin(); iter != _gameObjects.end(); ++iter )
+    const GameObjectSlot& slot = _gameObjects[ handle.Index ];
+    if ( slot.Generation != handle.Generation || slot.IsDestroying )
     {
-        if ( iter->get() == gameObject )
-        {
-            _gameObjects.erase( iter );
-            break;
-        }
+        return nullptr;
     }
 
-    return true;
+    return slot.Object;
+}
+
+// Checks that a transform's game object still exists
+Transform* Game::FindTransform( Transform* transform, GameObjectHandle handle ) const
+{
+    if ( transform != nullptr && !handle.IsNull() && Find( handle ) == nullptr )
+    {
+        return nullptr;
+    }
+
+    return transform;
+}
+
+// Finds a game object by name
+GameObject* Game::Find( const std::string& name ) const
+{
+    auto search = _gameObjectCache.find( name );
+    if ( search != _gameObjectCache.end() )
+    {
+        return _gameObjects[ search->second ].Object;
+    }
+
+    return nullptr;
+}
+
+// Destroys every game object queued for destruction
+void Game::FlushDestroyQueue()
+{
+    // Destroying a game object can queue more, so keep going until the queue is empty
+    for ( size_t i = 0; i < _destroyQueue.size(); ++i )
+    {
+        unsigned int index = _destroyQueue[ i ];
+        GameObjectSlot& slot = _gameObjects[ index ];
+        GameObject* object = slot.Object;
+
+        slot.Object = nullptr;
+        ++slot.Generation;
+        slot.IsDestroying = false;
+        _freeSlots.push_back( index );
+
+        _gameObjectPool.Destroy( object );
+    }
+    _destroyQueue.clear();
 }
 
 // Draws the game
 void Game::Draw()
 {
-    /* for (auto& object : _gameObjects)
-    {
-        if (object->GetActive())
-            object->Draw();
-    } */
     RenderManager::Draw();
 }
 
@@ -136,14 +227,22 @@ glm::vec4 Game::GetClearColor() const
 // Runs the game
 void Game::Run()
 {
+    // Start the workers here rather than in the constructor, as the game is first created during static initialization
+    JobSystem::Initialize();
+#if defined( RUN_JOBS_INLINE )
+    JobSystem::SetInline( true );
+#else
+    Physics::StartThread();
+#endif
+
 	// Add a test text renderer
 	{
 		auto go = AddGameObject("TestTextRenderer");
 		auto tm = go->AddComponent<TextMaterial>();
 		tr = go->AddComponent<TextRenderer>();
 
-		std::shared_ptr<Font> font = std::make_shared<Font>();
-		assert(font->LoadFromFile("Fonts\\OpenSans-Regular.ttf"));
+		std::shared_ptr<Font> font = Font::FromFile("Fonts\\OpenSans-Regular.ttf");
+		assert(font);
 		tr->SetFont(font);
 		tr->SetFontSize(12U);
 		tr->SetText("Hello, world!");
@@ -170,15 +269,29 @@ void Game::Run()
         Update();
         Draw();
 
+        // Hand any assets the workers have finished loading to the GPU, then make room for them if need be
+        AssetLoader::Update( ASSET_UPLOAD_BUDGET );
+        GpuResourceManager::Update();
+
         // Update the time values
         Time::Update();
         Physics::Update();
         Input::Update( _window->_window );
 
+        // Now that nothing is using them, get rid of the game objects destroyed this frame
+        FlushDestroyQueue();
+
         // Poll for events and swap the buffers
         _window->SwapBuffers();
         _window->PollEvents();
     }
+
+    Physics::StopThread();
+    JobSystem::Shutdown();
+    AssetLoader::Shutdown();
+
+    // Free every cached asset nothing uses while the window's context still exists
+    GpuResourceManager::Evict( 0 );
 }
 
 // Set the clear color
@@ -226,19 +339,20 @@ void Game::Update()
     }
 
     // Sets materials on Objects
-    for (auto& object : _gameObjects)
+    Camera* camera = gameManager->GetActiveCamera();
+    ComponentPool::ForEachOfType<Material>( [ camera ]( Material* material )
     {
-        if (object->GetActive())
+        if ( material->GetGameObject()->IsActiveInHierarchy() )
         {
-            Material* material = object->GetComponentOfType<Material>();
-            if (material)
-            {
-                material->ApplyCamera(gameManager->GetActiveCamera());
-            }
-            object->Update();
+            material->ApplyCamera( camera );
         }
-    }
-    
+    } );
+
+    // Update every component one type at a time, then rebuild the dirty world matrices on the workers
+    ComponentPool::UpdateAll();
+    ComponentPool::LateUpdateAll();
+    Transform::UpdateWorldMatrices();
+
 
     gameManager->Update();
 
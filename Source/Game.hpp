@@ -3,8 +3,9 @@
 #include "GameObject.hpp"
 #include "GameWindow.hpp"
 #include "Math.hpp"
+#include "ObjectPool.hpp"
 #include <memory>
-#include <map>
+#include <unordered_map>
 #include <vector>
 #include "Components.hpp"
 #include "BilliardGameManager.h"
@@ -17,10 +18,23 @@ class BilliardGameManager;
 /// </summary>
 class Game
 {
+    /// <summary>
+    /// Defines a slot that holds a game object.
+    /// </summary>
+    struct GameObjectSlot
+    {
+        GameObject*  Object;
+        unsigned int Generation;   // Bumped every time the slot's game object is destroyed
+        bool         IsDestroying; // True once the game object has been queued for destruction
+    };
+
     static std::shared_ptr<Game> _instance;
 
-    std::map<std::string, std::shared_ptr<GameObject>> _gameObjectCache;
-    std::vector<std::shared_ptr<GameObject>> _gameObjects;
+    ObjectPool<GameObject> _gameObjectPool;
+    std::unordered_map<std::string, unsigned int> _gameObjectCache; // Maps names to slots
+    std::vector<GameObjectSlot> _gameObjects;
+    std::vector<unsigned int> _freeSlots;
+    std::vector<unsigned int> _destroyQueue;
     std::shared_ptr<GameWindow> _window;
     glm::vec4 _clearColor;
 
@@ -41,6 +55,11 @@ class Game
     /// </summary>
     void Draw();
 
+    /// <summary>
+    /// Destroys every game object queued for destruction this frame.
+    /// </summary>
+    void FlushDestroyQueue();
+
     // Prevent the copy constructor and assignment operator from being used
     Game( const Game& ) = delete;
     Game& operator=( const Game& ) = delete;
@@ -72,11 +91,42 @@ public:
     GameObject* AddGameObject( const std::string& name );
 
     /// <summary>
-    /// Destroys the given game object.
+    /// Queues the given game object to be destroyed at the end of the frame. It is deactivated and
+    /// its name is freed up straight away.
     /// </summary>
     /// <param name="gameObject">The game object.</param>
     bool Destroy( GameObject* gameObject );
 
+    /// <summary>
+    /// Queues the given game object to be destroyed at the end of the frame.
+    /// </summary>
+    /// <param name="handle">The game object's handle.</param>
+    bool Destroy( GameObjectHandle handle );
+
+    /// <summary>
+    /// Finds the game object a handle refers to.
+    /// </summary>
+    /// <param name="handle">The handle.</param>
+    /// <returns>The game object, or null if it has been destroyed.</returns>
+    GameObject* Find( GameObjectHandle handle ) const;
+
+    /// <summary>
+    /// Checks that a transform's game object still exists, for components that keep a transform
+    /// around between frames. Transforms without a handle, such as a child game object's, are
+    /// trusted to outlive whatever keeps them.
+    /// </summary>
+    /// <param name="transform">The transform.</param>
+    /// <param name="handle">The handle of the transform's game object, or a null handle.</param>
+    /// <returns>The transform, or null if its game object has been destroyed.</returns>
+    Transform* FindTransform( Transform* transform, GameObjectHandle handle ) const;
+
+    /// <summary>
+    /// Finds a game object by name.
+    /// </summary>
+    /// <param name="name">The name of the game object.</param>
+    /// <returns>The game object, or null if there is no such game object.</returns>
+    GameObject* Find( const std::string& name ) const;
+
     /// <summary>
     /// Runs the game.
     /// </summary>
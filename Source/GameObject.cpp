@@ -1,20 +1,37 @@
 #include "GameObject.hpp"
 #include "Component.hpp"
 #include "Transform.hpp"
+#include <algorithm>
 
 // Create a new game object
 GameObject::GameObject( const std::string& name )
-    : _name( name )
+    : _exactTypes( 0 )
+    , _name( name )
     , _parent( nullptr )
     , _transform( nullptr )
-	, _isWorldMatrixDirty( true )
 {
+    std::fill( _componentSlots, _componentSlots + MAX_COMPONENT_TYPES, nullptr );
     _transform = AddComponent<Transform>();
 }
 
 // Destroy this game object
 GameObject::~GameObject()
 {
+    // Give our components back to their pools, keeping the transform until last
+    for ( ComponentTypeId id = MAX_COMPONENT_TYPES; id > 0; --id )
+    {
+        Component* component = _componentSlots[ id - 1 ];
+        if ( ( _exactTypes & ( 1U << ( id - 1 ) ) ) && component != _transform )
+        {
+            component->_pool->Destroy( component );
+        }
+    }
+    if ( _transform )
+    {
+        Component* transform = _transform;
+        transform->_pool->Destroy( transform );
+    }
+
     _parent = nullptr;
     _transform = nullptr;
 }
@@ -25,15 +42,40 @@ GameObject* GameObject::AddChild( const std::string& name )
     // Create the child
     auto child = std::make_shared<GameObject>( name );
     child->_parent = this;
+    child->_transform->_parent = _transform;
 
     // Record the child
     _children.push_back( child );
-    _childrenCache[ name ] = child;
 
     // Return the child
     return child.get();
 }
 
+// Record a newly added component in the type slots
+void GameObject::RegisterComponent( Component* component, ComponentTypeId typeId, ComponentPool* pool )
+{
+    ComponentTypeMask typeMask = pool->GetTypeMask();
+    component->_typeMask = typeMask;
+    component->_pool = pool;
+    _exactTypes |= ( 1U << typeId );
+
+    // The exact type always points at this component, but base types keep the first component added
+    _componentSlots[ typeId ] = component;
+    for ( ComponentTypeId id = 0; id < MAX_COMPONENT_TYPES; ++id )
+    {
+        if ( ( typeMask & ( 1U << id ) ) && _componentSlots[ id ] == nullptr )
+        {
+            _componentSlots[ id ] = component;
+        }
+    }
+}
+
+// Get our handle
+GameObjectHandle GameObject::GetHandle() const
+{
+    return _handle;
+}
+
 // Get our name
 std::string GameObject::GetName() const
 {
@@ -53,62 +95,33 @@ Transform* GameObject::GetTransform()
 }
 
 // Get this game object's world matrix
-const glm::mat4& GameObject::GetWorldMatrix() const
+glm::mat4 GameObject::GetWorldMatrix() const
 {
-	if (_isWorldMatrixDirty)
-	{
-		_worldMatrix = glm::mat4(1.0f);
-
-		// If we have a parent, we need to be based off of them
-		if (_parent)
-		{
-			_worldMatrix *= _parent->GetWorldMatrix();
-		}
-
-		_worldMatrix *= _transform->GetWorldMatrix();
-
-		_isWorldMatrixDirty = false;
-	}
-	return _worldMatrix;
+    // Our transform already takes our parents into account
+    return _transform->GetWorldMatrix();
 }
 
-// Update all components
-void GameObject::Update()
+// Check to see if we and all of our parents are active
+bool GameObject::IsActiveInHierarchy() const
 {
-    // Update all of our components
-    for ( auto& component : _components )
+    for ( const GameObject* object = this; object; object = object->_parent )
     {
-        if ( component->IsEnabled() )
+        if ( !object->_isActive )
         {
-            component->Update();
+            return false;
         }
     }
-
-    // Perform the late update on all of our components
-    for ( auto& component : _components )
-    {
-        if ( component->IsEnabled() && component->UsesLateUpdate() )
-        {
-            component->LateUpdate();
-        }
-    }
-
-    // Now update all of our children
-    for ( auto iter = _children.begin(); iter != _children.end(); ++iter )
-    {
-        iter->get()->Update();
-    }
-
-	_isWorldMatrixDirty = true;
+    return true;
 }
 
 // Draw all components
 void GameObject::Draw()
 {
     // Draw all of our components
-    for ( auto& component : _components )
+    for ( ComponentTypeId id = 0; id < MAX_COMPONENT_TYPES; ++id )
     {
-        if ( component->IsEnabled() && component->IsDrawable() )
+        Component* component = _componentSlots[ id ];
+        if ( ( _exactTypes & ( 1U << id ) ) && component->IsEnabled() && component->IsDrawable() )
         {
             component->Draw();
         }
@@ -7,29 +7,85 @@
 #include <vector>
 #include <string>
 
+#include "Component.hpp"
+#include "ComponentPool.hpp"
 #include "EventListener.hpp"
 
-class Component;
 class Transform;
 class Physics;
 
+/// <summary>
+/// Defines a weak reference to a game object owned by the game. A handle goes stale as soon as
+/// its game object is destroyed, even if the game object's slot is later reused.
+/// </summary>
+struct GameObjectHandle
+{
+    unsigned int Index;      // The game object's slot in the game
+    unsigned int Generation; // How many times the slot had been reused when the handle was made
+
+    /// <summary>
+    /// Creates a new, null handle.
+    /// </summary>
+    GameObjectHandle()
+        : Index( ~0U )
+        , Generation( 0 )
+    {
+    }
+
+    /// <summary>
+    /// Creates a new handle.
+    /// </summary>
+    /// <param name="index">The game object's slot.</param>
+    /// <param name="generation">The slot's generation.</param>
+    GameObjectHandle( unsigned int index, unsigned int generation )
+        : Index( index )
+        , Generation( generation )
+    {
+    }
+
+    /// <summary>
+    /// Checks to see if this handle was ever given a game object.
+    /// </summary>
+    inline bool IsNull() const
+    {
+        return Index == ~0U;
+    }
+
+    /// <summary>
+    /// Checks to see if two handles refer to the same game object.
+    /// </summary>
+    inline bool operator==( const GameObjectHandle& other ) const
+    {
+        return Index == other.Index && Generation == other.Generation;
+    }
+
+    /// <summary>
+    /// Checks to see if two handles refer to different game objects.
+    /// </summary>
+    inline bool operator!=( const GameObjectHandle& other ) const
+    {
+        return !( *this == other );
+    }
+};
+
 /// <summary>
 /// Defines a game object.
 /// </summary>
 class GameObject
 {
+    friend class Game; // The game hands out our handle
+    friend class Transform; // Transforms walk our children to keep their world matrices up to date
+
     bool _isActive = true;
 
-    std::unordered_map<std::string, std::shared_ptr<Component>> _componentCache;
-    std::unordered_map< std::string, std::shared_ptr<GameObject>> _childrenCache;
+    Component* _componentSlots[ MAX_COMPONENT_TYPES ]; // The first component of each type, with exact types taking precedence
+    ComponentTypeMask _exactTypes; // The types of the components we have, not counting their base types, whose slots own them
     std::vector<std::shared_ptr<GameObject>> _children;
-    std::vector<std::shared_ptr<Component>> _components;
     const std::string _name;
+    GameObjectHandle _handle;
     GameObject* _parent;
     Transform* _transform;
     EventListener _eventListener;
-	mutable glm::mat4 _worldMatrix;
-	mutable bool _isWorldMatrixDirty;
 
     // Prevent the use of the copy constructor and copy assignment operator
     GameObject( const GameObject& ) = delete;
@@ -39,6 +95,14 @@ class GameObject
     GameObject( GameObject&& ) = delete;
     GameObject& operator=( GameObject&& ) = delete;
 
+    /// <summary>
+    /// Records a newly added component in the type slots.
+    /// </summary>
+    /// <param name="component">The component.</param>
+    /// <param name="typeId">The component's type ID.</param>
+    /// <param name="pool">The pool the component was created in.</param>
+    void RegisterComponent( Component* component, ComponentTypeId typeId, ComponentPool* pool );
+
 public:
     /// <summary>
     /// Creates a new game object.
@@ -98,6 +162,11 @@ public:
     /// <param name="components">The list of components to populate.</param>
     template<class T> void GetComponentsOfType( std::vector<T*>& components );
 
+    /// <summary>
+    /// Gets this game object's handle. Child game objects are not owned by the game, so their handles are null.
+    /// </summary>
+    GameObjectHandle GetHandle() const;
+
     /// <summary>
     /// Gets this game object's name.
     /// </summary>
@@ -116,7 +185,7 @@ public:
     /// <summary>
     /// Gets this game object's world matrix.
     /// </summary>
-    const glm::mat4& GetWorldMatrix() const;
+    glm::mat4 GetWorldMatrix() const;
 
     /// <summary>
     /// Gets this game object's world matrix.
@@ -144,9 +213,9 @@ public:
     }
 
     /// <summary>
-    /// Draws this game object and all components inside of it.
+    /// Checks to see if this game object and all of its parents are active.
     /// </summary>
-    void Update();
+    bool IsActiveInHierarchy() const;
 
     /// <summary>
     /// Draws this component.
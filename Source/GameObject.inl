@@ -1,40 +1,34 @@
-#include <typeinfo>
-
 // TODO - Find some way to reduce code duplication in the const/non-const versions of GetComponent and GetComponentsOfType
 
 // Add a component to this game object.
 template<class T> T* GameObject::AddComponent()
 {
     // Get the type information
-    auto& type = typeid( T );
-    std::string typeName = std::string( type.name() );
-    
+    ComponentTypeId typeId = ComponentType<T>::Id;
+
     // Check to see if the component already exists
-    auto search = _componentCache.find( typeName );
-    if ( search != _componentCache.end() )
+    if ( _exactTypes & ( 1U << typeId ) )
     {
-        return reinterpret_cast<T*>( search->second.get() );
+        return static_cast<T*>( _componentSlots[ typeId ] );
     }
 
-    // Otherwise we need to create and add the component
-    std::shared_ptr<T> component = std::make_shared<T>( this );
-    _componentCache[ typeName ] = component;
-    _components.push_back( component );
-    return component.get();
+    // Otherwise we need to create the component in its type's pool
+    ComponentPool* pool = ComponentPool::GetPool<T>();
+    T* component = pool->Create<T>( this );
+    RegisterComponent( component, typeId, pool );
+    return component;
 }
 
 // Get the component of the given type, if it exists
 template<class T> const T* GameObject::GetComponent() const
 {
     // Get the type information
-    auto& type = typeid( T );
-    std::string typeName = std::string( type.name() );
+    ComponentTypeId typeId = ComponentType<T>::Id;
 
     // Check to see if the component already exists
-    auto search = _componentCache.find( typeName );
-    if ( search != _componentCache.end() )
+    if ( _exactTypes & ( 1U << typeId ) )
     {
-        return reinterpret_cast<const T*>( search->second.get() );
+        return static_cast<const T*>( _componentSlots[ typeId ] );
     }
 
     return nullptr;
@@ -43,18 +37,13 @@ template<class T> const T* GameObject::GetComponent() const
 // Get the component of the given type, if it exists
 template<class T> T* GameObject::GetComponent()
 {
-    // TODO - Minimize on repeating code by doing the following?
-    // return const_cast<T*>( this->GetComponent<T>() );
-
     // Get the type information
-    auto& type = typeid( T );
-    std::string typeName = std::string( type.name() );
+    ComponentTypeId typeId = ComponentType<T>::Id;
 
     // Check to see if the component already exists
-    auto search = _componentCache.find( typeName );
-    if ( search != _componentCache.end() )
+    if ( _exactTypes & ( 1U << typeId ) )
     {
-        return reinterpret_cast<T*>( search->second.get() );
+        return static_cast<T*>( _componentSlots[ typeId ] );
     }
 
     return nullptr;
@@ -63,39 +52,15 @@ template<class T> T* GameObject::GetComponent()
 // Get the component of the given base type, if it exists
 template<class T> const T* GameObject::GetComponentOfType() const
 {
-    for ( auto iter = _componentCache.begin(); iter != _componentCache.end(); ++iter )
-    {
-        // Get the component and the component as T
-        const std::shared_ptr<Component>& component = iter->second;
-        const T* typedComponent = dynamic_cast<const T*>( component.get() );
-
-        // Check if we've found the component
-        if ( typedComponent != nullptr )
-        {
-            return typedComponent;
-        }
-    }
-
-    return nullptr;
+    // The slot for a base type holds the first component derived from it
+    return static_cast<const T*>( _componentSlots[ ComponentType<T>::Id ] );
 }
 
 // Get the component of the given base type, if it exists
 template<class T> T* GameObject::GetComponentOfType()
 {
-    for ( auto iter = _componentCache.begin(); iter != _componentCache.end(); ++iter )
-    {
-        // Get the component and the component as T
-        std::shared_ptr<Component>& component = iter->second;
-        T* typedComponent = dynamic_cast<T*>( component.get() );
-
-        // Check if we've found the component
-        if ( typedComponent != nullptr )
-        {
-            return typedComponent;
-        }
-    }
-
-    return nullptr;
+    // The slot for a base type holds the first component derived from it
+    return static_cast<T*>( _componentSlots[ ComponentType<T>::Id ] );
 }
 
 // Get all of the components of the given type
@@ -105,15 +70,14 @@ template<class T> void GameObject::GetComponentsOfType( std::vector<const T*>& c
     components.clear();
 
     // Then iterate over all of our components to check if we have the given type
-    for ( auto iter = _componentCache.begin(); iter != _componentCache.end(); ++iter )
+    ComponentTypeMask typeBit = ( 1U << ComponentType<T>::Id );
+    for ( ComponentTypeId id = 0; id < MAX_COMPONENT_TYPES; ++id )
     {
-        const std::shared_ptr<Component>& component = iter->second;
-        const T* typedComponent = dynamic_cast<const T*>( component.get() );
-
-        // If the casted component is not null, then it's of the given type
-        if ( typedComponent != nullptr )
+        // If the component's mask contains the type, then it's of the given type
+        const Component* component = _componentSlots[ id ];
+        if ( ( _exactTypes & ( 1U << id ) ) && ( component->GetTypeMask() & typeBit ) )
         {
-            components.push_back( typedComponent );
+            components.push_back( static_cast<const T*>( component ) );
         }
     }
 }
@@ -125,15 +89,14 @@ template<class T> void GameObject::GetComponentsOfType( std::vector<T*>& compone
     components.clear();
 
     // Then iterate over all of our components to check if we have the given type
-    for ( auto iter = _componentCache.begin(); iter != _componentCache.end(); ++iter )
+    ComponentTypeMask typeBit = ( 1U << ComponentType<T>::Id );
+    for ( ComponentTypeId id = 0; id < MAX_COMPONENT_TYPES; ++id )
     {
-        const std::shared_ptr<Component>& component = iter->second;
-        T* typedComponent = dynamic_cast<T*>( component.get() );
-
-        // If the casted component is not null, then it's of the given type
-        if ( typedComponent != nullptr )
+        // If the component's mask contains the type, then it's of the given type
+        Component* component = _componentSlots[ id ];
+        if ( ( _exactTypes & ( 1U << id ) ) && ( component->GetTypeMask() & typeBit ) )
         {
-            components.push_back( typedComponent );
+            components.push_back( static_cast<T*>( component ) );
         }
     }
 }
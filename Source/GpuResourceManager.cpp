@@ -0,0 +1,213 @@
+#include "GpuResourceManager.hpp"
+#include <algorithm>
+#include <vector>
+
+#define GPU_DEFAULT_BUDGET ( 256U * 1024U * 1024U ) // Cached assets are evicted once everything uses more than this, in bytes
+
+std::mutex GpuResourceManager::_cacheMutex;
+std::unordered_map<std::string, GpuResourceManager::CachedAsset> GpuResourceManager::_cachedAssets;
+std::atomic<size_t> GpuResourceManager::_sizes[ GPU_RESOURCE_TYPE_COUNT ];
+std::atomic<size_t> GpuResourceManager::_counts[ GPU_RESOURCE_TYPE_COUNT ];
+size_t GpuResourceManager::_budget = GPU_DEFAULT_BUDGET;
+unsigned long long GpuResourceManager::_frame = 0;
+
+// Create a new, empty GPU resource
+GpuResource::GpuResource( GpuResourceType type )
+    : _type( type )
+    , _handle( 0 )
+    , _size( 0 )
+{
+}
+
+// Destroy this GPU resource
+GpuResource::~GpuResource()
+{
+    Release();
+}
+
+// Take ownership of a resource that was made elsewhere
+void GpuResource::Adopt( GLuint handle )
+{
+    Release();
+    if ( handle )
+    {
+        _handle = handle;
+        GpuResourceManager::Track( _type, 0, 0, 1 );
+    }
+}
+
+// Create the resource if it hasn't been yet
+GLuint GpuResource::Create()
+{
+    if ( !_handle )
+    {
+        switch ( _type )
+        {
+        case GpuResourceType::Buffer:  glGenBuffers( 1, &_handle );  break;
+        case GpuResourceType::Texture: glGenTextures( 1, &_handle ); break;
+        default:                                                     break;
+        }
+        if ( _handle )
+        {
+            GpuResourceManager::Track( _type, 0, 0, 1 );
+        }
+    }
+    return _handle;
+}
+
+// Get the number of bytes this resource is accounted as using
+size_t GpuResource::GetSize() const
+{
+    return _size;
+}
+
+// Release the resource
+void GpuResource::Release()
+{
+    if ( !_handle )
+    {
+        return;
+    }
+
+    switch ( _type )
+    {
+    case GpuResourceType::Buffer:  glDeleteBuffers( 1, &_handle );  break;
+    case GpuResourceType::Texture: glDeleteTextures( 1, &_handle ); break;
+    case GpuResourceType::Program: glDeleteProgram( _handle );      break;
+    }
+
+    GpuResourceManager::Track( _type, _size, 0, -1 );
+    _handle = 0;
+    _size = 0;
+}
+
+// Set the number of bytes this resource uses
+void GpuResource::SetSize( size_t size )
+{
+    if ( _handle )
+    {
+        GpuResourceManager::Track( _type, _size, size, 0 );
+        _size = size;
+    }
+}
+
+// Get this resource's handle
+GpuResource::operator GLuint() const
+{
+    return _handle;
+}
+
+// Add a cached asset
+void GpuResourceManager::AddCachedAsset( const std::string& key, const CachedAsset& asset )
+{
+    std::lock_guard<std::mutex> lock( _cacheMutex );
+    CachedAsset& cached = _cachedAssets[ key ];
+    cached = asset;
+    cached.LastUsed = _frame;
+}
+
+// Evict unused cached assets until we're within a budget
+void GpuResourceManager::Evict( size_t budget )
+{
+    if ( GetTotalSize() <= budget )
+    {
+        return;
+    }
+
+    // Evicting takes each cache's own lock, which is held while adding to ours, so work from a copy
+    std::vector<std::pair<std::string, CachedAsset>> candidates;
+    {
+        std::lock_guard<std::mutex> lock( _cacheMutex );
+        candidates.assign( _cachedAssets.begin(), _cachedAssets.end() );
+    }
+    std::sort( candidates.begin(), candidates.end(), []( const std::pair<std::string, CachedAsset>& a, const std::pair<std::string, CachedAsset>& b )
+    {
+        return a.second.LastUsed < b.second.LastUsed;
+    } );
+
+    // Freeing an asset releases its resources straight away, so we know as soon as we're within budget
+    for ( size_t i = 0; i < candidates.size() && GetTotalSize() > budget; ++i )
+    {
+        if ( candidates[ i ].second.Evict() )
+        {
+            std::lock_guard<std::mutex> lock( _cacheMutex );
+            auto search = _cachedAssets.find( candidates[ i ].first );
+            if ( search != _cachedAssets.end() && search->second.LastUsed == candidates[ i ].second.LastUsed )
+            {
+                _cachedAssets.erase( search );
+            }
+        }
+    }
+}
+
+// Get the budget cached assets are evicted to stay within
+size_t GpuResourceManager::GetBudget()
+{
+    return _budget;
+}
+
+// Get the number of resources of a kind
+size_t GpuResourceManager::GetCount( GpuResourceType type )
+{
+    return _counts[ static_cast<size_t>( type ) ];
+}
+
+// Get the number of bytes resources of a kind use
+size_t GpuResourceManager::GetSize( GpuResourceType type )
+{
+    return _sizes[ static_cast<size_t>( type ) ];
+}
+
+// Get the number of bytes every resource uses
+size_t GpuResourceManager::GetTotalSize()
+{
+    size_t size = 0;
+    for ( size_t i = 0; i < GPU_RESOURCE_TYPE_COUNT; ++i )
+    {
+        size += _sizes[ i ];
+    }
+    return size;
+}
+
+// Set the budget cached assets are evicted to stay within
+void GpuResourceManager::SetBudget( size_t budget )
+{
+    _budget = budget;
+}
+
+// Mark a cached asset as just used
+void GpuResourceManager::Touch( const std::string& prefix, const std::string& key )
+{
+    std::lock_guard<std::mutex> lock( _cacheMutex );
+    auto search = _cachedAssets.find( prefix + key );
+    if ( search != _cachedAssets.end() )
+    {
+        search->second.LastUsed = _frame;
+    }
+}
+
+// Account for a resource being created, resized or released
+void GpuResourceManager::Track( GpuResourceType type, size_t oldSize, size_t newSize, int countChange )
+{
+    size_t index = static_cast<size_t>( type );
+    _sizes[ index ] += newSize;
+    _sizes[ index ] -= oldSize;
+    if ( countChange > 0 )
+    {
+        ++_counts[ index ];
+    }
+    else if ( countChange < 0 )
+    {
+        --_counts[ index ];
+    }
+}
+
+// Evict whatever is needed to stay within the budget
+void GpuResourceManager::Update()
+{
+    {
+        std::lock_guard<std::mutex> lock( _cacheMutex );
+        ++_frame;
+    }
+    Evict( _budget );
+}
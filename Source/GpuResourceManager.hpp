@@ -0,0 +1,185 @@
+#pragma once
+
+#include "Config.hpp"
+#include "OpenGL.hpp"
+#include "AssetLoader.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/// <summary>
+/// Defines the kinds of GPU resources that are accounted for.
+/// </summary>
+enum class GpuResourceType
+{
+    Buffer,
+    Texture,
+    Program
+};
+
+#define GPU_RESOURCE_TYPE_COUNT 3
+
+/// <summary>
+/// Defines a GPU resource that is released as soon as its owner is destroyed. It converts to its
+/// handle, so it can be handed straight to OpenGL.
+/// </summary>
+class GpuResource
+{
+    ImplementNonCopyableClass( GpuResource );
+    ImplementNonMovableClass( GpuResource );
+
+    GpuResourceType _type;
+    GLuint          _handle;
+    size_t          _size;
+
+public:
+    /// <summary>
+    /// Creates a new, empty GPU resource.
+    /// </summary>
+    /// <param name="type">The kind of resource.</param>
+    explicit GpuResource( GpuResourceType type );
+
+    /// <summary>
+    /// Destroys this GPU resource, releasing it.
+    /// </summary>
+    ~GpuResource();
+
+    /// <summary>
+    /// Takes ownership of a resource that was made elsewhere, releasing the one held before.
+    /// </summary>
+    /// <param name="handle">The resource's handle.</param>
+    void Adopt( GLuint handle );
+
+    /// <summary>
+    /// Creates the resource if it hasn't been yet. Programs can't be created this way, only adopted.
+    /// </summary>
+    /// <returns>The resource's handle.</returns>
+    GLuint Create();
+
+    /// <summary>
+    /// Gets the number of bytes this resource is accounted as using.
+    /// </summary>
+    size_t GetSize() const;
+
+    /// <summary>
+    /// Releases the resource, leaving this empty.
+    /// </summary>
+    void Release();
+
+    /// <summary>
+    /// Sets the number of bytes this resource uses, for whenever its storage is (re)allocated.
+    /// </summary>
+    /// <param name="size">The number of bytes.</param>
+    void SetSize( size_t size );
+
+    /// <summary>
+    /// Gets this resource's handle, or 0 if it is empty.
+    /// </summary>
+    operator GLuint() const;
+};
+
+/// <summary>
+/// Defines a static GPU resource manager. Every buffer, texture and program is accounted for here
+/// by kind, and the assets the loaders cache are evicted, least recently used first, whenever
+/// nothing but their cache holds them and the GPU's memory use is over budget.
+/// </summary>
+class GpuResourceManager
+{
+    friend class GpuResource;
+
+    ImplementStaticClass( GpuResourceManager );
+
+    /// <summary>
+    /// Defines an asset held in a loader's cache.
+    /// </summary>
+    struct CachedAsset
+    {
+        std::function<bool()> Evict;    // Drops the asset unless something else holds it, returning true if it's gone
+        unsigned long long    LastUsed; // The frame the asset was last asked for
+    };
+
+    static std::mutex _cacheMutex;
+    static std::unordered_map<std::string, CachedAsset> _cachedAssets;
+    static std::atomic<size_t> _sizes[ GPU_RESOURCE_TYPE_COUNT ];  // Atomic rather than locked, as resources can outlive the mutex at exit
+    static std::atomic<size_t> _counts[ GPU_RESOURCE_TYPE_COUNT ];
+    static size_t _budget;
+    static unsigned long long _frame;
+
+    /// <summary>
+    /// Adds a cached asset.
+    /// </summary>
+    /// <param name="key">The asset's key, unique across every cache.</param>
+    /// <param name="asset">The asset.</param>
+    static void AddCachedAsset( const std::string& key, const CachedAsset& asset );
+
+    /// <summary>
+    /// Accounts for a resource being created, resized or released.
+    /// </summary>
+    /// <param name="type">The kind of resource.</param>
+    /// <param name="oldSize">The number of bytes it used to use.</param>
+    /// <param name="newSize">The number of bytes it uses now.</param>
+    /// <param name="countChange">1 if the resource was created, -1 if it was released, otherwise 0.</param>
+    static void Track( GpuResourceType type, size_t oldSize, size_t newSize, int countChange );
+
+public:
+    /// <summary>
+    /// Adds an asset a loader has cached, so it can be evicted once nothing else holds it. Must be
+    /// called while holding the cache's mutex, which is taken again to evict the asset.
+    /// </summary>
+    /// <param name="prefix">The prefix that makes the cache's keys unique across every cache.</param>
+    /// <param name="key">The asset's key in the cache.</param>
+    /// <param name="cache">The cache.</param>
+    /// <param name="mutex">The mutex guarding the cache.</param>
+    template<class T> static void AddCachedAsset( const std::string& prefix, const std::string& key, std::unordered_map<std::string, AssetHandle<T>>& cache, std::mutex& mutex );
+
+    /// <summary>
+    /// Evicts unused cached assets, least recently used first, until the GPU's memory use is within
+    /// a budget or there is nothing left that can be evicted.
+    /// </summary>
+    /// <param name="budget">The budget, in bytes.</param>
+    static void Evict( size_t budget );
+
+    /// <summary>
+    /// Gets the budget cached assets are evicted to stay within.
+    /// </summary>
+    static size_t GetBudget();
+
+    /// <summary>
+    /// Gets the number of resources of a kind.
+    /// </summary>
+    /// <param name="type">The kind of resource.</param>
+    static size_t GetCount( GpuResourceType type );
+
+    /// <summary>
+    /// Gets the number of bytes resources of a kind use.
+    /// </summary>
+    /// <param name="type">The kind of resource.</param>
+    static size_t GetSize( GpuResourceType type );
+
+    /// <summary>
+    /// Gets the number of bytes every resource uses.
+    /// </summary>
+    static size_t GetTotalSize();
+
+    /// <summary>
+    /// Sets the budget cached assets are evicted to stay within.
+    /// </summary>
+    /// <param name="budget">The budget, in bytes.</param>
+    static void SetBudget( size_t budget );
+
+    /// <summary>
+    /// Marks a cached asset as just used.
+    /// </summary>
+    /// <param name="prefix">The prefix of the asset's cache.</param>
+    /// <param name="key">The asset's key in the cache.</param>
+    static void Touch( const std::string& prefix, const std::string& key );
+
+    /// <summary>
+    /// Evicts whatever is needed to stay within the budget. Called once a frame on the main thread.
+    /// </summary>
+    static void Update();
+};
+
+#include "GpuResourceManager.inl"
@@ -0,0 +1,32 @@
+// Add an asset a loader has cached
+template<class T> void GpuResourceManager::AddCachedAsset( const std::string& prefix, const std::string& key, std::unordered_map<std::string, AssetHandle<T>>& cache, std::mutex& mutex )
+{
+    std::unordered_map<std::string, AssetHandle<T>>* cachePointer = &cache;
+    std::mutex* mutexPointer = &mutex;
+
+    CachedAsset asset;
+    asset.Evict = [ cachePointer, mutexPointer, key ]()
+    {
+        // Take the handle out of the cache first, so the asset is freed outside the lock
+        AssetHandle<T> handle;
+        {
+            std::lock_guard<std::mutex> lock( *mutexPointer );
+            auto search = cachePointer->find( key );
+            if ( search == cachePointer->end() )
+            {
+                return true;
+            }
+            if ( !search->second.IsUnique() )
+            {
+                return false;
+            }
+
+            handle = search->second;
+            cachePointer->erase( search );
+        }
+        return true;
+    };
+    asset.LastUsed = 0;
+
+    AddCachedAsset( prefix + key, asset );
+}
@@ -1,9 +1,15 @@
 #pragma warning( disable : 4800 ) // int->bool warning
 
 #include "Image.hpp"
+#include "MappedFile.hpp"
 #include "Texture2D.hpp"
 #include <FreeImage.h>
+#include <algorithm>
 #include <locale>
+#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __SSE2__ )
+#   include <emmintrin.h>
+#   define IMAGE_USE_SSE2
+#endif
 #if defined( _DEBUG ) || defined( DEBUG )
 #   include <iostream>
 #endif
@@ -45,6 +51,77 @@ Image::~Image()
     _height = 0;
 }
 
+// Creates the next level down in this image's mip chain
+bool Image::CreateMipmap( Image& mipmap ) const
+{
+    if ( _width <= 1 && _height <= 1 )
+    {
+        return false;
+    }
+
+    mipmap._width = std::max( _width / 2, 1U );
+    mipmap._height = std::max( _height / 2, 1U );
+    mipmap._pixels.resize( mipmap._width * mipmap._height * 4 );
+
+    // Odd sizes and single-pixel sides use their last pixel twice
+    for ( unsigned int y = 0; y < mipmap._height; ++y )
+    {
+        const unsigned char* top = &_pixels[ std::min( y * 2, _height - 1 ) * _width * 4 ];
+        const unsigned char* bottom = &_pixels[ std::min( y * 2 + 1, _height - 1 ) * _width * 4 ];
+        unsigned char* output = &mipmap._pixels[ y * mipmap._width * 4 ];
+        unsigned int x = 0;
+
+#if defined( IMAGE_USE_SSE2 )
+        // Average two output pixels at a time, from four source pixels on each row
+        if ( _width % 2 == 0 )
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i round = _mm_set1_epi16( 2 );
+            for ( ; x + 2 <= mipmap._width; x += 2 )
+            {
+                __m128i topPixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( top + x * 8 ) );
+                __m128i bottomPixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( bottom + x * 8 ) );
+
+                // Widen to 16 bits and add the rows, leaving the first two pixels' sums low and the last two high
+                __m128i low = _mm_add_epi16( _mm_unpacklo_epi8( topPixels, zero ), _mm_unpacklo_epi8( bottomPixels, zero ) );
+                __m128i high = _mm_add_epi16( _mm_unpackhi_epi8( topPixels, zero ), _mm_unpackhi_epi8( bottomPixels, zero ) );
+
+                // Add each pair of neighbors, then divide by four with rounding
+                __m128i sum = _mm_add_epi16( _mm_unpacklo_epi64( low, high ), _mm_unpackhi_epi64( low, high ) );
+                sum = _mm_srli_epi16( _mm_add_epi16( sum, round ), 2 );
+                _mm_storel_epi64( reinterpret_cast<__m128i*>( output + x * 4 ), _mm_packus_epi16( sum, zero ) );
+            }
+        }
+#endif
+
+        for ( ; x < mipmap._width; ++x )
+        {
+            unsigned int left = std::min( x * 2, _width - 1 ) * 4;
+            unsigned int right = std::min( x * 2 + 1, _width - 1 ) * 4;
+            for ( unsigned int channel = 0; channel < 4; ++channel )
+            {
+                unsigned int sum = top[ left + channel ] + top[ right + channel ] + bottom[ left + channel ] + bottom[ right + channel ];
+                output[ x * 4 + channel ] = static_cast<unsigned char>( ( sum + 2 ) / 4 );
+            }
+        }
+    }
+
+    return true;
+}
+
+// Checks to see if any of this image's pixels are see-through
+bool Image::HasAlpha() const
+{
+    for ( size_t i = 3; i < _pixels.size(); i += 4 )
+    {
+        if ( _pixels[ i ] != 255 )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 // Gets this image's pixel pointer
 const unsigned char* Image::GetPixels() const
 {
@@ -58,13 +135,13 @@ const unsigned char* Image::GetPixels() const
 // Get image height
 unsigned int Image::GetHeight() const
 {
-    return _width;
+    return _height;
 }
 
 // Get image width
 unsigned int Image::GetWidth() const
 {
-    return _height;
+    return _width;
 }
 
 // Attempt to save the image
@@ -122,15 +199,30 @@ bool Image::LoadFromFile( const std::string& fname )
 {
     Dispose();
 
+    // Decode straight from the mapped file, which may be packed into the content archive
+    MappedFile file;
+    if ( !file.Open( fname ) )
+    {
+        return false;
+    }
+    BYTE* data = reinterpret_cast<BYTE*>( const_cast<char*>( file.GetData() ) );
+    FIMEMORY* memory = FreeImage_OpenMemory( data, static_cast<DWORD>( file.GetSize() ) );
+    if ( !memory )
+    {
+        return false;
+    }
+
     // Get the image type
-    FREE_IMAGE_FORMAT imageFormat = FreeImage_GetFileType( fname.c_str() );
+    FREE_IMAGE_FORMAT imageFormat = FreeImage_GetFileTypeFromMemory( memory );
     if ( imageFormat == FREE_IMAGE_FORMAT::FIF_UNKNOWN )
     {
+        FreeImage_CloseMemory( memory );
         return false;
     }
 
     // Read the image and ensure it is 32-BPP
-    FIBITMAP* image = FreeImage_Load( imageFormat, fname.c_str() );
+    FIBITMAP* image = FreeImage_LoadFromMemory( imageFormat, memory );
+    FreeImage_CloseMemory( memory );
     if ( !image )
     {
         return false;
@@ -160,24 +252,23 @@ bool Image::LoadFromFile( const std::string& fname )
     _width  = FreeImage_GetWidth( image );
     _height = FreeImage_GetHeight( image );
 
-    // Copy over the data
+    // Copy over the data. FreeImage loads in BGRA, so we need to convert the pixel data into RGBA
+    // format as we go, swapping the red and blue components of a whole pixel at once.
     _pixels.resize( _width * _height * 4 );
-    unsigned char* imageBits = FreeImage_GetBits( image );
-    memcpy( &_pixels[ 0 ], imageBits, _pixels.size() );
+    const unsigned char* imageBits = FreeImage_GetBits( image );
+    for ( size_t i = 0; i < _pixels.size(); i += 4 )
+    {
+        unsigned int pixel;
+        memcpy( &pixel, imageBits + i, 4 );
+        pixel = ( pixel & 0xFF00FF00 ) | ( ( pixel >> 16 ) & 0xFF ) | ( ( pixel & 0xFF ) << 16 );
+        memcpy( &_pixels[ i ], &pixel, 4 );
+    }
 
 
     // Release the image
     FreeImage_Unload( image );
 
 
-    // FreeImage loads in BGRA, so we need to convert the pixel data into RGBA format
-    for ( size_t i = 0; i < _pixels.size(); i += 4 )
-    {
-        // We only need to swap the red and blue components
-        std::swap( _pixels[ i + 0 ], _pixels[ i + 2 ] );
-    }
-
-
     return true;
 }
 
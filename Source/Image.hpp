@@ -31,6 +31,19 @@ public:
     /// </summary>
     ~Image();
 
+    /// <summary>
+    /// Creates the next level down in this image's mip chain, half as big along each side, by
+    /// averaging each 2x2 block of pixels.
+    /// </summary>
+    /// <param name="mipmap">The image to receive the mip level.</param>
+    /// <returns>True if the mip level was made, false if this image is already a single pixel.</returns>
+    bool CreateMipmap( Image& mipmap ) const;
+
+    /// <summary>
+    /// Checks to see if any of this image's pixels are see-through.
+    /// </summary>
+    bool HasAlpha() const;
+
     /// <summary>
     /// Gets this image's pixels.
     /// </summary>
@@ -1,4 +1,6 @@
 #include <JSON.h>
+#include "JsonDocument.hpp"
+#include "JsonReader.hpp"
 #include <stdlib.h>
 #include <string>
 #include <string.h>
@@ -6,15 +8,7 @@
 #include <cstdlib>
 #include <cstdio>
 #include <climits>
-#include <string.h>
-#include <functional>
-#include <cctype>
-#include <stack>
-#include <cerrno>
-
-//#ifndef WIN32
-//#define _stricmp strcasecmp
-//#endif
+#include <vector>
 
 #ifdef _MSC_VER
 #define snprintf sprintf_s
@@ -22,53 +16,6 @@
 
 using namespace json;
 
-namespace json
-{
-    enum StackDepthType
-    {
-        InObject,
-        InArray
-    };
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Helper functions
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-static std::string Trim( const std::string& str )
-{
-    std::string s = str;
-
-    // remove white space in front
-    s.erase( s.begin(), std::find_if( s.begin(), s.end(), std::not1( std::ptr_fun<int, int>( std::isspace ) ) ) );
-
-    // remove trailing white space
-    s.erase( std::find_if( s.rbegin(), s.rend(), std::not1( std::ptr_fun<int, int>( std::isspace ) ) ).base(), s.end() );
-
-    return s;
-}
-
-// Finds the position of the first " character that is NOT preceeded immediately by a \ character.
-// In JSON, \" is valid and has a different meaning than the escaped " character.
-static size_t GetQuotePos( const std::string& str, size_t start_pos = 0 )
-{
-    bool found_slash = false;
-    for ( size_t i = start_pos; i < str.length(); i++ )
-    {
-        char c = str[ i ];
-        if ( ( c == '\\' ) && !found_slash )
-        {
-            found_slash = true;
-            continue;
-        }
-        else if ( ( c == '\"' ) && !found_slash )
-            return i;
-
-        found_slash = false;
-    }
-
-    return std::string::npos;
-}
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 Value::Value( const Value& v ) : mValueType( v.mValueType )
@@ -499,546 +446,161 @@ void Object::Clear()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-std::string SerializeArray( const Array& a );
-
-std::string SerializeValue( const Value& v )
-{
-    std::string str;
-
-    static const int BUFF_SZ = 500;
-    char buff[ BUFF_SZ ];
-    switch ( v.GetType() )
-    {
-        case IntVal: snprintf( buff, BUFF_SZ, "%d", (int)v ); str = buff; break;
-        case FloatVal: snprintf( buff, BUFF_SZ, "%f", (float)v ); str = buff; break;
-        case DoubleVal: snprintf( buff, BUFF_SZ, "%f", (double)v ); str = buff; break;
-        case BoolVal: str = v ? "true" : "false"; break;
-        case NULLVal: str = "null"; break;
-        case ObjectVal: str = Serialize( v ); break;
-        case ArrayVal: str = SerializeArray( v ); break;
-        case StringVal: str = std::string( "\"" ) + ( std::string )v + std::string( "\"" ); break;
-    }
-
-    return str;
-}
-
-std::string SerializeArray( const Array& a )
-{
-    std::string str = "[";
-
-    bool first = true;
-    for ( size_t i = 0; i < a.size(); i++ )
-    {
-        const Value& v = a[ i ];
-        if ( !first )
-            str += std::string( "," );
-
-        str += SerializeValue( v );
-
-        first = false;
-    }
-
-    str += "]";
-    return str;
-}
-
-std::string json::Serialize( const Value& v )
-{
-    std::string str;
-
-    bool first = true;
-
-    if ( v.GetType() == ObjectVal )
-    {
-        str = "{";
-        Object obj = v.ToObject();
-        for ( Object::ValueMap::const_iterator it = obj.begin(); it != obj.end(); ++it )
-        {
-            if ( !first )
-                str += std::string( "," );
-
-            str += std::string( "\"" ) + it->first + std::string( "\":" ) + SerializeValue( it->second );
-            first = false;
-        }
-
-        str += "}";
-    }
-    else if ( v.GetType() == ArrayVal )
-    {
-        str = "[";
-        Array a = v.ToArray();
-        for ( Array::ValueVector::const_iterator it = a.begin(); it != a.end(); ++it )
-        {
-            if ( !first )
-                str += std::string( "," );
-
-            str += SerializeValue( *it );
-            first = false;
-        }
-
-        str += "]";
-
-    }
-    // else it's not valid JSON, as a JSON data structure must be an array or an object. We'll return an empty string.
-
-
-    return str;
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-static Value DeserializeArray( std::string& str, std::stack<StackDepthType>& depth_stack );
-static Value DeserializeObj( const std::string& _str, std::stack<StackDepthType>& depth_stack );
-
-static Value DeserializeInternal( const std::string& _str, std::stack<StackDepthType>& depth_stack )
-{
-    Value v;
-
-    std::string str = Trim( _str );
-    if ( str[ 0 ] == '{' )
-    {
-        // Error: Began with a { but doesn't end with one
-        if ( str[ str.length() - 1 ] != '}' )
-            return Value();
-
-        depth_stack.push( InObject );
-        v = DeserializeObj( str, depth_stack );
-        if ( ( v.GetType() == NULLVal ) || ( depth_stack.top() != InObject ) )
-            return v;
-
-        depth_stack.pop();
-    }
-    else if ( str[ 0 ] == '[' )
-    {
-        // Error: Began with a [ but doesn't end with one
-        if ( str[ str.length() - 1 ] != ']' )
-            return Value();
-
-        depth_stack.push( InArray );
-        v = DeserializeArray( str, depth_stack );
-        if ( ( v.GetType() == NULLVal ) || ( depth_stack.top() != InArray ) )
-            return v;
-
-        depth_stack.pop();
-    }
-    else
-    {
-        // Will never get here unless _str is not valid JSON
-        return Value();
-    }
-
-    return v;
-}
-
-static size_t GetEndOfArrayOrObj( const std::string& str, std::stack<StackDepthType>& depth_stack )
+namespace json
 {
-    size_t i = 1;
-    bool in_quote = false;
-    size_t original_count = depth_stack.size();
-
-    for ( ; i < str.length(); i++ )
+    // Writes values into a buffer as JSON
+    class ValueWriter
     {
-        if ( str[ i ] == '\"' )
-        {
-            if ( str[ i - 1 ] != '\\' )
-                in_quote = !in_quote;
-        }
-        else if ( !in_quote )
-        {
-            if ( str[ i ] == '[' )
-                depth_stack.push( InArray );
-            else if ( str[ i ] == '{' )
-                depth_stack.push( InObject );
-            else if ( str[ i ] == ']' )
-            {
-                StackDepthType t = depth_stack.top();
-                if ( t != InArray )
-                {
-                    // expected to be closing an array but instead we're inside an object block.
-                    // Example problem: {]}
-                    return std::string::npos;
-                }
-
-                size_t count = depth_stack.size();
-                depth_stack.pop();
-                if ( count == original_count )
-                    break;
-            }
-            else if ( str[ i ] == '}' )
-            {
-                StackDepthType t = depth_stack.top();
-                if ( t != InObject )
-                {
-                    // expected to be closing an object but instead we're inside an array.
-                    // Example problem: [}]
-                    return std::string::npos;
-                }
-
-                size_t count = depth_stack.size();
-                depth_stack.pop();
-                if ( count == original_count )
-                    break;
-            }
-        }
-    }
-
-    return i;
-}
+        public:
 
-static std::string UnescapeJSONString( const std::string& str )
-{
-    std::string s = "";
-
-    for ( std::string::size_type i = 0; i < str.length(); i++ )
-    {
-        char c = str[ i ];
-        if ( ( c == '\\' ) && ( i + 1 < str.length() ) )
-        {
-            int skip_ahead = 1;
-            unsigned int hex;
-            std::string hex_str;
-
-            switch ( str[ i + 1 ] )
+            static void WriteString( const std::string& str, std::string& buffer )
             {
-                case '"': 	s.push_back( '\"' ); break;
-                case '\\': 	s.push_back( '\\' ); break;
-                case '/': 	s.push_back( '/' ); break;
-                case 't': 	s.push_back( '\t' ); break;
-                case 'n': 	s.push_back( '\n' ); break;
-                case 'r': 	s.push_back( '\r' ); break;
-                case 'b':	s.push_back( '\b' ); break;
-                case 'f': 	s.push_back( '\f' ); break;
-                case 'u': 	skip_ahead = 5;
-                    hex_str = str.substr( i + 4, 2 );
-                    hex = (unsigned int)std::strtoul( hex_str.c_str(), nullptr, 16 );
-                    s.push_back( (char)hex );
-                    break;
-
-                default: break;
+                JsonString view = { str.c_str(), str.length() };
+                JsonDocument::WriteString( view, buffer );
             }
 
-            i += skip_ahead;
-        }
-        else
-            s.push_back( c );
-    }
-
-    return Trim( s );
-}
-
-static Value DeserializeValue( std::string& str, bool* had_error, std::stack<StackDepthType>& depth_stack )
-{
-    Value v;
-
-    *had_error = false;
-    str = Trim( str );
-
-    if ( str.length() == 0 )
-        return v;
-
-    if ( str[ 0 ] == '[' )
-    {
-        // This value is an array, determine the end of it and then deserialize the array
-        depth_stack.push( InArray );
-        size_t i = GetEndOfArrayOrObj( str, depth_stack );
-        if ( i == std::string::npos )
-        {
-            *had_error = true;
-            return Value();
-        }
-
-        std::string array_str = str.substr( 0, i + 1 );
-        v = Value( DeserializeArray( array_str, depth_stack ) );
-        str = str.substr( i + 1, str.length() );
-    }
-    else if ( str[ 0 ] == '{' )
-    {
-        // This value is an object, determine the end of it and then deserialize the object
-        depth_stack.push( InObject );
-        size_t i = GetEndOfArrayOrObj( str, depth_stack );
-
-        if ( i == std::string::npos )
-        {
-            *had_error = true;
-            return Value();
-        }
-
-        std::string obj_str = str.substr( 0, i + 1 );
-        v = Value( DeserializeInternal( obj_str, depth_stack ) );
-        str = str.substr( i + 1, str.length() );
-    }
-    else if ( str[ 0 ] == '\"' )
-    {
-        // This value is a string
-        size_t end_quote = GetQuotePos( str, 1 );
-        if ( end_quote == std::string::npos )
-        {
-            *had_error = true;
-            return Value();
-        }
-
-        v = Value( UnescapeJSONString( str.substr( 1, end_quote - 1 ) ) );
-        str = str.substr( end_quote + 1, str.length() );
-    }
-    else
-    {
-        // it's not an object, string, or array so it's either a boolean or a number or null.
-        // Numbers can contain an exponent indicator ('e') or a decimal point.
-        bool has_dot = false;
-        bool has_e = false;
-        std::string temp_val;
-        size_t i = 0;
-        bool found_digit = false;
-        bool found_first_valid_char = false;
-
-        for ( ; i < str.length(); i++ )
-        {
-            if ( str[ i ] == '.' )
+            static void WriteValue( const Value& v, std::string& buffer )
             {
-                if ( !found_digit )
+                static const int BUFF_SZ = 500;
+                char buff[ BUFF_SZ ];
+                switch ( v.mValueType )
                 {
-                    // As per JSON standards, there must be a digit preceding a decimal point
-                    *had_error = true;
-                    return Value();
-                }
-
-                has_dot = true;
-            }
-            else if ( ( str[ i ] == 'e' ) || ( str[ i ] == 'E' ) )
-            {
-                if ( ( _stricmp( temp_val.c_str(), "fals" ) != 0 ) && ( _stricmp( temp_val.c_str(), "tru" ) != 0 ) )
-                {
-                    // it's not a boolean, check for scientific notation validity. This will also trap booleans with extra 'e' characters like falsee/truee
-                    if ( !found_digit )
+                    case IntVal: snprintf( buff, BUFF_SZ, "%d", v.mIntVal ); buffer.append( buff ); break;
+                    case FloatVal: snprintf( buff, BUFF_SZ, "%f", v.mFloatVal ); buffer.append( buff ); break;
+                    case DoubleVal: snprintf( buff, BUFF_SZ, "%f", v.mDoubleVal ); buffer.append( buff ); break;
+                    case BoolVal: buffer.append( v.mBoolVal ? "true" : "false" ); break;
+                    case NULLVal: buffer.append( "null" ); break;
+                    case StringVal: WriteString( v.mStringVal, buffer ); break;
+                    case ObjectVal:
                     {
-                        // As per JSON standards, a digit must precede the 'e' notation
-                        *had_error = true;
-                        return Value();
+                        bool first = true;
+                        buffer.push_back( '{' );
+                        for ( Object::ValueMap::const_iterator it = v.mObjectVal.begin(); it != v.mObjectVal.end(); ++it )
+                        {
+                            if ( !first )
+                                buffer.push_back( ',' );
+
+                            WriteString( it->first, buffer );
+                            buffer.push_back( ':' );
+                            WriteValue( it->second, buffer );
+                            first = false;
+                        }
+                        buffer.push_back( '}' );
+                        break;
                     }
-                    else if ( has_e )
+                    case ArrayVal:
                     {
-                        // multiple 'e' characters not allowed
-                        *had_error = true;
-                        return Value();
+                        buffer.push_back( '[' );
+                        for ( size_t i = 0; i < v.mArrayVal.size(); i++ )
+                        {
+                            if ( i > 0 )
+                                buffer.push_back( ',' );
+
+                            WriteValue( v.mArrayVal[ i ], buffer );
+                        }
+                        buffer.push_back( ']' );
+                        break;
                     }
-
-                    has_e = true;
-                }
-            }
-            else if ( str[ i ] == ']' )
-            {
-                if ( depth_stack.empty() || ( depth_stack.top() != InArray ) )
-                {
-                    *had_error = true;
-                    return Value();
                 }
-
-                depth_stack.pop();
             }
-            else if ( str[ i ] == '}' )
-            {
-                if ( depth_stack.empty() || ( depth_stack.top() != InObject ) )
-                {
-                    *had_error = true;
-                    return Value();
-                }
+    };
 
-                depth_stack.pop();
-            }
-            else if ( str[ i ] == ',' )
-                break;
-            else if ( ( str[ i ] == '[' ) || ( str[ i ] == '{' ) )
-            {
-                // error, we're supposed to be processing things besides arrays/objects in here
-                *had_error = true;
-                return Value();
-            }
+    // Builds values from what the JSON reader reports. Objects and arrays are filled in where they will end up, so nothing is copied
+    // once it has been read.
+    class ValueBuilder
+    {
+        protected:
 
-            if ( !std::isspace( str[ i ] ) )
-            {
-                if ( std::isdigit( str[ i ] ) )
-                    found_digit = true;
+            Value&				mRoot;
+            std::vector<Value*>	mOpen;
+            std::string			mKey;
 
-                found_first_valid_char = true;
-                temp_val += str[ i ];
-            }
-        }
-
-        // store all floating point as doubles. This will also set the float and int values as well.
-        if ( _stricmp( temp_val.c_str(), "true" ) == 0 )
-            v = Value( true );
-        else if ( _stricmp( temp_val.c_str(), "false" ) == 0 )
-            v = Value( false );
-        else if ( has_e || has_dot )
-        {
-            char* end_char;
-            errno = 0;
-            double d = strtod( temp_val.c_str(), &end_char );
-            if ( ( errno != 0 ) || ( *end_char != '\0' ) )
+            // Gets the place for the next value in the innermost open object or array
+            Value* Add()
             {
-                // invalid conversion or out of range
-                *had_error = true;
-                return Value();
-            }
+                if ( mOpen.empty() )
+                    return &mRoot;
 
-            v = Value( d );
-        }
-        else if ( _stricmp( temp_val.c_str(), "null" ) == 0 )
-            v = Value();
-        else
-        {
-            // Check if the value is beyond the size of an int and if so, store it as a double
-            char* end_char;
-            errno = 0;
-            long int ival = strtol( temp_val.c_str(), &end_char, 10 );
-            if ( *end_char != '\0' )
-            {
-                // invalid character sequence, not a number
-                *had_error = true;
-                return Value();
-            }
-            else if ( ( errno == ERANGE ) && ( ( ival == LONG_MAX ) || ( ival == LONG_MIN ) ) )
-            {
-                // value is out of range for a long int, should be a double then. See if we can convert it correctly.
-                errno = 0;
-                double dval = strtod( temp_val.c_str(), &end_char );
-                if ( ( errno != 0 ) || ( *end_char != '\0' ) )
-                {
-                    // error in conversion or it's too big for a double
-                    *had_error = true;
-                    return Value();
-                }
+                Value* parent = mOpen.back();
+                if ( parent->mValueType == ObjectVal )
+                    return &parent->mObjectVal[ mKey ];
 
-                v = Value( dval );
-            }
-            else if ( ( ival >= INT_MIN ) && ( ival <= INT_MAX ) )
-            {
-                // valid integer range
-                v = Value( (int)ival );
-            }
-            else
-            {
-                // probably running on a very old OS since this block implies that long isn't the same size as int.
-                // int is guaranteed to be at least 16 bits and long 32 bits...however nowadays they're almost
-                // always the same 32 bit size. But it's possible someone is running this on a very old architecture
-                // so for correctness, we'll error out here
-                *had_error = true;
-                return Value();
+                // Pointers into the array stay valid while they're open, as nothing is added to it until they're closed
+                parent->mArrayVal.push_back( Value() );
+                return &parent->mArrayVal[ parent->mArrayVal.size() - 1 ];
             }
-        }
-
-        str = str.substr( i, str.length() );
-    }
-
-    return v;
-}
-
-static Value DeserializeArray( std::string& str, std::stack<StackDepthType>& depth_stack )
-{
-    Array a;
-    bool had_error = false;
 
-    str = Trim( str );
+        public:
 
-    // Arrays begin and end with [], so if we don't find one, it's an error
-    if ( ( str[ 0 ] == '[' ) && ( str[ str.length() - 1 ] == ']' ) )
-        str = str.substr( 1, str.length() - 2 );
-    else
-        return Value();
+            ValueBuilder( Value& root ) : mRoot( root ) {}
 
-    // extract out all values from the array (remember, a value can also be an array or an object)
-    while ( str.length() > 0 )
-    {
-        std::string tmp;
+            bool Null() { *Add() = Value(); return true; }
+            bool Bool( bool value ) { *Add() = Value( value ); return true; }
+            bool String( const JsonString& value ) { *Add() = Value( std::string( value.Data, value.Length ) ); return true; }
+            bool Key( const JsonString& key ) { mKey.assign( key.Data, key.Length ); return true; }
+            bool EndObject( unsigned int ) { mOpen.pop_back(); return true; }
+            bool EndArray( unsigned int ) { mOpen.pop_back(); return true; }
 
-        size_t i = 0;
-        for ( ; i < str.length(); i++ )
-        {
-            // If we get to an object or array, parse it:
-            if ( ( str[ i ] == '{' ) || ( str[ i ] == '[' ) )
+            bool Number( double value, bool is_integer )
             {
-                Value v = DeserializeValue( str, &had_error, depth_stack );
-                if ( had_error )
-                    return Value();
-
-                if ( v.GetType() != NULLVal )
-                    a.push_back( v );
-
-                break;
+                // Integers that fit are kept as ints, and everything else as doubles
+                if ( is_integer && ( value >= INT_MIN ) && ( value <= INT_MAX ) )
+                    *Add() = Value( (int)value );
+                else
+                    *Add() = Value( value );
+                return true;
             }
 
-            bool terminate_parsing = false;
-
-            if ( ( str[ i ] == ',' ) || ( str[ i ] == ']' ) )
-                terminate_parsing = true;			// hit the end of a value, parse it in the next block
-            else
+            bool StartObject()
             {
-                // keep grabbing chars to build up the value
-                tmp += str[ i ];
-                if ( i == str.length() - 1 )
-                    terminate_parsing = true; // end of string, finish parsing
+                Value* v = Add();
+                *v = Value( Object() );
+                mOpen.push_back( v );
+                return true;
             }
 
-            if ( terminate_parsing )
+            bool StartArray()
             {
-                Value v = DeserializeValue( tmp, &had_error, depth_stack );
-                if ( had_error )
-                    return Value();
-
-                if ( v.GetType() != NULLVal )
-                    a.push_back( v );
-
-                str = str.substr( i + 1, str.length() );
-                break;
+                Value* v = Add();
+                *v = Value( Array() );
+                mOpen.push_back( v );
+                return true;
             }
-        }
-    }
-
-    return a;
+    };
 }
 
-static Value DeserializeObj( const std::string& _str, std::stack<StackDepthType>& depth_stack )
+std::string json::Serialize( const Value& v )
 {
-    Object obj;
-
-    std::string str = Trim( _str );
-
-    // Objects begin and end with {} so if we don't find a pair, it's an error
-    if ( ( str[ 0 ] != '{' ) && ( str[ str.length() - 1 ] != '}' ) )
-        return Value();
-    else
-        str = str.substr( 1, str.length() - 2 );
-
-    // Get all key/value pairs in this object...
-    while ( str.length() > 0 )
-    {
-        // Get the key name
-        size_t start_quote_idx = GetQuotePos( str );
-        size_t end_quote_idx = GetQuotePos( str, start_quote_idx + 1 );
-        size_t colon_idx = str.find( ':', end_quote_idx );
-
-        if ( ( start_quote_idx == std::string::npos ) || ( end_quote_idx == std::string::npos ) || ( colon_idx == std::string::npos ) )
-            return Value();	// can't find key name
-
-        std::string key = str.substr( start_quote_idx + 1, end_quote_idx - start_quote_idx - 1 );
-        if ( key.length() == 0 )
-            return Value();
-
-        bool had_error = false;
-        str = str.substr( colon_idx + 1, str.length() );
+    std::string str;
+    Serialize( v, str );
+    return str;
+}
 
-        // We have the key, now extract the value from the string
-        obj[ key ] = DeserializeValue( str, &had_error, depth_stack );
-        if ( had_error )
-            return Value();
-    }
+void json::Serialize( const Value& v, std::string& buffer )
+{
+    buffer.clear();
 
-    return obj;
+    // As per JSON specification, a JSON data structure must be an array or an object. Anything else gets an empty string.
+    if ( ( v.GetType() == ObjectVal ) || ( v.GetType() == ArrayVal ) )
+        ValueWriter::WriteValue( v, buffer );
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 Value json::Deserialize( const std::string &str )
 {
-    std::stack<StackDepthType> depth_stack;
-    return DeserializeInternal( str, depth_stack );
-}
+    // The reader works in place, and needs the text to end with a null character
+    std::vector<char> text( str.begin(), str.end() );
+    text.push_back( '\0' );
 
+    Value v;
+    ValueBuilder builder( v );
+    if ( !JsonReader::Parse( &text[ 0 ], str.length(), builder ) )
+        return Value();
+
+    // As per JSON specification, a JSON data structure must be an array or an object
+    if ( ( v.GetType() != ObjectVal ) && ( v.GetType() != ArrayVal ) )
+        return Value();
+
+    return v;
+}
@@ -0,0 +1,254 @@
+#include "JobSystem.hpp"
+
+std::vector<std::unique_ptr<JobSystem::Queue>> JobSystem::_queues;
+std::mutex                                     JobSystem::_sleepMutex;
+std::condition_variable                        JobSystem::_sleepCondition;
+std::atomic<int>                               JobSystem::_taskCount( 0 );
+std::atomic<bool>                              JobSystem::_isRunning( false );
+bool                                           JobSystem::_isInline = false;
+
+// Check to see if the job has finished
+bool JobHandle::IsDone() const
+{
+    return !_counter || _counter->Pending.load() <= 0;
+}
+
+// Start the worker threads
+void JobSystem::Initialize( unsigned int workerCount )
+{
+    if ( _isRunning )
+    {
+        return;
+    }
+
+    if ( workerCount == 0 )
+    {
+        unsigned int coreCount = std::thread::hardware_concurrency();
+        workerCount = ( coreCount > 1 ) ? coreCount - 1 : 0;
+    }
+
+    // Make every queue before starting any workers, as they steal from each other straight away
+    for ( unsigned int i = 0; i <= workerCount; ++i )
+    {
+        _queues.push_back( std::unique_ptr<Queue>( new Queue() ) );
+    }
+
+    // Hold the workers back until every thread ID is known, as any of them may need to look one up
+    std::lock_guard<std::mutex> lock( _sleepMutex );
+    for ( unsigned int i = 0; i < workerCount; ++i )
+    {
+        _queues[ i ]->Thread = std::thread( &JobSystem::RunWorker, static_cast<size_t>( i ) );
+        _queues[ i ]->ThreadId = _queues[ i ]->Thread.get_id();
+    }
+    _isRunning = true;
+}
+
+// Stop the worker threads
+void JobSystem::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock( _sleepMutex );
+        _isRunning = false;
+    }
+    _sleepCondition.notify_all();
+
+    for ( auto& queue : _queues )
+    {
+        if ( queue->Thread.joinable() )
+        {
+            queue->Thread.join();
+        }
+    }
+
+    _queues.clear();
+    _taskCount = 0;
+}
+
+// Finish a task
+void JobSystem::Finish( const std::shared_ptr<JobCounter>& counter )
+{
+    if ( --counter->Pending > 0 )
+    {
+        return;
+    }
+
+    // Anything scheduled against the counter after this point sees it as done and schedules itself
+    std::vector<Job> continuations;
+    {
+        std::lock_guard<std::mutex> lock( counter->Mutex );
+        continuations.swap( counter->Continuations );
+    }
+
+    for ( auto& continuation : continuations )
+    {
+        continuation();
+    }
+}
+
+// Get the number of worker threads
+size_t JobSystem::GetWorkerCount()
+{
+    return _queues.empty() ? 0 : _queues.size() - 1;
+}
+
+// Get the index of the calling thread's queue
+size_t JobSystem::GetQueueIndex()
+{
+    // Only a handful of workers, so a linear search beats anything fancier
+    std::thread::id id = std::this_thread::get_id();
+    size_t workerCount = GetWorkerCount();
+    for ( size_t i = 0; i < workerCount; ++i )
+    {
+        if ( _queues[ i ]->ThreadId == id )
+        {
+            return i;
+        }
+    }
+    return workerCount;
+}
+
+// Check to see if jobs are run inline
+bool JobSystem::IsInline()
+{
+    return _isInline;
+}
+
+// Add a task to the calling thread's queue
+void JobSystem::Push( Task task )
+{
+    Queue& queue = *_queues[ GetQueueIndex() ];
+    {
+        std::lock_guard<std::mutex> lock( queue.Mutex );
+        queue.Tasks.push_back( std::move( task ) );
+    }
+
+    ++_taskCount;
+    _sleepCondition.notify_one();
+}
+
+// Run a worker thread
+void JobSystem::RunWorker( size_t index )
+{
+    // Wait for Initialize to finish filling out the queues
+    {
+        std::lock_guard<std::mutex> lock( _sleepMutex );
+    }
+
+    while ( _isRunning )
+    {
+        if ( TryRunTask( index ) )
+        {
+            continue;
+        }
+
+        // Sleep until there's work, waking up now and then in case a notification was missed
+        std::unique_lock<std::mutex> lock( _sleepMutex );
+        _sleepCondition.wait_for( lock, std::chrono::milliseconds( 1 ), []() { return _taskCount > 0 || !_isRunning; } );
+    }
+}
+
+// Schedule a job
+JobHandle JobSystem::Schedule( Job job )
+{
+    return Schedule( std::move( job ), JobHandle() );
+}
+
+// Schedule a job to run once another job has finished
+JobHandle JobSystem::Schedule( Job job, const JobHandle& dependency )
+{
+    JobHandle handle;
+    handle._counter = std::make_shared<JobCounter>();
+    handle._counter->Pending = 1;
+
+    // Inline jobs run straight away, which also means their dependencies have always finished
+    if ( _isInline || _queues.size() <= 1 )
+    {
+        Wait( dependency );
+        job();
+        Finish( handle._counter );
+        return handle;
+    }
+
+    Task task;
+    task.Func = std::move( job );
+    task.Counter = handle._counter;
+
+    // Park the job on its dependency if the dependency is still running
+    if ( dependency._counter )
+    {
+        std::lock_guard<std::mutex> lock( dependency._counter->Mutex );
+        if ( dependency._counter->Pending > 0 )
+        {
+            dependency._counter->Continuations.push_back( [ task ]() { Push( task ); } );
+            return handle;
+        }
+    }
+
+    Push( std::move( task ) );
+    return handle;
+}
+
+// Set whether jobs are run inline
+void JobSystem::SetInline( bool isInline )
+{
+    _isInline = isInline;
+}
+
+// Attempt to run a single task
+bool JobSystem::TryRunTask( size_t queueIndex )
+{
+    if ( _taskCount <= 0 )
+    {
+        return false;
+    }
+
+    // Take our own newest task first, then steal the oldest task from everyone else
+    Task task;
+    bool hasTask = false;
+    for ( size_t offset = 0; offset < _queues.size() && !hasTask; ++offset )
+    {
+        size_t index = ( queueIndex + offset ) % _queues.size();
+        Queue& queue = *_queues[ index ];
+
+        std::lock_guard<std::mutex> lock( queue.Mutex );
+        if ( queue.Tasks.empty() )
+        {
+            continue;
+        }
+
+        if ( index == queueIndex )
+        {
+            task = std::move( queue.Tasks.back() );
+            queue.Tasks.pop_back();
+        }
+        else
+        {
+            task = std::move( queue.Tasks.front() );
+            queue.Tasks.pop_front();
+        }
+        hasTask = true;
+    }
+
+    if ( !hasTask )
+    {
+        return false;
+    }
+
+    --_taskCount;
+    task.Func();
+    Finish( task.Counter );
+    return true;
+}
+
+// Wait for a job to finish
+void JobSystem::Wait( const JobHandle& handle )
+{
+    size_t queueIndex = GetQueueIndex();
+    while ( !handle.IsDone() )
+    {
+        if ( !TryRunTask( queueIndex ) )
+        {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "Config.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Defines a unit of work.
+/// </summary>
+typedef std::function<void()> Job;
+
+/// <summary>
+/// Defines the number of jobs left in a group, and the jobs waiting on the group to finish.
+/// </summary>
+struct JobCounter
+{
+    std::atomic<int> Pending;
+    std::mutex       Mutex;
+    std::vector<Job> Continuations; // Run as soon as Pending reaches zero, each one scheduling a waiting job
+};
+
+/// <summary>
+/// Defines a handle to a scheduled job, used to wait on it or make other jobs depend on it.
+/// </summary>
+class JobHandle
+{
+    friend class JobSystem;
+
+    std::shared_ptr<JobCounter> _counter;
+
+public:
+    /// <summary>
+    /// Checks to see if the job has finished. Null handles are always finished.
+    /// </summary>
+    bool IsDone() const;
+};
+
+/// <summary>
+/// Defines a static class that runs jobs on a pool of worker threads. Each worker keeps its own
+/// queue, taking its newest job first and stealing the oldest jobs of the other workers when it
+/// runs dry. Threads that wait on a job help run jobs until it finishes.
+/// </summary>
+class JobSystem
+{
+    ImplementStaticClass( JobSystem );
+
+    /// <summary>
+    /// Defines a job waiting to be run.
+    /// </summary>
+    struct Task
+    {
+        Job                         Func;
+        std::shared_ptr<JobCounter> Counter;
+    };
+
+    /// <summary>
+    /// Defines a job queue. Every worker has one, plus one shared by every other thread.
+    /// </summary>
+    struct Queue
+    {
+        std::deque<Task> Tasks;
+        std::mutex       Mutex;
+        std::thread      Thread;
+        std::thread::id  ThreadId;
+    };
+
+    static std::vector<std::unique_ptr<Queue>> _queues; // The last queue belongs to non-worker threads
+    static std::mutex _sleepMutex;
+    static std::condition_variable _sleepCondition;
+    static std::atomic<int> _taskCount;
+    static std::atomic<bool> _isRunning;
+    static bool _isInline;
+
+    /// <summary>
+    /// Finishes a task, scheduling anything that was waiting on its counter.
+    /// </summary>
+    /// <param name="counter">The task's counter.</param>
+    static void Finish( const std::shared_ptr<JobCounter>& counter );
+
+    /// <summary>
+    /// Gets the index of the queue the calling thread should push to.
+    /// </summary>
+    static size_t GetQueueIndex();
+
+    /// <summary>
+    /// Adds a task to the calling thread's queue.
+    /// </summary>
+    /// <param name="task">The task.</param>
+    static void Push( Task task );
+
+    /// <summary>
+    /// Runs a worker thread.
+    /// </summary>
+    /// <param name="index">The worker's queue index.</param>
+    static void RunWorker( size_t index );
+
+    /// <summary>
+    /// Attempts to run a single task, stealing one if the calling thread's queue is empty.
+    /// </summary>
+    /// <param name="queueIndex">The index of the calling thread's queue.</param>
+    /// <returns>True if a task was run, false if there was nothing to run.</returns>
+    static bool TryRunTask( size_t queueIndex );
+
+public:
+    /// <summary>
+    /// Starts the worker threads.
+    /// </summary>
+    /// <param name="workerCount">The number of workers, or zero to use one less than the number of cores.</param>
+    static void Initialize( unsigned int workerCount = 0 );
+
+    /// <summary>
+    /// Stops the worker threads. Jobs that have not started yet are dropped.
+    /// </summary>
+    static void Shutdown();
+
+    /// <summary>
+    /// Gets the number of worker threads.
+    /// </summary>
+    static size_t GetWorkerCount();
+
+    /// <summary>
+    /// Checks to see if jobs are being run inline, on the thread that schedules them.
+    /// </summary>
+    static bool IsInline();
+
+    /// <summary>
+    /// Sets whether jobs are run inline, on the thread that schedules them. Useful for debugging.
+    /// </summary>
+    /// <param name="isInline">True to run jobs inline, false to hand them to the workers.</param>
+    static void SetInline( bool isInline );
+
+    /// <summary>
+    /// Splits a range into chunks and runs them in parallel, returning once every chunk is done. The
+    /// chunks only depend on the count and grain size, so results written per index are the same no
+    /// matter how many workers there are.
+    /// </summary>
+    /// <param name="count">The number of items.</param>
+    /// <param name="grainSize">The number of items in each chunk.</param>
+    /// <param name="func">The function to run on each chunk, taking the chunk's first and one past its last index.</param>
+    template<class TFunc> static void ParallelFor( size_t count, size_t grainSize, TFunc func );
+
+    /// <summary>
+    /// Schedules a job.
+    /// </summary>
+    /// <param name="job">The job.</param>
+    static JobHandle Schedule( Job job );
+
+    /// <summary>
+    /// Schedules a job to run once another job has finished.
+    /// </summary>
+    /// <param name="job">The job.</param>
+    /// <param name="dependency">The job to wait for.</param>
+    static JobHandle Schedule( Job job, const JobHandle& dependency );
+
+    /// <summary>
+    /// Waits for a job to finish, helping to run jobs in the meantime.
+    /// </summary>
+    /// <param name="handle">The job.</param>
+    static void Wait( const JobHandle& handle );
+};
+
+#include "JobSystem.inl"
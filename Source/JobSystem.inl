@@ -0,0 +1,42 @@
+// Split a range into chunks and run them in parallel
+template<class TFunc> void JobSystem::ParallelFor( size_t count, size_t grainSize, TFunc func )
+{
+    if ( grainSize == 0 )
+    {
+        grainSize = 1;
+    }
+    size_t chunkCount = ( count + grainSize - 1 ) / grainSize;
+
+    // Run every chunk here, in order, if there is no one to share them with
+    if ( _isInline || _queues.size() <= 1 || chunkCount <= 1 )
+    {
+        for ( size_t begin = 0; begin < count; begin += grainSize )
+        {
+            size_t end = begin + grainSize;
+            func( begin, ( end < count ) ? end : count );
+        }
+        return;
+    }
+
+    JobHandle handle;
+    handle._counter = std::make_shared<JobCounter>();
+    handle._counter->Pending = static_cast<int>( chunkCount );
+
+    // Hand out every chunk but the first, which we run ourselves
+    for ( size_t chunk = 1; chunk < chunkCount; ++chunk )
+    {
+        size_t begin = chunk * grainSize;
+        size_t end = ( begin + grainSize < count ) ? begin + grainSize : count;
+
+        Task task;
+        task.Func = [ &func, begin, end ]() { func( begin, end ); };
+        task.Counter = handle._counter;
+        Push( task );
+    }
+
+    func( 0, grainSize );
+    Finish( handle._counter );
+
+    // The function is captured by reference, so we can't leave until every chunk is done
+    Wait( handle );
+}
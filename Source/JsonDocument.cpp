@@ -0,0 +1,398 @@
+#include "JsonDocument.hpp"
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _MSC_VER
+#define snprintf sprintf_s
+#endif
+
+#define JSON_BLOCK_SIZE 4096 // The number of values in each block
+
+static const JsonValue NullValue;
+
+/// <summary>
+/// Defines the handler that builds a document as it is read.
+/// </summary>
+class JsonDocument::Builder
+{
+    JsonDocument& _document;
+    JsonString _key;
+
+    /// <summary>
+    /// Adds a value to the open object or array.
+    /// </summary>
+    /// <param name="type">The value's type.</param>
+    JsonValue& Add( JsonType type )
+    {
+        _document._pending.push_back( JsonValue() );
+        JsonValue& value = _document._pending.back();
+        value._type = type;
+        value._key = _key;
+        _key.Data = "";
+        _key.Length = 0;
+        return value;
+    }
+
+    /// <summary>
+    /// Moves the values of the object or array being closed from the pending list into a block.
+    /// </summary>
+    /// <param name="count">The number of values.</param>
+    bool Close( unsigned int count )
+    {
+        std::vector<JsonValue>& pending = _document._pending;
+        size_t first = _document._openIndices.back();
+        _document._openIndices.pop_back();
+
+        JsonValue* children = nullptr;
+        if ( count > 0 )
+        {
+            children = _document.Allocate( count );
+            std::copy( pending.begin() + first, pending.end(), children );
+        }
+        pending.resize( first );
+
+        JsonValue& container = pending.back();
+        container._children = children;
+        container._count = count;
+        return true;
+    }
+
+    /// <summary>
+    /// Opens a new object or array.
+    /// </summary>
+    /// <param name="type">The type.</param>
+    bool Open( JsonType type )
+    {
+        Add( type );
+        _document._openIndices.push_back( _document._pending.size() );
+        return true;
+    }
+
+public:
+    /// <summary>
+    /// Creates a new builder.
+    /// </summary>
+    /// <param name="document">The document to build.</param>
+    Builder( JsonDocument& document )
+        : _document( document )
+    {
+        _key.Data = "";
+        _key.Length = 0;
+    }
+
+    bool Null()                                { Add( JsonType::Null ); return true; }
+    bool Bool( bool value )                    { Add( JsonType::Bool )._bool = value; return true; }
+    bool Number( double value, bool )          { Add( JsonType::Number )._number = value; return true; }
+    bool String( const JsonString& value )     { Add( JsonType::String )._string = value; return true; }
+    bool Key( const JsonString& key )          { _key = key; return true; }
+    bool StartObject()                         { return Open( JsonType::Object ); }
+    bool EndObject( unsigned int memberCount ) { return Close( memberCount ); }
+    bool StartArray()                          { return Open( JsonType::Array ); }
+    bool EndArray( unsigned int elementCount ) { return Close( elementCount ); }
+};
+
+// Create a new null value
+JsonValue::JsonValue()
+    : _number( 0.0 )
+    , _children( nullptr )
+    , _count( 0 )
+    , _type( JsonType::Null )
+    , _bool( false )
+{
+    _key.Data = "";
+    _key.Length = 0;
+    _string.Data = "";
+    _string.Length = 0;
+}
+
+// Get this value's type
+JsonType JsonValue::GetType() const
+{
+    return _type;
+}
+
+// Get this value's name
+const JsonString& JsonValue::GetKey() const
+{
+    return _key;
+}
+
+// Get the number of members or elements
+unsigned int JsonValue::GetCount() const
+{
+    return _count;
+}
+
+// Find a member of this object
+const JsonValue* JsonValue::Find( const char* key ) const
+{
+    if ( _type != JsonType::Object )
+    {
+        return nullptr;
+    }
+
+    for ( unsigned int i = 0; i < _count; ++i )
+    {
+        if ( _children[ i ]._key == key )
+        {
+            return &_children[ i ];
+        }
+    }
+    return nullptr;
+}
+
+// Get a member of this object
+const JsonValue& JsonValue::operator[]( const char* key ) const
+{
+    const JsonValue* member = Find( key );
+    return member ? *member : NullValue;
+}
+
+// Get an element of this array
+const JsonValue& JsonValue::operator[]( size_t index ) const
+{
+    return ( index < _count ) ? _children[ index ] : NullValue;
+}
+
+// Get the first member or element
+const JsonValue* JsonValue::begin() const
+{
+    return _children;
+}
+
+// Get one past the last member or element
+const JsonValue* JsonValue::end() const
+{
+    return _children + _count;
+}
+
+// Get this value as a boolean
+bool JsonValue::ToBool( bool def ) const
+{
+    return ( _type == JsonType::Bool ) ? _bool : def;
+}
+
+// Get this value as a double
+double JsonValue::ToDouble( double def ) const
+{
+    return ( _type == JsonType::Number ) ? _number : def;
+}
+
+// Get this value as a float
+float JsonValue::ToFloat( float def ) const
+{
+    return ( _type == JsonType::Number ) ? static_cast<float>( _number ) : def;
+}
+
+// Get this value as an integer
+int JsonValue::ToInt( int def ) const
+{
+    return ( _type == JsonType::Number ) ? static_cast<int>( _number ) : def;
+}
+
+// Get this value as a string
+const char* JsonValue::ToString( const char* def ) const
+{
+    return ( _type == JsonType::String ) ? _string.Data : def;
+}
+
+// Get this value's string
+JsonString JsonValue::GetString() const
+{
+    return _string;
+}
+
+// Create a new document
+JsonDocument::JsonDocument()
+    : _blockIndex( 0 )
+    , _blockUsed( 0 )
+{
+}
+
+// Destroy this document
+JsonDocument::~JsonDocument()
+{
+}
+
+// Take a run of values from the blocks
+JsonValue* JsonDocument::Allocate( size_t count )
+{
+    // Move on to the next block with room, adding a new one if there isn't one
+    while ( _blockIndex < _blocks.size() && _blocks[ _blockIndex ].size() - _blockUsed < count )
+    {
+        ++_blockIndex;
+        _blockUsed = 0;
+    }
+    if ( _blockIndex == _blocks.size() )
+    {
+        _blocks.push_back( std::vector<JsonValue>( std::max<size_t>( count, JSON_BLOCK_SIZE ) ) );
+    }
+
+    JsonValue* values = &_blocks[ _blockIndex ][ _blockUsed ];
+    _blockUsed += count;
+    return values;
+}
+
+// Parse the text that has been copied into the document
+bool JsonDocument::ParseText()
+{
+    // Earlier values are dropped, but their blocks are kept
+    _blockIndex = 0;
+    _blockUsed = 0;
+    _pending.clear();
+    _openIndices.clear();
+    _root = JsonValue();
+
+    Builder builder( *this );
+    bool isValid = JsonReader::Parse( &_text[ 0 ], _text.size() - 1, builder ) && _pending.size() == 1;
+    if ( isValid )
+    {
+        _root = _pending[ 0 ];
+    }
+
+    _pending.clear();
+    return isValid;
+}
+
+// Get the document's root value
+const JsonValue& JsonDocument::GetRoot() const
+{
+    return _root;
+}
+
+// Read a file and parse it
+bool JsonDocument::LoadFromFile( const std::string& fname )
+{
+    MappedFile file;
+    if ( !file.Open( fname ) )
+    {
+        return false;
+    }
+
+    // The reader needs the text to end with a null character
+    _text.assign( file.GetData(), file.GetData() + file.GetSize() );
+    _text.push_back( '\0' );
+
+    return ParseText();
+}
+
+// Parse some text
+bool JsonDocument::Parse( const char* text, size_t length )
+{
+    _text.assign( text, text + length );
+    _text.push_back( '\0' );
+    return ParseText();
+}
+
+// Write a string to a buffer, escaping it
+void JsonDocument::WriteString( const JsonString& str, std::string& buffer )
+{
+    static const char HexDigits[] = "0123456789ABCDEF";
+
+    buffer.push_back( '"' );
+    for ( size_t i = 0; i < str.Length; ++i )
+    {
+        char c = str.Data[ i ];
+        switch ( c )
+        {
+            case '"':  buffer.append( "\\\"" ); break;
+            case '\\': buffer.append( "\\\\" ); break;
+            case '\b': buffer.append( "\\b" ); break;
+            case '\f': buffer.append( "\\f" ); break;
+            case '\n': buffer.append( "\\n" ); break;
+            case '\r': buffer.append( "\\r" ); break;
+            case '\t': buffer.append( "\\t" ); break;
+            default:
+                if ( static_cast<unsigned char>( c ) < 0x20 )
+                {
+                    buffer.append( "\\u00" );
+                    buffer.push_back( HexDigits[ c >> 4 ] );
+                    buffer.push_back( HexDigits[ c & 0xF ] );
+                }
+                else
+                {
+                    buffer.push_back( c );
+                }
+                break;
+        }
+    }
+    buffer.push_back( '"' );
+}
+
+// Write a value to a buffer
+void JsonDocument::WriteValue( const JsonValue& value, std::string& buffer )
+{
+    switch ( value._type )
+    {
+        case JsonType::Null:
+            buffer.append( "null" );
+            break;
+
+        case JsonType::Bool:
+            buffer.append( value._bool ? "true" : "false" );
+            break;
+
+        case JsonType::Number:
+        {
+            // JSON can't hold infinities or NaNs, so they're written as null
+            double number = value._number;
+            if ( number != number || number - number != 0.0 )
+            {
+                buffer.append( "null" );
+                break;
+            }
+
+            // Use the shortest form that reads back as the same number
+            char digits[ 32 ];
+            snprintf( digits, sizeof( digits ), "%.15g", number );
+            if ( strtod( digits, nullptr ) != number )
+            {
+                snprintf( digits, sizeof( digits ), "%.17g", number );
+            }
+            buffer.append( digits );
+            break;
+        }
+
+        case JsonType::String:
+            WriteString( value._string, buffer );
+            break;
+
+        case JsonType::Array:
+            buffer.push_back( '[' );
+            for ( unsigned int i = 0; i < value._count; ++i )
+            {
+                if ( i > 0 )
+                {
+                    buffer.push_back( ',' );
+                }
+                WriteValue( value._children[ i ], buffer );
+            }
+            buffer.push_back( ']' );
+            break;
+
+        case JsonType::Object:
+            buffer.push_back( '{' );
+            for ( unsigned int i = 0; i < value._count; ++i )
+            {
+                if ( i > 0 )
+                {
+                    buffer.push_back( ',' );
+                }
+                WriteString( value._children[ i ]._key, buffer );
+                buffer.push_back( ':' );
+                WriteValue( value._children[ i ], buffer );
+            }
+            buffer.push_back( '}' );
+            break;
+    }
+}
+
+// Write a value out as JSON
+void JsonDocument::Serialize( const JsonValue& value, std::string& buffer )
+{
+    buffer.clear();
+    WriteValue( value, buffer );
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "JsonReader.hpp"
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Defines the types of JSON values.
+/// </summary>
+enum class JsonType
+{
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object
+};
+
+/// <summary>
+/// Defines a value in a JSON document. Values belong to their document, and strings point into the
+/// document's text, so values are only valid for as long as the document they came from.
+/// </summary>
+class JsonValue
+{
+    friend class JsonDocument;
+
+    JsonString   _key;      // The value's name, if it is a member of an object
+    JsonString   _string;
+    double       _number;
+    JsonValue*   _children; // An object's members or an array's elements, kept together
+    unsigned int _count;
+    JsonType     _type;
+    bool         _bool;
+
+public:
+    /// <summary>
+    /// Creates a new null value.
+    /// </summary>
+    JsonValue();
+
+    /// <summary>
+    /// Gets this value's type.
+    /// </summary>
+    JsonType GetType() const;
+
+    /// <summary>
+    /// Gets this value's name, if it is a member of an object.
+    /// </summary>
+    const JsonString& GetKey() const;
+
+    /// <summary>
+    /// Gets the number of members or elements in this object or array.
+    /// </summary>
+    unsigned int GetCount() const;
+
+    /// <summary>
+    /// Finds a member of this object.
+    /// </summary>
+    /// <param name="key">The member's name.</param>
+    /// <returns>The member, or null if this isn't an object or doesn't have the member.</returns>
+    const JsonValue* Find( const char* key ) const;
+
+    /// <summary>
+    /// Gets a member of this object.
+    /// </summary>
+    /// <param name="key">The member's name.</param>
+    /// <returns>The member, or a null value if this isn't an object or doesn't have the member.</returns>
+    const JsonValue& operator[]( const char* key ) const;
+
+    /// <summary>
+    /// Gets an element of this array, or a member of this object in the order they were written.
+    /// </summary>
+    /// <param name="index">The element's index.</param>
+    /// <returns>The element, or a null value if the index is out of range.</returns>
+    const JsonValue& operator[]( size_t index ) const;
+
+    /// <summary>
+    /// Gets the first of this value's members or elements.
+    /// </summary>
+    const JsonValue* begin() const;
+
+    /// <summary>
+    /// Gets one past the last of this value's members or elements.
+    /// </summary>
+    const JsonValue* end() const;
+
+    /// <summary>
+    /// Gets this value as a boolean.
+    /// </summary>
+    /// <param name="def">The value to return if this isn't a boolean.</param>
+    bool ToBool( bool def = false ) const;
+
+    /// <summary>
+    /// Gets this value as a double.
+    /// </summary>
+    /// <param name="def">The value to return if this isn't a number.</param>
+    double ToDouble( double def = 0.0 ) const;
+
+    /// <summary>
+    /// Gets this value as a float.
+    /// </summary>
+    /// <param name="def">The value to return if this isn't a number.</param>
+    float ToFloat( float def = 0.0f ) const;
+
+    /// <summary>
+    /// Gets this value as an integer.
+    /// </summary>
+    /// <param name="def">The value to return if this isn't a number.</param>
+    int ToInt( int def = 0 ) const;
+
+    /// <summary>
+    /// Gets this value as a string.
+    /// </summary>
+    /// <param name="def">The value to return if this isn't a string.</param>
+    const char* ToString( const char* def = "" ) const;
+
+    /// <summary>
+    /// Gets this value's string, or an empty string if this isn't a string.
+    /// </summary>
+    JsonString GetString() const;
+};
+
+/// <summary>
+/// Defines a JSON document. The document keeps its own copy of the text it was parsed from, and its
+/// values are kept together in large blocks that are only freed with the document, so parsing never
+/// copies a string and never allocates a value on its own. Parsing again re-uses the memory.
+/// </summary>
+class JsonDocument
+{
+    ImplementNonCopyableClass( JsonDocument );
+    ImplementNonMovableClass( JsonDocument );
+
+    class Builder;
+
+    std::vector<char> _text;
+    std::vector<std::vector<JsonValue>> _blocks;
+    size_t _blockIndex;                 // The block values are being taken from
+    size_t _blockUsed;                  // The number of values taken from that block
+    std::vector<JsonValue> _pending;    // Values that have been read, but whose object or array is still open
+    std::vector<size_t> _openIndices;   // Where each open object or array's values start in the pending list
+    JsonValue _root;
+
+    /// <summary>
+    /// Takes a run of values from the blocks.
+    /// </summary>
+    /// <param name="count">The number of values.</param>
+    JsonValue* Allocate( size_t count );
+
+    /// <summary>
+    /// Parses the text that has been copied into the document.
+    /// </summary>
+    bool ParseText();
+
+    /// <summary>
+    /// Writes a value to a buffer.
+    /// </summary>
+    /// <param name="value">The value.</param>
+    /// <param name="buffer">The buffer.</param>
+    static void WriteValue( const JsonValue& value, std::string& buffer );
+
+public:
+    /// <summary>
+    /// Creates a new, empty document.
+    /// </summary>
+    JsonDocument();
+
+    /// <summary>
+    /// Destroys this document.
+    /// </summary>
+    ~JsonDocument();
+
+    /// <summary>
+    /// Gets the document's root value.
+    /// </summary>
+    const JsonValue& GetRoot() const;
+
+    /// <summary>
+    /// Reads a file and parses it. The file is read in one go.
+    /// </summary>
+    /// <param name="fname">The file name.</param>
+    /// <returns>True if the file was read and was a valid document, false if not.</returns>
+    bool LoadFromFile( const std::string& fname );
+
+    /// <summary>
+    /// Parses some text.
+    /// </summary>
+    /// <param name="text">The text.</param>
+    /// <param name="length">The length of the text.</param>
+    /// <returns>True if the text was a valid document, false if not.</returns>
+    bool Parse( const char* text, size_t length );
+
+    /// <summary>
+    /// Writes a value out as JSON.
+    /// </summary>
+    /// <param name="value">The value.</param>
+    /// <param name="buffer">The buffer to write to. It is cleared first, but keeps its memory, so it can be re-used.</param>
+    static void Serialize( const JsonValue& value, std::string& buffer );
+
+    /// <summary>
+    /// Writes a string to a buffer as JSON, quoting and escaping it.
+    /// </summary>
+    /// <param name="str">The string.</param>
+    /// <param name="buffer">The buffer to append to.</param>
+    static void WriteString( const JsonString& str, std::string& buffer );
+};
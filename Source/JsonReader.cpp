@@ -0,0 +1,281 @@
+#include "JsonReader.hpp"
+#include <cstdlib>
+#include <cstring>
+
+#define JSON_MAX_EXACT_DIGITS 15 // Integers with up to this many digits convert to a double exactly
+
+const unsigned int JsonReader::MaxDepth = 256;
+
+// Checks to see if a character is a decimal digit
+static bool IsDigit( char c )
+{
+    return c >= '0' && c <= '9';
+}
+
+// Reads the four hex digits of a unicode escape
+static bool ReadHex( const char* read, const char* end, unsigned int& code )
+{
+    if ( end - read < 4 )
+    {
+        return false;
+    }
+
+    code = 0;
+    for ( int i = 0; i < 4; ++i )
+    {
+        char c = read[ i ];
+        code <<= 4;
+        if ( c >= '0' && c <= '9' )
+        {
+            code |= c - '0';
+        }
+        else if ( c >= 'a' && c <= 'f' )
+        {
+            code |= c - 'a' + 10;
+        }
+        else if ( c >= 'A' && c <= 'F' )
+        {
+            code |= c - 'A' + 10;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writes a code point as UTF-8
+static char* WriteUtf8( char* write, unsigned int code )
+{
+    if ( code < 0x80 )
+    {
+        *write++ = static_cast<char>( code );
+    }
+    else if ( code < 0x800 )
+    {
+        *write++ = static_cast<char>( 0xC0 | ( code >> 6 ) );
+        *write++ = static_cast<char>( 0x80 | ( code & 0x3F ) );
+    }
+    else if ( code < 0x10000 )
+    {
+        *write++ = static_cast<char>( 0xE0 | ( code >> 12 ) );
+        *write++ = static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+        *write++ = static_cast<char>( 0x80 | ( code & 0x3F ) );
+    }
+    else
+    {
+        *write++ = static_cast<char>( 0xF0 | ( code >> 18 ) );
+        *write++ = static_cast<char>( 0x80 | ( ( code >> 12 ) & 0x3F ) );
+        *write++ = static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+        *write++ = static_cast<char>( 0x80 | ( code & 0x3F ) );
+    }
+    return write;
+}
+
+// Checks to see if this string is the same as a C string
+bool JsonString::operator==( const char* str ) const
+{
+    return strlen( str ) == Length && memcmp( Data, str, Length ) == 0;
+}
+
+// Checks to see if this string is not the same as a C string
+bool JsonString::operator!=( const char* str ) const
+{
+    return !( *this == str );
+}
+
+// Copies this string out into a std::string
+std::string JsonString::ToString() const
+{
+    return std::string( Data, Length );
+}
+
+// Moves the cursor past any whitespace
+void JsonReader::SkipWhitespace( Cursor& cursor )
+{
+    char* position = cursor.Position;
+    while ( position != cursor.End && ( *position == ' ' || *position == '\n' || *position == '\r' || *position == '\t' ) )
+    {
+        ++position;
+    }
+    cursor.Position = position;
+}
+
+// Reads a literal
+bool JsonReader::ReadLiteral( Cursor& cursor, const char* literal )
+{
+    size_t length = strlen( literal );
+    if ( static_cast<size_t>( cursor.End - cursor.Position ) < length || strncmp( cursor.Position, literal, length ) != 0 )
+    {
+        return false;
+    }
+
+    cursor.Position += length;
+    return true;
+}
+
+// Reads a number
+bool JsonReader::ReadNumber( Cursor& cursor, double& value, bool& isInteger )
+{
+    char* start = cursor.Position;
+    char* position = start;
+    char* end = cursor.End;
+
+    bool isNegative = ( position != end && *position == '-' );
+    if ( isNegative )
+    {
+        ++position;
+    }
+    if ( position == end || !IsDigit( *position ) )
+    {
+        return false;
+    }
+
+    // Integers are added up as they are read, as they're by far the most common kind of number.
+    // Leading zeros aren't allowed, so a zero is always a number on its own.
+    unsigned long long mantissa = 0;
+    int digitCount = 0;
+    if ( *position == '0' )
+    {
+        ++position;
+    }
+    else
+    {
+        while ( position != end && IsDigit( *position ) )
+        {
+            mantissa = mantissa * 10 + ( *position - '0' );
+            ++digitCount;
+            ++position;
+        }
+    }
+
+    isInteger = true;
+    if ( position != end && *position == '.' )
+    {
+        isInteger = false;
+        ++position;
+        if ( position == end || !IsDigit( *position ) )
+        {
+            return false;
+        }
+        while ( position != end && IsDigit( *position ) )
+        {
+            ++position;
+        }
+    }
+    if ( position != end && ( *position == 'e' || *position == 'E' ) )
+    {
+        isInteger = false;
+        ++position;
+        if ( position != end && ( *position == '+' || *position == '-' ) )
+        {
+            ++position;
+        }
+        if ( position == end || !IsDigit( *position ) )
+        {
+            return false;
+        }
+        while ( position != end && IsDigit( *position ) )
+        {
+            ++position;
+        }
+    }
+
+    // Anything else has already been checked, so the standard conversion can't fail. It stops at the
+    // same place we did, as the text always ends with a null character.
+    if ( isInteger && digitCount <= JSON_MAX_EXACT_DIGITS )
+    {
+        value = isNegative ? -static_cast<double>( mantissa ) : static_cast<double>( mantissa );
+    }
+    else
+    {
+        value = strtod( start, nullptr );
+    }
+
+    cursor.Position = position;
+    return true;
+}
+
+// Reads a string, unescaping it in place
+bool JsonReader::ReadString( Cursor& cursor, JsonString& value )
+{
+    if ( cursor.Position == cursor.End || *cursor.Position != '"' )
+    {
+        return false;
+    }
+
+    // Escapes are always longer than what they stand for, so writing never overtakes reading
+    char* start = cursor.Position + 1;
+    char* read = start;
+    char* write = start;
+    char* end = cursor.End;
+    while ( read != end )
+    {
+        char c = *read++;
+        if ( c == '"' )
+        {
+            // The closing quote (or something before it) becomes the string's null character
+            *write = '\0';
+            value.Data = start;
+            value.Length = static_cast<size_t>( write - start );
+            cursor.Position = read;
+            return true;
+        }
+        if ( static_cast<unsigned char>( c ) < 0x20 )
+        {
+            // Control characters have to be escaped
+            return false;
+        }
+        if ( c != '\\' )
+        {
+            *write++ = c;
+            continue;
+        }
+
+        if ( read == end )
+        {
+            return false;
+        }
+
+        switch ( *read++ )
+        {
+            case '"':  *write++ = '"'; break;
+            case '\\': *write++ = '\\'; break;
+            case '/':  *write++ = '/'; break;
+            case 'b':  *write++ = '\b'; break;
+            case 'f':  *write++ = '\f'; break;
+            case 'n':  *write++ = '\n'; break;
+            case 'r':  *write++ = '\r'; break;
+            case 't':  *write++ = '\t'; break;
+            case 'u':
+            {
+                unsigned int code = 0;
+                if ( !ReadHex( read, end, code ) )
+                {
+                    return false;
+                }
+                read += 4;
+
+                // Characters outside of the basic plane are escaped as a surrogate pair
+                if ( code >= 0xD800 && code <= 0xDBFF )
+                {
+                    unsigned int low = 0;
+                    if ( end - read < 2 || read[ 0 ] != '\\' || read[ 1 ] != 'u' || !ReadHex( read + 2, end, low ) || low < 0xDC00 || low > 0xDFFF )
+                    {
+                        return false;
+                    }
+                    read += 6;
+                    code = 0x10000 + ( ( code - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+                }
+
+                write = WriteUtf8( write, code );
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    return false;
+}
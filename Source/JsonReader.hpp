@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Config.hpp"
+#include <string>
+
+/// <summary>
+/// Defines a view of a string in the text of a JSON document. Strings read by the JSON reader are
+/// always followed by a null character, so their data can also be used as a C string.
+/// </summary>
+struct JsonString
+{
+    const char* Data;
+    size_t      Length;
+
+    /// <summary>
+    /// Checks to see if this string is the same as a C string.
+    /// </summary>
+    /// <param name="str">The C string.</param>
+    bool operator==( const char* str ) const;
+
+    /// <summary>
+    /// Checks to see if this string is not the same as a C string.
+    /// </summary>
+    /// <param name="str">The C string.</param>
+    bool operator!=( const char* str ) const;
+
+    /// <summary>
+    /// Copies this string out into a std::string.
+    /// </summary>
+    std::string ToString() const;
+};
+
+/// <summary>
+/// Defines a static, single-pass JSON reader. Text is read in place, with escaped strings being
+/// unescaped over the text they were read from, and everything read is reported to a handler as it
+/// is found. Handlers need the following methods, each returning false to stop reading:
+///     bool Null();
+///     bool Bool( bool value );
+///     bool Number( double value, bool isInteger );
+///     bool String( const JsonString& value );
+///     bool Key( const JsonString& key );
+///     bool StartObject();
+///     bool EndObject( unsigned int memberCount );
+///     bool StartArray();
+///     bool EndArray( unsigned int elementCount );
+/// </summary>
+class JsonReader
+{
+    ImplementStaticClass( JsonReader );
+
+    /// <summary>
+    /// Defines the reader's place in the text.
+    /// </summary>
+    struct Cursor
+    {
+        char* Position;
+        char* End;
+    };
+
+    /// <summary>
+    /// Moves the cursor past any whitespace.
+    /// </summary>
+    /// <param name="cursor">The cursor.</param>
+    static void SkipWhitespace( Cursor& cursor );
+
+    /// <summary>
+    /// Reads a literal, such as "true".
+    /// </summary>
+    /// <param name="cursor">The cursor.</param>
+    /// <param name="literal">The literal.</param>
+    static bool ReadLiteral( Cursor& cursor, const char* literal );
+
+    /// <summary>
+    /// Reads a number.
+    /// </summary>
+    /// <param name="cursor">The cursor.</param>
+    /// <param name="value">Receives the number.</param>
+    /// <param name="isInteger">Receives whether the number was written without a fraction or exponent.</param>
+    static bool ReadNumber( Cursor& cursor, double& value, bool& isInteger );
+
+    /// <summary>
+    /// Reads a string, unescaping it in place.
+    /// </summary>
+    /// <param name="cursor">The cursor.</param>
+    /// <param name="value">Receives the string.</param>
+    static bool ReadString( Cursor& cursor, JsonString& value );
+
+    /// <summary>
+    /// Reads a value, and everything in it.
+    /// </summary>
+    /// <param name="cursor">The cursor.</param>
+    /// <param name="handler">The handler to report to.</param>
+    /// <param name="depth">The number of objects and arrays the value is in.</param>
+    template<class THandler> static bool ReadValue( Cursor& cursor, THandler& handler, unsigned int depth );
+
+public:
+    /// <summary>
+    /// The deepest objects and arrays can be nested.
+    /// </summary>
+    static const unsigned int MaxDepth;
+
+    /// <summary>
+    /// Reads a JSON document, reporting everything in it to a handler.
+    /// </summary>
+    /// <param name="text">The text, which must be followed by a null character. Strings are unescaped in place, so the text is changed.</param>
+    /// <param name="length">The length of the text, not counting the null character.</param>
+    /// <param name="handler">The handler to report to.</param>
+    /// <returns>True if the whole text was a valid document, false if it wasn't or the handler stopped reading.</returns>
+    template<class THandler> static bool Parse( char* text, size_t length, THandler& handler );
+};
+
+#include "JsonReader.inl"
@@ -0,0 +1,153 @@
+// Reads a value, and everything in it
+template<class THandler> bool JsonReader::ReadValue( Cursor& cursor, THandler& handler, unsigned int depth )
+{
+    SkipWhitespace( cursor );
+    if ( cursor.Position == cursor.End )
+    {
+        return false;
+    }
+
+    switch ( *cursor.Position )
+    {
+        case '{':
+        {
+            ++cursor.Position;
+            if ( depth >= MaxDepth || !handler.StartObject() )
+            {
+                return false;
+            }
+
+            unsigned int count = 0;
+            SkipWhitespace( cursor );
+            if ( cursor.Position != cursor.End && *cursor.Position == '}' )
+            {
+                ++cursor.Position;
+                return handler.EndObject( count );
+            }
+
+            for ( ;; )
+            {
+                JsonString key;
+                SkipWhitespace( cursor );
+                if ( !ReadString( cursor, key ) || !handler.Key( key ) )
+                {
+                    return false;
+                }
+
+                SkipWhitespace( cursor );
+                if ( cursor.Position == cursor.End || *cursor.Position != ':' )
+                {
+                    return false;
+                }
+                ++cursor.Position;
+
+                if ( !ReadValue( cursor, handler, depth + 1 ) )
+                {
+                    return false;
+                }
+                ++count;
+
+                SkipWhitespace( cursor );
+                if ( cursor.Position == cursor.End )
+                {
+                    return false;
+                }
+
+                char next = *cursor.Position++;
+                if ( next == '}' )
+                {
+                    return handler.EndObject( count );
+                }
+                if ( next != ',' )
+                {
+                    return false;
+                }
+            }
+        }
+
+        case '[':
+        {
+            ++cursor.Position;
+            if ( depth >= MaxDepth || !handler.StartArray() )
+            {
+                return false;
+            }
+
+            unsigned int count = 0;
+            SkipWhitespace( cursor );
+            if ( cursor.Position != cursor.End && *cursor.Position == ']' )
+            {
+                ++cursor.Position;
+                return handler.EndArray( count );
+            }
+
+            for ( ;; )
+            {
+                if ( !ReadValue( cursor, handler, depth + 1 ) )
+                {
+                    return false;
+                }
+                ++count;
+
+                SkipWhitespace( cursor );
+                if ( cursor.Position == cursor.End )
+                {
+                    return false;
+                }
+
+                char next = *cursor.Position++;
+                if ( next == ']' )
+                {
+                    return handler.EndArray( count );
+                }
+                if ( next != ',' )
+                {
+                    return false;
+                }
+            }
+        }
+
+        case '"':
+        {
+            JsonString value;
+            return ReadString( cursor, value ) && handler.String( value );
+        }
+
+        case 't':
+            return ReadLiteral( cursor, "true" ) && handler.Bool( true );
+
+        case 'f':
+            return ReadLiteral( cursor, "false" ) && handler.Bool( false );
+
+        case 'n':
+            return ReadLiteral( cursor, "null" ) && handler.Null();
+
+        default:
+        {
+            double value = 0.0;
+            bool isInteger = false;
+            return ReadNumber( cursor, value, isInteger ) && handler.Number( value, isInteger );
+        }
+    }
+}
+
+// Reads a JSON document
+template<class THandler> bool JsonReader::Parse( char* text, size_t length, THandler& handler )
+{
+    Cursor cursor = { text, text + length };
+
+    // Skip the UTF-8 byte order mark some editors save
+    if ( length >= 3 && text[ 0 ] == '\xEF' && text[ 1 ] == '\xBB' && text[ 2 ] == '\xBF' )
+    {
+        cursor.Position += 3;
+    }
+
+    if ( !ReadValue( cursor, handler, 0 ) )
+    {
+        return false;
+    }
+
+    // Nothing but whitespace may follow the document
+    SkipWhitespace( cursor );
+    return cursor.Position == cursor.End;
+}
@@ -0,0 +1,38 @@
+#include "LayeredMaterial.hpp"
+#include "GameObject.hpp"
+#include "Texture2DArray.hpp"
+
+// Create a new layered material
+LayeredMaterial::LayeredMaterial( GameObject* gameObject )
+    : Material( gameObject )
+    , _world( 1.0f )
+    , _layer( 0 )
+{
+    LoadProgram( "Shaders\\SimpleMaterial.vert", "Shaders\\LayeredMaterial.frag" );
+}
+
+// Destroy this layered material
+LayeredMaterial::~LayeredMaterial()
+{
+}
+
+// Send our values to the shader
+void LayeredMaterial::SendValuesToShader()
+{
+    SetTexture( "MyTextures", _textures );
+    SetFloat( "Layer", static_cast<float>( _layer ) );
+    SetMatrix( "World", _world );
+}
+
+// Set our texture array and layer
+void LayeredMaterial::SetTextures( std::shared_ptr<Texture2DArray> textures, unsigned int layer )
+{
+    _textures = textures;
+    _layer = layer;
+}
+
+// Sets our world matrix
+void LayeredMaterial::SetWorld( const glm::mat4& world )
+{
+    _world = world;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Material.hpp"
+
+/// <summary>
+/// Defines a material that draws one layer of a texture array. Every object drawn from the same
+/// array shares its texture binding, so only the layer changes between them.
+/// </summary>
+class LayeredMaterial : public Material
+{
+    ImplementComponent( LayeredMaterial, Material );
+    glm::mat4 _world;
+    std::shared_ptr<Texture2DArray> _textures;
+    unsigned int _layer;
+
+public:
+    /// <summary>
+    /// Creates a new layered material.
+    /// </summary>
+    /// <param name="gameObject">The game object this material will belong to.</param>
+    LayeredMaterial( GameObject* gameObject );
+
+    /// <summary>
+    /// Destroys this layered material.
+    /// </summary>
+    ~LayeredMaterial();
+
+    /// <summary>
+    /// Sends this material's values to the shader.
+    /// </summary>
+    void SendValuesToShader() override;
+
+    /// <summary>
+    /// Sets the texture array this layered material uses, and the layer of it to draw with.
+    /// </summary>
+    /// <param name="textures">The texture array to use.</param>
+    /// <param name="layer">The layer to draw with.</param>
+    void SetTextures( std::shared_ptr<Texture2DArray> textures, unsigned int layer );
+
+    /// <summary>
+    /// Sets the world matrix this layered material uses.
+    /// </summary>
+    /// <param name="world">The world matrix.</param>
+    void SetWorld( const glm::mat4& world );
+};
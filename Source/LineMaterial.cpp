@@ -1,16 +1,17 @@
 #include "LineMaterial.hpp"
 #include "GameObject.hpp"
 
-// Create a new simple material
+// Create a new line material
 LineMaterial::LineMaterial(GameObject* gameObject)
 : Material(gameObject)
-, _lineColor( 0,0,0,0)
+, _world(1.0f)
+, _lineColor(1, 1, 1, 1)
 {
 	LoadProgram("Shaders\\LineMaterial.vert", "Shaders\\LineMaterial.frag");
 
 }
 
-// Destroy this simple material
+// Destroy this line material
 LineMaterial::~LineMaterial()
 {
 }
@@ -30,5 +31,4 @@ void LineMaterial::SendValuesToShader()
 {
 	SetVec4("LineColor", _lineColor);
 	SetMatrix("World", _world);
-	SetMatrix("Projection", _projection);
 }
@@ -3,41 +3,43 @@
 #include "Material.hpp"
 
 /// <summary>
-/// Defines a simple material.
+/// Defines a material used to draw lines.
 /// </summary>
 class LineMaterial : public Material
 {
+	ImplementComponent(LineMaterial, Material);
 	glm::mat4 _world;
-	glm::mat4 _projection;
 	glm::vec4 _lineColor;
 
 public:
 	/// <summary>
-	/// Creates a new simple material.
+	/// Creates a new line material.
 	/// </summary>
 	/// <param name="gameObject">The game object this material will belong to.</param>
 	LineMaterial(GameObject* gameObject);
 
 	/// <summary>
-	/// Destroys this simple material.
+	/// Destroys this line material.
 	/// </summary>
 	~LineMaterial();
 
 	/// <summary>
-	/// Gets the color to render the line as.
+	/// Gets the color to tint the lines with.
 	/// </summary>
 	glm::vec4 GetLineColor() const;
 
 	/// <summary>
-	/// Sets the color to render the line as.
+	/// Sets the color to tint the lines with.
 	/// </summary>
 	/// <param name="color">The new color.</param>
 	void SetLineColor(const glm::vec4& color);
 
+	/// <summary>
+	/// Sets the world matrix this line material uses.
+	/// </summary>
+	/// <param name="world">The world matrix.</param>
 	void SetWorld(const glm::mat4& world) { _world = world; }
 
-	void SetProjection(const glm::mat4& proj) { _projection = proj; }
-
 	/// <summary>
 	/// Sends this material's information to the shaders.
 	/// </summary>
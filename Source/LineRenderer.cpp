@@ -3,15 +3,7 @@
 #include "GameObject.hpp"
 #include "Transform.hpp"
 #include "Vertex.hpp"
-#include "Colors.hpp"
-#include "Game.hpp"
-#include "RenderManager.hpp"
-#include <algorithm>
-#include <DirectXColors.h>
 #include <vector>
-#include <iostream>
-
-using namespace DirectX;
 
 
 // Create a new Line renderer
@@ -20,16 +12,47 @@ LineRenderer::LineRenderer(GameObject* gameObject)
 , _isMeshDirty(false)
 {
 	_isDrawable = true;
-
-	RenderManager::AddRenderer(this);
 }
 
-// Destroys this text renderer
+// Destroys this line renderer
 LineRenderer::~LineRenderer()
 {
-	RenderManager::RemoveRenderer(this);
 }
 
+// Adds a line segment
+void LineRenderer::AddLine(const glm::vec3& start, const glm::vec3& end, const glm::vec4& color)
+{
+	_vertices.push_back(LineVertex(start, color));
+	_vertices.push_back(LineVertex(end, color));
+	_isMeshDirty = true;
+}
+
+// Adds a connected strip of line segments
+void LineRenderer::AddLineStrip(const std::vector<glm::vec3>& points, const glm::vec4& color)
+{
+	for (size_t i = 1; i < points.size(); ++i)
+	{
+		_vertices.push_back(LineVertex(points[i - 1], color));
+		_vertices.push_back(LineVertex(points[i], color));
+	}
+	_isMeshDirty = true;
+}
+
+// Removes all of the lines
+void LineRenderer::ClearLines()
+{
+	if (!_vertices.empty())
+	{
+		_vertices.clear();
+		_isMeshDirty = true;
+	}
+}
+
+// Gets the number of line segments
+size_t LineRenderer::GetLineCount() const
+{
+	return _vertices.size() / 2;
+}
 
 // Get our mesh
 std::shared_ptr<Mesh> LineRenderer::GetMesh() const
@@ -37,14 +60,7 @@ std::shared_ptr<Mesh> LineRenderer::GetMesh() const
 	return _mesh;
 }
 
-/*
-// Check if we're valid
-bool LineRenderer::IsValid() const
-{
-return static_cast<bool>(_font);
-}*/
-
-// Rebuild our text mesh (expensive operation)
+// Rebuild our line mesh
 void LineRenderer::RebuildMesh()
 {
 	// If there's nothing to do, then... don't do anything
@@ -53,51 +69,75 @@ void LineRenderer::RebuildMesh()
 		return;
 	}
 
-	std::vector<TextVertex> vertices;
+	// Re-use the same vertex buffer every time the lines change
+	if (!_mesh)
+	{
+		std::vector<unsigned int> indices;
+		_mesh = std::make_shared<Mesh>(_vertices, indices);
+	}
+	else
+	{
+		_mesh->UpdateVertices(_vertices);
+	}
 
-	// Create the mesh
-	std::vector<unsigned int> indices;
-	_mesh = std::make_shared<Mesh>(vertices, indices);
+	_isMeshDirty = false;
 }
 
-glm::vec2 LineRenderer::GetStartPoint() const
+// Gets the starting point of the first line
+glm::vec3 LineRenderer::GetStartPoint() const
 {
-	return _points[0].Position;
+	return _vertices.empty() ? glm::vec3(0) : _vertices[0].Position;
 }
 
-glm::vec2 LineRenderer::GetEndPoint() const
+// Gets the ending point of the first line
+glm::vec3 LineRenderer::GetEndPoint() const
 {
-	return _points[0].Position;
+	return _vertices.empty() ? glm::vec3(0) : _vertices[1].Position;
 }
 
-
-void LineRenderer::SetStartPoint(glm::vec2& startPoint)
+// Sets the starting point of the first line
+void LineRenderer::SetStartPoint(const glm::vec3& startPoint)
 {
-	glm::vec2 _start = startPoint;
-};
+	if (_vertices.empty())
+	{
+		_vertices.resize(2);
+	}
+	_vertices[0].Position = startPoint;
+	_isMeshDirty = true;
+}
 
-void LineRenderer::SetEndPoint(glm::vec2& endPoint)
+// Sets the ending point of the first line
+void LineRenderer::SetEndPoint(const glm::vec3& endPoint)
 {
-	glm::vec2 _end = endPoint;
-};
+	if (_vertices.empty())
+	{
+		_vertices.resize(2);
+	}
+	_vertices[1].Position = endPoint;
+	_isMeshDirty = true;
+}
 
-// Updates this text renderer
+// Updates this line renderer
 void LineRenderer::Update()
 {
-	if (_isMeshDirty)
-	{
-		RebuildMesh();
-		_isMeshDirty = false;
-	}
+	RebuildMesh();
 }
 
-// Draws this text renderer
+// Draws this line renderer
 void LineRenderer::Draw()
 {
+	// Lines may have changed after we were updated this frame
+	RebuildMesh();
+
 	LineMaterial* lm = _gameObject->GetComponent<LineMaterial>();
+	if (!_mesh || !lm || _vertices.empty())
+	{
+		return;
+	}
+
+	lm->SetWorld(_gameObject->GetWorldMatrix());
 	_mesh->Draw(lm);
-	
+
 	glDepthFunc(GL_LESS);
 	glBlendFunc(GL_ONE, GL_ZERO);
-
 }
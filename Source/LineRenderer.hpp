@@ -4,17 +4,19 @@
 #include "Component.hpp"
 #include "Mesh.hpp"
 #include "LineMaterial.hpp"
+#include <vector>
 
 /// <summary>
-/// Defines a Line renderer.
+/// Defines a Line renderer. All of the lines added to a renderer are batched into a single draw call.
 /// </summary>
 class LineRenderer : public Component
 {
+	ImplementComponent(LineRenderer, Component);
 	friend class RenderManager;
 
 private:
 
-	LineVertex _points[ 2 ];
+	std::vector<LineVertex> _vertices;
 	std::shared_ptr<Mesh> _mesh;
 	bool _isMeshDirty;
 
@@ -36,35 +38,56 @@ public:
 	~LineRenderer();
 
 	/// <summary>
-	/// Gets the starting point.
+	/// Adds a line segment.
 	/// </summary>
-	glm::vec2 GetStartPoint() const;
+	/// <param name="start">The starting point.</param>
+	/// <param name="end">The ending point.</param>
+	/// <param name="color">The line's color.</param>
+	void AddLine(const glm::vec3& start, const glm::vec3& end, const glm::vec4& color);
 
 	/// <summary>
-	/// Gets the ending point.
+	/// Adds a connected strip of line segments.
 	/// </summary>
-	glm::vec2 GetEndPoint() const;
+	/// <param name="points">The points along the strip.</param>
+	/// <param name="color">The strip's color.</param>
+	void AddLineStrip(const std::vector<glm::vec3>& points, const glm::vec4& color);
 
 	/// <summary>
-	/// Gets the text mesh.
+	/// Removes all of the lines.
 	/// </summary>
-	std::shared_ptr<Mesh> GetMesh() const;
+	void ClearLines();
 
+	/// <summary>
+	/// Gets the number of line segments.
+	/// </summary>
+	size_t GetLineCount() const;
 
 	/// <summary>
-	/// Checks to see if this line renderer is valid.
+	/// Gets the starting point of the first line.
 	/// </summary>
-	//bool IsValid() const;
+	glm::vec3 GetStartPoint() const;
 
 	/// <summary>
-	/// Sets the line to be rendered.
+	/// Gets the ending point of the first line.
 	/// </summary>
-	/// <param name="value">The new text.</param>
-	void SetLine(const std::string& value);
+	glm::vec3 GetEndPoint() const;
 
-	void SetStartPoint(glm::vec2& startPoint);
+	/// <summary>
+	/// Gets the line mesh.
+	/// </summary>
+	std::shared_ptr<Mesh> GetMesh() const;
 
-	void SetEndPoint(glm::vec2& endPoint);
+	/// <summary>
+	/// Sets the starting point of the first line.
+	/// </summary>
+	/// <param name="startPoint">The new starting point.</param>
+	void SetStartPoint(const glm::vec3& startPoint);
+
+	/// <summary>
+	/// Sets the ending point of the first line.
+	/// </summary>
+	/// <param name="endPoint">The new ending point.</param>
+	void SetEndPoint(const glm::vec3& endPoint);
 
 	/// <summary>
 	/// Updates this line renderer.
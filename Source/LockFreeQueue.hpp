@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Config.hpp"
+#include <atomic>
+#include <vector>
+
+/// <summary>
+/// Defines a fixed-size queue that one thread pushes to and one other thread pops from, without
+/// either of them ever taking a lock.
+/// </summary>
+template<class T> class LockFreeQueue
+{
+    ImplementNonCopyableClass( LockFreeQueue );
+    ImplementNonMovableClass( LockFreeQueue );
+
+    std::vector<T> _items;
+    size_t _mask;
+    std::atomic<size_t> _head; // The next item to pop, only written by the consumer
+    char _padding[ 64 ];       // Keeps the producer and consumer from fighting over one cache line
+    std::atomic<size_t> _tail; // The next item to push, only written by the producer
+
+public:
+    /// <summary>
+    /// Creates a new queue.
+    /// </summary>
+    /// <param name="capacity">The most items the queue can hold, rounded up to a power of two.</param>
+    explicit LockFreeQueue( size_t capacity );
+
+    /// <summary>
+    /// Gets the most items this queue can hold.
+    /// </summary>
+    size_t GetCapacity() const;
+
+    /// <summary>
+    /// Attempts to pop the oldest item. Only call this from the consuming thread.
+    /// </summary>
+    /// <param name="item">Receives the item.</param>
+    /// <returns>True if an item was popped, false if the queue was empty.</returns>
+    bool TryPop( T& item );
+
+    /// <summary>
+    /// Attempts to push an item. Only call this from the producing thread.
+    /// </summary>
+    /// <param name="item">The item.</param>
+    /// <returns>True if the item was pushed, false if the queue was full.</returns>
+    bool TryPush( const T& item );
+};
+
+#include "LockFreeQueue.inl"
@@ -0,0 +1,54 @@
+// Create a new queue
+template<class T> LockFreeQueue<T>::LockFreeQueue( size_t capacity )
+    : _mask( 0 )
+    , _head( 0 )
+    , _tail( 0 )
+{
+    // Wrapping the indices with a mask needs a power of two
+    size_t size = 1;
+    while ( size < capacity )
+    {
+        size <<= 1;
+    }
+
+    _items.resize( size );
+    _mask = size - 1;
+}
+
+// Get the most items this queue can hold
+template<class T> size_t LockFreeQueue<T>::GetCapacity() const
+{
+    return _items.size();
+}
+
+// Attempt to pop the oldest item
+template<class T> bool LockFreeQueue<T>::TryPop( T& item )
+{
+    size_t head = _head.load( std::memory_order_relaxed );
+    if ( head == _tail.load( std::memory_order_acquire ) )
+    {
+        return false;
+    }
+
+    item = _items[ head & _mask ];
+
+    // Only hand the slot back once we're done reading it
+    _head.store( head + 1, std::memory_order_release );
+    return true;
+}
+
+// Attempt to push an item
+template<class T> bool LockFreeQueue<T>::TryPush( const T& item )
+{
+    size_t tail = _tail.load( std::memory_order_relaxed );
+    if ( tail - _head.load( std::memory_order_acquire ) == _items.size() )
+    {
+        return false;
+    }
+
+    _items[ tail & _mask ] = item;
+
+    // Only show the item to the consumer once it has been written
+    _tail.store( tail + 1, std::memory_order_release );
+    return true;
+}
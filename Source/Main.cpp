@@ -1,17 +1,30 @@
 #include <iostream>
 #include "Game.hpp"
 #include "Colors.hpp"
+#include "VirtualFileSystem.hpp"
+#include <cstring>
 #if defined(DEBUG) || defined(_DEBUG)
 #   define _CRTDBG_MAP_ALLOC
 #   include <crtdbg.h>
 #endif
 
+#define CONTENT_ARCHIVE "Content.pak" // Packed content, which is read in place of the loose files it holds
+
 int main( int argc, char** argv )
 {
 #if defined( DEBUG ) || defined( _DEBUG )
     _CrtSetDbgFlag( _CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF );
 #endif
 
+    // "--pack <directory> <archive>" packs content instead of running the game
+    if ( argc == 4 && strcmp( argv[ 1 ], "--pack" ) == 0 )
+    {
+        return VirtualFileSystem::Pack( argv[ 2 ], argv[ 3 ] ) ? 0 : 1;
+    }
+
+    // Without an archive, everything is loaded from loose files. The archive stays mapped until we exit.
+    VirtualFileSystem::Mount( CONTENT_ARCHIVE );
+
     Game* game = Game::GetInstance();
 
     // Set the clear color to be cornflower blue
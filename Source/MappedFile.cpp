@@ -0,0 +1,168 @@
+#include "MappedFile.hpp"
+#include "VirtualFileSystem.hpp"
+#if defined( _WIN32 )
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <Windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#define MAPPED_FILE_PAGE_SIZE 4096 // The smallest page size of anything we run on
+
+// Create a new mapped file
+MappedFile::MappedFile()
+#if defined( _WIN32 )
+    : _file( INVALID_HANDLE_VALUE )
+    , _mapping( nullptr )
+#else
+    : _file( -1 )
+#endif
+    , _data( nullptr )
+    , _size( 0 )
+    , _isPacked( false )
+{
+}
+
+// Destroy this mapped file
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+// Close this file
+void MappedFile::Close()
+{
+    if ( _isPacked )
+    {
+        _data = nullptr;
+        _size = 0;
+        _isPacked = false;
+        return;
+    }
+
+#if defined( _WIN32 )
+    if ( _data )
+    {
+        UnmapViewOfFile( _data );
+    }
+    if ( _mapping )
+    {
+        CloseHandle( _mapping );
+    }
+    if ( _file != INVALID_HANDLE_VALUE )
+    {
+        CloseHandle( _file );
+    }
+    _file = INVALID_HANDLE_VALUE;
+    _mapping = nullptr;
+#else
+    if ( _data )
+    {
+        munmap( const_cast<char*>( _data ), _size );
+    }
+    if ( _file >= 0 )
+    {
+        close( _file );
+    }
+    _file = -1;
+#endif
+
+    _data = nullptr;
+    _size = 0;
+}
+
+// Get the file's contents
+const char* MappedFile::GetData() const
+{
+    return _data;
+}
+
+// Get the size of the file
+size_t MappedFile::GetSize() const
+{
+    return _size;
+}
+
+// Check to see if a file is open
+bool MappedFile::IsOpen() const
+{
+    return _data != nullptr;
+}
+
+// Map a file into memory
+bool MappedFile::Open( const std::string& fname )
+{
+    Close();
+
+    // Packed files are already mapped along with the rest of the archive
+    if ( VirtualFileSystem::ReadPacked( fname, _data, _size ) )
+    {
+        _isPacked = _size > 0;
+        if ( !_isPacked )
+        {
+            _data = nullptr;
+        }
+        return _isPacked;
+    }
+
+#if defined( _WIN32 )
+    _file = CreateFileA( fname.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+    LARGE_INTEGER size;
+    if ( _file == INVALID_HANDLE_VALUE || !GetFileSizeEx( _file, &size ) || size.QuadPart <= 0 )
+    {
+        Close();
+        return false;
+    }
+
+    _mapping = CreateFileMappingA( _file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    _data = _mapping ? static_cast<const char*>( MapViewOfFile( _mapping, FILE_MAP_READ, 0, 0, 0 ) ) : nullptr;
+    _size = static_cast<size_t>( size.QuadPart );
+#else
+    _file = open( fname.c_str(), O_RDONLY );
+    struct stat info;
+    if ( _file < 0 || fstat( _file, &info ) != 0 || info.st_size <= 0 )
+    {
+        Close();
+        return false;
+    }
+
+    void* data = mmap( nullptr, static_cast<size_t>( info.st_size ), PROT_READ, MAP_PRIVATE, _file, 0 );
+    _data = ( data != MAP_FAILED ) ? static_cast<const char*>( data ) : nullptr;
+    _size = static_cast<size_t>( info.st_size );
+#endif
+
+    if ( !_data )
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+// Read part of the file so that it is paged in
+void MappedFile::Prefetch( size_t offset, size_t size ) const
+{
+    if ( offset >= _size )
+    {
+        return;
+    }
+    if ( size > _size - offset )
+    {
+        size = _size - offset;
+    }
+
+    // Touching a single byte of every page is enough to bring the whole page in
+    volatile char sink = 0;
+    for ( size_t position = offset; position < offset + size; position += MAPPED_FILE_PAGE_SIZE )
+    {
+        sink += _data[ position ];
+    }
+    if ( size > 0 )
+    {
+        sink += _data[ offset + size - 1 ];
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Config.hpp"
+#include <string>
+
+/// <summary>
+/// Defines a read-only view of a file mapped into memory. The operating system pages the file in as
+/// it is read, so opening a file costs next to nothing however large it is. Files packed into the
+/// mounted archive are viewed in place instead.
+/// </summary>
+class MappedFile
+{
+    ImplementNonCopyableClass( MappedFile );
+    ImplementNonMovableClass( MappedFile );
+
+#if defined( _WIN32 )
+    void* _file;    // The file's HANDLE
+    void* _mapping; // The mapping's HANDLE
+#else
+    int _file;
+#endif
+    const char* _data;
+    size_t _size;
+    bool _isPacked; // True if the data belongs to the mounted archive, which unmaps it itself
+
+public:
+    /// <summary>
+    /// Creates a new, closed mapped file.
+    /// </summary>
+    MappedFile();
+
+    /// <summary>
+    /// Destroys this mapped file, closing it.
+    /// </summary>
+    ~MappedFile();
+
+    /// <summary>
+    /// Closes this file, unmapping it.
+    /// </summary>
+    void Close();
+
+    /// <summary>
+    /// Gets the file's contents, or null if it isn't open.
+    /// </summary>
+    const char* GetData() const;
+
+    /// <summary>
+    /// Gets the size of the file.
+    /// </summary>
+    size_t GetSize() const;
+
+    /// <summary>
+    /// Checks to see if a file is open.
+    /// </summary>
+    bool IsOpen() const;
+
+    /// <summary>
+    /// Maps a file into memory, closing any file that was already open. Empty files can't be mapped.
+    /// </summary>
+    /// <param name="fname">The file name.</param>
+    /// <returns>True if the file was mapped, false if not.</returns>
+    bool Open( const std::string& fname );
+
+    /// <summary>
+    /// Reads part of the file so that it is paged in, so that whoever reads it next doesn't have to wait on the disk.
+    /// </summary>
+    /// <param name="offset">The offset of the part to read.</param>
+    /// <param name="size">The size of the part to read.</param>
+    void Prefetch( size_t offset, size_t size ) const;
+};
@@ -2,13 +2,16 @@
 #include "Camera.h"
 #include "GameObject.hpp"
 #include "Shader.h"
+#include <algorithm>
 #include <assert.h>
 #include "Texture2D.hpp"
+#include "Texture2DArray.hpp"
 
 // Create a new material
 Material::Material( GameObject* gameObject )
     : Component( gameObject )
-    , _program( 0 )
+    , _program( GpuResourceType::Program )
+    , _camera( nullptr )
 {
     _usesLateUpdate = false;    // We don't update
     _isDrawable = false;        // We're not drawable
@@ -17,11 +20,7 @@ Material::Material( GameObject* gameObject )
 // Destroy this material
 Material::~Material()
 {
-    if ( _program )
-    {
-        glDeleteProgram( _program );
-        _program = 0;
-    }
+    _program.Release();
 }
 
 // Activates this material
@@ -33,10 +32,17 @@ void Material::Activate() const
 // Apply a camera to this material
 void Material::ApplyCamera( const Camera* camera )
 {
+    _camera = camera;
     SetMatrix( "View", camera->GetView() );
     SetMatrix( "Projection", camera->GetProjection() );
 }
 
+// Gets the camera last applied to this material
+const Camera* Material::GetCamera() const
+{
+    return _camera;
+}
+
 // Gets a uniform's location
 GLint Material::GetUniformLocation( const std::string& name ) const
 {
@@ -75,14 +81,43 @@ GLint Material::GetAttributeLocation( const std::string& name ) const
     return location;
 }
 
+// Gets the smallest vertex layout with every attribute our shader reads
+VertexLayout Material::GetVertexLayout() const
+{
+    // Attributes the shader declares but never uses are compiled out, so they don't count
+    if ( GetAttributeLocation( "vertNormal" ) >= 0 || GetAttributeLocation( "vertTangent" ) >= 0 )
+    {
+        return VertexLayout::Full;
+    }
+    if ( GetAttributeLocation( "vertPackedNormal" ) >= 0 || GetAttributeLocation( "vertPackedTangent" ) >= 0 )
+    {
+        return VertexLayout::Packed;
+    }
+    return VertexLayout::Compact;
+}
+
+// Sets the range the UVs of the mesh being drawn span
+void Material::SetUVRange( const glm::vec2& offset, const glm::vec2& scale )
+{
+    SetVec4( "UVRange", glm::vec4( offset, scale ) );
+}
+
 // Load the shader program
 void Material::LoadProgram( const std::string& vertShaderFName, const std::string& fragShaderFName )
 {
     _uniforms.clear();
-    _program = Shader::loadShaderProgram( vertShaderFName.c_str(), fragShaderFName.c_str() );
+    _program.Adopt( Shader::loadShaderProgram( vertShaderFName.c_str(), fragShaderFName.c_str() ) );
 
     if ( _program )
     {
+        // The driver only says how big a program is if it can hand the program back as a binary
+        GLint size = 0;
+        if ( GLEW_ARB_get_program_binary )
+        {
+            glGetProgramiv( _program, GL_PROGRAM_BINARY_LENGTH, &size );
+        }
+        _program.SetSize( static_cast<size_t>( std::max( size, 0 ) ) );
+
         glm::mat4 identity = glm::mat4( 1.0f );
         SetMatrix( "View", identity );
         SetMatrix( "Projection", identity );
@@ -104,6 +139,21 @@ void Material::SetMatrix( const std::string& name, const glm::mat4& value )
     }
 }
 
+// Set a float
+void Material::SetFloat( const std::string& name, float value )
+{
+    GLint location = GetUniformLocation( name );
+    if ( glProgramUniform1f )
+    {
+        glProgramUniform1f( _program, location, value );
+    }
+    else
+    {
+        glUseProgram( _program );
+        glUniform1f( location, value );
+    }
+}
+
 // Set a vec2
 void Material::SetVec2( const std::string& name, const glm::vec2& value )
 {
@@ -175,6 +225,32 @@ void Material::SetTexture( const std::string& name, const std::shared_ptr<Textur
     }
 }
 
+// Set a Texture2DArray
+void Material::SetTexture( const std::string& name, const std::shared_ptr<Texture2DArray> value )
+{
+    // Get the texture array handle
+    GLuint handle = 0;
+    if ( value )
+    {
+        handle = value->GetHandle();
+    }
+
+    // Set the texture array
+    glActiveTexture( GL_TEXTURE0 );
+    glBindTexture( GL_TEXTURE_2D_ARRAY, handle );
+
+    GLint location = GetUniformLocation( name );
+    if ( glProgramUniform1i )
+    {
+        glProgramUniform1i( _program, location, 0 );
+    }
+    else
+    {
+        glUseProgram( _program );
+        glUniform1i( location, 0 );
+    }
+}
+
 // Update this material
 void Material::Update()
 {
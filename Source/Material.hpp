@@ -2,17 +2,21 @@
 
 #include "Shader.h"
 #include "Component.hpp"
+#include "GpuResourceManager.hpp"
+#include "Vertex.hpp"
 #include <memory> // for std::shared_ptr
 #include <unordered_map>
 
 class Camera;
 class Texture2D;
+class Texture2DArray;
 
 /// <summary>
 /// Defines a material.
 /// </summary>
 class Material : public Component
 {
+    ImplementComponent( Material, Component );
     // Disallow the copy constructor and assignment operator
     Material( const Material& ) = delete;
     Material& operator=( const Material& ) = delete;
@@ -24,7 +28,8 @@ class Material : public Component
 protected:
     mutable std::unordered_map<std::string, GLint> _attributes;
     mutable std::unordered_map<std::string, GLint> _uniforms;
-    GLuint _program;
+    GpuResource _program;
+    const Camera* _camera; // The camera last applied to this material
 
     /// <summary>
     /// Gets a uniform's location.
@@ -39,6 +44,13 @@ protected:
     /// <param name="fragShaderFName">The fragment shader name.</param>
     void LoadProgram( const std::string& vertShaderFName, const std::string& fragShaderFName );
 
+    /// <summary>
+    /// Sets a float in this material.
+    /// </summary>
+    /// <param name="name">The float name.</param>
+    /// <param name="value">The float value.</param>
+    void SetFloat( const std::string& name, float value );
+
     /// <summary>
     /// Sets a vector in this material.
     /// </summary>
@@ -74,6 +86,13 @@ protected:
     /// <param name="value">The texture value.</param>
     void SetTexture( const std::string& name, const std::shared_ptr<Texture2D> value );
 
+    /// <summary>
+    /// Sets a texture array in this material.
+    /// </summary>
+    /// <param name="name">The texture array name.</param>
+    /// <param name="value">The texture array value.</param>
+    void SetTexture( const std::string& name, const std::shared_ptr<Texture2DArray> value );
+
 public:
     /// <summary>
     /// Creates a new, empty material component.
@@ -97,6 +116,11 @@ public:
     /// <param name="camera">The camera to apply.</param>
     void ApplyCamera( const Camera* camera );
 
+    /// <summary>
+    /// Gets the camera last applied to this material, or null if none has been.
+    /// </summary>
+    const Camera* GetCamera() const;
+
     /// <summary>
     /// Gets this material's program ID.
     /// </summary>
@@ -108,6 +132,19 @@ public:
     /// <param name="name">The uniform name.</param>
     GLint Material::GetAttributeLocation( const std::string& name ) const;
 
+    /// <summary>
+    /// Gets the smallest vertex layout that has every attribute this material's shader reads, so
+    /// meshes drawn with it don't carry anything it would ignore.
+    /// </summary>
+    VertexLayout GetVertexLayout() const;
+
+    /// <summary>
+    /// Sets the range the UVs of the mesh being drawn span, for shaders that read quantized UVs.
+    /// </summary>
+    /// <param name="offset">The start of the range.</param>
+    /// <param name="scale">The size of the range.</param>
+    void SetUVRange( const glm::vec2& offset, const glm::vec2& scale );
+
 	/// <summary>
 	/// Sends this material's values to the shader.
 	/// </summary>
@@ -13,3 +13,57 @@ inline glm::vec3 TransformVector( const glm::mat4& matrix, const glm::vec3& vect
 {
     return glm::vec3( matrix * glm::vec4( vector, 1.0f ) );
 }
+
+/// <summary>
+/// Finds where a segment enters an axis-aligned box.
+/// </summary>
+/// <param name="start">The start of the segment.</param>
+/// <param name="delta">The vector from the start of the segment to its end.</param>
+/// <param name="min">The box's minimum point.</param>
+/// <param name="max">The box's maximum point.</param>
+/// <param name="entry">Receives how far along the segment, from 0 to 1, it enters the box. Zero if it starts inside.</param>
+/// <param name="axis">Receives the axis of the face the segment enters through, or -1 if it starts inside.</param>
+/// <returns>True if the segment touches the box, false if not.</returns>
+inline bool IntersectSegmentBox( const glm::vec3& start, const glm::vec3& delta, const glm::vec3& min, const glm::vec3& max, float& entry, int& axis )
+{
+    float timeMin = 0.0f;
+    float timeMax = 1.0f;
+    axis = -1;
+
+    for ( int i = 0; i < 3; ++i )
+    {
+        // A segment parallel to the slab has to start inside it
+        if ( delta[ i ] == 0.0f )
+        {
+            if ( start[ i ] < min[ i ] || start[ i ] > max[ i ] )
+            {
+                return false;
+            }
+            continue;
+        }
+
+        float inverse = 1.0f / delta[ i ];
+        float timeNear = ( min[ i ] - start[ i ] ) * inverse;
+        float timeFar = ( max[ i ] - start[ i ] ) * inverse;
+        if ( timeNear > timeFar )
+        {
+            float swap = timeNear;
+            timeNear = timeFar;
+            timeFar = swap;
+        }
+
+        if ( timeNear > timeMin )
+        {
+            timeMin = timeNear;
+            axis = i;
+        }
+        timeMax = glm::min( timeMax, timeFar );
+        if ( timeMin > timeMax )
+        {
+            return false;
+        }
+    }
+
+    entry = timeMin;
+    return true;
+}
@@ -2,9 +2,20 @@
 
 #include <functional>
 #include <vector>
+#include "GpuResourceManager.hpp"
 #include "Material.hpp"
 #include "Vertex.hpp"
 
+/// <summary>
+/// Defines a mesh's level of detail, a range of its indices that draws a simplified version of it.
+/// </summary>
+struct MeshLod
+{
+    unsigned int FirstIndex;
+    unsigned int IndexCount;
+    float        Error;      // Roughly how far the level strays from the full mesh, in the mesh's units
+};
+
 /// <summary>
 /// Defines a mesh.
 /// </summary>
@@ -17,11 +28,20 @@ class Mesh
         unsigned int VertexCount;
         unsigned int VertexStride;
         unsigned int IndexCount;
+        unsigned int IndexType;    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+        unsigned int IndexOffset;  // The offset of the first index to draw, in bytes
+        glm::vec2    UVOffset;     // The start of the range quantized UVs span
+        glm::vec2    UVScale;      // The size of the range quantized UVs span
 
         MeshData();
     };
 
     MeshData _data;
+    GpuResource _vertexBuffer; // Owns the buffer in _data.VBO
+    GpuResource _indexBuffer;  // Owns the buffer in _data.IBO
+    glm::vec3 _boundsMin;
+    glm::vec3 _boundsMax;
+    std::vector<MeshLod> _lods;
     std::function<void( const MeshData&, Material* const )> _drawCallback;
     
     // Prevent use of the move constructor and assignment operator
@@ -49,15 +69,89 @@ public:
     template<typename TVertex> Mesh( const std::vector<TVertex>& vertices, const std::vector<unsigned>& indices );
 
     /// <summary>
-    /// Destroys this mesh.
+    /// Destroys this mesh, releasing its buffers.
     /// </summary>
     ~Mesh();
 
+    /// <summary>
+    /// Sizes this mesh's buffers for the given number of vertices and indices without filling them, so
+    /// that they can be filled a piece at a time with UploadVertices and UploadIndices.
+    /// </summary>
+    /// <param name="vertexCount">The number of vertices.</param>
+    /// <param name="indexCount">The number of indices.</param>
+    /// <param name="indexType">The type of the indices, either GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.</param>
+    template<typename TVertex> void ReserveBuffers( size_t vertexCount, size_t indexCount, unsigned int indexType );
+
+    /// <summary>
+    /// Fills part of this mesh's vertex buffer.
+    /// </summary>
+    /// <param name="first">The index of the first vertex to fill.</param>
+    /// <param name="count">The number of vertices to fill.</param>
+    /// <param name="vertices">The vertices, in the type the buffers were reserved for.</param>
+    void UploadVertices( size_t first, size_t count, const void* vertices );
+
+    /// <summary>
+    /// Fills part of this mesh's index buffer.
+    /// </summary>
+    /// <param name="first">The first index to fill.</param>
+    /// <param name="count">The number of indices to fill.</param>
+    /// <param name="indices">The indices, in the type the buffers were reserved for.</param>
+    void UploadIndices( size_t first, size_t count, const void* indices );
+
+    /// <summary>
+    /// Replaces this mesh's vertices, re-using its vertex buffer. Meant for meshes that change often.
+    /// </summary>
+    /// <param name="vertices">The new vertices.</param>
+    template<typename TVertex> void UpdateVertices( const std::vector<TVertex>& vertices );
+
+    /// <summary>
+    /// Gets the corner of this mesh's bounding box with the smallest coordinates.
+    /// </summary>
+    const glm::vec3& GetBoundsMin() const;
+
+    /// <summary>
+    /// Gets the corner of this mesh's bounding box with the largest coordinates.
+    /// </summary>
+    const glm::vec3& GetBoundsMax() const;
+
+    /// <summary>
+    /// Sets this mesh's bounding box.
+    /// </summary>
+    /// <param name="min">The corner with the smallest coordinates.</param>
+    /// <param name="max">The corner with the largest coordinates.</param>
+    void SetBounds( const glm::vec3& min, const glm::vec3& max );
+
+    /// <summary>
+    /// Sets the range this mesh's quantized UVs span, which is handed to materials so they can expand
+    /// the UVs back out. Meshes with float UVs keep an offset of 0 and a scale of 1.
+    /// </summary>
+    /// <param name="offset">The start of the range.</param>
+    /// <param name="scale">The size of the range.</param>
+    void SetUVRange( const glm::vec2& offset, const glm::vec2& scale );
+
+    /// <summary>
+    /// Gets the number of levels of detail this mesh has. Meshes without any count as having one.
+    /// </summary>
+    size_t GetLodCount() const;
+
+    /// <summary>
+    /// Gets the coarsest level of detail that strays from the full mesh by less than a pixel.
+    /// </summary>
+    /// <param name="projectedRadius">The radius of the mesh's bounds on screen, in pixels.</param>
+    size_t GetLodForRadius( float projectedRadius ) const;
+
+    /// <summary>
+    /// Sets this mesh's levels of detail, from the full mesh down. Each is a range of the mesh's indices.
+    /// </summary>
+    /// <param name="lods">The levels of detail.</param>
+    void SetLods( const std::vector<MeshLod>& lods );
+
     /// <summary>
     /// Draws this mesh.
     /// </summary>
     /// <param name="material">The material to use to draw.</param>
-    void Draw( Material* const material );
+    /// <param name="lod">The level of detail to draw.</param>
+    void Draw( Material* const material, size_t lod = 0 );
 };
 
 #include "Mesh.inl"
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <cstddef>
+
 #define glOffset(Type, Count) reinterpret_cast<void*>( sizeof( Type ) * Count )
+#define glOffsetOf(Type, Member) reinterpret_cast<void*>( offsetof( Type, Member ) )
+#define glIndexOffset(Data) reinterpret_cast<void*>( static_cast<size_t>( ( Data ).IndexOffset ) )
 
 // Creates a new mesh
 template<typename TVertex> Mesh::Mesh( const std::vector<TVertex>& vertices, const std::vector<unsigned>& indices )
+    : _vertexBuffer( GpuResourceType::Buffer )
+    , _indexBuffer( GpuResourceType::Buffer )
+    , _boundsMin( 0 )
+    , _boundsMax( 0 )
 {
     CreateBuffers<TVertex>( vertices, indices );
     CreateDrawCallback<TVertex>();
@@ -17,9 +25,10 @@ template<typename TVertex> void Mesh::CreateBuffers( const std::vector<TVertex>&
     // Copy the buffer data over
     if ( vertices.size() )
     {
-        glGenBuffers( 1, &_data.VBO );
+        _data.VBO = _vertexBuffer.Create();
         glBindBuffer( GL_ARRAY_BUFFER, _data.VBO );
         glBufferData( GL_ARRAY_BUFFER, vertices.size() * sizeof( TVertex ), &vertices[ 0 ], GL_STATIC_DRAW );
+        _vertexBuffer.SetSize( vertices.size() * sizeof( TVertex ) );
         _data.VertexCount = vertices.size();
         _data.VertexStride = sizeof( TVertex );
         glBindBuffer( GL_ARRAY_BUFFER, 0 );
@@ -28,14 +37,62 @@ template<typename TVertex> void Mesh::CreateBuffers( const std::vector<TVertex>&
     // Copy the index data over
     if ( indices.size() )
     {
-        glGenBuffers( 1, &_data.IBO );
+        _data.IBO = _indexBuffer.Create();
         glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _data.IBO );
         glBufferData( GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof( UINT ), &indices[ 0 ], GL_STATIC_DRAW );
+        _indexBuffer.SetSize( indices.size() * sizeof( UINT ) );
         _data.IndexCount = indices.size();
         glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
     }
 }
 
+// Sizes this mesh's buffers without filling them
+template<typename TVertex> void Mesh::ReserveBuffers( size_t vertexCount, size_t indexCount, unsigned int indexType )
+{
+    size_t indexSize = ( indexType == GL_UNSIGNED_SHORT ) ? sizeof( unsigned short ) : sizeof( unsigned int );
+
+    if ( vertexCount )
+    {
+        _data.VBO = _vertexBuffer.Create();
+        glBindBuffer( GL_ARRAY_BUFFER, _data.VBO );
+        glBufferData( GL_ARRAY_BUFFER, vertexCount * sizeof( TVertex ), nullptr, GL_STATIC_DRAW );
+        glBindBuffer( GL_ARRAY_BUFFER, 0 );
+        _vertexBuffer.SetSize( vertexCount * sizeof( TVertex ) );
+    }
+    if ( indexCount )
+    {
+        _data.IBO = _indexBuffer.Create();
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _data.IBO );
+        glBufferData( GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, nullptr, GL_STATIC_DRAW );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+        _indexBuffer.SetSize( indexCount * indexSize );
+    }
+
+    _data.VertexCount = vertexCount;
+    _data.VertexStride = sizeof( TVertex );
+    _data.IndexCount = indexCount;
+    _data.IndexType = indexType;
+}
+
+// Replaces this mesh's vertices
+template<typename TVertex> void Mesh::UpdateVertices( const std::vector<TVertex>& vertices )
+{
+    _data.VBO = _vertexBuffer.Create();
+
+    // Orphan the old storage so we don't stall on a buffer that's still being drawn
+    glBindBuffer( GL_ARRAY_BUFFER, _data.VBO );
+    glBufferData( GL_ARRAY_BUFFER, vertices.size() * sizeof( TVertex ), nullptr, GL_DYNAMIC_DRAW );
+    if ( vertices.size() )
+    {
+        glBufferSubData( GL_ARRAY_BUFFER, 0, vertices.size() * sizeof( TVertex ), &vertices[ 0 ] );
+    }
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    _vertexBuffer.SetSize( vertices.size() * sizeof( TVertex ) );
+
+    _data.VertexCount = vertices.size();
+    _data.VertexStride = sizeof( TVertex );
+}
+
 // Failure to create a draw callback
 template<typename TVertex> inline void Mesh::CreateDrawCallback()
 {
@@ -78,7 +135,7 @@ template<> inline void Mesh::CreateDrawCallback<Vertex>()
 
 
         // Draw the buffer!
-        glDrawElements( GL_TRIANGLES, data.IndexCount, GL_UNSIGNED_INT, nullptr );
+        glDrawElements( GL_TRIANGLES, data.IndexCount, data.IndexType, glIndexOffset( data ) );
 
 
         // Disable the attributes
@@ -89,20 +146,106 @@ template<> inline void Mesh::CreateDrawCallback<Vertex>()
     };
 }
 
-// Specialized draw callback for text vertices
+// Specialized draw callback for packed mesh vertices
+template<> inline void Mesh::CreateDrawCallback<PackedVertex>()
+{
+    _drawCallback = []( const MeshData& data, Material* const material )
+    {
+        // Get the attribute locations
+        GLint attrVertex = material->GetAttributeLocation( "vertPosition" );
+        GLint attrNormal = material->GetAttributeLocation( "vertPackedNormal" );
+        GLint attrTangent = material->GetAttributeLocation( "vertPackedTangent" );
+        GLint attrUV = material->GetAttributeLocation( "vertUV" );
+
+
+        // Enable the attributes (the packed ones are normalized, so shaders see them between -1 or 0 and 1)
+        if ( attrVertex >= 0 )
+        {
+            glEnableVertexAttribArray( attrVertex );
+            glVertexAttribPointer( attrVertex, 3, GL_FLOAT, GL_FALSE, data.VertexStride, glOffsetOf( PackedVertex, Position ) );
+        }
+        if ( attrNormal >= 0 )
+        {
+            glEnableVertexAttribArray( attrNormal );
+            glVertexAttribPointer( attrNormal, 2, GL_SHORT, GL_TRUE, data.VertexStride, glOffsetOf( PackedVertex, Normal ) );
+        }
+        if ( attrTangent >= 0 )
+        {
+            glEnableVertexAttribArray( attrTangent );
+            glVertexAttribPointer( attrTangent, 2, GL_SHORT, GL_TRUE, data.VertexStride, glOffsetOf( PackedVertex, Tangent ) );
+        }
+        if ( attrUV >= 0 )
+        {
+            glEnableVertexAttribArray( attrUV );
+            glVertexAttribPointer( attrUV, 2, GL_UNSIGNED_SHORT, GL_TRUE, data.VertexStride, glOffsetOf( PackedVertex, UV ) );
+        }
+
+
+        // Draw the buffer!
+        glDrawElements( GL_TRIANGLES, data.IndexCount, data.IndexType, glIndexOffset( data ) );
+
+
+        // Disable the attributes
+        if ( attrVertex >= 0 ) glDisableVertexAttribArray( attrVertex );
+        if ( attrNormal >= 0 ) glDisableVertexAttribArray( attrNormal );
+        if ( attrTangent >= 0 ) glDisableVertexAttribArray( attrTangent );
+        if ( attrUV >= 0 ) glDisableVertexAttribArray( attrUV );
+    };
+}
+
+// Specialized draw callback for compact mesh vertices
+template<> inline void Mesh::CreateDrawCallback<CompactVertex>()
+{
+    _drawCallback = []( const MeshData& data, Material* const material )
+    {
+        // Get the attribute locations
+        GLint attrVertex = material->GetAttributeLocation( "vertPosition" );
+        GLint attrUV = material->GetAttributeLocation( "vertUV" );
+
+
+        // Enable the attributes
+        if ( attrVertex >= 0 )
+        {
+            glEnableVertexAttribArray( attrVertex );
+            glVertexAttribPointer( attrVertex, 3, GL_FLOAT, GL_FALSE, data.VertexStride, glOffsetOf( CompactVertex, Position ) );
+        }
+        if ( attrUV >= 0 )
+        {
+            glEnableVertexAttribArray( attrUV );
+            glVertexAttribPointer( attrUV, 2, GL_UNSIGNED_SHORT, GL_TRUE, data.VertexStride, glOffsetOf( CompactVertex, UV ) );
+        }
+
+
+        // Draw the buffer!
+        glDrawElements( GL_TRIANGLES, data.IndexCount, data.IndexType, glIndexOffset( data ) );
+
+
+        // Disable the attributes
+        if ( attrVertex >= 0 ) glDisableVertexAttribArray( attrVertex );
+        if ( attrUV >= 0 ) glDisableVertexAttribArray( attrUV );
+    };
+}
+
+// Specialized draw callback for line vertices
 template<> inline void Mesh::CreateDrawCallback<LineVertex>()
 {
     _drawCallback = []( const MeshData& data, Material* const material )
     {
         // Get the attribute locations
         GLint attrVertex = material->GetAttributeLocation( "vertPosition" );
+        GLint attrColor = material->GetAttributeLocation( "vertColor" );
 
 
         // Enable the attributes
         if ( attrVertex >= 0 )
         {
             glEnableVertexAttribArray( attrVertex );
-            glVertexAttribPointer( attrVertex, 3, GL_FLOAT, GL_FALSE, data.VertexStride, glOffset( glm::vec2, 0 ) );
+            glVertexAttribPointer( attrVertex, 3, GL_FLOAT, GL_FALSE, data.VertexStride, glOffset( glm::vec3, 0 ) );
+        }
+        if ( attrColor >= 0 )
+        {
+            glEnableVertexAttribArray( attrColor );
+            glVertexAttribPointer( attrColor, 4, GL_FLOAT, GL_FALSE, data.VertexStride, glOffset( glm::vec3, 1 ) );
         }
 
 
@@ -112,6 +255,7 @@ template<> inline void Mesh::CreateDrawCallback<LineVertex>()
 
         // Disable the attributes
         if ( attrVertex >= 0 ) glDisableVertexAttribArray( attrVertex );
+        if ( attrColor >= 0 ) glDisableVertexAttribArray( attrColor );
     };
 }
 
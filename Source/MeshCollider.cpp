@@ -0,0 +1,86 @@
+#include "MeshCollider.hpp"
+#include "GameObject.hpp"
+
+// Creates a new mesh collider
+MeshCollider::MeshCollider( GameObject* gameObject )
+    : Collider( gameObject, ColliderType::Mesh )
+{
+}
+
+// Destroys this mesh collider
+MeshCollider::~MeshCollider()
+{
+}
+
+// Gets this collider's bounding volume hierarchy
+std::shared_ptr<TriangleBvh> MeshCollider::GetBvh() const
+{
+    return _bvh;
+}
+
+// Gets the maximum point of this collider
+glm::vec3 MeshCollider::GetMaxPoint() const
+{
+    glm::vec3 origin = GetOrigin();
+    return _bvh ? origin + _bvh->GetMaxPoint() : origin;
+}
+
+// Gets the minimum point of this collider
+glm::vec3 MeshCollider::GetMinPoint() const
+{
+    glm::vec3 origin = GetOrigin();
+    return _bvh ? origin + _bvh->GetMinPoint() : origin;
+}
+
+// Gets this collider's origin in global coordinates
+glm::vec3 MeshCollider::GetOrigin() const
+{
+    if ( _gameObject )
+    {
+        return TransformVector( _gameObject->GetWorldMatrix(), glm::vec3( 0 ) );
+    }
+    return glm::vec3( 0 );
+}
+
+// Finds the closest point where a sphere touches this collider
+bool MeshCollider::FindSphereContact( const glm::vec3& center, float radius, BvhContact& contact ) const
+{
+    if ( !_bvh )
+    {
+        return false;
+    }
+
+    glm::vec3 origin = GetOrigin();
+    if ( !_bvh->FindSphereContact( center - origin, radius, glm::vec3( 0 ), contact ) )
+    {
+        return false;
+    }
+
+    contact.Point += origin;
+    return true;
+}
+
+// Sets the model this collider's triangles come from
+bool MeshCollider::SetMesh( const std::string& fname )
+{
+    _bvh = TriangleBvh::FromFile( fname );
+    return _bvh != nullptr;
+}
+
+// Sweeps a sphere through this collider
+bool MeshCollider::SweepSphere( const glm::vec3& start, const glm::vec3& end, float radius, BvhSweepHit& hit ) const
+{
+    if ( !_bvh )
+    {
+        return false;
+    }
+
+    glm::vec3 origin = GetOrigin();
+    if ( !_bvh->SweepSphere( start - origin, end - origin, radius, glm::vec3( 0 ), hit ) )
+    {
+        return false;
+    }
+
+    hit.Point += origin;
+    return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Collider.hpp"
+#include "Math.hpp"
+#include "TriangleBvh.hpp"
+#include <memory>
+#include <string>
+
+/// <summary>
+/// Defines a static triangle mesh collider. Mesh colliders follow their game object's position,
+/// but are not rotated or scaled with it.
+/// </summary>
+class MeshCollider : public Collider
+{
+    ImplementComponent( MeshCollider, Collider );
+    std::shared_ptr<TriangleBvh> _bvh;
+
+public:
+    /// <summary>
+    /// Creates a new mesh collider.
+    /// </summary>
+    /// <param name="gameObject">The game object this component will belong to.</param>
+    MeshCollider( GameObject* gameObject );
+
+    /// <summary>
+    /// Destroys this mesh collider.
+    /// </summary>
+    ~MeshCollider();
+
+    /// <summary>
+    /// Gets the bounding volume hierarchy over this collider's triangles.
+    /// </summary>
+    std::shared_ptr<TriangleBvh> GetBvh() const;
+
+    /// <summary>
+    /// Gets the maximum point of this collider.
+    /// </summary>
+    virtual glm::vec3 GetMaxPoint() const;
+
+    /// <summary>
+    /// Gets the minimum point of this collider.
+    /// </summary>
+    virtual glm::vec3 GetMinPoint() const;
+
+    /// <summary>
+    /// Gets this collider's origin in global coordinates.
+    /// </summary>
+    glm::vec3 GetOrigin() const;
+
+    /// <summary>
+    /// Finds the closest point where a sphere touches this collider.
+    /// </summary>
+    /// <param name="center">The sphere's center in global coordinates.</param>
+    /// <param name="radius">The sphere's radius.</param>
+    /// <param name="contact">Receives the contact in global coordinates.</param>
+    bool FindSphereContact( const glm::vec3& center, float radius, BvhContact& contact ) const;
+
+    /// <summary>
+    /// Sets the model this collider's triangles come from.
+    /// </summary>
+    /// <param name="fname">The model's file name.</param>
+    /// <returns>True if the model's triangles were loaded, false if not.</returns>
+    bool SetMesh( const std::string& fname );
+
+    /// <summary>
+    /// Sweeps a sphere through this collider, finding the first point it hits.
+    /// </summary>
+    /// <param name="start">The sphere's starting center in global coordinates.</param>
+    /// <param name="end">The sphere's ending center in global coordinates.</param>
+    /// <param name="radius">The sphere's radius.</param>
+    /// <param name="hit">Receives the hit in global coordinates.</param>
+    bool SweepSphere( const glm::vec3& start, const glm::vec3& end, float radius, BvhSweepHit& hit ) const;
+};
@@ -1,13 +1,156 @@
 #include "MeshLoader.hpp"
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
+#include "MeshOptimizer.hpp"
+#include "VirtualFileSystem.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
-std::unordered_map<std::string, std::shared_ptr<Mesh>> MeshLoader::_meshCache;
+//#define MESH_COOKED_ONLY // Leaves Assimp out, so only cooked meshes can be loaded
+
+#if !defined( MESH_COOKED_ONLY )
+#   include <assimp/Importer.hpp>
+#   include <assimp/scene.h>
+#   include <assimp/postprocess.h>
+#endif
+
+#define MESH_COOKED_MAGIC   0x3148534D // "MSH1"
+#define MESH_COOKED_VERSION 3
+#define MESH_ACMR_CACHE_SIZE 16 // The post-transform cache size cooked meshes are measured against
+
+std::unordered_map<std::string, AssetHandle<Mesh>> MeshLoader::_meshCache;
+std::mutex MeshLoader::_cacheMutex;
+std::mutex MeshLoader::_cookMutex;
 
 typedef unsigned int UINT;
 
+// Gets the size of a vertex packed in a layout
+static unsigned int GetVertexStride( VertexLayout layout )
+{
+    switch ( layout )
+    {
+        case VertexLayout::Packed:  return sizeof( PackedVertex );
+        case VertexLayout::Compact: return sizeof( CompactVertex );
+        default:                    return sizeof( Vertex );
+    }
+}
+
+// Gets the name of the mesh file a model is cooked into for a layout
+static std::string GetCookedName( const std::string& fname, VertexLayout layout )
+{
+    switch ( layout )
+    {
+        case VertexLayout::Packed:  return fname + ".packed.mesh";
+        case VertexLayout::Compact: return fname + ".compact.mesh";
+        default:                    return fname + ".mesh";
+    }
+}
+
+// Creates a mesh with empty buffers for the given vertex type
+template<typename TVertex> static std::shared_ptr<Mesh> CreateEmptyMesh( size_t vertexCount, size_t indexCount, unsigned int indexType )
+{
+    std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>( std::vector<TVertex>(), std::vector<UINT>() );
+    mesh->ReserveBuffers<TVertex>( vertexCount, indexCount, indexType );
+    return mesh;
+}
+
+/// <summary>
+/// Defines a request to load a mesh. The vertices are handed to the GPU first, then the indices.
+/// </summary>
+class MeshRequest : public TypedAssetRequest<Mesh>
+{
+    std::string _fname;
+    VertexLayout _layout;
+    MeshLoader::Geometry _geometry;
+    size_t _uploadedVertices;
+    size_t _uploadedIndices;
+
+    // Read the mesh's geometry
+    bool Decode() override
+    {
+        return MeshLoader::ReadGeometry( _fname, _layout, _geometry );
+    }
+
+    // Hand the next piece of the mesh to the GPU
+    bool UploadPiece( size_t maxBytes ) override
+    {
+        size_t vertexCount = _geometry.VertexCount;
+        size_t indexCount = _geometry.IndexCount;
+        size_t vertexStride = _geometry.VertexStride;
+        size_t indexSize = _geometry.IndexSize;
+
+        if ( !_asset )
+        {
+            unsigned int indexType = ( indexSize == sizeof( unsigned short ) ) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+            switch ( _geometry.Layout )
+            {
+                case VertexLayout::Packed:  _asset = CreateEmptyMesh<PackedVertex>( vertexCount, indexCount, indexType );  break;
+                case VertexLayout::Compact: _asset = CreateEmptyMesh<CompactVertex>( vertexCount, indexCount, indexType ); break;
+                default:                    _asset = CreateEmptyMesh<Vertex>( vertexCount, indexCount, indexType );        break;
+            }
+            _asset->SetBounds( _geometry.BoundsMin, _geometry.BoundsMax );
+            _asset->SetUVRange( _geometry.UVOffset, _geometry.UVScale );
+            _asset->SetLods( _geometry.Lods );
+        }
+
+        // Cooked geometry goes to the GPU straight from the mapped file
+        if ( _uploadedVertices < vertexCount )
+        {
+            size_t count = std::min( vertexCount - _uploadedVertices, std::max<size_t>( maxBytes / vertexStride, 1 ) );
+            _asset->UploadVertices( _uploadedVertices, count, _geometry.Vertices + _uploadedVertices * vertexStride );
+            _uploadedVertices += count;
+        }
+        else if ( _uploadedIndices < indexCount )
+        {
+            size_t count = std::min( indexCount - _uploadedIndices, std::max<size_t>( maxBytes / indexSize, 1 ) );
+            _asset->UploadIndices( _uploadedIndices, count, _geometry.Indices + _uploadedIndices * indexSize );
+            _uploadedIndices += count;
+        }
+
+        if ( _uploadedVertices < vertexCount || _uploadedIndices < indexCount )
+        {
+            return false;
+        }
+
+        // The GPU has its own copy now
+        _geometry.File.Close();
+        std::vector<char>().swap( _geometry.ImportedVertices );
+        std::vector<char>().swap( _geometry.ImportedIndices );
+        _geometry.Vertices = nullptr;
+        _geometry.Indices = nullptr;
+        return true;
+    }
+
+public:
+    // Create a new mesh request
+    MeshRequest( const std::string& fname, VertexLayout layout )
+        : _fname( fname )
+        , _layout( layout )
+        , _uploadedVertices( 0 )
+        , _uploadedIndices( 0 )
+    {
+    }
+};
+
+// Create new, empty geometry
+MeshLoader::Geometry::Geometry()
+    : Vertices( nullptr )
+    , Indices( nullptr )
+    , Layout( VertexLayout::Full )
+    , VertexStride( 0 )
+    , IndexSize( 0 )
+    , VertexCount( 0 )
+    , IndexCount( 0 )
+    , BoundsMin( 0 )
+    , BoundsMax( 0 )
+    , UVOffset( 0 )
+    , UVScale( 1 )
+{
+}
+
+#if !defined( MESH_COOKED_ONLY )
+
 // Processes an Assimp node
 void MeshLoader::ProcessNode( std::vector<Vertex>& vertices, std::vector<UINT>& indices, const aiScene* scene, aiNode* node )
 {
@@ -28,6 +171,9 @@ void MeshLoader::ProcessNode( std::vector<Vertex>& vertices, std::vector<UINT>&
 // Processes an Assimp mesh
 void MeshLoader::ProcessMesh( std::vector<Vertex>& vertices, std::vector<UINT>& indices, const aiScene* scene, aiMesh* mesh )
 {
+    // The mesh's indices are relative to its own vertices, so offset them past any earlier meshes
+    UINT baseVertex = static_cast<UINT>( vertices.size() );
+
     // Get the vertices
     Vertex v;
     for ( UINT i = 0; i < mesh->mNumVertices; ++i )
@@ -59,48 +205,348 @@ void MeshLoader::ProcessMesh( std::vector<Vertex>& vertices, std::vector<UINT>&
     {
         // We triangulate the models, so we're guaranteed 3 indices
         aiFace face = mesh->mFaces[ i ];
-        indices.push_back( face.mIndices[ 0 ] );
-        indices.push_back( face.mIndices[ 1 ] );
-        indices.push_back( face.mIndices[ 2 ] );
+        indices.push_back( baseVertex + face.mIndices[ 0 ] );
+        indices.push_back( baseVertex + face.mIndices[ 1 ] );
+        indices.push_back( baseVertex + face.mIndices[ 2 ] );
     }
 }
 
-// Loads a mesh from a file
-std::shared_ptr<Mesh> MeshLoader::Load( const std::string& fname )
+// Reads a mesh file's vertices and indices
+bool MeshLoader::ReadFile( const std::string& fname, std::vector<Vertex>& vertices, std::vector<UINT>& indices )
 {
-    // If we've already loaded the mesh, then we don't need to do it again
-    auto search = _meshCache.find( fname );
-    if ( search != _meshCache.end() )
-    {
-        return search->second;
-    }
-
-    std::cout << "Loading " << fname << "... ";
-
     // Load the mesh's information
     Assimp::Importer importer;
     UINT importFlags = aiProcess_CalcTangentSpace
                      | aiProcess_GenSmoothNormals
                      | aiProcess_JoinIdenticalVertices
                      | aiProcess_Triangulate;
-    const aiScene* scene = importer.ReadFile( fname, importFlags );
+    MappedFile file;
+    if ( !file.Open( fname ) )
+    {
+        return false;
+    }
+
+    // Assimp picks its importer by extension, since it can't see the file's name from memory
+    std::string extension = fname.substr( fname.find_last_of( '.' ) + 1 );
+    const aiScene* scene = importer.ReadFileFromMemory( file.GetData(), file.GetSize(), importFlags, extension.c_str() );
 
     // If we failed to load the mesh, then we have nothing to return
-    std::shared_ptr<Mesh> mesh;
     if ( !scene || scene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode )
     {
-        std::cout << "Failed ;_;" << std::endl;
-        return mesh;
+        return false;
+    }
+
+    // Make room for every mesh up front, rather than growing a vertex at a time
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    for ( UINT i = 0; i < scene->mNumMeshes; ++i )
+    {
+        vertexCount += scene->mMeshes[ i ]->mNumVertices;
+        indexCount += scene->mMeshes[ i ]->mNumFaces * 3;
     }
+    vertices.reserve( vertexCount );
+    indices.reserve( indexCount );
 
     // Now process the root node
+    ProcessNode( vertices, indices, scene, scene->mRootNode );
+    return true;
+}
+
+#else
+
+// Reads a mesh file's vertices and indices
+bool MeshLoader::ReadFile( const std::string&, std::vector<Vertex>&, std::vector<UINT>& )
+{
+    // Without Assimp, models have to have been cooked already
+    return false;
+}
+
+#endif
+
+// Imports a model and cooks it into geometry
+bool MeshLoader::CookGeometry( const std::string& fname, VertexLayout layout, Geometry& geometry )
+{
     std::vector<Vertex> vertices;
     std::vector<UINT> indices;
-    ProcessNode( vertices, indices, scene, scene->mRootNode );
+    if ( !ReadFile( fname, vertices, indices ) )
+    {
+        return false;
+    }
 
-    // Now create the mesh
-    mesh = std::make_shared<Mesh>( vertices, indices );
-    _meshCache[ fname ] = mesh;
-    std::cout << "Done." << std::endl;
-    return mesh;
+    // Order the triangles for the vertex cache first, as the vertices are then put in the order they use them
+    float oldMissRatio = MeshOptimizer::GetCacheMissRatio( indices, vertices.size(), MESH_ACMR_CACHE_SIZE );
+    MeshOptimizer::OptimizeVertexCache( indices, vertices.size() );
+    MeshOptimizer::OptimizeVertexFetch( vertices, indices );
+    float newMissRatio = MeshOptimizer::GetCacheMissRatio( indices, vertices.size(), MESH_ACMR_CACHE_SIZE );
+    std::cout << "Cooking " << fname << " (ACMR " << oldMissRatio << " -> " << newMissRatio << ")" << std::endl;
+
+    // Each level of detail has about half the triangles of the last, and its indices follow the last's.
+    // They're all simplified from the full mesh, so their errors are measured against what they stand in for.
+    std::vector<UINT> lodIndices = indices;
+    MeshLod full = { 0, static_cast<UINT>( indices.size() ), 0.0f };
+    geometry.Lods.assign( 1, full );
+    for ( UINT i = 1; i < MaxLodCount; ++i )
+    {
+        std::vector<UINT> simplified;
+        float error = MeshOptimizer::Simplify( vertices, indices, ( indices.size() / 3 >> i ) * 3, simplified );
+
+        // Stop once the mesh won't simplify much further, as another level wouldn't save anything
+        if ( simplified.empty() || simplified.size() > geometry.Lods.back().IndexCount * 3 / 4 )
+        {
+            break;
+        }
+
+        MeshOptimizer::OptimizeVertexCache( simplified, vertices.size() );
+        MeshLod lod = { static_cast<UINT>( lodIndices.size() ), static_cast<UINT>( simplified.size() ), error };
+        geometry.Lods.push_back( lod );
+        lodIndices.insert( lodIndices.end(), simplified.begin(), simplified.end() );
+    }
+
+    geometry.BoundsMin = geometry.BoundsMax = glm::vec3( 0 );
+    if ( !vertices.empty() )
+    {
+        geometry.BoundsMin = geometry.BoundsMax = vertices[ 0 ].Position;
+        for ( size_t i = 1; i < vertices.size(); ++i )
+        {
+            geometry.BoundsMin = glm::min( geometry.BoundsMin, vertices[ i ].Position );
+            geometry.BoundsMax = glm::max( geometry.BoundsMax, vertices[ i ].Position );
+        }
+    }
+
+    geometry.Layout = layout;
+    geometry.VertexStride = static_cast<UINT>( MeshOptimizer::PackVertices( vertices, layout, geometry.ImportedVertices, geometry.UVOffset, geometry.UVScale ) );
+    geometry.IndexSize = static_cast<UINT>( MeshOptimizer::PackIndices( lodIndices, vertices.size(), geometry.ImportedIndices ) );
+    geometry.Vertices = geometry.ImportedVertices.data();
+    geometry.Indices = geometry.ImportedIndices.data();
+    geometry.VertexCount = static_cast<UINT>( vertices.size() );
+    geometry.IndexCount = static_cast<UINT>( lodIndices.size() );
+    return true;
+}
+
+// Reads a model's geometry
+bool MeshLoader::ReadGeometry( const std::string& fname, VertexLayout layout, Geometry& geometry )
+{
+    unsigned long long sourceSize = 0;
+    long long sourceTime = 0;
+    bool hasSource = VirtualFileSystem::GetFileInfo( fname, sourceSize, sourceTime );
+
+    // The cooked mesh is only used if it was cooked from this exact model
+    std::string cookedName = GetCookedName( fname, layout );
+    if ( LoadCooked( cookedName, layout, hasSource, sourceSize, sourceTime, geometry ) )
+    {
+        return true;
+    }
+    if ( !hasSource )
+    {
+        return false;
+    }
+
+    // Only one thread cooks at a time, and a model another thread has just cooked doesn't need cooking again
+    std::lock_guard<std::mutex> lock( _cookMutex );
+    if ( LoadCooked( cookedName, layout, hasSource, sourceSize, sourceTime, geometry ) )
+    {
+        return true;
+    }
+
+    if ( !CookGeometry( fname, layout, geometry ) )
+    {
+        return false;
+    }
+
+    SaveCooked( cookedName, sourceSize, sourceTime, geometry );
+    return true;
+}
+
+// Attempts to map a cooked mesh file
+bool MeshLoader::LoadCooked( const std::string& fname, VertexLayout layout, bool hasSource, unsigned long long sourceSize, long long sourceTime, Geometry& geometry )
+{
+    MappedFile& file = geometry.File;
+    if ( !file.Open( fname ) || file.GetSize() < sizeof( CookedHeader ) )
+    {
+        file.Close();
+        return false;
+    }
+
+    // Make sure the mesh is ours, is current, and isn't obviously broken
+    const CookedHeader* header = reinterpret_cast<const CookedHeader*>( file.GetData() );
+    unsigned long long vertexStride = GetVertexStride( layout );
+    bool isValid = header->Magic == MESH_COOKED_MAGIC
+                && header->Version == MESH_COOKED_VERSION
+                && ( !hasSource || ( header->SourceSize == sourceSize && header->SourceTime == sourceTime ) )
+                && header->Layout == static_cast<UINT>( layout )
+                && ( header->IndexSize == sizeof( unsigned short ) || header->IndexSize == sizeof( UINT ) )
+                && header->LodCount >= 1 && header->LodCount <= MaxLodCount
+                && static_cast<unsigned long long>( file.GetSize() ) == sizeof( CookedHeader )
+                                                                     + vertexStride * header->VertexCount
+                                                                     + static_cast<unsigned long long>( header->IndexSize ) * header->IndexCount;
+
+    const char* vertices = reinterpret_cast<const char*>( header + 1 );
+    const char* indices = vertices + ( isValid ? vertexStride * header->VertexCount : 0 );
+
+    // Every index has to point at a vertex. Checking them also pages them in, so do the vertices too
+    // while we're on a worker, leaving nothing for the upload to wait on.
+    if ( isValid && header->IndexSize == sizeof( unsigned short ) )
+    {
+        const unsigned short* shortIndices = reinterpret_cast<const unsigned short*>( indices );
+        for ( UINT i = 0; isValid && i < header->IndexCount; ++i )
+        {
+            isValid = shortIndices[ i ] < header->VertexCount;
+        }
+    }
+    else if ( isValid )
+    {
+        const UINT* intIndices = reinterpret_cast<const UINT*>( indices );
+        for ( UINT i = 0; isValid && i < header->IndexCount; ++i )
+        {
+            isValid = intIndices[ i ] < header->VertexCount;
+        }
+    }
+
+    // So does every level of detail's range
+    for ( UINT i = 0; isValid && i < header->LodCount; ++i )
+    {
+        isValid = header->Lods[ i ].FirstIndex <= header->IndexCount
+               && header->Lods[ i ].IndexCount <= header->IndexCount - header->Lods[ i ].FirstIndex;
+    }
+
+    if ( !isValid )
+    {
+        file.Close();
+        return false;
+    }
+    file.Prefetch( sizeof( CookedHeader ), static_cast<size_t>( vertexStride * header->VertexCount ) );
+
+    geometry.Vertices = vertices;
+    geometry.Indices = indices;
+    geometry.Layout = layout;
+    geometry.VertexStride = static_cast<UINT>( vertexStride );
+    geometry.IndexSize = header->IndexSize;
+    geometry.VertexCount = header->VertexCount;
+    geometry.IndexCount = header->IndexCount;
+    geometry.Lods.assign( header->Lods, header->Lods + header->LodCount );
+    geometry.BoundsMin = header->BoundsMin;
+    geometry.BoundsMax = header->BoundsMax;
+    geometry.UVOffset = header->UVOffset;
+    geometry.UVScale = header->UVScale;
+    return true;
+}
+
+// Attempts to save geometry as a cooked mesh file
+bool MeshLoader::SaveCooked( const std::string& fname, unsigned long long sourceSize, long long sourceTime, const Geometry& geometry )
+{
+    CookedHeader header = {};
+    header.Magic = MESH_COOKED_MAGIC;
+    header.Version = MESH_COOKED_VERSION;
+    header.SourceSize = sourceSize;
+    header.SourceTime = sourceTime;
+    header.VertexCount = geometry.VertexCount;
+    header.IndexCount = geometry.IndexCount;
+    header.LodCount = static_cast<UINT>( std::min( geometry.Lods.size(), static_cast<size_t>( MaxLodCount ) ) );
+    std::copy( geometry.Lods.begin(), geometry.Lods.begin() + header.LodCount, header.Lods );
+    header.Layout = static_cast<UINT>( geometry.Layout );
+    header.IndexSize = geometry.IndexSize;
+    header.BoundsMin = geometry.BoundsMin;
+    header.BoundsMax = geometry.BoundsMax;
+    header.UVOffset = geometry.UVOffset;
+    header.UVScale = geometry.UVScale;
+
+    // Write to a temporary file first, so nobody ever maps a half-written mesh
+    std::string tempName = fname + ".tmp";
+    {
+        std::ofstream file( tempName, std::ios::binary | std::ios::trunc );
+        if ( !file.is_open() )
+        {
+            return false;
+        }
+
+        file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+        file.write( geometry.Vertices, static_cast<std::streamsize>( geometry.VertexStride ) * geometry.VertexCount );
+        file.write( geometry.Indices, static_cast<std::streamsize>( geometry.IndexSize ) * geometry.IndexCount );
+        if ( !file )
+        {
+            file.close();
+            std::remove( tempName.c_str() );
+            return false;
+        }
+    }
+
+    // Renaming won't replace a file on every platform, so get rid of the stale mesh first
+    std::remove( fname.c_str() );
+    if ( std::rename( tempName.c_str(), fname.c_str() ) != 0 )
+    {
+        std::remove( tempName.c_str() );
+        return false;
+    }
+    return true;
+}
+
+// Loads a mesh from a file
+std::shared_ptr<Mesh> MeshLoader::Load( const std::string& fname, VertexLayout layout )
+{
+    AssetHandle<Mesh> handle = LoadAsync( fname, layout );
+    AssetLoader::Wait( handle );
+    return handle.Get();
+}
+
+// Starts loading a mesh from a file
+AssetHandle<Mesh> MeshLoader::LoadAsync( const std::string& fname, VertexLayout layout )
+{
+    std::lock_guard<std::mutex> lock( _cacheMutex );
+
+    // If we've already started loading the mesh in this layout, then we don't need to do it again
+    std::string key = GetCookedName( fname, layout );
+    auto search = _meshCache.find( key );
+    if ( search != _meshCache.end() )
+    {
+        GpuResourceManager::Touch( "Mesh:", key );
+        return search->second;
+    }
+
+    std::cout << "Loading " << fname << "..." << std::endl;
+
+    std::shared_ptr<MeshRequest> request = std::make_shared<MeshRequest>( fname, layout );
+    AssetHandle<Mesh> handle( request );
+    _meshCache[ key ] = handle;
+    GpuResourceManager::AddCachedAsset( "Mesh:", key, _meshCache, _cacheMutex );
+
+    handle.OnFinished( [ fname ]( const std::shared_ptr<Mesh>& mesh )
+    {
+        if ( !mesh )
+        {
+            std::cout << "Failed to load " << fname << " ;_;" << std::endl;
+        }
+    } );
+    AssetLoader::Load( request );
+    return handle;
+}
+
+// Loads a mesh's geometry from a file
+bool MeshLoader::LoadGeometry( const std::string& fname, std::vector<glm::vec3>& positions, std::vector<UINT>& indices )
+{
+    Geometry geometry;
+    positions.clear();
+    indices.clear();
+    // Only the positions are needed for collision, which every layout keeps as they are, so read the
+    // smallest one. It's the one simple materials draw with too, so the model is usually cooked already.
+    if ( !ReadGeometry( fname, VertexLayout::Compact, geometry ) )
+    {
+        return false;
+    }
+
+    positions.resize( geometry.VertexCount );
+    for ( UINT i = 0; i < geometry.VertexCount; ++i )
+    {
+        memcpy( &positions[ i ], geometry.Vertices + i * geometry.VertexStride, sizeof( glm::vec3 ) );
+    }
+
+    // Collision is always against the full mesh, which is the first level of detail
+    const MeshLod& full = geometry.Lods[ 0 ];
+    indices.resize( full.IndexCount );
+    for ( UINT i = 0; i < full.IndexCount; ++i )
+    {
+        indices[ i ] = ( geometry.IndexSize == sizeof( unsigned short ) )
+            ? reinterpret_cast<const unsigned short*>( geometry.Indices )[ full.FirstIndex + i ]
+            : reinterpret_cast<const UINT*>( geometry.Indices )[ full.FirstIndex + i ];
+    }
+    return true;
 }
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "AssetLoader.hpp"
+#include "MappedFile.hpp"
 #include "Mesh.hpp"
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
@@ -10,11 +13,67 @@ struct aiMesh;
 struct aiScene;
 
 /// <summary>
-/// Defines a static mesh loader.
+/// Defines a static mesh loader. The first time a model is loaded it is imported and cooked into a
+/// mesh file that is saved next to it, and later loads map that file straight into memory instead of
+/// importing the model again. A model that is missing uses its mesh file as it is, so the models
+/// themselves don't have to be shipped. Cooking reorders the triangles for the GPU's vertex cache,
+/// simplifies the mesh into a chain of levels of detail that share its vertices, and packs the
+/// vertices into the layout asked for, so each layout is cooked into a mesh file of its own.
 /// </summary>
 class MeshLoader
 {
-    static std::unordered_map<std::string, std::shared_ptr<Mesh>> _meshCache;
+    friend class MeshRequest;
+
+    static const unsigned int MaxLodCount = 5;
+
+    /// <summary>
+    /// Defines the start of a cooked mesh file. The vertices follow it, then the indices of every level of detail.
+    /// </summary>
+    struct CookedHeader
+    {
+        unsigned int       Magic;
+        unsigned int       Version;
+        unsigned long long SourceSize;  // The size of the model the mesh was cooked from
+        long long          SourceTime;  // The modification time of the model the mesh was cooked from
+        unsigned int       VertexCount;
+        unsigned int       IndexCount;  // The number of indices in every level of detail together
+        unsigned int       LodCount;
+        MeshLod            Lods[ MaxLodCount ];
+        unsigned int       Layout;      // The VertexLayout the vertices are packed in
+        unsigned int       IndexSize;   // The size of each index, either 2 or 4
+        glm::vec3          BoundsMin;
+        glm::vec3          BoundsMax;
+        glm::vec2          UVOffset;    // The start of the range the quantized UVs span
+        glm::vec2          UVScale;     // The size of the range the quantized UVs span
+    };
+
+    /// <summary>
+    /// Defines a mesh's geometry, either mapped straight from a cooked mesh file or imported into memory.
+    /// </summary>
+    struct Geometry
+    {
+        MappedFile           File;
+        std::vector<char>    ImportedVertices;
+        std::vector<char>    ImportedIndices;
+        const char*          Vertices;     // Packed in the geometry's layout
+        const char*          Indices;      // Each IndexSize bytes
+        VertexLayout         Layout;
+        unsigned int         VertexStride;
+        unsigned int         IndexSize;
+        unsigned int         VertexCount;
+        unsigned int         IndexCount;
+        std::vector<MeshLod> Lods;
+        glm::vec3            BoundsMin;
+        glm::vec3            BoundsMax;
+        glm::vec2            UVOffset;
+        glm::vec2            UVScale;
+
+        Geometry();
+    };
+
+    static std::unordered_map<std::string, AssetHandle<Mesh>> _meshCache;
+    static std::mutex _cacheMutex;
+    static std::mutex _cookMutex;
 
     /// <summary>
     /// Processes a mesh's node into the given vertices and indices.
@@ -26,6 +85,47 @@ class MeshLoader
     /// </summary>
     static void ProcessMesh( std::vector<Vertex>& vertices, std::vector<unsigned>& indices, const aiScene* scene, aiMesh* mesh );
 
+    /// <summary>
+    /// Reads a mesh file into the given vertices and indices.
+    /// </summary>
+    static bool ReadFile( const std::string& fname, std::vector<Vertex>& vertices, std::vector<unsigned>& indices );
+
+    /// <summary>
+    /// Imports a model and cooks it into geometry, optimized and packed into a layout.
+    /// </summary>
+    /// <param name="fname">The model's file name.</param>
+    /// <param name="layout">The layout to pack the vertices in.</param>
+    /// <param name="geometry">Receives the geometry.</param>
+    static bool CookGeometry( const std::string& fname, VertexLayout layout, Geometry& geometry );
+
+    /// <summary>
+    /// Reads a model's geometry, from its cooked mesh file if it is up to date and by cooking it if not.
+    /// </summary>
+    /// <param name="fname">The model's file name.</param>
+    /// <param name="layout">The layout to pack the vertices in.</param>
+    /// <param name="geometry">Receives the geometry.</param>
+    static bool ReadGeometry( const std::string& fname, VertexLayout layout, Geometry& geometry );
+
+    /// <summary>
+    /// Attempts to map a cooked mesh file.
+    /// </summary>
+    /// <param name="fname">The mesh file's name.</param>
+    /// <param name="layout">The layout the vertices must be packed in.</param>
+    /// <param name="hasSource">True if the model exists, so the mesh file must have been cooked from it.</param>
+    /// <param name="sourceSize">The size of the model.</param>
+    /// <param name="sourceTime">The modification time of the model.</param>
+    /// <param name="geometry">Receives the geometry.</param>
+    static bool LoadCooked( const std::string& fname, VertexLayout layout, bool hasSource, unsigned long long sourceSize, long long sourceTime, Geometry& geometry );
+
+    /// <summary>
+    /// Attempts to save geometry as a cooked mesh file.
+    /// </summary>
+    /// <param name="fname">The mesh file's name.</param>
+    /// <param name="sourceSize">The size of the model the geometry was imported from.</param>
+    /// <param name="sourceTime">The modification time of the model the geometry was imported from.</param>
+    /// <param name="geometry">The geometry.</param>
+    static bool SaveCooked( const std::string& fname, unsigned long long sourceSize, long long sourceTime, const Geometry& geometry );
+
     // Hide all of the instance-based methods
     MeshLoader() = delete;
     MeshLoader( const MeshLoader& ) = delete;
@@ -36,10 +136,26 @@ class MeshLoader
 
 public:
     /// <summary>
-    /// Loads a mesh.
+    /// Loads a mesh, waiting for it to finish.
+    /// </summary>
+    /// <param name="fname">The file name.</param>
+    /// <param name="layout">The layout to pack the vertices in, normally the one the mesh's material reads.</param>
+    static std::shared_ptr<Mesh> Load( const std::string& fname, VertexLayout layout = VertexLayout::Full );
+
+    /// <summary>
+    /// Starts loading a mesh in the background. The file is read on a worker thread, and the mesh is
+    /// handed to the GPU over the next few frames.
+    /// </summary>
+    /// <param name="fname">The file name.</param>
+    /// <param name="layout">The layout to pack the vertices in, normally the one the mesh's material reads.</param>
+    static AssetHandle<Mesh> LoadAsync( const std::string& fname, VertexLayout layout = VertexLayout::Full );
+
+    /// <summary>
+    /// Loads just a mesh's geometry, without creating anything on the GPU. Used for collision.
     /// </summary>
     /// <param name="fname">The file name.</param>
-    /// <param name="device">The graphics device to create the mesh on.</param>
-    /// <param name="device">The device context for the mesh to draw on.</param>
-    static std::shared_ptr<Mesh> Load( const std::string& fname );
+    /// <param name="positions">Receives the vertex positions.</param>
+    /// <param name="indices">Receives the triangle indices.</param>
+    /// <returns>True if the file was loaded, false if not.</returns>
+    static bool LoadGeometry( const std::string& fname, std::vector<glm::vec3>& positions, std::vector<unsigned>& indices );
 };
\ No newline at end of file
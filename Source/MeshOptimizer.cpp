@@ -0,0 +1,604 @@
+#include "MeshOptimizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+
+#define VERTEX_CACHE_SIZE         32    // The cache size the scores are tuned for
+#define VERTEX_CACHE_DECAY_POWER  1.5f  // How quickly a vertex's score falls off as it ages in the cache
+#define VERTEX_LAST_TRIANGLE      0.75f // The score of the last triangle's vertices, kept low so strips don't just go back and forth
+#define VERTEX_VALENCE_SCALE      2.0f  // How much vertices with few triangles left are favored, so no lone triangles are left behind
+#define VERTEX_VALENCE_POWER      0.5f
+#define VERTEX_NOT_CACHED         -1
+
+typedef unsigned int UINT;
+
+// Scores a vertex by its place in the cache and the number of triangles it still has to draw
+static float ScoreVertex( int cachePosition, UINT remaining )
+{
+    if ( remaining == 0 )
+    {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if ( cachePosition >= 0 )
+    {
+        if ( cachePosition < 3 )
+        {
+            score = VERTEX_LAST_TRIANGLE;
+        }
+        else
+        {
+            const float scale = 1.0f / ( VERTEX_CACHE_SIZE - 3 );
+            score = std::pow( 1.0f - ( cachePosition - 3 ) * scale, VERTEX_CACHE_DECAY_POWER );
+        }
+    }
+
+    return score + VERTEX_VALENCE_SCALE * std::pow( static_cast<float>( remaining ), -VERTEX_VALENCE_POWER );
+}
+
+// Reorders triangles for the post-transform cache
+void MeshOptimizer::OptimizeVertexCache( std::vector<UINT>& indices, size_t vertexCount )
+{
+    size_t triangleCount = indices.size() / 3;
+    if ( triangleCount == 0 || vertexCount == 0 )
+    {
+        return;
+    }
+
+    // Build the list of triangles each vertex is in, all in one block
+    std::vector<UINT> remaining( vertexCount, 0 );
+    for ( size_t i = 0; i < triangleCount * 3; ++i )
+    {
+        ++remaining[ indices[ i ] ];
+    }
+
+    std::vector<UINT> firstTriangle( vertexCount + 1, 0 );
+    for ( size_t i = 0; i < vertexCount; ++i )
+    {
+        firstTriangle[ i + 1 ] = firstTriangle[ i ] + remaining[ i ];
+    }
+
+    std::vector<UINT> triangles( triangleCount * 3 );
+    std::vector<UINT> filled( vertexCount, 0 );
+    for ( size_t i = 0; i < triangleCount * 3; ++i )
+    {
+        UINT vertex = indices[ i ];
+        triangles[ firstTriangle[ vertex ] + filled[ vertex ]++ ] = static_cast<UINT>( i / 3 );
+    }
+
+    // Score everything, and start with the best triangle
+    std::vector<int> cachePositions( vertexCount, VERTEX_NOT_CACHED );
+    std::vector<float> vertexScores( vertexCount );
+    for ( size_t i = 0; i < vertexCount; ++i )
+    {
+        vertexScores[ i ] = ScoreVertex( VERTEX_NOT_CACHED, remaining[ i ] );
+    }
+
+    std::vector<float> triangleScores( triangleCount );
+    std::vector<bool> isEmitted( triangleCount, false );
+    size_t bestTriangle = 0;
+    for ( size_t i = 0; i < triangleCount; ++i )
+    {
+        const UINT* triangle = &indices[ i * 3 ];
+        triangleScores[ i ] = vertexScores[ triangle[ 0 ] ] + vertexScores[ triangle[ 1 ] ] + vertexScores[ triangle[ 2 ] ];
+        if ( triangleScores[ i ] > triangleScores[ bestTriangle ] )
+        {
+            bestTriangle = i;
+        }
+    }
+
+    // The cache has room for the newest triangle's vertices on top, so we know which ones fall out
+    UINT cache[ VERTEX_CACHE_SIZE + 3 ];
+    UINT newCache[ VERTEX_CACHE_SIZE + 3 ];
+    size_t cacheCount = 0;
+    size_t nextUnemitted = 0;
+
+    std::vector<UINT> output;
+    output.reserve( triangleCount * 3 );
+    while ( output.size() < triangleCount * 3 )
+    {
+        const UINT* triangle = &indices[ bestTriangle * 3 ];
+        isEmitted[ bestTriangle ] = true;
+        output.insert( output.end(), triangle, triangle + 3 );
+
+        // Take the triangle off its vertices' lists, which keeps the triangles still to draw at the front
+        for ( int corner = 0; corner < 3; ++corner )
+        {
+            UINT vertex = triangle[ corner ];
+            UINT* list = &triangles[ firstTriangle[ vertex ] ];
+            UINT* last = list + remaining[ vertex ] - 1;
+            *std::find( list, last + 1, static_cast<UINT>( bestTriangle ) ) = *last;
+            *last = static_cast<UINT>( bestTriangle );
+            --remaining[ vertex ];
+        }
+
+        // Move the triangle's vertices to the front of the cache
+        size_t newCount = 0;
+        for ( int corner = 0; corner < 3; ++corner )
+        {
+            newCache[ newCount++ ] = triangle[ corner ];
+        }
+        for ( size_t i = 0; i < cacheCount; ++i )
+        {
+            UINT vertex = cache[ i ];
+            if ( vertex != triangle[ 0 ] && vertex != triangle[ 1 ] && vertex != triangle[ 2 ] )
+            {
+                newCache[ newCount++ ] = vertex;
+            }
+        }
+
+        // Re-score everything that moved, and pick the best triangle around it
+        float bestScore = -1.0f;
+        for ( size_t i = 0; i < newCount; ++i )
+        {
+            UINT vertex = newCache[ i ];
+            cachePositions[ vertex ] = ( i < VERTEX_CACHE_SIZE ) ? static_cast<int>( i ) : VERTEX_NOT_CACHED;
+            float score = ScoreVertex( cachePositions[ vertex ], remaining[ vertex ] );
+            float change = score - vertexScores[ vertex ];
+            vertexScores[ vertex ] = score;
+
+            const UINT* list = &triangles[ firstTriangle[ vertex ] ];
+            for ( UINT j = 0; j < remaining[ vertex ]; ++j )
+            {
+                UINT neighbor = list[ j ];
+                triangleScores[ neighbor ] += change;
+                if ( triangleScores[ neighbor ] > bestScore )
+                {
+                    bestScore = triangleScores[ neighbor ];
+                    bestTriangle = neighbor;
+                }
+            }
+        }
+
+        cacheCount = std::min<size_t>( newCount, VERTEX_CACHE_SIZE );
+        memcpy( cache, newCache, cacheCount * sizeof( UINT ) );
+
+        // Nothing in the cache has triangles left, so carry on from wherever we haven't been yet
+        if ( bestScore < 0.0f )
+        {
+            while ( nextUnemitted < triangleCount && isEmitted[ nextUnemitted ] )
+            {
+                ++nextUnemitted;
+            }
+            bestTriangle = nextUnemitted;
+        }
+    }
+
+    indices.swap( output );
+}
+
+// Reorders vertices into the order the triangles use them
+void MeshOptimizer::OptimizeVertexFetch( std::vector<Vertex>& vertices, std::vector<UINT>& indices )
+{
+    const UINT unused = static_cast<UINT>( -1 );
+    std::vector<UINT> remap( vertices.size(), unused );
+    std::vector<Vertex> ordered;
+    ordered.reserve( vertices.size() );
+
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        UINT& index = remap[ indices[ i ] ];
+        if ( index == unused )
+        {
+            index = static_cast<UINT>( ordered.size() );
+            ordered.push_back( vertices[ indices[ i ] ] );
+        }
+        indices[ i ] = index;
+    }
+
+    vertices.swap( ordered );
+}
+
+/// <summary>
+/// Defines a quadric, which measures the squared distance from a point to a set of planes. Planes are
+/// weighted by the area of the triangle they came from, and the total weight is kept so the error
+/// can be read back as an average.
+/// </summary>
+struct Quadric
+{
+    double XX, XY, XZ, XW, YY, YZ, YW, ZZ, ZW, WW;
+    double Weight;
+
+    Quadric()
+    {
+        memset( this, 0, sizeof( Quadric ) );
+    }
+
+    // Adds a plane
+    void AddPlane( const glm::dvec3& normal, double distance, double weight )
+    {
+        XX += weight * normal.x * normal.x; XY += weight * normal.x * normal.y; XZ += weight * normal.x * normal.z; XW += weight * normal.x * distance;
+        YY += weight * normal.y * normal.y; YZ += weight * normal.y * normal.z; YW += weight * normal.y * distance;
+        ZZ += weight * normal.z * normal.z; ZW += weight * normal.z * distance;
+        WW += weight * distance * distance;
+        Weight += weight;
+    }
+
+    // Adds another quadric's planes
+    void Add( const Quadric& other )
+    {
+        XX += other.XX; XY += other.XY; XZ += other.XZ; XW += other.XW;
+        YY += other.YY; YZ += other.YZ; YW += other.YW;
+        ZZ += other.ZZ; ZW += other.ZW;
+        WW += other.WW;
+        Weight += other.Weight;
+    }
+
+    // Gets the average squared distance from a point to the planes
+    double GetError( const glm::vec3& point ) const
+    {
+        double x = point.x, y = point.y, z = point.z;
+        double error = XX * x * x + 2 * XY * x * y + 2 * XZ * x * z + 2 * XW * x
+                     + YY * y * y + 2 * YZ * y * z + 2 * YW * y
+                     + ZZ * z * z + 2 * ZW * z
+                     + WW;
+        return ( Weight > 0.0 ) ? std::abs( error ) / Weight : 0.0;
+    }
+};
+
+/// <summary>
+/// Defines an edge collapse, which moves every vertex at one position onto a vertex at another.
+/// </summary>
+struct Collapse
+{
+    UINT  From; // The id of the position that moves
+    UINT  To;   // The vertex it moves onto
+    float Cost;
+
+    bool operator<( const Collapse& other ) const
+    {
+        return Cost < other.Cost;
+    }
+};
+
+// Checks to see if moving a position onto a vertex would turn any of the triangles around it over
+static bool DoesCollapseFlip( const std::vector<Vertex>& vertices, const std::vector<UINT>& positionIds, const std::vector<UINT>& indices, const UINT* triangles, UINT triangleCount, UINT from, UINT to )
+{
+    for ( UINT i = 0; i < triangleCount; ++i )
+    {
+        const UINT* triangle = &indices[ triangles[ i ] * 3 ];
+        UINT toId = positionIds[ to ];
+        if ( positionIds[ triangle[ 0 ] ] == toId || positionIds[ triangle[ 1 ] ] == toId || positionIds[ triangle[ 2 ] ] == toId )
+        {
+            continue; // This one collapses away
+        }
+
+        glm::vec3 before[ 3 ];
+        glm::vec3 after[ 3 ];
+        for ( int corner = 0; corner < 3; ++corner )
+        {
+            before[ corner ] = vertices[ triangle[ corner ] ].Position;
+            after[ corner ] = ( positionIds[ triangle[ corner ] ] == from ) ? vertices[ to ].Position : before[ corner ];
+        }
+
+        glm::vec3 normalBefore = glm::cross( before[ 1 ] - before[ 0 ], before[ 2 ] - before[ 0 ] );
+        glm::vec3 normalAfter = glm::cross( after[ 1 ] - after[ 0 ], after[ 2 ] - after[ 0 ] );
+        if ( glm::dot( normalBefore, normalAfter ) <= 0.0f )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Simplifies a mesh by collapsing edges
+float MeshOptimizer::Simplify( const std::vector<Vertex>& vertices, const std::vector<UINT>& indices, size_t targetIndexCount, std::vector<UINT>& result )
+{
+    size_t vertexCount = vertices.size();
+    result.assign( indices.begin(), indices.begin() + indices.size() / 3 * 3 );
+
+    // Models split their vertices wherever the normal or UV changes, so the shape is worked out from
+    // positions alone. Each vertex is given the id of the first vertex sharing its position.
+    std::vector<UINT> sorted( vertexCount );
+    for ( size_t i = 0; i < vertexCount; ++i )
+    {
+        sorted[ i ] = static_cast<UINT>( i );
+    }
+    std::sort( sorted.begin(), sorted.end(), [ &vertices ]( UINT a, UINT b )
+    {
+        const glm::vec3& left = vertices[ a ].Position;
+        const glm::vec3& right = vertices[ b ].Position;
+        return ( left.x != right.x ) ? left.x < right.x : ( left.y != right.y ) ? left.y < right.y : ( left.z != right.z ) ? left.z < right.z : a < b;
+    } );
+
+    // A position whose vertices don't agree on a UV is on a seam, and moving it would tear the texture
+    std::vector<UINT> positionIds( vertexCount );
+    std::vector<bool> isLocked( vertexCount, false );
+    for ( size_t i = 0; i < vertexCount; ++i )
+    {
+        UINT vertex = sorted[ i ];
+        UINT previous = ( i > 0 ) ? sorted[ i - 1 ] : vertex;
+        bool isShared = ( i > 0 ) && vertices[ previous ].Position == vertices[ vertex ].Position;
+        positionIds[ vertex ] = isShared ? positionIds[ previous ] : vertex;
+        if ( isShared && vertices[ previous ].UV != vertices[ vertex ].UV )
+        {
+            isLocked[ positionIds[ vertex ] ] = true;
+        }
+    }
+
+    // An edge only one triangle uses is on a border, so lock both ends
+    std::unordered_set<unsigned long long> edges;
+    for ( size_t i = 0; i < result.size(); i += 3 )
+    {
+        for ( int corner = 0; corner < 3; ++corner )
+        {
+            unsigned long long a = positionIds[ result[ i + corner ] ], b = positionIds[ result[ i + ( corner + 1 ) % 3 ] ];
+            edges.insert( ( a << 32 ) | b );
+        }
+    }
+
+    std::vector<Quadric> quadrics( vertexCount );
+    for ( size_t i = 0; i < result.size(); i += 3 )
+    {
+        for ( int corner = 0; corner < 3; ++corner )
+        {
+            unsigned long long a = positionIds[ result[ i + corner ] ], b = positionIds[ result[ i + ( corner + 1 ) % 3 ] ];
+            if ( !edges.count( ( b << 32 ) | a ) )
+            {
+                isLocked[ static_cast<size_t>( a ) ] = true;
+                isLocked[ static_cast<size_t>( b ) ] = true;
+            }
+        }
+
+        // Every position starts out measuring the distance to the planes of its own triangles
+        glm::dvec3 a = glm::dvec3( vertices[ result[ i ] ].Position );
+        glm::dvec3 b = glm::dvec3( vertices[ result[ i + 1 ] ].Position );
+        glm::dvec3 c = glm::dvec3( vertices[ result[ i + 2 ] ].Position );
+        glm::dvec3 normal = glm::cross( b - a, c - a );
+        double area = glm::length( normal );
+        if ( area > 0.0 )
+        {
+            normal /= area;
+            for ( int corner = 0; corner < 3; ++corner )
+            {
+                quadrics[ positionIds[ result[ i + corner ] ] ].AddPlane( normal, -glm::dot( normal, a ), area );
+            }
+        }
+    }
+
+    // Collapse the cheapest edges that don't touch each other, a pass at a time
+    const UINT unmoved = static_cast<UINT>( -1 );
+    std::vector<UINT> firstTriangle( vertexCount + 1 );
+    std::vector<UINT> filled( vertexCount );
+    std::vector<UINT> triangles;
+    std::vector<Collapse> collapses;
+    std::vector<bool> isTouched( vertexCount );
+    std::vector<UINT> moves( vertexCount );
+    double maxError = 0.0;
+    while ( result.size() > targetIndexCount )
+    {
+        size_t triangleCount = result.size() / 3;
+
+        // Find the triangles around each position, for checking whether a collapse turns any over
+        std::fill( firstTriangle.begin(), firstTriangle.end(), 0 );
+        for ( size_t i = 0; i < result.size(); ++i )
+        {
+            ++firstTriangle[ positionIds[ result[ i ] ] + 1 ];
+        }
+        for ( size_t i = 0; i < vertexCount; ++i )
+        {
+            firstTriangle[ i + 1 ] += firstTriangle[ i ];
+            filled[ i ] = firstTriangle[ i ];
+        }
+        triangles.resize( result.size() );
+        for ( size_t i = 0; i < result.size(); ++i )
+        {
+            triangles[ filled[ positionIds[ result[ i ] ] ]++ ] = static_cast<UINT>( i / 3 );
+        }
+
+        // Cost every way an edge could collapse. A position moves onto the vertex across the edge from
+        // it, which has the UV that matches its side of any seam.
+        collapses.clear();
+        for ( size_t i = 0; i < result.size(); i += 3 )
+        {
+            for ( int corner = 0; corner < 3; ++corner )
+            {
+                UINT a = result[ i + corner ], b = result[ i + ( corner + 1 ) % 3 ];
+                UINT idA = positionIds[ a ], idB = positionIds[ b ];
+                Quadric quadric = quadrics[ idA ];
+                quadric.Add( quadrics[ idB ] );
+                if ( !isLocked[ idA ] )
+                {
+                    Collapse collapse = { idA, b, static_cast<float>( quadric.GetError( vertices[ b ].Position ) ) };
+                    collapses.push_back( collapse );
+                }
+                if ( !isLocked[ idB ] )
+                {
+                    Collapse collapse = { idB, a, static_cast<float>( quadric.GetError( vertices[ a ].Position ) ) };
+                    collapses.push_back( collapse );
+                }
+            }
+        }
+        std::sort( collapses.begin(), collapses.end() );
+
+        // Each collapse takes out about two triangles, so stop once there would be enough
+        size_t collapseLimit = ( triangleCount - targetIndexCount / 3 ) / 2 + 1;
+        size_t collapseCount = 0;
+        std::fill( isTouched.begin(), isTouched.end(), false );
+        std::fill( moves.begin(), moves.end(), unmoved );
+
+        for ( size_t i = 0; i < collapses.size() && collapseCount < collapseLimit; ++i )
+        {
+            const Collapse& collapse = collapses[ i ];
+            UINT toId = positionIds[ collapse.To ];
+            const UINT* around = &triangles[ firstTriangle[ collapse.From ] ];
+            UINT aroundCount = firstTriangle[ collapse.From + 1 ] - firstTriangle[ collapse.From ];
+            if ( isTouched[ collapse.From ] || isTouched[ toId ]
+              || DoesCollapseFlip( vertices, positionIds, result, around, aroundCount, collapse.From, collapse.To ) )
+            {
+                continue;
+            }
+
+            // Nothing else around the position can move this pass, or the flip check above would be stale
+            for ( UINT j = 0; j < aroundCount; ++j )
+            {
+                const UINT* triangle = &result[ around[ j ] * 3 ];
+                for ( int corner = 0; corner < 3; ++corner )
+                {
+                    isTouched[ positionIds[ triangle[ corner ] ] ] = true;
+                }
+            }
+
+            moves[ collapse.From ] = collapse.To;
+            quadrics[ toId ].Add( quadrics[ collapse.From ] );
+            maxError = std::max( maxError, static_cast<double>( collapse.Cost ) );
+            ++collapseCount;
+        }
+
+        if ( collapseCount == 0 )
+        {
+            break;
+        }
+
+        // Move the collapsed positions, and drop the triangles that collapsed away
+        size_t kept = 0;
+        for ( size_t i = 0; i < result.size(); i += 3 )
+        {
+            UINT corners[ 3 ];
+            for ( int corner = 0; corner < 3; ++corner )
+            {
+                UINT move = moves[ positionIds[ result[ i + corner ] ] ];
+                corners[ corner ] = ( move != unmoved ) ? move : result[ i + corner ];
+            }
+
+            UINT a = positionIds[ corners[ 0 ] ], b = positionIds[ corners[ 1 ] ], c = positionIds[ corners[ 2 ] ];
+            if ( a != b && b != c && a != c )
+            {
+                result[ kept++ ] = corners[ 0 ];
+                result[ kept++ ] = corners[ 1 ];
+                result[ kept++ ] = corners[ 2 ];
+            }
+        }
+        result.resize( kept );
+    }
+
+    return static_cast<float>( std::sqrt( maxError ) );
+}
+
+// Gets the average number of vertices transformed per triangle
+float MeshOptimizer::GetCacheMissRatio( const std::vector<UINT>& indices, size_t vertexCount, size_t cacheSize )
+{
+    if ( indices.size() < 3 )
+    {
+        return 0.0f;
+    }
+
+    // A vertex is still in a FIFO cache if fewer than cacheSize misses have happened since it went in
+    std::vector<size_t> insertedAt( vertexCount, 0 );
+    size_t misses = 0;
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        size_t& inserted = insertedAt[ indices[ i ] ];
+        if ( inserted == 0 || misses + 1 - inserted >= cacheSize )
+        {
+            ++misses;
+            inserted = misses;
+        }
+    }
+
+    return static_cast<float>( misses ) / static_cast<float>( indices.size() / 3 );
+}
+
+// Packs a unit vector into an octahedral snorm16 pair
+glm::i16vec2 MeshOptimizer::EncodeOctahedral( const glm::vec3& vector )
+{
+    // Project onto the octahedron, then fold the lower half over the upper half's corners
+    float length = std::abs( vector.x ) + std::abs( vector.y ) + std::abs( vector.z );
+    glm::vec2 encoded = ( length > 0.0f ) ? glm::vec2( vector.x, vector.y ) / length : glm::vec2( 0.0f );
+    if ( vector.z < 0.0f )
+    {
+        glm::vec2 folded = glm::vec2( 1.0f ) - glm::abs( glm::vec2( encoded.y, encoded.x ) );
+        encoded.x = ( encoded.x >= 0.0f ) ? folded.x : -folded.x;
+        encoded.y = ( encoded.y >= 0.0f ) ? folded.y : -folded.y;
+    }
+
+    encoded = glm::round( glm::clamp( encoded, -1.0f, 1.0f ) * 32767.0f );
+    return glm::i16vec2( static_cast<short>( encoded.x ), static_cast<short>( encoded.y ) );
+}
+
+// Packs a UV into unorm16s spanning a range
+glm::u16vec2 MeshOptimizer::EncodeUV( const glm::vec2& uv, const glm::vec2& offset, const glm::vec2& scale )
+{
+    glm::vec2 normalized = ( uv - offset ) / scale;
+    normalized = glm::round( glm::clamp( normalized, 0.0f, 1.0f ) * 65535.0f );
+    return glm::u16vec2( static_cast<unsigned short>( normalized.x ), static_cast<unsigned short>( normalized.y ) );
+}
+
+// Packs vertices into a layout
+size_t MeshOptimizer::PackVertices( const std::vector<Vertex>& vertices, VertexLayout layout, std::vector<char>& data, glm::vec2& uvOffset, glm::vec2& uvScale )
+{
+    // Full vertices keep their UVs as they are
+    uvOffset = glm::vec2( 0.0f );
+    uvScale = glm::vec2( 1.0f );
+    if ( layout == VertexLayout::Full )
+    {
+        data.resize( vertices.size() * sizeof( Vertex ) );
+        if ( !vertices.empty() )
+        {
+            memcpy( &data[ 0 ], &vertices[ 0 ], data.size() );
+        }
+        return sizeof( Vertex );
+    }
+
+    // The quantized UVs span just the range the mesh uses, as UVs that wrap round aren't between 0 and 1
+    if ( !vertices.empty() )
+    {
+        glm::vec2 uvMin = vertices[ 0 ].UV;
+        glm::vec2 uvMax = vertices[ 0 ].UV;
+        for ( size_t i = 1; i < vertices.size(); ++i )
+        {
+            uvMin = glm::min( uvMin, vertices[ i ].UV );
+            uvMax = glm::max( uvMax, vertices[ i ].UV );
+        }
+
+        uvOffset = uvMin;
+        uvScale = glm::max( uvMax - uvMin, glm::vec2( 1e-6f ) );
+    }
+
+    if ( layout == VertexLayout::Packed )
+    {
+        data.resize( vertices.size() * sizeof( PackedVertex ) );
+        PackedVertex* packed = reinterpret_cast<PackedVertex*>( data.data() );
+        for ( size_t i = 0; i < vertices.size(); ++i )
+        {
+            packed[ i ].Position = vertices[ i ].Position;
+            packed[ i ].Normal = EncodeOctahedral( vertices[ i ].Normal );
+            packed[ i ].Tangent = EncodeOctahedral( vertices[ i ].Tangent );
+            packed[ i ].UV = EncodeUV( vertices[ i ].UV, uvOffset, uvScale );
+        }
+        return sizeof( PackedVertex );
+    }
+
+    data.resize( vertices.size() * sizeof( CompactVertex ) );
+    CompactVertex* compact = reinterpret_cast<CompactVertex*>( data.data() );
+    for ( size_t i = 0; i < vertices.size(); ++i )
+    {
+        compact[ i ].Position = vertices[ i ].Position;
+        compact[ i ].UV = EncodeUV( vertices[ i ].UV, uvOffset, uvScale );
+    }
+    return sizeof( CompactVertex );
+}
+
+// Packs indices into as few bits as they fit in
+size_t MeshOptimizer::PackIndices( const std::vector<UINT>& indices, size_t vertexCount, std::vector<char>& data )
+{
+    if ( vertexCount > 0xFFFF )
+    {
+        data.resize( indices.size() * sizeof( UINT ) );
+        if ( !indices.empty() )
+        {
+            memcpy( &data[ 0 ], &indices[ 0 ], data.size() );
+        }
+        return sizeof( UINT );
+    }
+
+    data.resize( indices.size() * sizeof( unsigned short ) );
+    unsigned short* packed = reinterpret_cast<unsigned short*>( data.data() );
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        packed[ i ] = static_cast<unsigned short>( indices[ i ] );
+    }
+    return sizeof( unsigned short );
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Config.hpp"
+#include "Vertex.hpp"
+#include <vector>
+
+/// <summary>
+/// Defines a static mesh optimizer, used when cooking models. It reorders triangles so the GPU's
+/// post-transform cache is hit as often as possible, reorders vertices to match, simplifies meshes
+/// into levels of detail, and packs vertices into the layout a material actually reads.
+/// </summary>
+class MeshOptimizer
+{
+    ImplementStaticClass( MeshOptimizer );
+
+    /// <summary>
+    /// Packs a unit vector into an octahedral snorm16 pair.
+    /// </summary>
+    /// <param name="vector">The vector.</param>
+    static glm::i16vec2 EncodeOctahedral( const glm::vec3& vector );
+
+    /// <summary>
+    /// Packs a UV into unorm16s spanning a range.
+    /// </summary>
+    /// <param name="uv">The UV.</param>
+    /// <param name="offset">The start of the range.</param>
+    /// <param name="scale">The size of the range.</param>
+    static glm::u16vec2 EncodeUV( const glm::vec2& uv, const glm::vec2& offset, const glm::vec2& scale );
+
+public:
+    /// <summary>
+    /// Reorders triangles so that vertices are re-used while they are still in the post-transform
+    /// cache, using Tom Forsyth's linear-speed vertex cache optimization.
+    /// </summary>
+    /// <param name="indices">The triangle indices.</param>
+    /// <param name="vertexCount">The number of vertices the indices point at.</param>
+    static void OptimizeVertexCache( std::vector<unsigned>& indices, size_t vertexCount );
+
+    /// <summary>
+    /// Reorders vertices into the order the triangles first use them, so they are fetched from memory
+    /// in order. Vertices no triangle uses are dropped.
+    /// </summary>
+    /// <param name="vertices">The vertices.</param>
+    /// <param name="indices">The triangle indices, which are remapped to match.</param>
+    static void OptimizeVertexFetch( std::vector<Vertex>& vertices, std::vector<unsigned>& indices );
+
+    /// <summary>
+    /// Simplifies a mesh by collapsing edges in order of the quadric error they add. Vertices on a
+    /// border or a UV seam never move, so the texture stays where it was, and no vertices are made,
+    /// so the simplified indices still point at the original vertices.
+    /// </summary>
+    /// <param name="vertices">The vertices.</param>
+    /// <param name="indices">The triangle indices.</param>
+    /// <param name="targetIndexCount">The number of indices to simplify down to, if possible.</param>
+    /// <param name="result">Receives the simplified triangle indices.</param>
+    /// <returns>Roughly how far the simplified mesh strays from the original, in the mesh's units.</returns>
+    static float Simplify( const std::vector<Vertex>& vertices, const std::vector<unsigned>& indices, size_t targetIndexCount, std::vector<unsigned>& result );
+
+    /// <summary>
+    /// Gets the average number of vertices transformed per triangle with a FIFO cache of the given
+    /// size. The best possible is about 0.5, and the worst is 3.
+    /// </summary>
+    /// <param name="indices">The triangle indices.</param>
+    /// <param name="vertexCount">The number of vertices the indices point at.</param>
+    /// <param name="cacheSize">The number of vertices the cache holds.</param>
+    static float GetCacheMissRatio( const std::vector<unsigned>& indices, size_t vertexCount, size_t cacheSize );
+
+    /// <summary>
+    /// Packs vertices into a layout.
+    /// </summary>
+    /// <param name="vertices">The vertices.</param>
+    /// <param name="layout">The layout.</param>
+    /// <param name="data">Receives the packed vertices.</param>
+    /// <param name="uvOffset">Receives the start of the range the UVs span.</param>
+    /// <param name="uvScale">Receives the size of the range the UVs span.</param>
+    /// <returns>The size of each packed vertex.</returns>
+    static size_t PackVertices( const std::vector<Vertex>& vertices, VertexLayout layout, std::vector<char>& data, glm::vec2& uvOffset, glm::vec2& uvScale );
+
+    /// <summary>
+    /// Packs indices into 16 bits each if every vertex can be reached that way, or 32 bits if not.
+    /// </summary>
+    /// <param name="indices">The indices.</param>
+    /// <param name="vertexCount">The number of vertices the indices point at.</param>
+    /// <param name="data">Receives the packed indices.</param>
+    /// <returns>The size of each packed index.</returns>
+    static size_t PackIndices( const std::vector<unsigned>& indices, size_t vertexCount, std::vector<char>& data );
+};
@@ -1,7 +1,9 @@
 #include "MeshRenderer.hpp"
 #include "GameObject.hpp"
 #include "SimpleMaterial.hpp"
-#include "RenderManager.hpp"
+#include "LayeredMaterial.hpp"
+#include "Camera.h"
+#include <algorithm>
 #include <assert.h>
 
 // Create a new mesh renderer
@@ -13,16 +15,12 @@ MeshRenderer::MeshRenderer( GameObject* gameObj )
 
     _mesh = nullptr;
     _material = nullptr;
-
-    RenderManager::AddRenderer( this );
 }
 
 // Destroy this mesh renderer
 MeshRenderer::~MeshRenderer()
 {
     _material = nullptr;
-
-    RenderManager::RemoveRenderer( this );
 }
 
 // Set our mesh
@@ -66,7 +64,24 @@ void MeshRenderer::Draw()
         {
             sm->SetWorld( _gameObject->GetWorldMatrix() );
         }
+        LayeredMaterial* lm = dynamic_cast<LayeredMaterial*>( _material );
+        if ( lm )
+        {
+            lm->SetWorld( _gameObject->GetWorldMatrix() );
+        }
+
+        // Pick the level of detail from how big the mesh is for the camera it's being drawn for
+        size_t lod = 0;
+        const Camera* camera = _material->GetCamera();
+        if ( camera && _mesh->GetLodCount() > 1 )
+        {
+            glm::mat4 world = _gameObject->GetWorldMatrix();
+            glm::vec3 center = TransformVector( world, ( _mesh->GetBoundsMin() + _mesh->GetBoundsMax() ) * 0.5f );
+            float scale = std::max( glm::length( glm::vec3( world[ 0 ] ) ), std::max( glm::length( glm::vec3( world[ 1 ] ) ), glm::length( glm::vec3( world[ 2 ] ) ) ) );
+            float radius = glm::length( _mesh->GetBoundsMax() - _mesh->GetBoundsMin() ) * 0.5f * scale;
+            lod = _mesh->GetLodForRadius( camera->GetProjectedRadius( center, radius ) );
+        }
 
-        _mesh->Draw( _material );
+        _mesh->Draw( _material, lod );
     }
 }
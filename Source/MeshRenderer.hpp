@@ -10,6 +10,7 @@
 
 class MeshRenderer : public Component
 {
+    ImplementComponent( MeshRenderer, Component );
     // Disallow the copy constructor and assignment operator
     MeshRenderer( const MeshRenderer& ) = delete;
     MeshRenderer& operator=( const MeshRenderer& ) = delete;
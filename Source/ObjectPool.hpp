@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Config.hpp"
+#include <type_traits>
+#include <vector>
+
+/// <summary>
+/// Defines a pool of objects of a single type. Memory is taken from the heap in fixed-size chunks
+/// and is kept when objects are destroyed, so that creating an object after the pool has warmed up
+/// does not allocate.
+/// </summary>
+template<class T> class ObjectPool
+{
+    ImplementNonCopyableClass( ObjectPool );
+    ImplementNonMovableClass( ObjectPool );
+
+    /// <summary>
+    /// Defines a slot in a chunk. A free slot holds the next free slot.
+    /// </summary>
+    union Slot
+    {
+        Slot* Next;
+        typename std::aligned_storage<sizeof( T ), std::alignment_of<T>::value>::type Storage;
+    };
+
+    std::vector<Slot*> _chunks;
+    Slot* _freeList;
+    const size_t _chunkSize;
+    size_t _count;
+
+    /// <summary>
+    /// Adds a new chunk of free slots.
+    /// </summary>
+    void AddChunk();
+
+public:
+    /// <summary>
+    /// Creates a new object pool.
+    /// </summary>
+    /// <param name="chunkSize">The number of objects each chunk holds.</param>
+    explicit ObjectPool( size_t chunkSize = 64 );
+
+    /// <summary>
+    /// Destroys this object pool. Every object must have been destroyed already.
+    /// </summary>
+    ~ObjectPool();
+
+    /// <summary>
+    /// Creates a new object.
+    /// </summary>
+    /// <param name="args">The arguments to pass to the object's constructor.</param>
+    template<typename... Args> T* Create( Args&&... args );
+
+    /// <summary>
+    /// Destroys an object created by this pool.
+    /// </summary>
+    /// <param name="object">The object.</param>
+    void Destroy( T* object );
+
+    /// <summary>
+    /// Gets the number of objects this pool can hold before it has to allocate again.
+    /// </summary>
+    size_t GetCapacity() const;
+
+    /// <summary>
+    /// Gets the number of live objects.
+    /// </summary>
+    size_t GetCount() const;
+
+    /// <summary>
+    /// Makes sure this pool can hold the given number of objects without allocating.
+    /// </summary>
+    /// <param name="count">The number of objects.</param>
+    void Reserve( size_t count );
+};
+
+#include "ObjectPool.inl"
@@ -0,0 +1,89 @@
+#include <assert.h>
+#include <new>
+#include <utility>
+
+// Create a new object pool
+template<class T> ObjectPool<T>::ObjectPool( size_t chunkSize )
+    : _freeList( nullptr )
+    , _chunkSize( chunkSize )
+    , _count( 0 )
+{
+    assert( _chunkSize > 0 && "Object pools need at least one object per chunk" );
+}
+
+// Destroy this object pool
+template<class T> ObjectPool<T>::~ObjectPool()
+{
+    assert( _count == 0 && "Object pool destroyed with live objects" );
+
+    for ( size_t i = 0; i < _chunks.size(); ++i )
+    {
+        delete[] _chunks[ i ];
+    }
+}
+
+// Add a new chunk of free slots
+template<class T> void ObjectPool<T>::AddChunk()
+{
+    Slot* chunk = new Slot[ _chunkSize ];
+    _chunks.push_back( chunk );
+
+    // Thread the new slots onto the front of the free list, keeping them in address order
+    for ( size_t i = _chunkSize; i > 0; --i )
+    {
+        chunk[ i - 1 ].Next = _freeList;
+        _freeList = &chunk[ i - 1 ];
+    }
+}
+
+// Create a new object
+template<class T> template<typename... Args> T* ObjectPool<T>::Create( Args&&... args )
+{
+    if ( !_freeList )
+    {
+        AddChunk();
+    }
+
+    Slot* slot = _freeList;
+    _freeList = slot->Next;
+    ++_count;
+
+    return new ( &slot->Storage ) T( std::forward<Args>( args )... );
+}
+
+// Destroy an object created by this pool
+template<class T> void ObjectPool<T>::Destroy( T* object )
+{
+    if ( !object )
+    {
+        return;
+    }
+
+    object->~T();
+
+    Slot* slot = reinterpret_cast<Slot*>( object );
+    slot->Next = _freeList;
+    _freeList = slot;
+    --_count;
+}
+
+// Get the number of objects we can hold without allocating
+template<class T> size_t ObjectPool<T>::GetCapacity() const
+{
+    return _chunks.size() * _chunkSize;
+}
+
+// Get the number of live objects
+template<class T> size_t ObjectPool<T>::GetCount() const
+{
+    return _count;
+}
+
+// Make sure we can hold the given number of objects
+template<class T> void ObjectPool<T>::Reserve( size_t count )
+{
+    while ( GetCapacity() < count )
+    {
+        AddChunk();
+    }
+}
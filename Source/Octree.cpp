@@ -23,6 +23,8 @@ static BoxCollider* CreateBounds()
 Octree::Octree()
     : _subdivision( 0 )
     , _bounds( nullptr )
+    , _looseMin( 0 )
+    , _looseMax( 0 )
 {
     _bounds = CreateBounds();
 }
@@ -31,6 +33,8 @@ Octree::Octree()
 Octree::Octree( int subdivision, glm::vec3 center, glm::vec3 size )
     : _subdivision( subdivision )
     , _bounds( CreateBounds() )
+    , _looseMin( 0 )
+    , _looseMax( 0 )
 {
     _bounds->SetLocalCenter( center );
     _bounds->SetSize( size );
@@ -178,6 +182,96 @@ void Octree::Rebuild( std::vector<Collider*>& objects )
     {
         AddObject( obj );
     }
+
+    UpdateLooseBounds();
+}
+
+// Grows this octree's loose bounds to cover everything stored in it
+void Octree::UpdateLooseBounds()
+{
+    _looseMin = _bounds->GetMinPoint();
+    _looseMax = _bounds->GetMaxPoint();
+
+    // Objects only go in the first octant they touch, so they can hang out past its bounds
+    if ( _objects )
+    {
+        for ( auto& obj : *_objects )
+        {
+            _looseMin = glm::min( _looseMin, obj->GetMinPoint() );
+            _looseMax = glm::max( _looseMax, obj->GetMaxPoint() );
+        }
+    }
+
+    if ( HasSubdivided() )
+    {
+        for ( auto& child : _children )
+        {
+            child->UpdateLooseBounds();
+            _looseMin = glm::min( _looseMin, child->_looseMin );
+            _looseMax = glm::max( _looseMax, child->_looseMax );
+        }
+    }
+}
+
+// Finds every object whose bounds overlap the given box
+void Octree::QueryBox( const glm::vec3& min, const glm::vec3& max, std::vector<Collider*>& objects ) const
+{
+    if ( glm::any( glm::greaterThan( min, _looseMax ) ) || glm::any( glm::lessThan( max, _looseMin ) ) )
+    {
+        return;
+    }
+
+    if ( _objects )
+    {
+        for ( auto& obj : *_objects )
+        {
+            if ( glm::all( glm::lessThanEqual( min, obj->GetMaxPoint() ) ) && glm::all( glm::greaterThanEqual( max, obj->GetMinPoint() ) ) )
+            {
+                objects.push_back( obj );
+            }
+        }
+    }
+
+    if ( HasSubdivided() )
+    {
+        for ( auto& child : _children )
+        {
+            child->QueryBox( min, max, objects );
+        }
+    }
+}
+
+// Finds every object whose padded bounds a segment passes through
+void Octree::QuerySegment( const glm::vec3& start, const glm::vec3& end, float padding, std::vector<Collider*>& objects ) const
+{
+    const glm::vec3 delta = end - start;
+    const glm::vec3 pad( padding );
+    float entry = 0.0f;
+    int axis = 0;
+
+    if ( !IntersectSegmentBox( start, delta, _looseMin - pad, _looseMax + pad, entry, axis ) )
+    {
+        return;
+    }
+
+    if ( _objects )
+    {
+        for ( auto& obj : *_objects )
+        {
+            if ( IntersectSegmentBox( start, delta, obj->GetMinPoint() - pad, obj->GetMaxPoint() + pad, entry, axis ) )
+            {
+                objects.push_back( obj );
+            }
+        }
+    }
+
+    if ( HasSubdivided() )
+    {
+        for ( auto& child : _children )
+        {
+            child->QuerySegment( start, end, padding, objects );
+        }
+    }
 }
 
 // Attempts to subdivide this octree
@@ -22,6 +22,8 @@ private:
     BoxCollider* _bounds;
     std::array<std::shared_ptr<Octree>, 8> _children;
     std::shared_ptr<std::vector<Collider*>> _objects; // Because we won't always have objects
+    glm::vec3 _looseMin;
+    glm::vec3 _looseMax;
 
 private:
     /// <summary>
@@ -39,6 +41,11 @@ private:
     /// </summary>
     bool Subdivide();
 
+    /// <summary>
+    /// Grows this octree's loose bounds to cover everything stored in it and its children.
+    /// </summary>
+    void UpdateLooseBounds();
+
 public:
     /// <summary>
     /// Creates a new octree.
@@ -67,6 +74,23 @@ public:
     /// <param name="collidingObject">The collider that the given collider is colliding with.</param>
     bool IsColliding( Collider* collider, Collider** collidingObject );
 
+    /// <summary>
+    /// Finds every object whose bounds overlap the given box.
+    /// </summary>
+    /// <param name="min">The box's minimum point.</param>
+    /// <param name="max">The box's maximum point.</param>
+    /// <param name="objects">The list to add the objects to.</param>
+    void QueryBox( const glm::vec3& min, const glm::vec3& max, std::vector<Collider*>& objects ) const;
+
+    /// <summary>
+    /// Finds every object whose bounds, grown by the given padding, a segment passes through.
+    /// </summary>
+    /// <param name="start">The start of the segment.</param>
+    /// <param name="end">The end of the segment.</param>
+    /// <param name="padding">How much to grow the bounds by (e.g. the radius of a sphere being cast).</param>
+    /// <param name="objects">The list to add the objects to.</param>
+    void QuerySegment( const glm::vec3& start, const glm::vec3& end, float padding, std::vector<Collider*>& objects ) const;
+
     /// <summary>
     /// Rebuilds this octree based on the given objects.
     /// </summary>
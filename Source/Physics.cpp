@@ -1,9 +1,12 @@
 #include "Physics.hpp"
 #include "BoxCollider.hpp"
+#include "MeshCollider.hpp"
 #include "SphereCollider.hpp"
 #include "RigidBody.h"
 #include "Time.hpp"
 #include "GameObject.hpp"
+#include <algorithm>
+#include <cfloat>
 #if defined( _DEBUG )
 #   include <iostream>
 #endif
@@ -12,22 +15,72 @@ using namespace glm;
 
 #define MakeCollisionType(a, b) static_cast<Physics::CollisionType>( EnumOR( a, b ) )
 
-std::vector<glm::vec3>  Physics::_lhsCorners( 8 );
-std::vector<glm::vec3>  Physics::_rhsCorners( 8 );
-std::vector<RigidBody*> Physics::_rigidbodies;
-std::vector<Collider*>  Physics::_colliders;
-Octree                  Physics::_octree;
+std::vector<glm::vec3>         Physics::_lhsCorners( 8 );
+std::vector<glm::vec3>         Physics::_rhsCorners( 8 );
+std::vector<RigidBody*>        Physics::_rigidbodies;
+std::vector<Collider*>         Physics::_colliders;
+std::vector<Physics::BodySync> Physics::_bodySyncs;
+std::unordered_map<unsigned int, RigidBody*> Physics::_bodiesById;
+std::vector<SimulationBody>    Physics::_bodies;
+std::vector<PlanarBody>        Physics::_planarBodies;
+std::vector<glm::vec3>         Physics::_bodyOffsets;
+std::vector<Collider*>         Physics::_queryColliders;
+std::vector<Collider*>         Physics::_rayColliders;
+std::vector<glm::vec3>         Physics::_queryBounds;
+std::vector<SimulationContact> Physics::_contacts;
+std::vector<size_t>            Physics::_bodiesOutOfBounds;
+ContactCache                   Physics::_contactCache;
+unsigned int                   Physics::_nextBodyId = 0;
+SimulationMode                 Physics::_simulationMode = SimulationMode::Spatial;
+float                          Physics::_planeHeight = 0.0f;
+bool                           Physics::_isDispatchingContacts = false;
+bool                           Physics::_hasRemovedBodies = false;
+bool                           Physics::_isOctreeDirty = false;
+bool                           Physics::_isSettled = true;
+bool                           Physics::_hasTableBounds = false;
+size_t                         Physics::_movingBodyCount = 0;
+glm::vec3                      Physics::_tableMin;
+glm::vec3                      Physics::_tableMax;
+EventListener                  Physics::_eventListener;
+Octree                         Physics::_octree;
+PhysicsWorld                   Physics::_world;
+
+// Creates a new, empty ray
+PhysicsRay::PhysicsRay()
+    : Origin( 0, 0, 0 )
+    , Direction( 0, 0, 0 )
+    , MaxDistance( 0 )
+{
+}
+
+// Creates a new ray
+PhysicsRay::PhysicsRay( const glm::vec3& origin, const glm::vec3& direction, float maxDistance )
+    : Origin( origin )
+    , Direction( direction )
+    , MaxDistance( maxDistance )
+{
+}
 
-// Creates new collision information
-Physics::Collision::Collision(Collider* lhs, Collider* rhs, CollisionType collisionType)
-    : _lhs( lhs )
-    , _rhs( rhs )
-    , _collisionType( collisionType)
+// Creates a new body sync
+Physics::BodySync::BodySync()
+    : Offset( 0, 0, 0 )
+    , TransformPosition( 0, 0, 0 )
+    , Sequence( 0 )
+    , IsNew( true )
+{
+}
+
+// Creates a new, empty hit
+RaycastHit::RaycastHit()
+    : HitCollider( nullptr )
+    , Point( 0, 0, 0 )
+    , Normal( 0, 0, 0 )
+    , Distance( 0 )
 {
 }
 
 // Perform box <--> box collision
-bool Physics::AreColliding( BoxCollider* lhs, BoxCollider* rhs )
+bool                           Physics::AreColliding( BoxCollider* lhs, BoxCollider* rhs )
 {
 #if 1
     // Gets the half widths of the box colliders.
@@ -147,7 +200,7 @@ bool Physics::AreColliding( BoxCollider* lhs, BoxCollider* rhs )
 }
 
 // Perform box <--> sphere collision
-bool Physics::AreColliding( BoxCollider* lhs, SphereCollider* rhs )
+bool                           Physics::AreColliding( BoxCollider* lhs, SphereCollider* rhs )
 {
 #if 1
     float sphereRadius = rhs->GetRadius();
@@ -185,8 +238,26 @@ bool Physics::AreColliding( BoxCollider* lhs, SphereCollider* rhs )
 #endif
 }
 
+// Perform box <--> mesh collision
+bool                           Physics::AreColliding( BoxCollider* lhs, MeshCollider* rhs )
+{
+    glm::vec3 lhsMin = lhs->GetMinPoint(), lhsMax = lhs->GetMaxPoint();
+    glm::vec3 rhsMin = rhs->GetMinPoint(), rhsMax = rhs->GetMaxPoint();
+
+    return lhsMin.x <= rhsMax.x && lhsMax.x >= rhsMin.x
+        && lhsMin.y <= rhsMax.y && lhsMax.y >= rhsMin.y
+        && lhsMin.z <= rhsMax.z && lhsMax.z >= rhsMin.z;
+}
+
+// Perform mesh <--> sphere collision
+bool                           Physics::AreColliding( MeshCollider* lhs, SphereCollider* rhs )
+{
+    BvhContact contact;
+    return lhs->FindSphereContact( rhs->GetGlobalCenter(), rhs->GetRadius(), contact );
+}
+
 // Perform sphere <--> sphere collision
-bool Physics::AreColliding( SphereCollider* lhs, SphereCollider* rhs )
+bool                           Physics::AreColliding( SphereCollider* lhs, SphereCollider* rhs )
 {
     float centerDistance = glm::distance( lhs->GetGlobalCenter(), rhs->GetGlobalCenter() );
     float sumOfRadii = lhs->GetRadius() + rhs->GetRadius();
@@ -200,9 +271,376 @@ Physics::CollisionType Physics::GetCollisionType( Collider* a, Collider* b )
     return MakeCollisionType( a->GetColliderType(), b->GetColliderType() );
 }
 
+// Checks to see if a collider is only ever passed through
+bool Physics::IsTrigger( Collider* collider )
+{
+    // Mass-less spheres (the pockets) are triggers, the same as in the simulation
+    if ( collider->GetColliderType() != ColliderType::Sphere )
+    {
+        return false;
+    }
+
+    RigidBody* rigidBody = collider->GetGameObject()->GetComponent<RigidBody>();
+    return rigidBody && rigidBody->GetMass() == 0.0f;
+}
+
+// Sweeps a sphere against a single collider
+bool Physics::CastCollider( Collider* collider, const glm::vec3& start, const glm::vec3& delta, float radius, float& time, glm::vec3& point, glm::vec3& normal )
+{
+    switch ( collider->GetColliderType() )
+    {
+        case ColliderType::Sphere:
+        {
+            SphereCollider* sphere = static_cast<SphereCollider*>( collider );
+            glm::vec3 center = sphere->GetGlobalCenter();
+            float sumOfRadii = sphere->GetRadius() + radius;
+
+            // Solve for where the swept center first reaches the sum of the radii
+            glm::vec3 fromCenter = start - center;
+            float a = glm::dot( delta, delta );
+            float b = glm::dot( fromCenter, delta );
+            float c = glm::dot( fromCenter, fromCenter ) - sumOfRadii * sumOfRadii;
+            if ( c < 0.0f || b >= 0.0f || a <= 0.0f || sumOfRadii <= 0.0f )
+            {
+                return false;
+            }
+
+            float discriminant = b * b - a * c;
+            if ( discriminant < 0.0f )
+            {
+                return false;
+            }
+
+            time = ( -b - glm::sqrt( discriminant ) ) / a;
+            if ( time > 1.0f )
+            {
+                return false;
+            }
+
+            normal = ( start + delta * time - center ) / sumOfRadii;
+            point = center + normal * sphere->GetRadius();
+            return true;
+        }
+
+        case ColliderType::Box:
+        {
+            // The table's boxes are axis aligned. Growing a box by the radius leaves its corners square
+            // rather than rounded, so a sphere can hit them slightly early.
+            BoxCollider* box = static_cast<BoxCollider*>( collider );
+            glm::vec3 padding( radius );
+            int axis = -1;
+            if ( !IntersectSegmentBox( start, delta, box->GetMinPoint() - padding, box->GetMaxPoint() + padding, time, axis ) || axis < 0 )
+            {
+                return false;
+            }
+
+            normal = glm::vec3( 0 );
+            normal[ axis ] = ( delta[ axis ] > 0.0f ) ? -1.0f : 1.0f;
+            point = start + delta * time - normal * radius;
+            return true;
+        }
+
+        case ColliderType::Mesh:
+        {
+            MeshCollider* mesh = static_cast<MeshCollider*>( collider );
+            BvhSweepHit sweep;
+            if ( !mesh->SweepSphere( start, start + delta, radius, sweep ) )
+            {
+                return false;
+            }
+
+            time = sweep.Time;
+            point = sweep.Point;
+            normal = sweep.Normal;
+            return true;
+        }
+
+        default:
+        {
+            // Colliders without a shape can't be hit
+            return false;
+        }
+    }
+}
+
+// Sweeps a sphere against the given colliders, finding the first one it hits
+bool Physics::CastClosest( const std::vector<Collider*>& colliders, const glm::vec3& start, const glm::vec3& delta, float radius, bool hitTriggers, RaycastHit& hit )
+{
+    float firstTime = FLT_MAX;
+    hit = RaycastHit();
+
+    for ( auto& collider : colliders )
+    {
+        // Colliders on inactive game objects (e.g. pooled balls) aren't in the scene
+        if ( !collider->GetGameObject()->IsActiveInHierarchy() || ( !hitTriggers && IsTrigger( collider ) ) )
+        {
+            continue;
+        }
+
+        float time = 0.0f;
+        glm::vec3 point, normal;
+        if ( CastCollider( collider, start, delta, radius, time, point, normal ) && time < firstTime )
+        {
+            firstTime = time;
+            hit.HitCollider = collider;
+            hit.Point = point;
+            hit.Normal = normal;
+        }
+    }
+
+    if ( !hit.HitCollider )
+    {
+        return false;
+    }
+
+    hit.Distance = firstTime * glm::length( delta );
+    return true;
+}
+
+// Reads a rigid body's current state
+void Physics::ReadBody( RigidBody* rigidBody, Collider* collider, SimulationBody& body )
+{
+    body = SimulationBody();
+    body.Id = rigidBody->_bodyId;
+    body.Velocity = rigidBody->GetVelocity();
+    body.Mass = rigidBody->GetMass();
+    body.IsMovable = rigidBody->IsMovable() && body.Mass > 0.0f;
+    body.Shape = collider->GetColliderType();
+
+    switch ( body.Shape )
+    {
+        case ColliderType::Box:
+        {
+            BoxCollider* box = static_cast<BoxCollider*>( collider );
+            body.Position = box->GetGlobalCenter();
+            body.HalfSize = box->GetSize() * 0.5f;
+        }
+        break;
+
+        case ColliderType::Sphere:
+        {
+            SphereCollider* sphere = static_cast<SphereCollider*>( collider );
+            body.Position = sphere->GetGlobalCenter();
+            body.Radius = sphere->GetRadius();
+        }
+        break;
+
+        case ColliderType::Mesh:
+        {
+            MeshCollider* mesh = static_cast<MeshCollider*>( collider );
+            body.Position = mesh->GetOrigin();
+            body.Mesh = mesh->GetBvh();
+        }
+        break;
+
+        default:
+        {
+            // Bodies without a shape keep the defaults, and never touch anything
+        }
+        break;
+    }
+}
+
+// Captures a snapshot of every registered body
+void Physics::CaptureSnapshot( std::vector<SimulationBody>& bodies, std::vector<RigidBody*>& owners )
+{
+    bodies.clear();
+    owners.clear();
+
+    for ( size_t i = 0; i < _rigidbodies.size(); ++i )
+    {
+        // Skip the same bodies the step does, so predictions see what the real step will
+        if ( !_rigidbodies[ i ] || !_colliders[ i ] || !_rigidbodies[ i ]->GetGameObject()->IsActiveInHierarchy() )
+        {
+            continue;
+        }
+
+        SimulationBody body;
+        ReadBody( _rigidbodies[ i ], _colliders[ i ], body );
+
+        bodies.push_back( body );
+        owners.push_back( _rigidbodies[ i ] );
+    }
+}
+
+// Gets the listener for the table-wide events
+EventListener*                 Physics::GetEventListener()
+{
+    return &_eventListener;
+}
+
+// Gets the height of the table plane
+float                          Physics::GetPlaneHeight()
+{
+    return _planeHeight;
+}
+
+// Gets the current simulation mode
+SimulationMode                 Physics::GetSimulationMode()
+{
+    return _simulationMode;
+}
+
+// Checks to see if every movable body on the table has stopped
+bool                           Physics::IsSettled()
+{
+    return _isSettled;
+}
+
+// Finds every collider whose bounds overlap the given box
+size_t Physics::OverlapBox( const glm::vec3& min, const glm::vec3& max, std::vector<Collider*>& colliders, bool hitTriggers )
+{
+    UpdateOctree();
+    _queryColliders.clear();
+    _octree.QueryBox( min, max, _queryColliders );
+
+    colliders.clear();
+    for ( auto& collider : _queryColliders )
+    {
+        // Colliders on inactive game objects (e.g. pooled balls) aren't in the scene
+        if ( !collider->GetGameObject()->IsActiveInHierarchy() || ( !hitTriggers && IsTrigger( collider ) ) )
+        {
+            continue;
+        }
+
+        // Spheres can be tested exactly for next to nothing
+        if ( collider->GetColliderType() == ColliderType::Sphere )
+        {
+            SphereCollider* sphere = static_cast<SphereCollider*>( collider );
+            glm::vec3 center = sphere->GetGlobalCenter();
+            glm::vec3 fromBox = center - glm::clamp( center, min, max );
+            if ( glm::dot( fromBox, fromBox ) > sphere->GetRadius() * sphere->GetRadius() )
+            {
+                continue;
+            }
+        }
+
+        colliders.push_back( collider );
+    }
+
+    return colliders.size();
+}
+
+// Casts a ray, finding the first collider it hits
+bool Physics::Raycast( const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RaycastHit& hit, bool hitTriggers )
+{
+    return SphereCast( origin, 0.0f, direction, maxDistance, hit, hitTriggers );
+}
+
+// Casts a batch of rays
+size_t Physics::Raycast( const std::vector<PhysicsRay>& rays, std::vector<RaycastHit>& hits, bool hitTriggers )
+{
+    hits.assign( rays.size(), RaycastHit() );
+
+    // Walk the octree once, for the box around every ray
+    glm::vec3 min( FLT_MAX ), max( -FLT_MAX );
+    for ( auto& ray : rays )
+    {
+        float length = glm::length( ray.Direction );
+        if ( length > 0.0f && ray.MaxDistance > 0.0f )
+        {
+            glm::vec3 end = ray.Origin + ray.Direction * ( ray.MaxDistance / length );
+            min = glm::min( min, glm::min( ray.Origin, end ) );
+            max = glm::max( max, glm::max( ray.Origin, end ) );
+        }
+    }
+
+    UpdateOctree();
+    _queryColliders.clear();
+    if ( min.x <= max.x )
+    {
+        _octree.QueryBox( min, max, _queryColliders );
+    }
+
+    // Then each ray only has to look at the colliders whose bounds it passes through
+    _queryBounds.resize( _queryColliders.size() * 2 );
+    for ( size_t i = 0; i < _queryColliders.size(); ++i )
+    {
+        _queryBounds[ i * 2 ] = _queryColliders[ i ]->GetMinPoint();
+        _queryBounds[ i * 2 + 1 ] = _queryColliders[ i ]->GetMaxPoint();
+    }
+
+    size_t hitCount = 0;
+    for ( size_t i = 0; i < rays.size(); ++i )
+    {
+        const PhysicsRay& ray = rays[ i ];
+        float length = glm::length( ray.Direction );
+        if ( length <= 0.0f || ray.MaxDistance <= 0.0f )
+        {
+            continue;
+        }
+
+        glm::vec3 delta = ray.Direction * ( ray.MaxDistance / length );
+        _rayColliders.clear();
+        for ( size_t j = 0; j < _queryColliders.size(); ++j )
+        {
+            float entry = 0.0f;
+            int axis = 0;
+            if ( IntersectSegmentBox( ray.Origin, delta, _queryBounds[ j * 2 ], _queryBounds[ j * 2 + 1 ], entry, axis ) )
+            {
+                _rayColliders.push_back( _queryColliders[ j ] );
+            }
+        }
+
+        if ( CastClosest( _rayColliders, ray.Origin, delta, 0.0f, hitTriggers, hits[ i ] ) )
+        {
+            ++hitCount;
+        }
+    }
+
+    return hitCount;
+}
+
+// Casts a sphere, finding the first collider it hits
+bool Physics::SphereCast( const glm::vec3& origin, float radius, const glm::vec3& direction, float maxDistance, RaycastHit& hit, bool hitTriggers )
+{
+    hit = RaycastHit();
+
+    float length = glm::length( direction );
+    if ( length <= 0.0f || maxDistance <= 0.0f )
+    {
+        return false;
+    }
+
+    glm::vec3 delta = direction * ( maxDistance / length );
+    UpdateOctree();
+    _queryColliders.clear();
+    _octree.QuerySegment( origin, origin + delta, radius, _queryColliders );
+
+    return CastClosest( _queryColliders, origin, delta, radius, hitTriggers, hit );
+}
+
+// Sets the height of the table plane
+void Physics::SetPlaneHeight( float height )
+{
+    _planeHeight = height;
+    SendMode();
+}
+
+// Sets the bounds of the table
+void Physics::SetTableBounds( const glm::vec3& min, const glm::vec3& max )
+{
+    _tableMin = min;
+    _tableMax = max;
+    _hasTableBounds = true;
+}
+
+// Sets the current simulation mode
+void Physics::SetSimulationMode( SimulationMode mode )
+{
+    _simulationMode = mode;
+    SendMode();
+}
+
 // Register a rigid body
 void Physics::RegisterRigidbody(RigidBody* rigidBody)
 {
+    // Pooled bodies are registered again every time they are reused
+    if ( rigidBody->_bodyIndex != RigidBody::InvalidBodyIndex )
+    {
+        return;
+    }
+
     GameObject* obj = rigidBody->GetGameObject();
     Collider* collider = obj->GetComponentOfType<Collider>();
 #if defined( _DEBUG )
@@ -212,236 +650,449 @@ void Physics::RegisterRigidbody(RigidBody* rigidBody)
     }
 #endif
 
+    // Give the body an ID that stays the same no matter where it ends up in our lists
+    rigidBody->_bodyId = ++_nextBodyId;
+    rigidBody->_bodyIndex = _rigidbodies.size();
+
     _rigidbodies.push_back( rigidBody );
     _colliders.push_back( collider );
+    _bodySyncs.push_back( BodySync() );
+    _bodiesById[ rigidBody->_bodyId ] = rigidBody;
 }
 
-// Resolves box <--> sphere collision
-void Physics::ResolveBoxSphereCollision( BoxCollider* box, SphereCollider* sphere )
+// Un-register a rigid body
+void Physics::UnregisterRigidbody(RigidBody* rigidBody)
 {
-    // In our game, the boxes are not moved in collisions and are assumed to be oriented.
+    // Bodies know where they are kept, so there's no need to search for them
+    size_t index = rigidBody->_bodyIndex;
+    if ( index >= _rigidbodies.size() || _rigidbodies[ index ] != rigidBody )
+    {
+        return;
+    }
+    rigidBody->_bodyIndex = RigidBody::InvalidBodyIndex;
+    _bodiesById.erase( rigidBody->_bodyId );
 
-    //Get The rigid body
-    RigidBody* sphereRigidBody = sphere->GetGameObject()->GetComponent<RigidBody>();
+    if ( _world.IsRunning() && !_bodySyncs[ index ].IsNew )
+    {
+        PhysicsCommand command;
+        command.Type = PhysicsCommandType::RemoveBody;
+        command.Body.Id = rigidBody->_bodyId;
+        _world.Push( command );
+    }
 
-    // Find the global centers
-    glm::vec3 boxCenter = box->GetGlobalCenter();
-    // Finds the center of the sphere in the previous frame
-    glm::vec3 sphereCenter = sphere->GetGlobalCenter() - sphereRigidBody->GetVelocity() * Time::GetElapsedTime();
-    glm::vec3 betweenCenters = box->GetGlobalCenter() - sphereCenter;
+    // Contacts refer to bodies by index, so only blank the slot out while they're being dispatched
+    if ( _isDispatchingContacts )
+    {
+        _rigidbodies[ index ] = nullptr;
+        _colliders[ index ] = nullptr;
+        _hasRemovedBodies = true;
+        return;
+    }
 
-    // Find the range of values inside the box.
-    glm::vec3 boxMin = boxCenter - box->GetSize() * 0.5f;
-    glm::vec3 boxMax = boxCenter + box->GetSize() * 0.5f;
+    RemoveBodyAt( index );
+}
 
-    // Finds the closest point on the box to the sphere.
-    glm::vec3 closestPoint = glm::clamp( sphereCenter, boxMin, boxMax );
-    
-    // If the sphere's center inside the box, reverse the velocity
-    if (closestPoint == sphereCenter)
+// Remove the body at the given index
+void Physics::RemoveBodyAt( size_t index )
+{
+    size_t last = _rigidbodies.size() - 1;
+    if ( index != last )
     {
-        sphereRigidBody->SetVelocity(-sphereRigidBody->GetVelocity());
-        return;
+        _rigidbodies[ index ] = _rigidbodies[ last ];
+        _colliders[ index ] = _colliders[ last ];
+        _bodySyncs[ index ] = _bodySyncs[ last ];
+        _rigidbodies[ index ]->_bodyIndex = index;
     }
+    _rigidbodies.pop_back();
+    _colliders.pop_back();
+    _bodySyncs.pop_back();
+
+    // The octree may still point at the removed collider, so it must be rebuilt before it is used again
+    _isOctreeDirty = true;
+}
 
-    // Finds the vector between the closest point and the sphere's center
-    glm::vec3 collisionDistance = closestPoint - sphereCenter;
+// Rebuild the octree if bodies have been removed
+void Physics::UpdateOctree()
+{
+    if ( _isOctreeDirty )
+    {
+        _octree.Rebuild( _colliders );
+        _isOctreeDirty = false;
+    }
+}
 
-    // Finds the magnitude of penetration based off the length of the collision and the sphere's radius.
-    float penetration = sphere->GetRadius() - glm::length(collisionDistance);	
+// Gathers the state of every registered rigid body
+void Physics::GatherBodies( float time )
+{
+    _bodies.resize( _rigidbodies.size() );
+    _bodyOffsets.resize( _rigidbodies.size() );
+    if ( _simulationMode == SimulationMode::Planar )
+    {
+        _planarBodies.resize( _rigidbodies.size() );
+    }
 
-    // Finds the normal vector of the collision.
-    glm::vec3 collisionNormal = glm::normalize( collisionDistance );
+    for ( size_t i = 0; i < _rigidbodies.size(); ++i )
+    {
+        RigidBody* rigidBody = _rigidbodies[ i ];
+        Collider* collider = _colliders[ i ];
+        SimulationBody& body = _bodies[ i ];
 
-    // Moves the sphere back until it is no longer penetrating.
-    sphereRigidBody->SetPosition( sphereCenter - collisionNormal * penetration);
+        // Bodies on inactive game objects (e.g. ones waiting to be destroyed) sit the step out
+        if ( !collider || !rigidBody->GetGameObject()->IsActiveInHierarchy() )
+        {
+            body = SimulationBody();
+            body.IsActive = false;
+        }
+        else
+        {
+            // Apply whatever forces were added since the last step
+            if ( rigidBody->_IsMovable )
+            {
+                rigidBody->m_v3Velocity += rigidBody->m_v3Acceleration * time;
+                rigidBody->m_v3Acceleration = glm::vec3( 0 );
+            }
 
-    // Reflects the sphere's velocity by the collision normal
-    glm::vec3 newVelocity = glm::reflect( sphereRigidBody->GetVelocity(), collisionNormal );
+            ReadBody( rigidBody, collider, body );
+            _bodyOffsets[ i ] = body.Position - rigidBody->transform->GetPosition();
+        }
 
-    // Sets the new velocity
-    sphereRigidBody->SetVelocity( newVelocity );
+        if ( _simulationMode == SimulationMode::Planar )
+        {
+            _planarBodies[ i ] = Simulation::ToPlanar( body, _planeHeight );
+        }
+    }
 }
 
-// Resolves sphere <--> sphere collision
-void Physics::ResolveSphereSphereCollision( SphereCollider* sphere1, SphereCollider* sphere2 )
+// Writes the simulation's bodies back out to the registered rigid bodies
+void Physics::ScatterBodies()
 {
-    // Get the rigid bodies
-    RigidBody* sphere1RigidBody = sphere1->GetGameObject()->GetComponent<RigidBody>();
-    RigidBody* sphere2RigidBody = sphere2->GetGameObject()->GetComponent<RigidBody>();
+    _movingBodyCount = 0;
+    _bodiesOutOfBounds.clear();
 
-    // Calculate Penetration
-    glm::vec3 betweenCenters = sphere2->GetGlobalCenter() - sphere1->GetGlobalCenter();
-    float sumOfRadii = sphere2->GetRadius() + sphere1->GetRadius();
-    float distanceCenters = glm::length( betweenCenters );
-    float penetrationDepth = sumOfRadii - distanceCenters + 0.01f;
+    for ( size_t i = 0; i < _rigidbodies.size(); ++i )
+    {
+        RigidBody* rigidBody = _rigidbodies[ i ];
+        SimulationBody& body = _bodies[ i ];
+        if ( !body.IsActive || !body.IsMovable )
+        {
+            continue;
+        }
 
-    // The vector between centers
-    betweenCenters = glm::normalize( betweenCenters );
+        if ( _simulationMode == SimulationMode::Planar )
+        {
+            Simulation::FromPlanar( _planarBodies[ i ], _planeHeight, body );
+        }
 
-    // To handle collisions, we are finding the momentum of each sphere on the line between centers.
-    // We switch the projected momentums between spheres while maintaining the momentum perpendicular to that line.
+        rigidBody->m_v3Velocity = body.Velocity;
+        rigidBody->m_v3Position = body.Position - _bodyOffsets[ i ];
+        rigidBody->transform->SetPosition( rigidBody->m_v3Position );
+        rigidBody->_AtRest = ( body.Velocity == glm::vec3( 0 ) );
 
-    // Find projected velocity of sphere one
-    glm::vec3 velocity1 = sphere1RigidBody->GetVelocity();
-    float x1 = glm::dot(betweenCenters, velocity1);	// The magnitude of the projected velocity.
-    glm::vec3 v1proj = betweenCenters * x1;	// The projected velocity
-    glm::vec3 v1perp = velocity1 - v1proj;	// The velocity perpendicular to the projected velocity. (It does not matter where it points to)
+        RecordMotion( i, rigidBody->m_v3Position, body.Velocity );
+    }
+}
 
-    // Find projected velocity of sphere two
-    glm::vec3 velocity2 = sphere2RigidBody->GetVelocity();
-    float x2 = glm::dot(betweenCenters, velocity2);	// The magnitude of the projected velocity.
-    glm::vec3 v2proj = betweenCenters * x2; // The projected velocity
-    glm::vec3 v2perp = velocity2 - v2proj; // The velocity perpendicular to the projected velocity. (It does not matter where it points to)
+// Records where a movable body ended up after a step
+void Physics::RecordMotion( size_t index, const glm::vec3& position, const glm::vec3& velocity )
+{
+    if ( velocity != glm::vec3( 0 ) )
+    {
+        ++_movingBodyCount;
+    }
 
-    // Find masses
-    float mass1 = sphere1RigidBody->GetMass();
-    float mass2 = sphere2RigidBody->GetMass();
+    if ( _hasTableBounds && ( glm::any( glm::lessThan( position, _tableMin ) ) || glm::any( glm::greaterThan( position, _tableMax ) ) ) )
+    {
+        _bodiesOutOfBounds.push_back( index );
+    }
+}
 
-    float massSum = mass1 + mass2;
-    float massDiff = mass1 - mass2;
+// Fires the events for bodies that left the table and for the table starting or stopping
+void Physics::DispatchNotifications()
+{
+    // Handlers may remove bodies, so this works like dispatching contacts
+    _isDispatchingContacts = true;
 
-    // Find new velocities
-    velocity1 = v1proj * massDiff / massSum + v2proj * (2 * mass2) / massSum + v1perp;
-    velocity2 = v1proj * (2 * mass1) / massSum + v2proj * massDiff / massSum + v2perp;
+    for ( size_t index : _bodiesOutOfBounds )
+    {
+        RigidBody* rigidBody = _rigidbodies[ index ];
+        if ( rigidBody )
+        {
+            _eventListener.FireEvent( "OnBodyLeftTable", rigidBody->GetGameObject() );
+        }
+    }
+    _bodiesOutOfBounds.clear();
 
-    // Sets the new velocities
-    sphere1RigidBody->SetVelocity(velocity1 * 0.9f);
-    sphere2RigidBody->SetVelocity(velocity2 * 0.9f);
+    bool isSettled = ( _movingBodyCount == 0 );
+    if ( isSettled != _isSettled )
+    {
+        _isSettled = isSettled;
+        _eventListener.FireEvent( isSettled ? "OnTableSettled" : "OnTableMoving" );
+    }
 
-    // Moves the spheres so they are no longer colliding
-    sphere1RigidBody->SetPosition( sphere1RigidBody->GetPosition() - betweenCenters * penetrationDepth * 0.5f );
-    sphere2RigidBody->SetPosition( sphere2RigidBody->GetPosition() + betweenCenters * penetrationDepth * 0.5f );
+    _isDispatchingContacts = false;
 }
 
-// Resolves the given collision
-void Physics::ResolveCollision( Collision& collision )
+// Dispatches the "OnCollide" event for every contact
+void Physics::DispatchContacts()
 {
-    switch ( collision._collisionType )
+    _isDispatchingContacts = true;
+
+    for ( auto& contact : _contacts )
     {
-        case CollisionType::Sphere_Sphere:
+        // Either body may have been removed by an earlier event handler
+        RigidBody* lhs = _rigidbodies[ contact.Lhs ];
+        RigidBody* rhs = _rigidbodies[ contact.Rhs ];
+        if ( !lhs || !rhs )
         {
-            // Get the two colliders
-            SphereCollider* sphere1 = static_cast<SphereCollider*>( collision._lhs );
-            SphereCollider* sphere2 = static_cast<SphereCollider*>( collision._rhs );
-
-            ResolveSphereSphereCollision( sphere1, sphere2 );
+            continue;
         }
-        break;
 
-        case CollisionType::Box_Sphere:
-        {
-            SphereCollider* sphere = nullptr;
-            BoxCollider*    box = nullptr;
+        GameObject* lhsObject = lhs->GetGameObject();
+        GameObject* rhsObject = rhs->GetGameObject();
+        lhsObject->GetEventListener()->FireEvent( "OnCollide", rhsObject );
+        rhsObject->GetEventListener()->FireEvent( "OnCollide", lhsObject );
+    }
 
-            // Get the sphere and box colliders
-            switch ( collision._lhs->GetColliderType() )
+    _isDispatchingContacts = false;
+
+    // Now get rid of any bodies that were removed while dispatching
+    if ( _hasRemovedBodies )
+    {
+        size_t count = 0;
+        for ( size_t i = 0; i < _rigidbodies.size(); ++i )
+        {
+            if ( _rigidbodies[ i ] )
             {
-                case ColliderType::Sphere:
-                {
-                    sphere = static_cast<SphereCollider*>( collision._lhs );
-                    box = static_cast<BoxCollider*>( collision._rhs );
-                }
-                break;
-
-                case ColliderType::Box:
-                {
-                    sphere = static_cast<SphereCollider*>( collision._rhs );
-                    box = static_cast<BoxCollider*>( collision._lhs );
-                }
-                break;
+                _rigidbodies[ count ] = _rigidbodies[ i ];
+                _colliders[ count ] = _colliders[ i ];
+                _bodySyncs[ count ] = _bodySyncs[ i ];
+                _rigidbodies[ count ]->_bodyIndex = count;
+                ++count;
             }
-
-            // Resolve the collision
-            ResolveBoxSphereCollision( box, sphere );
         }
-        break;
+        _rigidbodies.resize( count );
+        _colliders.resize( count );
+        _bodySyncs.resize( count );
+        _hasRemovedBodies = false;
     }
 }
 
-// Un-register a rigid body
-void Physics::UnregisterRigidbody(RigidBody* rigidBody)
+// Checks to see if two bodies only differ in how they are moving
+static bool HasSameShape( const SimulationBody& lhs, const SimulationBody& rhs )
 {
+    return lhs.IsActive == rhs.IsActive
+        && lhs.Shape == rhs.Shape
+        && lhs.Radius == rhs.Radius
+        && lhs.HalfSize == rhs.HalfSize
+        && lhs.Mass == rhs.Mass
+        && lhs.IsMovable == rhs.IsMovable
+        && lhs.Mesh == rhs.Mesh;
+}
+
+// Sends the physics thread every change the game has made to the registered rigid bodies
+void Physics::SendChanges( float time )
+{
+    _world.FlushCommands();
+
     for ( size_t i = 0; i < _rigidbodies.size(); ++i )
     {
-        if ( _rigidbodies[ i ] == rigidBody )
+        RigidBody* rigidBody = _rigidbodies[ i ];
+        Collider* collider = _colliders[ i ];
+        BodySync& sync = _bodySyncs[ i ];
+
+        SimulationBody body;
+        if ( !collider || !rigidBody->GetGameObject()->IsActiveInHierarchy() )
+        {
+            body.Id = rigidBody->_bodyId;
+            body.IsActive = false;
+        }
+        else
+        {
+            ReadBody( rigidBody, collider, body );
+        }
+
+        // We wrote the transform and velocity ourselves last time, so any difference means the game changed them
+        glm::vec3 transformPosition = rigidBody->transform->GetPosition();
+        bool isChanged = sync.IsNew || !HasSameShape( body, sync.Body );
+        if ( body.IsActive )
         {
-            _rigidbodies.erase( _rigidbodies.begin() + i );
-            _colliders.erase( _colliders.begin() + i );
+            isChanged = isChanged || transformPosition != sync.TransformPosition || body.Velocity != sync.Body.Velocity;
+        }
+
+        if ( isChanged )
+        {
+            PhysicsCommand command;
+            command.Type = sync.IsNew ? PhysicsCommandType::AddBody : PhysicsCommandType::SetBody;
+            command.Body = body;
+
+            sync.Sequence = _world.Push( command );
+            sync.Body = body;
+            sync.Offset = body.Position - transformPosition;
+            sync.TransformPosition = transformPosition;
+            sync.IsNew = false;
+        }
+
+        // Forces are sent as a change in velocity, as the physics thread's velocity is newer than ours
+        if ( body.IsActive && rigidBody->_IsMovable && rigidBody->m_v3Acceleration != glm::vec3( 0 ) )
+        {
+            PhysicsCommand command;
+            command.Type = PhysicsCommandType::AddVelocity;
+            command.Body.Id = body.Id;
+            command.Vector = rigidBody->m_v3Acceleration * time;
+            _world.Push( command );
 
-            _octree.Rebuild( _colliders );
-            break;
+            rigidBody->m_v3Acceleration = glm::vec3( 0 );
         }
     }
 }
 
-// Updates the physics system
-void Physics::Update()
+// Writes the newest frame from the physics thread out to the registered rigid bodies
+bool Physics::ReceiveFrame()
 {
-    float time = Time::GetElapsedTime();
-    Collision collision( nullptr, nullptr, CollisionType::Sphere_Sphere );
+    const PhysicsFrame* frame = _world.AcquireFrame();
+    if ( !frame )
+    {
+        return false;
+    }
 
+    _movingBodyCount = 0;
+    _bodiesOutOfBounds.clear();
 
-    for (unsigned int i = 0; i < _rigidbodies.size() - 1; i++)
+    for ( auto& published : frame->Bodies )
     {
-        RigidBody* thisRigidBody = _rigidbodies[i];
-        Collider* thisCollider = thisRigidBody->GetGameObject()->GetComponentOfType<Collider>();
-        collision._lhs = thisCollider;
-
-        // List of collisions with rest of list 
-        for (unsigned int j = i + 1; j < _rigidbodies.size(); j++)
+        auto search = _bodiesById.find( published.Id );
+        if ( search == _bodiesById.end() )
         {
-            RigidBody* otherRigidBody = _rigidbodies[j];
+            continue;
+        }
 
-            // Check the others
-            Collider* otherCollider = otherRigidBody->GetGameObject()->GetComponentOfType<Collider>();
-            collision._rhs = otherCollider;
+        RigidBody* rigidBody = search->second;
+        BodySync& sync = _bodySyncs[ rigidBody->_bodyIndex ];
 
-            // Checks if collides
-            if ( thisCollider->CollidesWith( otherCollider ) )
-            {
-                collision._collisionType = GetCollisionType( collision._lhs, collision._rhs );
-                ResolveCollision( collision );
+        if ( sync.IsNew || !sync.Body.IsActive || !sync.Body.IsMovable )
+        {
+            continue;
+        }
 
-                thisCollider->GetGameObject()->GetEventListener()->FireEvent( "OnCollide", otherCollider->GetGameObject() );
-                otherCollider->GetGameObject()->GetEventListener()->FireEvent( "OnCollide", thisCollider->GetGameObject() );
+        // Bodies the game changed after the frame was stepped would have the change undone by it
+        if ( static_cast<int>( frame->Sequence - sync.Sequence ) >= 0 )
+        {
+            rigidBody->m_v3Velocity = published.Velocity;
+            rigidBody->m_v3Position = published.Position - sync.Offset;
+            rigidBody->transform->SetPosition( rigidBody->m_v3Position );
+            rigidBody->_AtRest = ( published.Velocity == glm::vec3( 0 ) );
+
+            sync.Body.Position = published.Position;
+            sync.Body.Velocity = published.Velocity;
+            sync.TransformPosition = rigidBody->m_v3Position;
+        }
 
-                break;
-            }
+        RecordMotion( rigidBody->_bodyIndex, rigidBody->m_v3Position, rigidBody->m_v3Velocity );
+    }
+
+    // The frame may cover several steps, so only report each touching pair once
+    _contacts.clear();
+    for ( auto& contact : frame->Contacts )
+    {
+        auto lhs = _bodiesById.find( contact.Lhs );
+        auto rhs = _bodiesById.find( contact.Rhs );
+        if ( lhs != _bodiesById.end() && rhs != _bodiesById.end() )
+        {
+            SimulationContact indices = { static_cast<unsigned int>( lhs->second->_bodyIndex ), static_cast<unsigned int>( rhs->second->_bodyIndex ) };
+            _contacts.push_back( indices );
         }
     }
+    std::sort( _contacts.begin(), _contacts.end(), []( const SimulationContact& lhs, const SimulationContact& rhs )
+    {
+        return lhs.Lhs < rhs.Lhs || ( lhs.Lhs == rhs.Lhs && lhs.Rhs < rhs.Rhs );
+    } );
+    _contacts.erase( std::unique( _contacts.begin(), _contacts.end(), []( const SimulationContact& lhs, const SimulationContact& rhs )
+    {
+        return lhs.Lhs == rhs.Lhs && lhs.Rhs == rhs.Rhs;
+    } ), _contacts.end() );
 
-    // Build the octree if this is our first time
-    static bool isFirstUpdate = true;
-    if ( isFirstUpdate )
+    return true;
+}
+
+// Sends the simulation mode and plane height to the physics thread
+void Physics::SendMode()
+{
+    if ( _world.IsRunning() )
     {
-        _octree.Rebuild( _colliders );
-        isFirstUpdate = false;
+        PhysicsCommand command;
+        command.Type = PhysicsCommandType::SetMode;
+        command.Mode = _simulationMode;
+        command.PlaneHeight = _planeHeight;
+        _world.Push( command );
     }
+}
+
+// Checks to see if the simulation is being stepped on its own thread
+bool Physics::IsThreaded()
+{
+    return _world.IsRunning();
+}
 
-    for ( size_t i = 0; i < _colliders.size(); ++i )
+// Starts stepping the simulation on its own thread
+void Physics::StartThread( float timeStep )
+{
+    if ( _world.IsRunning() )
     {
-        // Get the first collider
-        collision._lhs = _colliders[ i ];
+        return;
+    }
 
-        // If we're colliding according to the octree
-        if ( _octree.IsColliding( collision._lhs, &( collision._rhs ) ) )
-        {
-            // Get the collision type
-            collision._collisionType = GetCollisionType( collision._lhs, collision._rhs );
+    _world.Start( timeStep );
+    SendMode();
+
+    // Every body already registered has to be sent to the new thread
+    for ( auto& sync : _bodySyncs )
+    {
+        sync.IsNew = true;
+    }
+}
+
+// Stops the physics thread
+void Physics::StopThread()
+{
+    _world.Stop();
+}
 
-            // Resolve the collision
-            ResolveCollision( collision );
+// Updates the physics system
+void Physics::Update()
+{
+    float time = Time::GetElapsedTime();
 
-            // Dispatch the "OnCollide" event
-            collision._lhs->GetGameObject()->GetEventListener()->FireEvent( "OnCollide", collision._rhs );
-            collision._rhs->GetGameObject()->GetEventListener()->FireEvent( "OnCollide", collision._lhs );
+    if ( _world.IsRunning() )
+    {
+        // Swap changes and results with the physics thread, which steps on its own
+        SendChanges( time );
+        if ( ReceiveFrame() )
+        {
+            DispatchNotifications();
+            DispatchContacts();
+        }
+    }
+    else
+    {
+        // Step the simulation on a copy of every body, then write the results back out
+        GatherBodies( time );
 
-            // Rebuild the octree
-            _octree.Rebuild( _colliders );
+        _contacts.clear();
+        if ( _simulationMode == SimulationMode::Planar )
+        {
+            Simulation::Step( _planarBodies, time, &_contacts, _contactCache );
+        }
+        else
+        {
+            Simulation::Step( _bodies, time, &_contacts, _contactCache );
         }
+
+        ScatterBodies();
+        DispatchNotifications();
+        DispatchContacts();
     }
 
     // Rebuild the octree
     _octree.Rebuild( _colliders );
-}
+    _isOctreeDirty = false;
+}
\ No newline at end of file
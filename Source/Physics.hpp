@@ -5,15 +5,59 @@
 #include <set>
 #include <vector>
 #include "Collider.hpp"
+#include "EventListener.hpp"
 #include "Octree.hpp"
+#include "PhysicsWorld.hpp"
+#include "Simulation.hpp"
+#include <unordered_map>
 
 class Collider;
 class BoxCollider;
+class MeshCollider;
 class SphereCollider;
 class RigidBody;
 
 #define EnumOR(a, b) ( static_cast<unsigned>( a ) | static_cast<unsigned>( b ) )
 
+/// <summary>
+/// Defines a ray for use with the scene queries.
+/// </summary>
+struct PhysicsRay
+{
+    glm::vec3 Origin;
+    glm::vec3 Direction;
+    float     MaxDistance;
+
+    /// <summary>
+    /// Creates a new, empty ray.
+    /// </summary>
+    PhysicsRay();
+
+    /// <summary>
+    /// Creates a new ray.
+    /// </summary>
+    /// <param name="origin">The ray's origin.</param>
+    /// <param name="direction">The ray's direction. Does not need to be normalized.</param>
+    /// <param name="maxDistance">The furthest the ray can hit something.</param>
+    PhysicsRay( const glm::vec3& origin, const glm::vec3& direction, float maxDistance );
+};
+
+/// <summary>
+/// Defines where a scene query hit something.
+/// </summary>
+struct RaycastHit
+{
+    Collider* HitCollider; // The collider that was hit, or null if nothing was
+    glm::vec3 Point;       // The point on the collider that was hit
+    glm::vec3 Normal;      // The collider's normal at the point that was hit
+    float     Distance;    // How far along the query's direction the hit was
+
+    /// <summary>
+    /// Creates a new, empty hit.
+    /// </summary>
+    RaycastHit();
+};
+
 /// <summary>
 /// Defines a static class used for physics constants and methods.
 /// </summary>
@@ -28,53 +72,159 @@ class Physics
     {
         Sphere_Sphere = EnumOR( ColliderType::Sphere, ColliderType::Sphere ),
         Box_Sphere    = EnumOR( ColliderType::Box, ColliderType::Sphere ),
-        Box_Box       = EnumOR( ColliderType::Box, ColliderType::Box )
+        Box_Box       = EnumOR( ColliderType::Box, ColliderType::Box ),
+        Box_Mesh      = EnumOR( ColliderType::Box, ColliderType::Mesh ),
+        Mesh_Sphere   = EnumOR( ColliderType::Mesh, ColliderType::Sphere )
     };
 
+private:
     /// <summary>
-    /// Defines a container for collision information.
+    /// Defines what the physics thread was last told about a body, used to spot the changes the game makes.
     /// </summary>
-    struct Collision
+    struct BodySync
     {
-        Collider* _lhs;
-        Collider* _rhs;
-        CollisionType _collisionType;
+        SimulationBody Body;
+        glm::vec3      Offset;            // The body's position relative to its transform
+        glm::vec3      TransformPosition; // The transform position the body was last synced with
+        unsigned int   Sequence;          // The command that last replaced the body
+        bool           IsNew;             // True until the body has been added to the physics thread
 
-        Collision( Collider* lhs, Collider* rhs, CollisionType collisionType);
+        /// <summary>
+        /// Creates a new body sync.
+        /// </summary>
+        BodySync();
     };
 
-private:
     static std::vector<glm::vec3> _lhsCorners;
     static std::vector<glm::vec3> _rhsCorners;
     static std::vector<RigidBody*> _rigidbodies;
     static std::vector<Collider*> _colliders;
+    static std::vector<BodySync> _bodySyncs;
+    static std::unordered_map<unsigned int, RigidBody*> _bodiesById;
+    static std::vector<SimulationBody> _bodies;
+    static std::vector<PlanarBody> _planarBodies;
+    static std::vector<glm::vec3> _bodyOffsets;
+    static std::vector<Collider*> _queryColliders;
+    static std::vector<Collider*> _rayColliders;
+    static std::vector<glm::vec3> _queryBounds;
+    static std::vector<SimulationContact> _contacts;
+    static std::vector<size_t> _bodiesOutOfBounds;
+    static ContactCache _contactCache;
+    static unsigned int _nextBodyId;
+    static SimulationMode _simulationMode;
+    static float _planeHeight;
+    static bool _isDispatchingContacts;
+    static bool _hasRemovedBodies;
+    static bool _isOctreeDirty;
+    static bool _isSettled;
+    static bool _hasTableBounds;
+    static size_t _movingBodyCount;
+    static glm::vec3 _tableMin;
+    static glm::vec3 _tableMax;
+    static EventListener _eventListener;
     static Octree _octree;
+    static PhysicsWorld _world;
+
+    /// <summary>
+    /// Reads a rigid body's current state.
+    /// </summary>
+    /// <param name="rigidBody">The rigid body.</param>
+    /// <param name="collider">The rigid body's collider.</param>
+    /// <param name="body">The body to fill out.</param>
+    static void ReadBody( RigidBody* rigidBody, Collider* collider, SimulationBody& body );
+
+    /// <summary>
+    /// Gathers the state of every registered rigid body into the simulation's bodies.
+    /// </summary>
+    /// <param name="time">The time step.</param>
+    static void GatherBodies( float time );
+
+    /// <summary>
+    /// Writes the simulation's bodies back out to the registered rigid bodies.
+    /// </summary>
+    static void ScatterBodies();
+
+    /// <summary>
+    /// Dispatches the "OnCollide" event for every contact found this step.
+    /// </summary>
+    static void DispatchContacts();
 
     /// <summary>
-    /// Resolves box <--> sphere collision.
+    /// Fires the "OnBodyLeftTable" event for every body that left the table this step, and the
+    /// "OnTableMoving" or "OnTableSettled" event if the table started or stopped moving.
     /// </summary>
-    /// <param name="box">The box collider.</param>
-    /// <param name="sphere">The sphere collider.</param>
-    static void ResolveBoxSphereCollision( BoxCollider* box, SphereCollider* sphere );
+    static void DispatchNotifications();
 
     /// <summary>
-    /// Resolves sphere <--> sphere collision.
+    /// Records where a movable body ended up after a step.
     /// </summary>
-    /// <param name="sphere1">The first sphere.</param>
-    /// <param name="sphere2">The second sphere.</param>
-    static void ResolveSphereSphereCollision( SphereCollider* sphere1, SphereCollider* sphere2 );
+    /// <param name="index">The body's index.</param>
+    /// <param name="position">The body's position.</param>
+    /// <param name="velocity">The body's velocity.</param>
+    static void RecordMotion( size_t index, const glm::vec3& position, const glm::vec3& velocity );
 
     /// <summary>
-    /// Resolves the given collision.
+    /// Sends the physics thread every change the game has made to the registered rigid bodies.
     /// </summary>
-    /// <param name="collision">The collision to resolve.</param>
-    static void ResolveCollision( Collision& collision );
+    /// <param name="time">The time since the last frame, used to apply forces.</param>
+    static void SendChanges( float time );
+
+    /// <summary>
+    /// Writes the newest frame from the physics thread out to the registered rigid bodies.
+    /// </summary>
+    /// <returns>True if there was a new frame, false if not.</returns>
+    static bool ReceiveFrame();
+
+    /// <summary>
+    /// Sends the simulation mode and plane height to the physics thread.
+    /// </summary>
+    static void SendMode();
+
+    /// <summary>
+    /// Removes the body at the given index by moving the last body into its place.
+    /// </summary>
+    /// <param name="index">The body's index.</param>
+    static void RemoveBodyAt( size_t index );
+
+    /// <summary>
+    /// Rebuilds the octree if any bodies have been removed since it was last built.
+    /// </summary>
+    static void UpdateOctree();
 
     /// <summary>
     /// Gets the collision type between two colliders.
     /// </summary>
     static CollisionType GetCollisionType( Collider* a, Collider* b );
 
+    /// <summary>
+    /// Checks to see if a collider is only ever passed through (e.g. a pocket).
+    /// </summary>
+    /// <param name="collider">The collider.</param>
+    static bool IsTrigger( Collider* collider );
+
+    /// <summary>
+    /// Sweeps a sphere against a single collider. Colliders the sphere starts out inside are never hit.
+    /// </summary>
+    /// <param name="collider">The collider.</param>
+    /// <param name="start">The sphere's starting center.</param>
+    /// <param name="delta">The vector from the sphere's starting center to its ending center.</param>
+    /// <param name="radius">The sphere's radius. Zero casts a ray.</param>
+    /// <param name="time">Receives how far along the sweep, from 0 to 1, the collider was hit.</param>
+    /// <param name="point">Receives the point on the collider that was hit.</param>
+    /// <param name="normal">Receives the collider's normal at the point that was hit.</param>
+    static bool CastCollider( Collider* collider, const glm::vec3& start, const glm::vec3& delta, float radius, float& time, glm::vec3& point, glm::vec3& normal );
+
+    /// <summary>
+    /// Sweeps a sphere against the given colliders, finding the first one it hits.
+    /// </summary>
+    /// <param name="colliders">The colliders.</param>
+    /// <param name="start">The sphere's starting center.</param>
+    /// <param name="delta">The vector from the sphere's starting center to its ending center.</param>
+    /// <param name="radius">The sphere's radius. Zero casts a ray.</param>
+    /// <param name="hitTriggers">True to hit triggers, false to pass through them.</param>
+    /// <param name="hit">Receives the hit.</param>
+    static bool CastClosest( const std::vector<Collider*>& colliders, const glm::vec3& start, const glm::vec3& delta, float radius, bool hitTriggers, RaycastHit& hit );
+
 public:
     /// <summary>
     /// Checks for box <--> box collision.
@@ -90,6 +240,20 @@ public:
     /// <param name="rhs">The sphere.</param>
     static bool AreColliding( BoxCollider* lhs, SphereCollider* rhs );
 
+    /// <summary>
+    /// Checks for box <--> mesh collision. Only the mesh's bounds are tested.
+    /// </summary>
+    /// <param name="lhs">The box.</param>
+    /// <param name="rhs">The mesh.</param>
+    static bool AreColliding( BoxCollider* lhs, MeshCollider* rhs );
+
+    /// <summary>
+    /// Checks for mesh <--> sphere collision.
+    /// </summary>
+    /// <param name="lhs">The mesh.</param>
+    /// <param name="rhs">The sphere.</param>
+    static bool AreColliding( MeshCollider* lhs, SphereCollider* rhs );
+
     /// <summary>
     /// Checks for sphere <--> sphere collision.
     /// </summary>
@@ -98,7 +262,101 @@ public:
     static bool AreColliding( SphereCollider* lhs, SphereCollider* rhs );
 
     /// <summary>
-    /// Registers a rigid body to be managed by physics.
+    /// Captures a snapshot of every registered body for use with the simulation kernels.
+    /// </summary>
+    /// <param name="bodies">The list to receive the bodies.</param>
+    /// <param name="owners">The list to receive the rigid body each snapshot body came from.</param>
+    static void CaptureSnapshot( std::vector<SimulationBody>& bodies, std::vector<RigidBody*>& owners );
+
+    /// <summary>
+    /// Gets the listener for the table-wide events: "OnTableMoving" and "OnTableSettled", which take no
+    /// arguments, and "OnBodyLeftTable", which takes the body's GameObject*.
+    /// </summary>
+    static EventListener* GetEventListener();
+
+    /// <summary>
+    /// Gets the height of the table plane used by the planar simulation mode.
+    /// </summary>
+    static float GetPlaneHeight();
+
+    /// <summary>
+    /// Checks to see if every movable body on the table has stopped.
+    /// </summary>
+    static bool IsSettled();
+
+    /// <summary>
+    /// Checks to see if the simulation is being stepped on its own thread.
+    /// </summary>
+    static bool IsThreaded();
+
+    /// <summary>
+    /// Finds every collider whose bounds overlap the given box. Spheres are tested exactly.
+    /// </summary>
+    /// <param name="min">The box's minimum point.</param>
+    /// <param name="max">The box's maximum point.</param>
+    /// <param name="colliders">The list to receive the colliders.</param>
+    /// <param name="hitTriggers">True to include triggers, false to leave them out.</param>
+    /// <returns>The number of colliders found.</returns>
+    static size_t OverlapBox( const glm::vec3& min, const glm::vec3& max, std::vector<Collider*>& colliders, bool hitTriggers = false );
+
+    /// <summary>
+    /// Casts a ray, finding the first collider it hits.
+    /// </summary>
+    /// <param name="origin">The ray's origin.</param>
+    /// <param name="direction">The ray's direction. Does not need to be normalized.</param>
+    /// <param name="maxDistance">The furthest the ray can hit something.</param>
+    /// <param name="hit">Receives the hit.</param>
+    /// <param name="hitTriggers">True to hit triggers, false to pass through them.</param>
+    /// <returns>True if something was hit, false if not.</returns>
+    static bool Raycast( const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RaycastHit& hit, bool hitTriggers = false );
+
+    /// <summary>
+    /// Casts a batch of rays, walking the octree once for the whole batch.
+    /// </summary>
+    /// <param name="rays">The rays.</param>
+    /// <param name="hits">Receives one hit per ray. Rays that hit nothing get a null collider.</param>
+    /// <param name="hitTriggers">True to hit triggers, false to pass through them.</param>
+    /// <returns>The number of rays that hit something.</returns>
+    static size_t Raycast( const std::vector<PhysicsRay>& rays, std::vector<RaycastHit>& hits, bool hitTriggers = false );
+
+    /// <summary>
+    /// Casts a sphere, finding the first collider it hits.
+    /// </summary>
+    /// <param name="origin">The sphere's starting center.</param>
+    /// <param name="radius">The sphere's radius.</param>
+    /// <param name="direction">The direction to cast in. Does not need to be normalized.</param>
+    /// <param name="maxDistance">The furthest the sphere can travel.</param>
+    /// <param name="hit">Receives the hit.</param>
+    /// <param name="hitTriggers">True to hit triggers, false to pass through them.</param>
+    /// <returns>True if something was hit, false if not.</returns>
+    static bool SphereCast( const glm::vec3& origin, float radius, const glm::vec3& direction, float maxDistance, RaycastHit& hit, bool hitTriggers = false );
+
+    /// <summary>
+    /// Gets the current simulation mode.
+    /// </summary>
+    static SimulationMode GetSimulationMode();
+
+    /// <summary>
+    /// Sets the height of the table plane used by the planar simulation mode.
+    /// </summary>
+    /// <param name="height">The new plane height.</param>
+    static void SetPlaneHeight( float height );
+
+    /// <summary>
+    /// Sets the bounds of the table. Movable bodies that end a step outside of them fire "OnBodyLeftTable".
+    /// </summary>
+    /// <param name="min">The bounds' minimum point.</param>
+    /// <param name="max">The bounds' maximum point.</param>
+    static void SetTableBounds( const glm::vec3& min, const glm::vec3& max );
+
+    /// <summary>
+    /// Sets the current simulation mode.
+    /// </summary>
+    /// <param name="mode">The new simulation mode.</param>
+    static void SetSimulationMode( SimulationMode mode );
+
+    /// <summary>
+    /// Registers a rigid body to be managed by physics. Rigid bodies that are already registered are left alone.
     /// </summary>
     /// <param name="rigidBody">The rigid body.</param>
     static void RegisterRigidbody( RigidBody* rigidBody );
@@ -109,6 +367,18 @@ public:
     /// <param name="rigidBody">The rigid body.</param>
     static void UnregisterRigidbody( RigidBody* rigidBody );
 
+    /// <summary>
+    /// Starts stepping the simulation on its own thread at a fixed rate. Update then only exchanges
+    /// changes and results with the thread, so a slow step never holds up a frame.
+    /// </summary>
+    /// <param name="timeStep">The time, in seconds, each step covers.</param>
+    static void StartThread( float timeStep = 1.0f / 120.0f );
+
+    /// <summary>
+    /// Stops the physics thread, going back to stepping the simulation once per Update.
+    /// </summary>
+    static void StopThread();
+
     /// <summary>
     /// Updates the physics system.
     /// </summary>
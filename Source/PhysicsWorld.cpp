@@ -0,0 +1,281 @@
+#include "PhysicsWorld.hpp"
+#include <chrono>
+
+const size_t PhysicsWorld::CommandCapacity = 4096;
+
+// Create a new physics command
+PhysicsCommand::PhysicsCommand()
+    : Type( PhysicsCommandType::SetBody )
+    , Sequence( 0 )
+    , Vector( 0, 0, 0 )
+    , Mode( SimulationMode::Spatial )
+    , PlaneHeight( 0 )
+{
+}
+
+// Create a new, empty frame
+PhysicsFrame::PhysicsFrame()
+    : Sequence( 0 )
+{
+}
+
+// Create a new, stopped physics world
+PhysicsWorld::PhysicsWorld()
+    : _nextSequence( 0 )
+    , _commands( CommandCapacity )
+    , _isRunning( false )
+    , _simulationMode( SimulationMode::Spatial )
+    , _planeHeight( 0 )
+    , _timeStep( 0 )
+    , _appliedSequence( 0 )
+    , _isBackUnread( false )
+{
+}
+
+// Destroy this physics world
+PhysicsWorld::~PhysicsWorld()
+{
+    Stop();
+}
+
+// Get the newest frame published since the last call
+const PhysicsFrame* PhysicsWorld::AcquireFrame()
+{
+    if ( !_frames.Acquire() )
+    {
+        return nullptr;
+    }
+    return &_frames.GetFront();
+}
+
+// Apply a single command
+void PhysicsWorld::ApplyCommand( const PhysicsCommand& command )
+{
+    _appliedSequence = command.Sequence;
+
+    if ( command.Type == PhysicsCommandType::AddBody )
+    {
+        _bodyIndices[ command.Body.Id ] = _bodies.size();
+        _bodies.push_back( command.Body );
+        return;
+    }
+
+    if ( command.Type == PhysicsCommandType::SetMode )
+    {
+        _simulationMode = command.Mode;
+        _planeHeight = command.PlaneHeight;
+        return;
+    }
+
+    auto search = _bodyIndices.find( command.Body.Id );
+    if ( search == _bodyIndices.end() )
+    {
+        return;
+    }
+    size_t index = search->second;
+
+    switch ( command.Type )
+    {
+        case PhysicsCommandType::RemoveBody:
+        {
+            // Move the last body into the removed body's place
+            size_t last = _bodies.size() - 1;
+            if ( index != last )
+            {
+                _bodies[ index ] = _bodies[ last ];
+                _bodyIndices[ _bodies[ index ].Id ] = index;
+            }
+            _bodies.pop_back();
+            _bodyIndices.erase( search );
+        }
+        break;
+
+        case PhysicsCommandType::SetBody:
+        {
+            _bodies[ index ] = command.Body;
+        }
+        break;
+
+        case PhysicsCommandType::AddVelocity:
+        {
+            if ( _bodies[ index ].IsMovable )
+            {
+                _bodies[ index ].Velocity += command.Vector;
+            }
+        }
+        break;
+
+        default:
+        {
+            // AddBody and SetMode are handled before the body is looked up
+        }
+        break;
+    }
+}
+
+// Apply every command waiting in the queue
+void PhysicsWorld::ApplyCommands()
+{
+    PhysicsCommand command;
+    while ( _commands.TryPop( command ) )
+    {
+        ApplyCommand( command );
+    }
+}
+
+// Send any commands held back because the queue was full
+void PhysicsWorld::FlushCommands()
+{
+    size_t count = 0;
+    while ( count < _overflow.size() && _commands.TryPush( _overflow[ count ] ) )
+    {
+        ++count;
+    }
+    _overflow.erase( _overflow.begin(), _overflow.begin() + count );
+}
+
+// Check to see if the physics thread is running
+bool PhysicsWorld::IsRunning() const
+{
+    return _isRunning;
+}
+
+// Publish the results of the last step
+void PhysicsWorld::Publish()
+{
+    PhysicsFrame& frame = _frames.GetBack();
+
+    // A frame the game never read still holds contacts it hasn't seen, so add to them instead
+    if ( !_isBackUnread )
+    {
+        frame.Contacts.clear();
+    }
+    for ( auto& contact : _contacts )
+    {
+        SimulationContact published = { _bodies[ contact.Lhs ].Id, _bodies[ contact.Rhs ].Id };
+        frame.Contacts.push_back( published );
+    }
+
+    frame.Bodies.resize( _bodies.size() );
+    for ( size_t i = 0; i < _bodies.size(); ++i )
+    {
+        PublishedBody& published = frame.Bodies[ i ];
+        published.Id = _bodies[ i ].Id;
+        published.Position = _bodies[ i ].Position;
+        published.Velocity = _bodies[ i ].Velocity;
+    }
+    frame.Sequence = _appliedSequence;
+
+    _isBackUnread = _frames.Publish();
+}
+
+// Send a command to the physics thread
+unsigned int PhysicsWorld::Push( PhysicsCommand command )
+{
+    command.Sequence = ++_nextSequence;
+
+    // Keep commands in order by holding this one back too if anything is already waiting
+    FlushCommands();
+    if ( !_overflow.empty() || !_commands.TryPush( command ) )
+    {
+        _overflow.push_back( command );
+    }
+
+    return command.Sequence;
+}
+
+// Run the physics thread
+void PhysicsWorld::Run()
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration stepDuration = std::chrono::duration_cast<Clock::duration>( std::chrono::duration<float>( _timeStep ) );
+    Clock::time_point nextStep = Clock::now();
+
+    while ( _isRunning )
+    {
+        ApplyCommands();
+        Step();
+        Publish();
+
+        // Falling behind (e.g. during a big break) slows the table down rather than stepping ever faster to catch up
+        nextStep += stepDuration;
+        Clock::time_point now = Clock::now();
+        if ( now > nextStep )
+        {
+            nextStep = now;
+        }
+        else
+        {
+            std::this_thread::sleep_until( nextStep );
+        }
+    }
+}
+
+// Start the physics thread
+void PhysicsWorld::Start( float timeStep )
+{
+    if ( _isRunning )
+    {
+        return;
+    }
+
+    _bodies.clear();
+    _planarBodies.clear();
+    _bodyIndices.clear();
+    _contacts.clear();
+    _contactCache.Clear();
+    _simulationMode = SimulationMode::Spatial;
+    _planeHeight = 0.0f;
+    _timeStep = timeStep;
+    _appliedSequence = _nextSequence;
+    _isBackUnread = false;
+
+    _isRunning = true;
+    _thread = std::thread( &PhysicsWorld::Run, this );
+}
+
+// Step the simulation once
+void PhysicsWorld::Step()
+{
+    _contacts.clear();
+
+    if ( _simulationMode == SimulationMode::Planar )
+    {
+        _planarBodies.resize( _bodies.size() );
+        for ( size_t i = 0; i < _bodies.size(); ++i )
+        {
+            _planarBodies[ i ] = Simulation::ToPlanar( _bodies[ i ], _planeHeight );
+        }
+
+        Simulation::Step( _planarBodies, _timeStep, &_contacts, _contactCache );
+
+        for ( size_t i = 0; i < _bodies.size(); ++i )
+        {
+            Simulation::FromPlanar( _planarBodies[ i ], _planeHeight, _bodies[ i ] );
+        }
+    }
+    else
+    {
+        Simulation::Step( _bodies, _timeStep, &_contacts, _contactCache );
+    }
+}
+
+// Stop the physics thread
+void PhysicsWorld::Stop()
+{
+    if ( !_isRunning )
+    {
+        return;
+    }
+
+    _isRunning = false;
+    _thread.join();
+
+    // Nothing is left to read the queue or write frames, so throw away whatever is still in flight
+    PhysicsCommand command;
+    while ( _commands.TryPop( command ) )
+    {
+    }
+    _overflow.clear();
+    _frames.Acquire();
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "Config.hpp"
+#include "LockFreeQueue.hpp"
+#include "Simulation.hpp"
+#include "TripleBuffer.hpp"
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// An enumeration of possible physics commands.
+/// </summary>
+enum class PhysicsCommandType
+{
+    AddBody,     // Adds Body to the simulation
+    RemoveBody,  // Removes the body with Body.Id
+    SetBody,     // Replaces the body with Body.Id, e.g. after the game moved it
+    AddVelocity, // Adds Vector to the velocity of the body with Body.Id
+    SetMode      // Changes the simulation mode and plane height
+};
+
+/// <summary>
+/// Defines a change the game makes to the simulation.
+/// </summary>
+struct PhysicsCommand
+{
+    PhysicsCommandType Type;
+    unsigned int       Sequence; // Given out by the world in the order commands are pushed
+    SimulationBody     Body;
+    glm::vec3          Vector;
+    SimulationMode     Mode;
+    float              PlaneHeight;
+
+    /// <summary>
+    /// Creates a new physics command.
+    /// </summary>
+    PhysicsCommand();
+};
+
+/// <summary>
+/// Defines the motion of a single body at the end of a step.
+/// </summary>
+struct PublishedBody
+{
+    unsigned int Id;
+    glm::vec3    Position;
+    glm::vec3    Velocity;
+};
+
+/// <summary>
+/// Defines the results the simulation publishes after each step.
+/// </summary>
+struct PhysicsFrame
+{
+    std::vector<PublishedBody>     Bodies;
+    std::vector<SimulationContact> Contacts; // Holds body IDs rather than indices, covering every step since the last frame was read
+    unsigned int                   Sequence; // The last command applied before the frame was stepped
+
+    /// <summary>
+    /// Creates a new, empty frame.
+    /// </summary>
+    PhysicsFrame();
+};
+
+/// <summary>
+/// Defines a copy of the table that is stepped on its own thread at a fixed rate. The game thread
+/// sends it commands through a lock-free queue and reads the results back through a lock-free triple
+/// buffer, so neither thread ever waits on the other.
+/// </summary>
+class PhysicsWorld
+{
+    ImplementNonCopyableClass( PhysicsWorld );
+    ImplementNonMovableClass( PhysicsWorld );
+
+    // Only touched by the game thread
+    std::vector<PhysicsCommand> _overflow; // Commands that didn't fit in the queue, sent first next time
+    unsigned int _nextSequence;
+
+    // Shared between the threads
+    LockFreeQueue<PhysicsCommand> _commands;
+    TripleBuffer<PhysicsFrame> _frames;
+    std::atomic<bool> _isRunning;
+    std::thread _thread;
+
+    // Only touched by the physics thread while it runs
+    std::vector<SimulationBody> _bodies;
+    std::vector<PlanarBody> _planarBodies;
+    std::unordered_map<unsigned int, size_t> _bodyIndices;
+    std::vector<SimulationContact> _contacts;
+    ContactCache _contactCache;
+    SimulationMode _simulationMode;
+    float _planeHeight;
+    float _timeStep;
+    unsigned int _appliedSequence;
+    bool _isBackUnread; // True when the back frame was never read, so its contacts must be kept
+
+    /// <summary>
+    /// Applies a single command.
+    /// </summary>
+    /// <param name="command">The command.</param>
+    void ApplyCommand( const PhysicsCommand& command );
+
+    /// <summary>
+    /// Applies every command waiting in the queue.
+    /// </summary>
+    void ApplyCommands();
+
+    /// <summary>
+    /// Publishes the results of the last step.
+    /// </summary>
+    void Publish();
+
+    /// <summary>
+    /// Runs the physics thread.
+    /// </summary>
+    void Run();
+
+    /// <summary>
+    /// Steps the simulation once.
+    /// </summary>
+    void Step();
+
+public:
+    /// <summary>
+    /// The number of commands that can be waiting at once before they are held back on the game thread.
+    /// </summary>
+    static const size_t CommandCapacity;
+
+    /// <summary>
+    /// Creates a new, stopped physics world.
+    /// </summary>
+    PhysicsWorld();
+
+    /// <summary>
+    /// Destroys this physics world, stopping its thread.
+    /// </summary>
+    ~PhysicsWorld();
+
+    /// <summary>
+    /// Gets the newest frame published since the last call. Only call this from the game thread.
+    /// </summary>
+    /// <returns>The frame, or null if nothing new has been published.</returns>
+    const PhysicsFrame* AcquireFrame();
+
+    /// <summary>
+    /// Sends any commands held back because the queue was full. Only call this from the game thread.
+    /// </summary>
+    void FlushCommands();
+
+    /// <summary>
+    /// Checks to see if the physics thread is running.
+    /// </summary>
+    bool IsRunning() const;
+
+    /// <summary>
+    /// Sends a command to the physics thread. Only call this from the game thread.
+    /// </summary>
+    /// <param name="command">The command.</param>
+    /// <returns>The command's sequence number.</returns>
+    unsigned int Push( PhysicsCommand command );
+
+    /// <summary>
+    /// Starts the physics thread with an empty table.
+    /// </summary>
+    /// <param name="timeStep">The time, in seconds, each step covers.</param>
+    void Start( float timeStep );
+
+    /// <summary>
+    /// Stops the physics thread, dropping any commands it has not applied yet.
+    /// </summary>
+    void Stop();
+};
@@ -4,59 +4,23 @@
 #include "MeshRenderer.hpp"
 #include "TextRenderer.hpp"
 #include "LineRenderer.hpp"
-#include <vector>
 
 /// <summary>
-/// Defines a render manager.
+/// Defines a render manager. Renderers are drawn straight out of their component pools.
 /// </summary>
 class RenderManager
 {
     ImplementStaticClass( RenderManager );
 
 private:
-    static std::vector<MeshRenderer*> _meshRenderers;
-    static std::vector<TextRenderer*> _textRenderers;
-	static std::vector<LineRenderer*> _lineRenderers;
-
-public:
     /// <summary>
-    /// Adds the given renderer to be managed.
+    /// Draws every enabled renderer of the given type.
     /// </summary>
-    /// <param name="renderer">The renderer.</param>
-    static void AddRenderer( MeshRenderer* renderer );
-
-    /// <summary>
-    /// Adds the given renderer to be managed.
-    /// </summary>
-    /// <param name="renderer">The renderer.</param>
-    static void AddRenderer( TextRenderer* renderer );
-
-	/// <summary>
-	/// Adds the given renderer to be managed.
-	/// </summary>
-	/// <param name="renderer">The renderer.</param>
-	static void AddRenderer(LineRenderer* renderer);
+    template<class T> static void DrawAll();
 
+public:
     /// <summary>
     /// Draws all of the renderer.
     /// </summary>
     static void Draw();
-
-    /// <summary>
-    /// Removes the given renderer.
-    /// </summary>
-    /// <param name="renderer">The renderer.</param>
-    static void RemoveRenderer( MeshRenderer* renderer );
-
-    /// <summary>
-    /// Removes the given renderer.
-    /// </summary>
-    /// <param name="renderer">The renderer.</param>
-    static void RemoveRenderer( TextRenderer* renderer );
-
-	/// <summary>
-	/// Removes the given renderer.
-	/// </summary>
-	/// <param name="renderer">The renderer.</param>
-	static void RemoveRenderer(LineRenderer* renderer);
 };
@@ -3,7 +3,7 @@
 #include "GameObject.hpp"
 #include "Transform.hpp"
 
-#define MIN_SPEED 0.1f
+const size_t RigidBody::InvalidBodyIndex = ~static_cast<size_t>(0);
 
 RigidBody::RigidBody(GameObject* gameObject)
     : Component(gameObject)
@@ -12,6 +12,10 @@ RigidBody::RigidBody(GameObject* gameObject)
     , m_fMaxAcc( 100.0f )
     , m_v3Position( 0, 0, 0 )
     , m_v3Velocity( 0, 0, 0 )
+    , m_v3Acceleration( 0, 0, 0 )
+	, _bodyId(0)
+	, _bodyIndex(InvalidBodyIndex)
+	, _AtRest(true)
 	, _IsMovable(true)
 {
     Physics::RegisterRigidbody(this);
@@ -69,29 +73,9 @@ void RigidBody::AddForce(const glm::vec3& force)
    /// m_v3Acceleration = glm::clamp(m_v3Acceleration, -m_fMaxAcc, m_fMaxAcc);
 }
 
+// Forces, friction and collisions are all applied by Physics::Update
 void RigidBody::Update(void)
 {
-	if (_IsMovable)
-	{
-		// Apply Friction
-		AddForce(-m_v3Velocity * m_fBallFriction);
-
-		m_v3Velocity = m_v3Velocity + (m_v3Acceleration * Time::GetElapsedTime());
-		m_v3Acceleration = glm::vec3(0);
-
-		//m_v3Position = m_v3Position + m_v3Velocity;
-		m_v3Position = transform->GetPosition();
-
-
-		m_v3Position += m_v3Velocity * Time::GetElapsedTime();
-		transform->SetPosition(m_v3Position);
-
-		if (glm::abs(m_v3Velocity.x) < MIN_SPEED) m_v3Velocity.x = 0;
-		if (glm::abs(m_v3Velocity.y) < MIN_SPEED) m_v3Velocity.y = 0;
-		if (glm::abs(m_v3Velocity.z) < MIN_SPEED) m_v3Velocity.z = 0;
-
-		_AtRest = (0 == glm::dot(m_v3Velocity, m_v3Velocity));
-	}
 }
 
 bool RigidBody::IsAtRest()
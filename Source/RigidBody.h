@@ -10,6 +10,8 @@
 
 class RigidBody : public Component
 {
+	ImplementComponent(RigidBody, Component);
+	friend class Physics; // Physics integrates us
 	
 	glm::vec3 m_v3Position;
 	glm::vec3 m_v3Velocity;
@@ -23,10 +25,13 @@ class RigidBody : public Component
 	const float m_fBallFriction = 0.1f;
 	//const float m_CushionFriction = 0.2f;
 
+	unsigned int _bodyId; // The ID physics knows us by
+	size_t _bodyIndex; // Where physics keeps us, or InvalidBodyIndex if we aren't registered
 	bool _AtRest; // Is true when the object has no velocity
 	bool _IsMovable;	// Is true when the object can move
 
 public:
+	static const size_t InvalidBodyIndex;
 
 	RigidBody( GameObject* gameObject );
 
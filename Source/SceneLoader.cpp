@@ -0,0 +1,328 @@
+#include "SceneLoader.hpp"
+#include "Components.hpp"
+#include "Game.hpp"
+#include "JsonDocument.hpp"
+#include "MappedFile.hpp"
+#include "MeshLoader.hpp"
+#include "Texture2D.hpp"
+#include "VirtualFileSystem.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#define SCENE_COOKED_MAGIC   0x314E4353 // "SCN1"
+#define SCENE_COOKED_VERSION 1
+
+const unsigned int SceneLoader::NoParent = 0xFFFFFFFF;
+
+// Reads a vector from a JSON array, keeping the given value if it isn't one
+static glm::vec3 ReadVector( const JsonValue& value, const char* key, const glm::vec3& def )
+{
+    const JsonValue& array = value[ key ];
+    if ( array.GetType() != JsonType::Array || array.GetCount() != 3 )
+    {
+        return def;
+    }
+
+    return glm::vec3( array[ size_t( 0 ) ].ToFloat( def.x ), array[ size_t( 1 ) ].ToFloat( def.y ), array[ size_t( 2 ) ].ToFloat( def.z ) );
+}
+
+// Checks to see if one JSON value's name comes before another's
+static bool IsKeyLess( const JsonValue* lhs, const JsonValue* rhs )
+{
+    return strcmp( lhs->GetKey().Data, rhs->GetKey().Data ) < 0;
+}
+
+// Adds a string to a string table
+unsigned int SceneLoader::AddString( std::vector<char>& strings, const std::string& str )
+{
+    unsigned int offset = static_cast<unsigned int>( strings.size() );
+    strings.insert( strings.end(), str.begin(), str.end() );
+    strings.push_back( '\0' );
+    return offset;
+}
+
+// Cooks a JSON game object, and then its children
+void SceneLoader::CookObject( const JsonValue& value, unsigned int parent, std::vector<CookedObject>& objects, std::vector<char>& strings )
+{
+    CookedObject object = {};
+    object.Name = AddString( strings, value.GetKey().Data );
+    object.Parent = parent;
+    object.Scale = glm::vec3( 1 );
+
+    if ( const JsonValue* transform = value.Find( "Transform" ) )
+    {
+        object.Position = ReadVector( *transform, "Position", object.Position );
+        object.Rotation = ReadVector( *transform, "Rotation", object.Rotation );
+        object.Scale = ReadVector( *transform, "Scale", object.Scale );
+    }
+    if ( const JsonValue* material = value.Find( "SimpleMaterial" ) )
+    {
+        object.Components |= CookedSimpleMaterial;
+        object.Texture = AddString( strings, ( *material )[ "Texture" ].ToString() );
+    }
+    if ( const JsonValue* renderer = value.Find( "MeshRenderer" ) )
+    {
+        object.Components |= CookedMeshRenderer;
+        object.Mesh = AddString( strings, ( *renderer )[ "Mesh" ].ToString() );
+    }
+    if ( const JsonValue* collider = value.Find( "SphereCollider" ) )
+    {
+        object.Components |= CookedSphereCollider;
+        object.Radius = ( *collider )[ "Radius" ].ToFloat( 0.5f );
+    }
+    if ( const JsonValue* collider = value.Find( "BoxCollider" ) )
+    {
+        object.Components |= CookedBoxCollider;
+        object.Size = ReadVector( *collider, "Size", glm::vec3( 1 ) );
+    }
+    if ( const JsonValue* collider = value.Find( "MeshCollider" ) )
+    {
+        object.Components |= CookedMeshCollider;
+        object.ColliderMesh = AddString( strings, ( *collider )[ "Mesh" ].ToString() );
+    }
+    if ( const JsonValue* rigidBody = value.Find( "RigidBody" ) )
+    {
+        object.Components |= CookedRigidBody;
+        object.Mass = ( *rigidBody )[ "Mass" ].ToFloat( 1.0f );
+        object.IsMovable = ( *rigidBody )[ "IsMovable" ].ToBool( true ) ? 1 : 0;
+    }
+
+    unsigned int index = static_cast<unsigned int>( objects.size() );
+    objects.push_back( object );
+
+    if ( const JsonValue* children = value.Find( "Children" ) )
+    {
+        CookObjects( *children, index, objects, strings );
+    }
+}
+
+// Cooks every game object in a JSON object, in name order
+void SceneLoader::CookObjects( const JsonValue& value, unsigned int parent, std::vector<CookedObject>& objects, std::vector<char>& strings )
+{
+    // Sort the game objects by name, so that the image doesn't depend on how the JSON was written
+    std::vector<const JsonValue*> members;
+    for ( const JsonValue& member : value )
+    {
+        if ( member.GetType() == JsonType::Object )
+        {
+            members.push_back( &member );
+        }
+    }
+    std::sort( members.begin(), members.end(), IsKeyLess );
+
+    for ( const JsonValue* member : members )
+    {
+        CookObject( *member, parent, objects, strings );
+    }
+}
+
+// Cooks a scene's JSON into a scene image
+bool SceneLoader::Cook( const std::string& fname, unsigned long long sourceSize, long long sourceTime, std::vector<char>& image )
+{
+    JsonDocument document;
+    if ( !document.LoadFromFile( fname ) || document.GetRoot().GetType() != JsonType::Object )
+    {
+        return false;
+    }
+
+    std::vector<CookedObject> objects;
+    std::vector<char> strings;
+    CookObjects( document.GetRoot(), NoParent, objects, strings );
+
+    CookedHeader header;
+    memset( &header, 0, sizeof( header ) );
+    header.Magic = SCENE_COOKED_MAGIC;
+    header.Version = SCENE_COOKED_VERSION;
+    header.SourceSize = sourceSize;
+    header.SourceTime = sourceTime;
+    header.ObjectCount = static_cast<unsigned int>( objects.size() );
+    header.StringSize = static_cast<unsigned int>( strings.size() );
+
+    // The image is laid out exactly as it is saved: the header, then the objects, then the strings
+    const char* headerBytes = reinterpret_cast<const char*>( &header );
+    const char* objectBytes = reinterpret_cast<const char*>( objects.data() );
+    image.clear();
+    image.reserve( sizeof( header ) + sizeof( CookedObject ) * objects.size() + strings.size() );
+    image.insert( image.end(), headerBytes, headerBytes + sizeof( header ) );
+    image.insert( image.end(), objectBytes, objectBytes + sizeof( CookedObject ) * objects.size() );
+    image.insert( image.end(), strings.begin(), strings.end() );
+    return true;
+}
+
+// Creates the game objects in a scene image
+void SceneLoader::Instantiate( const std::vector<char>& image, std::vector<GameObject*>& objects )
+{
+    const CookedHeader* header = reinterpret_cast<const CookedHeader*>( image.data() );
+    const CookedObject* cooked = reinterpret_cast<const CookedObject*>( header + 1 );
+    const char* strings = reinterpret_cast<const char*>( cooked + header->ObjectCount );
+
+    Game* game = Game::GetInstance();
+    size_t first = objects.size();
+    objects.reserve( first + header->ObjectCount );
+
+    std::vector<unsigned int> roots; // The index of the object at the top of each object's hierarchy
+    roots.reserve( header->ObjectCount );
+
+    for ( unsigned int i = 0; i < header->ObjectCount; ++i )
+    {
+        const CookedObject& object = cooked[ i ];
+        const char* name = strings + object.Name;
+        GameObject* gameObject = ( object.Parent == NoParent )
+            ? game->AddGameObject( name )
+            : objects[ first + object.Parent ]->AddChild( name );
+        objects.push_back( gameObject );
+
+        Transform* transform = gameObject->GetTransform();
+        transform->SetPosition( object.Position );
+        transform->SetRotation( object.Rotation );
+        transform->SetScale( object.Scale );
+
+        // Children don't have handles of their own, but they live exactly as long as the top of their hierarchy
+        roots.push_back( ( object.Parent == NoParent ) ? i : roots[ object.Parent ] );
+        GameObjectHandle root = objects[ first + roots.back() ]->GetHandle();
+
+        // Components are always added in this order, as renderers want their material and rigid bodies want their collider.
+        // Textures and meshes are loaded in the background, and handed over once they're ready.
+        SimpleMaterial* material = nullptr;
+        if ( object.Components & CookedSimpleMaterial )
+        {
+            material = gameObject->AddComponent<SimpleMaterial>();
+            if ( strings[ object.Texture ] )
+            {
+                Texture2D::FromFileAsync( strings + object.Texture ).OnFinished( [ root, material ]( const std::shared_ptr<Texture2D>& texture )
+                {
+                    if ( Game::GetInstance()->Find( root ) )
+                    {
+                        material->SetMyTexture( texture );
+                    }
+                } );
+            }
+        }
+        if ( object.Components & CookedMeshRenderer )
+        {
+            MeshRenderer* renderer = gameObject->AddComponent<MeshRenderer>();
+            renderer->SetMaterial( material );
+            VertexLayout layout = material ? material->GetVertexLayout() : VertexLayout::Full;
+            MeshLoader::LoadAsync( strings + object.Mesh, layout ).OnFinished( [ root, renderer ]( const std::shared_ptr<Mesh>& mesh )
+            {
+                if ( Game::GetInstance()->Find( root ) )
+                {
+                    renderer->SetMesh( mesh );
+                }
+            } );
+        }
+
+        bool hasCollider = false;
+        if ( object.Components & CookedSphereCollider )
+        {
+            gameObject->AddComponent<SphereCollider>()->SetRadius( object.Radius );
+            hasCollider = true;
+        }
+        if ( object.Components & CookedBoxCollider )
+        {
+            gameObject->AddComponent<BoxCollider>()->SetSize( object.Size );
+            hasCollider = true;
+        }
+        if ( object.Components & CookedMeshCollider )
+        {
+            hasCollider = gameObject->AddComponent<MeshCollider>()->SetMesh( strings + object.ColliderMesh ) || hasCollider;
+        }
+        if ( ( object.Components & CookedRigidBody ) && hasCollider )
+        {
+            RigidBody* rigidBody = gameObject->AddComponent<RigidBody>();
+            rigidBody->SetMass( object.Mass );
+            rigidBody->SetIsMovable( object.IsMovable != 0 );
+        }
+    }
+}
+
+// Attempts to load a cooked scene image from disk
+bool SceneLoader::LoadCooked( const std::string& fname, unsigned long long sourceSize, long long sourceTime, std::vector<char>& image )
+{
+    MappedFile file;
+    if ( !file.Open( fname ) || file.GetSize() < sizeof( CookedHeader ) )
+    {
+        return false;
+    }
+
+    // Copy the whole image at once
+    size_t size = file.GetSize();
+    image.assign( file.GetData(), file.GetData() + size );
+
+    // Make sure the image is ours, is current, and isn't obviously broken
+    const CookedHeader* header = reinterpret_cast<const CookedHeader*>( image.data() );
+    bool isValid = header->Magic == SCENE_COOKED_MAGIC
+                && header->Version == SCENE_COOKED_VERSION
+                && header->SourceSize == sourceSize
+                && header->SourceTime == sourceTime
+                && static_cast<unsigned long long>( size ) == sizeof( CookedHeader ) + sizeof( CookedObject ) * static_cast<unsigned long long>( header->ObjectCount ) + header->StringSize
+                && ( header->StringSize == 0 || image.back() == '\0' );
+
+    // Every object has to point somewhere valid
+    const CookedObject* objects = reinterpret_cast<const CookedObject*>( header + 1 );
+    for ( unsigned int i = 0; isValid && i < header->ObjectCount; ++i )
+    {
+        const CookedObject& object = objects[ i ];
+        unsigned int stringSize = header->StringSize;
+        isValid = ( object.Parent == NoParent || object.Parent < i )
+               && object.Name < stringSize
+               && ( !( object.Components & CookedSimpleMaterial ) || object.Texture < stringSize )
+               && ( !( object.Components & CookedMeshRenderer ) || object.Mesh < stringSize )
+               && ( !( object.Components & CookedMeshCollider ) || object.ColliderMesh < stringSize );
+    }
+
+    if ( !isValid )
+    {
+        image.clear();
+    }
+    return isValid;
+}
+
+// Attempts to save a cooked scene image to disk
+bool SceneLoader::SaveCooked( const std::string& fname, const std::vector<char>& image )
+{
+    std::ofstream file( fname, std::ios::binary | std::ios::trunc );
+    if ( !file.is_open() )
+    {
+        return false;
+    }
+
+    file.write( image.data(), image.size() );
+    return static_cast<bool>( file );
+}
+
+// Loads a scene
+bool SceneLoader::Load( const std::string& fname, std::vector<GameObject*>& objects )
+{
+    unsigned long long sourceSize = 0;
+    long long sourceTime = 0;
+    if ( !VirtualFileSystem::GetFileInfo( fname, sourceSize, sourceTime ) )
+    {
+        return false;
+    }
+
+    std::cout << "Loading scene " << fname << "... ";
+
+    // The cooked image is only used if it was cooked from this exact scene
+    std::vector<char> image;
+    std::string cookedName = fname + ".cooked";
+    if ( LoadCooked( cookedName, sourceSize, sourceTime, image ) )
+    {
+        std::cout << "Done." << std::endl;
+    }
+    else if ( Cook( fname, sourceSize, sourceTime, image ) )
+    {
+        SaveCooked( cookedName, image );
+        std::cout << "Cooked." << std::endl;
+    }
+    else
+    {
+        std::cout << "Failed ;_;" << std::endl;
+        return false;
+    }
+
+    Instantiate( image, objects );
+    return true;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Config.hpp"
+#include "Math.hpp"
+#include <string>
+#include <vector>
+
+class GameObject;
+class JsonValue;
+
+/// <summary>
+/// Defines a static scene loader. Scenes are written in JSON as an object of game objects keyed by
+/// name, each holding its components keyed by type (plus "Children", another object of game objects).
+/// The first time a scene is loaded it is cooked into a flat binary image that is saved next to it,
+/// and later loads read that image in one go instead of parsing the JSON.
+/// </summary>
+class SceneLoader
+{
+    ImplementStaticClass( SceneLoader );
+
+    /// <summary>
+    /// Defines the components a cooked object can have.
+    /// </summary>
+    enum CookedComponent
+    {
+        CookedSimpleMaterial = 1 << 0,
+        CookedMeshRenderer   = 1 << 1,
+        CookedSphereCollider = 1 << 2,
+        CookedBoxCollider    = 1 << 3,
+        CookedMeshCollider   = 1 << 4,
+        CookedRigidBody      = 1 << 5
+    };
+
+    /// <summary>
+    /// Defines the start of a cooked scene image.
+    /// </summary>
+    struct CookedHeader
+    {
+        unsigned int       Magic;
+        unsigned int       Version;
+        unsigned long long SourceSize;  // The size of the JSON file the image was cooked from
+        long long          SourceTime;  // The modification time of the JSON file the image was cooked from
+        unsigned int       ObjectCount; // The number of objects following the header
+        unsigned int       StringSize;  // The size of the string table following the objects
+    };
+
+    /// <summary>
+    /// Defines a cooked game object. Strings are stored as offsets into the image's string table, and
+    /// parents always come before their children.
+    /// </summary>
+    struct CookedObject
+    {
+        unsigned int Name;
+        unsigned int Parent;       // The index of the parent object, or NoParent
+        unsigned int Components;   // The CookedComponent flags of the components the object has
+        glm::vec3    Position;
+        glm::vec3    Rotation;
+        glm::vec3    Scale;
+        unsigned int Texture;      // The simple material's texture
+        unsigned int Mesh;         // The mesh renderer's mesh
+        unsigned int ColliderMesh; // The mesh collider's mesh
+        float        Radius;       // The sphere collider's radius
+        glm::vec3    Size;         // The box collider's size
+        float        Mass;         // The rigid body's mass
+        unsigned int IsMovable;    // Whether the rigid body is movable
+    };
+
+    static const unsigned int NoParent;
+
+    /// <summary>
+    /// Adds a string to a string table.
+    /// </summary>
+    /// <param name="strings">The string table.</param>
+    /// <param name="str">The string.</param>
+    /// <returns>The offset of the string in the table.</returns>
+    static unsigned int AddString( std::vector<char>& strings, const std::string& str );
+
+    /// <summary>
+    /// Cooks a JSON game object, and then its children.
+    /// </summary>
+    /// <param name="value">The game object's JSON value, named after the game object.</param>
+    /// <param name="parent">The index of the game object's parent.</param>
+    /// <param name="objects">The list to receive the cooked objects.</param>
+    /// <param name="strings">The string table.</param>
+    static void CookObject( const JsonValue& value, unsigned int parent, std::vector<CookedObject>& objects, std::vector<char>& strings );
+
+    /// <summary>
+    /// Cooks every game object in a JSON object, in name order.
+    /// </summary>
+    /// <param name="value">The JSON object.</param>
+    /// <param name="parent">The index of the game objects' parent.</param>
+    /// <param name="objects">The list to receive the cooked objects.</param>
+    /// <param name="strings">The string table.</param>
+    static void CookObjects( const JsonValue& value, unsigned int parent, std::vector<CookedObject>& objects, std::vector<char>& strings );
+
+    /// <summary>
+    /// Cooks a scene's JSON into a scene image.
+    /// </summary>
+    /// <param name="fname">The scene's file name.</param>
+    /// <param name="sourceSize">The size of the scene's file.</param>
+    /// <param name="sourceTime">The modification time of the scene's file.</param>
+    /// <param name="image">The buffer to receive the scene image.</param>
+    static bool Cook( const std::string& fname, unsigned long long sourceSize, long long sourceTime, std::vector<char>& image );
+
+    /// <summary>
+    /// Creates the game objects in a scene image.
+    /// </summary>
+    /// <param name="image">The scene image.</param>
+    /// <param name="objects">The list to receive the new game objects.</param>
+    static void Instantiate( const std::vector<char>& image, std::vector<GameObject*>& objects );
+
+    /// <summary>
+    /// Attempts to load a cooked scene image from disk.
+    /// </summary>
+    /// <param name="fname">The image's file name.</param>
+    /// <param name="sourceSize">The size of the scene the image must have been cooked from.</param>
+    /// <param name="sourceTime">The modification time of the scene the image must have been cooked from.</param>
+    /// <param name="image">The buffer to receive the scene image.</param>
+    static bool LoadCooked( const std::string& fname, unsigned long long sourceSize, long long sourceTime, std::vector<char>& image );
+
+    /// <summary>
+    /// Attempts to save a cooked scene image to disk.
+    /// </summary>
+    /// <param name="fname">The image's file name.</param>
+    /// <param name="image">The scene image.</param>
+    static bool SaveCooked( const std::string& fname, const std::vector<char>& image );
+
+public:
+    /// <summary>
+    /// Loads a scene, creating its game objects. Rigid bodies are only added to game objects that
+    /// ended up with a collider, so a game object whose mesh collider could not be loaded has none.
+    /// </summary>
+    /// <param name="fname">The scene's file name.</param>
+    /// <param name="objects">The list to receive the new game objects, with parents before their children.</param>
+    /// <returns>True if the scene was loaded, false if not.</returns>
+    static bool Load( const std::string& fname, std::vector<GameObject*>& objects );
+};
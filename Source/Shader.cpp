@@ -1,43 +1,39 @@
 #include "Shader.h"
+#include "MappedFile.hpp"
+#include <cstring>
 
 
 char* Shader::loadTextFile(const char* file)
 {
     //Open
-    ifstream is(file, ios::binary);
-    if (!is.is_open()) return 0;
+    MappedFile mapped;
+    if (!mapped.Open(file)) return 0;
 
-    //Length
-    is.seekg(0, ios::end);
-    int length = (int)is.tellg();
-    is.seekg(0, ios::beg);
-
-    //Read
+    //Copy
+    size_t length = mapped.GetSize();
     char* fileContents = new char[length + 1];
-    is.read(fileContents, length);
+    memcpy(fileContents, mapped.GetData(), length);
     fileContents[length] = 0;
 
-    //Close
-    is.close();
-
     return fileContents;
 }
 
 GLuint Shader::loadShader(const char* file, GLenum shaderType)
 {
-    //loadTextFile
-    const char* shaderCode = loadTextFile(file);
-    if (shaderCode == 0)
+    //Open, compiling straight from the mapped file
+    MappedFile mapped;
+    if (!mapped.Open(file))
     {
         cout << "File failed to open: " << file << endl;
         return 0;
     }
+    const char* shaderCode = mapped.GetData();
+    GLint length = (GLint)mapped.GetSize();
 
     //Compile
     GLuint shader = glCreateShader(shaderType);
-    glShaderSource(shader, 1, &shaderCode, 0);
+    glShaderSource(shader, 1, &shaderCode, &length);
     glCompileShader(shader);
-    delete[] shaderCode;
 
     GLint compiled;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
@@ -71,6 +67,7 @@ GLuint Shader::loadShaderProgram(const char* vertexFile, const char* fragmentFil
     GLuint fragmentShader = loadShader(fragmentFile, GL_FRAGMENT_SHADER);
     if ( fragmentShader == 0 )
     {
+        glDeleteShader( vertexShader );
         glDeleteProgram( program );
         return 0;
     }
@@ -80,6 +77,12 @@ GLuint Shader::loadShaderProgram(const char* vertexFile, const char* fragmentFil
     glAttachShader(program, fragmentShader);
     glLinkProgram(program);
 
+    //The program keeps what it needs, so the shaders can go
+    glDetachShader(program, vertexShader);
+    glDetachShader(program, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
     GLint linked;
     glGetProgramiv(program, GL_LINK_STATUS, &linked);
     if (linked) return program;
@@ -0,0 +1,240 @@
+#include "ShotPredictor.hpp"
+
+#define PATH_SAMPLE_RATE 4
+
+const float ShotPredictor::TimeStep    = 1.0f / 120.0f;
+const float ShotPredictor::MaxDuration = 10.0f;
+
+// Creates a new shot predictor
+ShotPredictor::ShotPredictor()
+    : _generation( 0 )
+    , _requestCueIndex( 0 )
+    , _requestMode( SimulationMode::Spatial )
+    , _requestHeight( 0 )
+    , _hasRequest( false )
+    , _isRunning( true )
+    , _hasPrediction( false )
+{
+    _thread = std::thread( &ShotPredictor::Run, this );
+}
+
+// Destroys this shot predictor
+ShotPredictor::~ShotPredictor()
+{
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _isRunning = false;
+        ++_generation;
+    }
+    _condition.notify_one();
+
+    if ( _thread.joinable() )
+    {
+        _thread.join();
+    }
+}
+
+// Cancels any pending or running prediction
+void ShotPredictor::Cancel()
+{
+    std::lock_guard<std::mutex> lock( _mutex );
+    ++_generation;
+    _hasRequest = false;
+    _hasPrediction = false;
+}
+
+// Requests a new prediction
+void ShotPredictor::Predict( const std::vector<SimulationBody>& bodies, unsigned int cueIndex, SimulationMode mode, float height )
+{
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+
+        // Bumping the generation makes the worker drop whatever it is currently simulating
+        ++_generation;
+        _requestBodies = bodies;
+        _requestCueIndex = cueIndex;
+        _requestMode = mode;
+        _requestHeight = height;
+        _hasRequest = true;
+    }
+    _condition.notify_one();
+}
+
+// Attempts to get the latest prediction
+bool ShotPredictor::TryGetPrediction( Prediction& prediction )
+{
+    // The worker only ever holds the lock to swap data, but we still never wait on it
+    std::unique_lock<std::mutex> lock( _mutex, std::try_to_lock );
+    if ( !lock.owns_lock() || !_hasPrediction )
+    {
+        return false;
+    }
+
+    std::swap( prediction, _prediction );
+    _hasPrediction = false;
+    return true;
+}
+
+// Runs the worker thread
+void ShotPredictor::Run()
+{
+    std::vector<SimulationBody> bodies;
+    std::vector<PlanarBody> planarBodies;
+    Prediction prediction;
+
+    while ( true )
+    {
+        unsigned int cueIndex = 0;
+        unsigned int generation = 0;
+        SimulationMode mode = SimulationMode::Spatial;
+        float height = 0.0f;
+
+        // Wait for a request
+        {
+            std::unique_lock<std::mutex> lock( _mutex );
+            _condition.wait( lock, [ this ]() { return _hasRequest || !_isRunning; } );
+            if ( !_isRunning )
+            {
+                return;
+            }
+
+            bodies.swap( _requestBodies );
+            cueIndex = _requestCueIndex;
+            mode = _requestMode;
+            height = _requestHeight;
+            generation = _generation;
+            _hasRequest = false;
+        }
+
+        // Simulate the shot in the same mode as the live physics
+        bool isFinished = false;
+        if ( mode == SimulationMode::Planar )
+        {
+            planarBodies.resize( bodies.size() );
+            for ( size_t i = 0; i < bodies.size(); ++i )
+            {
+                planarBodies[ i ] = Simulation::ToPlanar( bodies[ i ], height );
+            }
+            isFinished = Simulate( planarBodies, cueIndex, generation, height, prediction );
+        }
+        else
+        {
+            isFinished = Simulate( bodies, cueIndex, generation, height, prediction );
+        }
+
+        // Publish the prediction if nothing newer has come in since
+        if ( isFinished )
+        {
+            std::lock_guard<std::mutex> lock( _mutex );
+            if ( generation == _generation )
+            {
+                std::swap( _prediction, prediction );
+                _hasPrediction = true;
+            }
+        }
+    }
+}
+
+// Gets a body's position in the world
+static glm::vec3 GetWorldPosition( const SimulationBody& body, float )
+{
+    return body.Position;
+}
+
+// Gets a planar body's position in the world
+static glm::vec3 GetWorldPosition( const PlanarBody& body, float height )
+{
+    return glm::vec3( body.Position.x, height, body.Position.y );
+}
+
+// Checks to see if a body has stopped moving
+static bool IsStopped( const SimulationBody& body )
+{
+    return body.Velocity == glm::vec3( 0 );
+}
+
+// Checks to see if a planar body has stopped moving
+static bool IsStopped( const PlanarBody& body )
+{
+    return body.Velocity == glm::vec2( 0 );
+}
+
+// Simulates a shot
+template<typename TBody> bool ShotPredictor::Simulate( std::vector<TBody>& bodies, unsigned int cueIndex, unsigned int generation, float height, Prediction& prediction )
+{
+    prediction.CuePath.clear();
+    prediction.ObjectPath.clear();
+    if ( cueIndex >= bodies.size() )
+    {
+        return true;
+    }
+
+    std::vector<SimulationContact> contacts;
+    ContactCache cache;
+    size_t objectIndex = bodies.size();
+    int stepCount = static_cast<int>( MaxDuration / TimeStep );
+
+    prediction.CuePath.push_back( GetWorldPosition( bodies[ cueIndex ], height ) );
+
+    for ( int step = 1; step <= stepCount; ++step )
+    {
+        // Drop out as soon as the aim has changed
+        if ( _generation != generation )
+        {
+            return false;
+        }
+
+        contacts.clear();
+        Simulation::Step( bodies, TimeStep, &contacts, cache );
+
+        bool hasCueBounced = false;
+        for ( auto& contact : contacts )
+        {
+            TBody& lhs = bodies[ contact.Lhs ];
+            TBody& rhs = bodies[ contact.Rhs ];
+
+            // Anything that hits a pocket leaves the table
+            if ( Simulation::IsTrigger( lhs, rhs ) )
+            {
+                if ( lhs.IsMovable ) lhs.IsActive = false;
+                if ( rhs.IsMovable ) rhs.IsActive = false;
+                continue;
+            }
+
+            // Keep track of the first ball the cue ball hits
+            if ( contact.Lhs == cueIndex || contact.Rhs == cueIndex )
+            {
+                size_t other = ( contact.Lhs == cueIndex ) ? contact.Rhs : contact.Lhs;
+                if ( objectIndex == bodies.size() && bodies[ other ].Shape == ColliderType::Sphere && bodies[ other ].IsMovable )
+                {
+                    objectIndex = other;
+                    prediction.ObjectPath.push_back( GetWorldPosition( bodies[ other ], height ) );
+                }
+                hasCueBounced = true;
+            }
+        }
+
+        // Record the paths, always keeping the points where the cue ball changed direction
+        const TBody& cue = bodies[ cueIndex ];
+        if ( hasCueBounced || step % PATH_SAMPLE_RATE == 0 || !cue.IsActive )
+        {
+            prediction.CuePath.push_back( GetWorldPosition( cue, height ) );
+            if ( objectIndex < bodies.size() )
+            {
+                prediction.ObjectPath.push_back( GetWorldPosition( bodies[ objectIndex ], height ) );
+            }
+        }
+
+        // Stop once everything we're following has stopped
+        bool isCueDone = !cue.IsActive || IsStopped( cue );
+        bool isObjectDone = objectIndex == bodies.size()
+                         || !bodies[ objectIndex ].IsActive
+                         || IsStopped( bodies[ objectIndex ] );
+        if ( isCueDone && isObjectDone )
+        {
+            break;
+        }
+    }
+
+    return true;
+}
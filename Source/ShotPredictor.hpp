@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Config.hpp"
+#include "Math.hpp"
+#include "Simulation.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Defines a shot predictor, which fast-forwards a snapshot of the table on a worker
+/// thread to find out where a pending shot will send the cue ball.
+/// </summary>
+class ShotPredictor
+{
+    ImplementNonCopyableClass( ShotPredictor );
+    ImplementNonMovableClass( ShotPredictor );
+
+public:
+    /// <summary>
+    /// Defines the result of a prediction.
+    /// </summary>
+    struct Prediction
+    {
+        std::vector<glm::vec3> CuePath;
+        std::vector<glm::vec3> ObjectPath;
+    };
+
+private:
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::atomic<unsigned int> _generation;
+    std::vector<SimulationBody> _requestBodies;
+    unsigned int _requestCueIndex;
+    SimulationMode _requestMode;
+    float _requestHeight;
+    bool _hasRequest;
+    bool _isRunning;
+    Prediction _prediction;
+    bool _hasPrediction;
+
+    /// <summary>
+    /// The worker thread's entry point.
+    /// </summary>
+    void Run();
+
+    /// <summary>
+    /// Simulates a shot, returning false if the shot was cancelled part way through.
+    /// </summary>
+    /// <param name="bodies">The bodies to simulate.</param>
+    /// <param name="cueIndex">The index of the cue ball.</param>
+    /// <param name="generation">The generation of the request being simulated.</param>
+    /// <param name="height">The height of the table plane.</param>
+    /// <param name="prediction">The prediction to fill out.</param>
+    template<typename TBody> bool Simulate( std::vector<TBody>& bodies, unsigned int cueIndex, unsigned int generation, float height, Prediction& prediction );
+
+public:
+    /// <summary>
+    /// The time step used when fast-forwarding a shot.
+    /// </summary>
+    static const float TimeStep;
+
+    /// <summary>
+    /// The longest amount of time a shot will be fast-forwarded for.
+    /// </summary>
+    static const float MaxDuration;
+
+    /// <summary>
+    /// Creates a new shot predictor.
+    /// </summary>
+    ShotPredictor();
+
+    /// <summary>
+    /// Destroys this shot predictor.
+    /// </summary>
+    ~ShotPredictor();
+
+    /// <summary>
+    /// Cancels any pending or running prediction.
+    /// </summary>
+    void Cancel();
+
+    /// <summary>
+    /// Requests a new prediction. Any prediction still running is cancelled.
+    /// </summary>
+    /// <param name="bodies">The snapshot of the table, with the cue ball's velocity already applied.</param>
+    /// <param name="cueIndex">The index of the cue ball.</param>
+    /// <param name="mode">The simulation mode to predict with.</param>
+    /// <param name="height">The height of the table plane, used by the planar mode.</param>
+    void Predict( const std::vector<SimulationBody>& bodies, unsigned int cueIndex, SimulationMode mode, float height );
+
+    /// <summary>
+    /// Attempts to get the latest finished prediction without blocking.
+    /// </summary>
+    /// <param name="prediction">The prediction to fill out.</param>
+    /// <returns>True if a new prediction was available, false if not.</returns>
+    bool TryGetPrediction( Prediction& prediction );
+};
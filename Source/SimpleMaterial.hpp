@@ -7,6 +7,7 @@
 /// </summary>
 class SimpleMaterial : public Material
 {
+    ImplementComponent( SimpleMaterial, Material );
     glm::mat4 _world;
 	std::shared_ptr<Texture2D> _texture;
 
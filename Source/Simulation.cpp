@@ -0,0 +1,582 @@
+#include "Simulation.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+
+const float Simulation::Friction              = 0.625f;
+const float Simulation::MinSpeed              = 0.1f;
+const float Simulation::Restitution           = 0.9f;
+const float Simulation::CushionRestitution    = 1.0f;
+const int   Simulation::SolverIterations      = 8;
+const float Simulation::ImpulseTolerance      = 0.001f;
+const float Simulation::PenetrationSlop       = 0.01f;
+const float Simulation::PenetrationCorrection = 0.8f;
+const size_t Simulation::BodiesPerJob         = 32;
+
+// Creates a new simulation body
+SimulationBody::SimulationBody()
+    : Id( 0 )
+    , Position( 0, 0, 0 )
+    , Velocity( 0, 0, 0 )
+    , HalfSize( 0, 0, 0 )
+    , Radius( 0 )
+    , Mass( 0 )
+    , Shape( ColliderType::Unknown )
+    , IsMovable( false )
+    , IsActive( true )
+{
+}
+
+// Gets the key for a pair of bodies
+unsigned long long ContactCache::GetKey( unsigned int lhsId, unsigned int rhsId )
+{
+    // Order the IDs so that both ways around give the same key
+    unsigned long long low = std::min( lhsId, rhsId );
+    unsigned long long high = std::max( lhsId, rhsId );
+    return ( high << 32 ) | low;
+}
+
+// Gets the spatial solver contacts
+std::vector<SolverContact<glm::vec3>>& ContactCache::GetSolverContacts( const glm::vec3& )
+{
+    return _spatialContacts;
+}
+
+// Gets the planar solver contacts
+std::vector<SolverContact<glm::vec2>>& ContactCache::GetSolverContacts( const glm::vec2& )
+{
+    return _planarContacts;
+}
+
+// Gets the spatial candidate contact lists
+std::vector<std::vector<SolverContact<glm::vec3>>>& ContactCache::GetCandidateLists( const glm::vec3& )
+{
+    return _spatialCandidates;
+}
+
+// Gets the planar candidate contact lists
+std::vector<std::vector<SolverContact<glm::vec2>>>& ContactCache::GetCandidateLists( const glm::vec2& )
+{
+    return _planarCandidates;
+}
+
+// Removes every cached contact
+void ContactCache::Clear()
+{
+    _entries.clear();
+}
+
+// Finds the impulse applied between two bodies last step
+float ContactCache::Find( unsigned int lhsId, unsigned int rhsId ) const
+{
+    auto search = _entries.find( GetKey( lhsId, rhsId ) );
+    if ( search != _entries.end() )
+    {
+        return search->second.NormalImpulse;
+    }
+    return 0.0f;
+}
+
+// Gets the number of cached contacts
+size_t ContactCache::GetCount() const
+{
+    return _entries.size();
+}
+
+// Removes every contact that was not stored since the last prune
+void ContactCache::Prune()
+{
+    for ( auto it = _entries.begin(); it != _entries.end(); )
+    {
+        if ( !it->second.IsTouched )
+        {
+            it = _entries.erase( it );
+        }
+        else
+        {
+            it->second.IsTouched = false;
+            ++it;
+        }
+    }
+}
+
+// Stores the impulse applied between two bodies this step
+void ContactCache::Store( unsigned int lhsId, unsigned int rhsId, float impulse )
+{
+    Entry& entry = _entries[ GetKey( lhsId, rhsId ) ];
+    entry.NormalImpulse = impulse;
+    entry.IsTouched = true;
+}
+
+// Checks to see if two bodies are colliding
+bool Simulation::AreColliding( const SimulationBody& lhs, const SimulationBody& rhs )
+{
+    glm::vec3 normal;
+    float penetration = 0.0f;
+    return FindContact( lhs, rhs, normal, penetration );
+}
+
+// Checks to see if two planar bodies are colliding
+bool Simulation::AreColliding( const PlanarBody& lhs, const PlanarBody& rhs )
+{
+    glm::vec2 normal;
+    float penetration = 0.0f;
+    return FindContact( lhs, rhs, normal, penetration );
+}
+
+// Checks to see if a contact is a trigger only
+bool Simulation::IsTrigger( const SimulationBody& lhs, const SimulationBody& rhs )
+{
+    // Mass-less spheres (the pockets) are passed through by everything
+    return lhs.Shape == ColliderType::Sphere
+        && rhs.Shape == ColliderType::Sphere
+        && ( lhs.Mass == 0.0f || rhs.Mass == 0.0f );
+}
+
+// Checks to see if a planar contact is a trigger only
+bool Simulation::IsTrigger( const PlanarBody& lhs, const PlanarBody& rhs )
+{
+    return lhs.Shape == ColliderType::Sphere
+        && rhs.Shape == ColliderType::Sphere
+        && ( lhs.Mass == 0.0f || rhs.Mass == 0.0f );
+}
+
+// Gets a body's position in the world
+static glm::vec3 GetWorldPosition( const SimulationBody& body )
+{
+    return body.Position;
+}
+
+// Gets a planar body's position in the world
+static glm::vec3 GetWorldPosition( const PlanarBody& body )
+{
+    return glm::vec3( body.Position.x, body.Height, body.Position.y );
+}
+
+// Gets a vector in the world
+static glm::vec3 ToWorldVector( const glm::vec3& vector )
+{
+    return vector;
+}
+
+// Gets a planar vector in the world
+static glm::vec3 ToWorldVector( const glm::vec2& vector )
+{
+    return glm::vec3( vector.x, 0, vector.y );
+}
+
+// Gets a world vector in the simulation's space
+static void FromWorldVector( const glm::vec3& world, glm::vec3& vector )
+{
+    vector = world;
+}
+
+// Gets a world vector in the plane
+static void FromWorldVector( const glm::vec3& world, glm::vec2& vector )
+{
+    vector = glm::vec2( world.x, world.z );
+}
+
+// Gets the normal of the surface a body slides along, which meshes shouldn't push it away from
+static glm::vec3 GetSurfaceNormal( const SimulationBody& )
+{
+    return glm::vec3( 0 );
+}
+
+// Gets the normal of the plane a planar body slides along
+static glm::vec3 GetSurfaceNormal( const PlanarBody& )
+{
+    return glm::vec3( 0, 1, 0 );
+}
+
+// Gets the inverse mass of a body, which is zero for anything that can't be moved
+template<typename TBody> static float GetInverseMass( const TBody& body )
+{
+    return ( body.IsMovable && body.Mass > 0.0f ) ? ( 1.0f / body.Mass ) : 0.0f;
+}
+
+// Finds the contact between two bodies
+template<typename TBody> bool Simulation::FindContact( const TBody& lhs, const TBody& rhs, typename TBody::Vector& normal, float& penetration )
+{
+    typedef typename TBody::Vector Vector;
+    const int dimensions = sizeof( Vector ) / sizeof( float );
+
+    // Sphere <--> sphere
+    if ( lhs.Shape == ColliderType::Sphere && rhs.Shape == ColliderType::Sphere )
+    {
+        Vector between = rhs.Position - lhs.Position;
+        float sumOfRadii = lhs.Radius + rhs.Radius;
+        float distance2 = glm::dot( between, between );
+        if ( distance2 > sumOfRadii * sumOfRadii )
+        {
+            return false;
+        }
+
+        float distance = glm::sqrt( distance2 );
+        normal = Vector( 0 );
+        normal[ 0 ] = 1.0f;
+        if ( distance > 0.0f )
+        {
+            normal = between / distance;
+        }
+        penetration = sumOfRadii - distance;
+        return true;
+    }
+
+    // Box <--> sphere (the table's boxes are all axis aligned)
+    if ( ( lhs.Shape == ColliderType::Box && rhs.Shape == ColliderType::Sphere )
+      || ( lhs.Shape == ColliderType::Sphere && rhs.Shape == ColliderType::Box ) )
+    {
+        const bool isBoxFirst = ( lhs.Shape == ColliderType::Box );
+        const TBody& box = isBoxFirst ? lhs : rhs;
+        const TBody& sphere = isBoxFirst ? rhs : lhs;
+
+        // Find the closest point on the box to the sphere
+        Vector closestPoint = glm::clamp( sphere.Position, box.Position - box.HalfSize, box.Position + box.HalfSize );
+        Vector fromBox = sphere.Position - closestPoint;
+        float distance2 = glm::dot( fromBox, fromBox );
+        if ( distance2 > sphere.Radius * sphere.Radius )
+        {
+            return false;
+        }
+
+        if ( distance2 > 0.0f )
+        {
+            float distance = glm::sqrt( distance2 );
+            normal = fromBox / distance;
+            penetration = sphere.Radius - distance;
+        }
+        else
+        {
+            // The sphere's center is inside the box, so push it out through the nearest face
+            Vector fromCenter = sphere.Position - box.Position;
+            int axis = 0;
+            float closest = box.HalfSize[ 0 ] - glm::abs( fromCenter[ 0 ] );
+            for ( int i = 1; i < dimensions; ++i )
+            {
+                float distanceToFace = box.HalfSize[ i ] - glm::abs( fromCenter[ i ] );
+                if ( distanceToFace < closest )
+                {
+                    closest = distanceToFace;
+                    axis = i;
+                }
+            }
+
+            normal = Vector( 0 );
+            normal[ axis ] = ( fromCenter[ axis ] < 0.0f ) ? -1.0f : 1.0f;
+            penetration = closest + sphere.Radius;
+        }
+
+        // The normal always points from the first body to the second
+        if ( !isBoxFirst )
+        {
+            normal = -normal;
+        }
+        return true;
+    }
+
+    // Mesh <--> sphere
+    if ( ( lhs.Shape == ColliderType::Mesh && rhs.Shape == ColliderType::Sphere )
+      || ( lhs.Shape == ColliderType::Sphere && rhs.Shape == ColliderType::Mesh ) )
+    {
+        const bool isMeshFirst = ( lhs.Shape == ColliderType::Mesh );
+        const TBody& mesh = isMeshFirst ? lhs : rhs;
+        const TBody& sphere = isMeshFirst ? rhs : lhs;
+
+        BvhContact meshContact;
+        glm::vec3 center = GetWorldPosition( sphere ) - GetWorldPosition( mesh );
+        if ( !mesh.Mesh || !mesh.Mesh->FindSphereContact( center, sphere.Radius, GetSurfaceNormal( sphere ), meshContact ) )
+        {
+            return false;
+        }
+
+        // In the plane only the sideways part of the contact can push the sphere
+        Vector meshNormal;
+        FromWorldVector( meshContact.Normal, meshNormal );
+        float length = glm::length( meshNormal );
+        if ( length <= 0.0f )
+        {
+            return false;
+        }
+
+        normal = meshNormal / length;
+        penetration = sphere.Radius - meshContact.Distance;
+        if ( !isMeshFirst )
+        {
+            normal = -normal;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+// Applies friction to a body's velocity
+template<typename TBody> void Simulation::ApplyFriction( TBody& body, float time )
+{
+    if ( !body.IsMovable || !body.IsActive )
+    {
+        return;
+    }
+
+    body.Velocity += -body.Velocity * Friction * GetInverseMass( body ) * time;
+}
+
+// Shortens a sphere's displacement so that it stops at the first mesh in its way
+template<typename TBody> void Simulation::SweepMeshes( const std::vector<TBody>& bodies, const TBody& body, typename TBody::Vector& displacement )
+{
+    // Anything moving less than half its radius can't skip past a surface, so the next step's contacts will catch it
+    float distance2 = glm::dot( displacement, displacement );
+    if ( body.Shape != ColliderType::Sphere || distance2 <= body.Radius * body.Radius * 0.25f )
+    {
+        return;
+    }
+
+    glm::vec3 start = GetWorldPosition( body );
+    glm::vec3 end = start + ToWorldVector( displacement );
+    float firstHit = 1.0f;
+
+    for ( auto& mesh : bodies )
+    {
+        if ( mesh.Shape != ColliderType::Mesh || !mesh.Mesh || !mesh.IsActive )
+        {
+            continue;
+        }
+
+        // The slightly smaller sphere keeps the surfaces the body is already resting on from stopping it
+        BvhSweepHit hit;
+        glm::vec3 origin = GetWorldPosition( mesh );
+        if ( mesh.Mesh->SweepSphere( start - origin, end - origin, std::max( body.Radius - PenetrationSlop, 0.0f ), GetSurfaceNormal( body ), hit ) )
+        {
+            firstHit = std::min( firstHit, hit.Time );
+        }
+    }
+
+    // The bounce itself is left to the contact found next step
+    displacement *= firstHit;
+}
+
+// Integrates a body's position
+template<typename TBody> void Simulation::Integrate( const std::vector<TBody>& bodies, TBody& body, float time )
+{
+    typedef typename TBody::Vector Vector;
+    const int dimensions = sizeof( Vector ) / sizeof( float );
+
+    if ( !body.IsMovable || !body.IsActive )
+    {
+        return;
+    }
+
+    Vector displacement = body.Velocity * time;
+    SweepMeshes( bodies, body, displacement );
+    body.Position += displacement;
+
+    // Stop the body once it's slow enough
+    for ( int i = 0; i < dimensions; ++i )
+    {
+        if ( glm::abs( body.Velocity[ i ] ) < MinSpeed )
+        {
+            body.Velocity[ i ] = 0;
+        }
+    }
+}
+
+// Steps the given bodies forward in time
+template<typename TBody> void Simulation::StepBodies( std::vector<TBody>& bodies, float time, std::vector<SimulationContact>* contacts, ContactCache& cache )
+{
+    typedef typename TBody::Vector Vector;
+    std::vector<SolverContact<Vector>>& solverContacts = cache.GetSolverContacts( Vector() );
+    solverContacts.clear();
+
+    JobSystem::ParallelFor( bodies.size(), BodiesPerJob, [ &bodies, time ]( size_t begin, size_t end )
+    {
+        for ( size_t i = begin; i < end; ++i )
+        {
+            ApplyFriction( bodies[ i ], time );
+        }
+    } );
+
+    // Find every touching pair on the workers. Each job owns a run of rows, so its list is already in (i, j) order.
+    size_t jobCount = ( bodies.size() + BodiesPerJob - 1 ) / BodiesPerJob;
+    std::vector<std::vector<SolverContact<Vector>>>& candidateLists = cache.GetCandidateLists( Vector() );
+    if ( candidateLists.size() < jobCount )
+    {
+        candidateLists.resize( jobCount );
+    }
+
+    JobSystem::ParallelFor( bodies.size(), BodiesPerJob, [ &bodies, &candidateLists ]( size_t begin, size_t end )
+    {
+        std::vector<SolverContact<Vector>>& candidates = candidateLists[ begin / BodiesPerJob ];
+        candidates.clear();
+
+        for ( size_t i = begin; i < end; ++i )
+        {
+            const TBody& lhs = bodies[ i ];
+            if ( !lhs.IsActive )
+            {
+                continue;
+            }
+
+            for ( size_t j = i + 1; j < bodies.size(); ++j )
+            {
+                const TBody& rhs = bodies[ j ];
+
+                // Static bodies never need to be solved against each other
+                if ( !rhs.IsActive || ( !lhs.IsMovable && !rhs.IsMovable ) )
+                {
+                    continue;
+                }
+
+                SolverContact<Vector> contact;
+                if ( FindContact( lhs, rhs, contact.Normal, contact.Penetration ) )
+                {
+                    contact.Lhs = static_cast<unsigned int>( i );
+                    contact.Rhs = static_cast<unsigned int>( j );
+                    candidates.push_back( contact );
+                }
+            }
+        }
+    } );
+
+    // Set up every contact in (i, j) order, starting each one off with the impulse it ended the last step with.
+    // This is kept serial as each warm start changes the velocities the following contacts see.
+    for ( size_t job = 0; job < jobCount; ++job )
+    {
+        for ( auto& contact : candidateLists[ job ] )
+        {
+            TBody& lhs = bodies[ contact.Lhs ];
+            TBody& rhs = bodies[ contact.Rhs ];
+
+            if ( contacts )
+            {
+                SimulationContact simulationContact = { contact.Lhs, contact.Rhs };
+                contacts->push_back( simulationContact );
+            }
+
+            float lhsInvMass = GetInverseMass( lhs );
+            float rhsInvMass = GetInverseMass( rhs );
+            if ( IsTrigger( lhs, rhs ) || lhsInvMass + rhsInvMass == 0.0f )
+            {
+                continue;
+            }
+
+            contact.EffectiveMass = 1.0f / ( lhsInvMass + rhsInvMass );
+
+            // Bodies that are only resting against each other should not bounce
+            float approachSpeed = -glm::dot( rhs.Velocity - lhs.Velocity, contact.Normal );
+            float restitution = ( lhs.IsMovable && rhs.IsMovable ) ? Restitution : CushionRestitution;
+            contact.Bias = ( approachSpeed > MinSpeed ) ? restitution * approachSpeed : 0.0f;
+
+            // Warm start
+            contact.Impulse = cache.Find( lhs.Id, rhs.Id );
+            lhs.Velocity -= contact.Normal * ( contact.Impulse * lhsInvMass );
+            rhs.Velocity += contact.Normal * ( contact.Impulse * rhsInvMass );
+
+            solverContacts.push_back( contact );
+        }
+    }
+
+    // Refine the impulses until they stop changing. Warm started contacts usually settle in one or two passes.
+    for ( int iteration = 0; iteration < SolverIterations; ++iteration )
+    {
+        float largestChange = 0.0f;
+
+        for ( auto& contact : solverContacts )
+        {
+            TBody& lhs = bodies[ contact.Lhs ];
+            TBody& rhs = bodies[ contact.Rhs ];
+
+            // Accumulate the impulse, never letting it pull the bodies together
+            float normalSpeed = glm::dot( rhs.Velocity - lhs.Velocity, contact.Normal );
+            float impulse = std::max( contact.Impulse + contact.EffectiveMass * ( contact.Bias - normalSpeed ), 0.0f );
+            float change = impulse - contact.Impulse;
+            contact.Impulse = impulse;
+
+            lhs.Velocity -= contact.Normal * ( change * GetInverseMass( lhs ) );
+            rhs.Velocity += contact.Normal * ( change * GetInverseMass( rhs ) );
+
+            largestChange = std::max( largestChange, glm::abs( change ) );
+        }
+
+        if ( largestChange < ImpulseTolerance )
+        {
+            break;
+        }
+    }
+
+    // Bodies only read the meshes while integrating, which never move, so every body can be moved at once
+    JobSystem::ParallelFor( bodies.size(), BodiesPerJob, [ &bodies, time ]( size_t begin, size_t end )
+    {
+        for ( size_t i = begin; i < end; ++i )
+        {
+            Integrate( bodies, bodies[ i ], time );
+        }
+    } );
+
+    // Push overlapping bodies apart and remember the impulses for the next step
+    for ( auto& contact : solverContacts )
+    {
+        TBody& lhs = bodies[ contact.Lhs ];
+        TBody& rhs = bodies[ contact.Rhs ];
+
+        float correction = std::max( contact.Penetration - PenetrationSlop, 0.0f ) * PenetrationCorrection * contact.EffectiveMass;
+        lhs.Position -= contact.Normal * ( correction * GetInverseMass( lhs ) );
+        rhs.Position += contact.Normal * ( correction * GetInverseMass( rhs ) );
+
+        cache.Store( lhs.Id, rhs.Id, contact.Impulse );
+    }
+    cache.Prune();
+}
+
+// Steps the given bodies forward in time
+void Simulation::Step( std::vector<SimulationBody>& bodies, float time, std::vector<SimulationContact>* contacts, ContactCache& cache )
+{
+    StepBodies( bodies, time, contacts, cache );
+}
+
+// Steps the given planar bodies forward in time
+void Simulation::Step( std::vector<PlanarBody>& bodies, float time, std::vector<SimulationContact>* contacts, ContactCache& cache )
+{
+    StepBodies( bodies, time, contacts, cache );
+}
+
+// Converts a body into the table plane
+PlanarBody Simulation::ToPlanar( const SimulationBody& body, float height )
+{
+    PlanarBody planar;
+    planar.Id = body.Id;
+    planar.Position = glm::vec2( body.Position.x, body.Position.z );
+    planar.Velocity = glm::vec2( body.Velocity.x, body.Velocity.z );
+    planar.HalfSize = glm::vec2( body.HalfSize.x, body.HalfSize.z );
+    planar.Height = body.IsMovable ? height : body.Position.y;
+    planar.Radius = body.Radius;
+    planar.Mass = body.Mass;
+    planar.Shape = body.Shape;
+    planar.IsMovable = body.IsMovable;
+    planar.IsActive = body.IsActive;
+    planar.Mesh = body.Mesh;
+
+    // Static bodies that never reach the plane can never be touched in it. Meshes are left to their own triangles.
+    if ( !body.IsMovable && body.Shape != ColliderType::Mesh )
+    {
+        float extent = ( body.Shape == ColliderType::Sphere ) ? body.Radius : body.HalfSize.y;
+        if ( body.Position.y + extent < height || body.Position.y - extent > height )
+        {
+            planar.IsActive = false;
+        }
+    }
+
+    return planar;
+}
+
+// Copies a planar body's motion back onto the given body
+void Simulation::FromPlanar( const PlanarBody& planar, float height, SimulationBody& body )
+{
+    if ( !body.IsMovable )
+    {
+        return;
+    }
+
+    body.Position = glm::vec3( planar.Position.x, height, planar.Position.y );
+    body.Velocity = glm::vec3( planar.Velocity.x, 0, planar.Velocity.y );
+    body.IsActive = planar.IsActive;
+}
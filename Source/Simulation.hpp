@@ -0,0 +1,328 @@
+#pragma once
+
+#include "Config.hpp"
+#include "Collider.hpp"
+#include "Math.hpp"
+#include "TriangleBvh.hpp"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// An enumeration of possible simulation modes.
+/// </summary>
+enum class SimulationMode
+{
+    Spatial, // Every body moves and collides in full 3D
+    Planar   // Dynamic bodies move and collide in the (x, z) plane at a fixed height
+};
+
+/// <summary>
+/// Defines the state of a single body as seen by the simulation kernels.
+/// </summary>
+struct SimulationBody
+{
+    typedef glm::vec3 Vector;
+
+    unsigned int Id;
+    glm::vec3    Position;
+    glm::vec3    Velocity;
+    glm::vec3    HalfSize;
+    float        Radius;
+    float        Mass;
+    ColliderType Shape;
+    bool         IsMovable;
+    bool         IsActive;
+
+    std::shared_ptr<const TriangleBvh> Mesh; // Only set for mesh bodies, whose triangles are relative to Position
+
+    /// <summary>
+    /// Creates a new simulation body.
+    /// </summary>
+    SimulationBody();
+};
+
+/// <summary>
+/// Defines the state of a single body in the table plane. The plane's x and y map to the world's x and z.
+/// </summary>
+struct PlanarBody
+{
+    typedef glm::vec2 Vector;
+
+    unsigned int Id;
+    glm::vec2    Position;
+    glm::vec2    Velocity;
+    glm::vec2    HalfSize;
+    float        Height; // The world height of the body's position
+    float        Radius;
+    float        Mass;
+    ColliderType Shape;
+    bool         IsMovable;
+    bool         IsActive;
+
+    std::shared_ptr<const TriangleBvh> Mesh; // Only set for mesh bodies, whose triangles are relative to Position
+};
+
+/// <summary>
+/// Defines a contact between two simulation bodies.
+/// </summary>
+struct SimulationContact
+{
+    unsigned int Lhs;
+    unsigned int Rhs;
+};
+
+/// <summary>
+/// Defines a contact being solved during a single step.
+/// </summary>
+template<typename TVector> struct SolverContact
+{
+    unsigned int Lhs;
+    unsigned int Rhs;
+    TVector      Normal;
+    float        Penetration;
+    float        EffectiveMass;
+    float        Bias;
+    float        Impulse;
+};
+
+/// <summary>
+/// Defines a cache of the contacts between pairs of bodies, kept across steps so that the
+/// impulses found in one step can be used as the starting point for the next.
+/// </summary>
+class ContactCache
+{
+    friend class Simulation;
+
+    /// <summary>
+    /// Defines a cached contact.
+    /// </summary>
+    struct Entry
+    {
+        float NormalImpulse;
+        bool  IsTouched;
+    };
+
+    std::unordered_map<unsigned long long, Entry> _entries;
+    std::vector<SolverContact<glm::vec3>> _spatialContacts;
+    std::vector<SolverContact<glm::vec2>> _planarContacts;
+    std::vector<std::vector<SolverContact<glm::vec3>>> _spatialCandidates; // One list per contact finding job, kept to avoid reallocating
+    std::vector<std::vector<SolverContact<glm::vec2>>> _planarCandidates;
+
+    /// <summary>
+    /// Gets the key for a pair of bodies.
+    /// </summary>
+    /// <param name="lhsId">The first body's ID.</param>
+    /// <param name="rhsId">The second body's ID.</param>
+    static unsigned long long GetKey( unsigned int lhsId, unsigned int rhsId );
+
+    /// <summary>
+    /// Gets the solver contacts list to use for the given vector type.
+    /// </summary>
+    std::vector<SolverContact<glm::vec3>>& GetSolverContacts( const glm::vec3& );
+
+    /// <summary>
+    /// Gets the solver contacts list to use for the given vector type.
+    /// </summary>
+    std::vector<SolverContact<glm::vec2>>& GetSolverContacts( const glm::vec2& );
+
+    /// <summary>
+    /// Gets the per-job candidate contact lists to use for the given vector type.
+    /// </summary>
+    std::vector<std::vector<SolverContact<glm::vec3>>>& GetCandidateLists( const glm::vec3& );
+
+    /// <summary>
+    /// Gets the per-job candidate contact lists to use for the given vector type.
+    /// </summary>
+    std::vector<std::vector<SolverContact<glm::vec2>>>& GetCandidateLists( const glm::vec2& );
+
+public:
+    /// <summary>
+    /// Removes every cached contact.
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Finds the impulse applied between two bodies last step.
+    /// </summary>
+    /// <param name="lhsId">The first body's ID.</param>
+    /// <param name="rhsId">The second body's ID.</param>
+    /// <returns>The accumulated impulse, or zero if the bodies were not touching.</returns>
+    float Find( unsigned int lhsId, unsigned int rhsId ) const;
+
+    /// <summary>
+    /// Gets the number of cached contacts.
+    /// </summary>
+    size_t GetCount() const;
+
+    /// <summary>
+    /// Removes every contact that was not stored since the last time the cache was pruned.
+    /// </summary>
+    void Prune();
+
+    /// <summary>
+    /// Stores the impulse applied between two bodies this step.
+    /// </summary>
+    /// <param name="lhsId">The first body's ID.</param>
+    /// <param name="rhsId">The second body's ID.</param>
+    /// <param name="impulse">The accumulated impulse.</param>
+    void Store( unsigned int lhsId, unsigned int rhsId, float impulse );
+};
+
+/// <summary>
+/// Defines a static class containing the data-only simulation kernels. These do not touch
+/// any game objects, so they can be run on a copy of the table from any thread.
+/// </summary>
+class Simulation
+{
+    ImplementStaticClass( Simulation );
+
+    /// <summary>
+    /// Finds the contact between two bodies, returning false if they are not touching.
+    /// </summary>
+    /// <param name="lhs">The first body.</param>
+    /// <param name="rhs">The second body.</param>
+    /// <param name="normal">Receives the contact normal, pointing from the first body to the second.</param>
+    /// <param name="penetration">Receives how far the bodies overlap.</param>
+    template<typename TBody> static bool FindContact( const TBody& lhs, const TBody& rhs, typename TBody::Vector& normal, float& penetration );
+
+    /// <summary>
+    /// Steps the given bodies forward in time.
+    /// </summary>
+    /// <param name="bodies">The bodies.</param>
+    /// <param name="time">The time step.</param>
+    /// <param name="contacts">The list to receive this step's contacts. Can be null.</param>
+    /// <param name="cache">The contacts kept from the previous step.</param>
+    template<typename TBody> static void StepBodies( std::vector<TBody>& bodies, float time, std::vector<SimulationContact>* contacts, ContactCache& cache );
+
+    /// <summary>
+    /// Applies friction to a body's velocity.
+    /// </summary>
+    /// <param name="body">The body.</param>
+    /// <param name="time">The time step.</param>
+    template<typename TBody> static void ApplyFriction( TBody& body, float time );
+
+    /// <summary>
+    /// Integrates a body's position, stopping the body once it is slow enough.
+    /// </summary>
+    /// <param name="bodies">Every body being stepped, used to find the meshes a fast body could pass through.</param>
+    /// <param name="body">The body.</param>
+    /// <param name="time">The time step.</param>
+    template<typename TBody> static void Integrate( const std::vector<TBody>& bodies, TBody& body, float time );
+
+    /// <summary>
+    /// Shortens a sphere's displacement so that it stops at the first mesh it would otherwise pass through.
+    /// </summary>
+    /// <param name="bodies">Every body being stepped.</param>
+    /// <param name="body">The sphere.</param>
+    /// <param name="displacement">The sphere's displacement this step.</param>
+    template<typename TBody> static void SweepMeshes( const std::vector<TBody>& bodies, const TBody& body, typename TBody::Vector& displacement );
+
+public:
+    /// <summary>
+    /// The friction applied to every moving body.
+    /// </summary>
+    static const float Friction;
+
+    /// <summary>
+    /// The speed, per axis, below which a body is considered to be stopped.
+    /// </summary>
+    static const float MinSpeed;
+
+    /// <summary>
+    /// The amount of speed kept along the normal after two spheres collide.
+    /// </summary>
+    static const float Restitution;
+
+    /// <summary>
+    /// The amount of speed kept along the normal after a sphere hits a static body.
+    /// </summary>
+    static const float CushionRestitution;
+
+    /// <summary>
+    /// The most velocity iterations the solver will run per step.
+    /// </summary>
+    static const int SolverIterations;
+
+    /// <summary>
+    /// The impulse change below which the solver considers itself converged.
+    /// </summary>
+    static const float ImpulseTolerance;
+
+    /// <summary>
+    /// The amount of penetration that is allowed before positions are corrected.
+    /// </summary>
+    static const float PenetrationSlop;
+
+    /// <summary>
+    /// The fraction of the remaining penetration that is corrected each step.
+    /// </summary>
+    static const float PenetrationCorrection;
+
+    /// <summary>
+    /// The number of bodies each job handles when a step is split across the job system.
+    /// </summary>
+    static const size_t BodiesPerJob;
+
+    /// <summary>
+    /// Checks to see if two bodies are colliding.
+    /// </summary>
+    /// <param name="lhs">The first body.</param>
+    /// <param name="rhs">The second body.</param>
+    static bool AreColliding( const SimulationBody& lhs, const SimulationBody& rhs );
+
+    /// <summary>
+    /// Checks to see if two planar bodies are colliding.
+    /// </summary>
+    /// <param name="lhs">The first body.</param>
+    /// <param name="rhs">The second body.</param>
+    static bool AreColliding( const PlanarBody& lhs, const PlanarBody& rhs );
+
+    /// <summary>
+    /// Checks to see if a contact between two bodies is a trigger only (e.g. a pocket).
+    /// </summary>
+    /// <param name="lhs">The first body.</param>
+    /// <param name="rhs">The second body.</param>
+    static bool IsTrigger( const SimulationBody& lhs, const SimulationBody& rhs );
+
+    /// <summary>
+    /// Checks to see if a contact between two planar bodies is a trigger only (e.g. a pocket).
+    /// </summary>
+    /// <param name="lhs">The first body.</param>
+    /// <param name="rhs">The second body.</param>
+    static bool IsTrigger( const PlanarBody& lhs, const PlanarBody& rhs );
+
+    /// <summary>
+    /// Steps all of the given bodies forward in time.
+    /// </summary>
+    /// <param name="bodies">The bodies.</param>
+    /// <param name="time">The time step.</param>
+    /// <param name="contacts">The list to receive this step's contacts. Can be null.</param>
+    /// <param name="cache">The contacts kept from the previous step.</param>
+    static void Step( std::vector<SimulationBody>& bodies, float time, std::vector<SimulationContact>* contacts, ContactCache& cache );
+
+    /// <summary>
+    /// Steps all of the given planar bodies forward in time.
+    /// </summary>
+    /// <param name="bodies">The bodies.</param>
+    /// <param name="time">The time step.</param>
+    /// <param name="contacts">The list to receive this step's contacts. Can be null.</param>
+    /// <param name="cache">The contacts kept from the previous step.</param>
+    static void Step( std::vector<PlanarBody>& bodies, float time, std::vector<SimulationContact>* contacts, ContactCache& cache );
+
+    /// <summary>
+    /// Converts a body into the table plane. Static bodies that do not cross the plane (e.g. the floor)
+    /// become inactive, as the plane itself already keeps everything on the table.
+    /// </summary>
+    /// <param name="body">The body.</param>
+    /// <param name="height">The height of the plane.</param>
+    static PlanarBody ToPlanar( const SimulationBody& body, float height );
+
+    /// <summary>
+    /// Copies a planar body's motion back onto the given body, keeping dynamic bodies at the plane's height.
+    /// </summary>
+    /// <param name="planar">The planar body.</param>
+    /// <param name="height">The height of the plane.</param>
+    /// <param name="body">The body to update.</param>
+    static void FromPlanar( const PlanarBody& planar, float height, SimulationBody& body );
+};
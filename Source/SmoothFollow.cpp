@@ -1,4 +1,5 @@
 #include "SmoothFollow.h"
+#include "Game.hpp"
 
 
 SmoothFollow::SmoothFollow(GameObject* gameObject)
@@ -20,13 +21,20 @@ SmoothFollow::~SmoothFollow()
 {
 }
 
+Transform* SmoothFollow::GetTarget() const
+{
+	return Game::GetInstance()->FindTransform(m_TargetTransform, m_TargetHandle);
+}
+
 void SmoothFollow::SetTarget(Transform* a_TargetTransform)
 {
 	m_TargetTransform = a_TargetTransform;
+	m_TargetHandle = a_TargetTransform ? a_TargetTransform->GetGameObject()->GetHandle() : GameObjectHandle();
 }
 
 void SmoothFollow::Update()
 {
+	m_TargetTransform = Game::GetInstance()->FindTransform(m_TargetTransform, m_TargetHandle);
 	if (m_pCamera != nullptr && m_TargetTransform != nullptr)
 	{
 		float fDeltaTime = Time::GetElapsedTime();
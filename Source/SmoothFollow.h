@@ -6,11 +6,13 @@
 class SmoothFollow :
 	public Component
 {
+	ImplementComponent(SmoothFollow, Component);
 private:
 	Camera* m_pCamera;
 
 	Transform* m_ObjectTransform;
 	Transform* m_TargetTransform;
+	GameObjectHandle m_TargetHandle;	// Lets us notice when the target's game object is destroyed
 
 	float m_fDistance;
 	float m_fHeight;
@@ -22,6 +24,7 @@ public:
 	SmoothFollow(GameObject* gameObject);
 	~SmoothFollow();
 
+	Transform* GetTarget() const;
 	void SetTarget(Transform* a_TargetTransform);
 	void Update() override;
 };
@@ -8,6 +8,7 @@
 /// </summary>
 class SphereCollider : public Collider
 {
+    ImplementComponent( SphereCollider, Collider );
     glm::vec3 _center;
     float _radius;
 
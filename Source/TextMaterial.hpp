@@ -7,6 +7,7 @@
 /// </summary>
 class TextMaterial : public Material
 {
+    ImplementComponent( TextMaterial, Material );
     glm::mat4 _world;
     glm::mat4 _projection;
     glm::vec4 _textColor;
@@ -5,7 +5,6 @@
 #include "Vertex.hpp"
 #include "Colors.hpp"
 #include "Game.hpp"
-#include "RenderManager.hpp"
 #include <algorithm>
 #include <DirectXColors.h>
 #include <vector>
@@ -16,17 +15,15 @@ using namespace DirectX;
 // Create a new text renderer
 TextRenderer::TextRenderer( GameObject* gameObject )
     : Component( gameObject )
+    , _fontSize( 12U )
     , _isMeshDirty( false )
 {
     _isDrawable = true;
-
-    RenderManager::AddRenderer( this );
 }
 
 // Destroys this text renderer
 TextRenderer::~TextRenderer()
 {
-    RenderManager::RemoveRenderer( this );
 }
 
 // Get our font
@@ -46,7 +43,7 @@ unsigned int TextRenderer::GetFontSize() const
 {
     if ( _font )
     {
-        return _font->GetCurrentSize();
+        return _fontSize;
     }
     return 0;
 }
@@ -86,8 +83,17 @@ void TextRenderer::RebuildMesh()
     float ySpace = _font->GetLineSpacing( fontSize );
     float x = 0.0f;
     float y = static_cast<float>( fontSize );
-    float uScale = 1.0f / _font->GetTexture( fontSize )->GetWidth();
-    float vScale = 1.0f / _font->GetTexture( fontSize )->GetHeight();
+
+    // Load every glyph before anything else, as a new glyph can grow the page's texture
+    for ( size_t i = 0; i < _text.length(); ++i )
+    {
+        _font->GetGlyph( _text[ i ], fontSize );
+    }
+    std::shared_ptr<Texture2D> texture = _font->GetTexture( fontSize );
+    _meshTexture = texture;
+
+    float uScale = 1.0f / texture->GetWidth();
+    float vScale = 1.0f / texture->GetHeight();
     char  chPrev = 0;
     std::vector<TextVertex> vertices;
 
@@ -150,9 +156,16 @@ void TextRenderer::RebuildMesh()
 
     
 
-    // Create the mesh
-    std::vector<unsigned int> indices;
-    _mesh = std::make_shared<Mesh>( vertices, indices );
+    // Re-use our mesh's buffer rather than making a new mesh every time the text changes
+    if ( _mesh )
+    {
+        _mesh->UpdateVertices( vertices );
+    }
+    else
+    {
+        std::vector<unsigned int> indices;
+        _mesh = std::make_shared<Mesh>( vertices, indices );
+    }
 }
 
 // Set the font
@@ -168,9 +181,9 @@ void TextRenderer::SetFont( std::shared_ptr<Font> value )
 // Set the font's size
 void TextRenderer::SetFontSize( unsigned int value )
 {
-    if ( _font )
+    if ( _fontSize != value )
     {
-        _font->SetCurrentSize( value );
+        _fontSize = value;
         _isMeshDirty = true;
     }
 }
@@ -185,6 +198,12 @@ void TextRenderer::SetText( const std::string& value )
 // Updates this text renderer
 void TextRenderer::Update()
 {
+    // Other text renderers sharing our font can grow its page texture, which moves our texture coordinates
+    if ( _font && _mesh && _font->GetTexture( _fontSize ) != _meshTexture.lock() )
+    {
+        _isMeshDirty = true;
+    }
+
     if ( _isMeshDirty )
     {
         RebuildMesh();
@@ -214,7 +233,7 @@ void TextRenderer::Draw()
                 0.1f                                        // far
             );
 
-            std::shared_ptr<Texture2D> texture = _font->GetTexture( _font->GetCurrentSize() );
+            std::shared_ptr<Texture2D> texture = _font->GetTexture( _fontSize );
             if ( texture )
             {
                 tm->SetWorld( _gameObject->GetWorldMatrix() );
@@ -9,12 +9,15 @@
 /// </summary>
 class TextRenderer : public Component
 {
+    ImplementComponent( TextRenderer, Component );
     friend class RenderManager;
 
 private:
     std::string _text;
     std::shared_ptr<Font> _font;
     std::shared_ptr<Mesh> _mesh;
+    std::weak_ptr<Texture2D> _meshTexture; // The glyph page texture the mesh was built for, held weakly so it tells when the page is replaced
+    unsigned int _fontSize;
     bool _isMeshDirty;
 
     /// <summary>
@@ -45,7 +48,7 @@ public:
     const Font* GetFont() const;
 
     /// <summary>
-    /// Gets the current font size.
+    /// Gets this text renderer's font size.
     /// </summary>
     unsigned int GetFontSize() const;
 
@@ -71,7 +74,8 @@ public:
     void SetFont( std::shared_ptr<Font> value );
 
     /// <summary>
-    /// Sets this text renderer's font size.
+    /// Sets this text renderer's font size. The size belongs to this text renderer rather than the
+    /// font, since fonts are shared.
     /// </summary>
     /// <param name="value">The new font size.</param>
     void SetFontSize( unsigned int value );
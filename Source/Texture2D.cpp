@@ -1,68 +1,495 @@
 #include "Texture2D.hpp"
+#include "VirtualFileSystem.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 
-std::unordered_map<std::string, std::shared_ptr<Texture2D>> Texture2D::_textureCache;
+#define TEXTURE_CACHE_MAGIC    0x31584554 // "TEX1"
+#define TEXTURE_CACHE_VERSION  1
+#define TEXTURE_MAX_ANISOTROPY 8.0f       // Past this, sharper textures at grazing angles cost more than they show
+
+#define DDS_MAGIC          0x20534444 // "DDS "
+#define DDS_FOURCC_DXT1    0x31545844 // "DXT1"
+#define DDS_FOURCC_DXT5    0x35545844 // "DXT5"
+#define DDSD_CAPS          0x00000001
+#define DDSD_HEIGHT        0x00000002
+#define DDSD_WIDTH         0x00000004
+#define DDSD_PIXELFORMAT   0x00001000
+#define DDSD_MIPMAPCOUNT   0x00020000
+#define DDSD_LINEARSIZE    0x00080000
+#define DDPF_FOURCC        0x00000004
+#define DDSCAPS_COMPLEX    0x00000008
+#define DDSCAPS_TEXTURE    0x00001000
+#define DDSCAPS_MIPMAP     0x00400000
+
+std::unordered_map<std::string, AssetHandle<Texture2D>> Texture2D::_textureCache;
+std::mutex Texture2D::_cacheMutex;
+std::mutex Texture2D::_cookMutex;
+
+// Joins the two words of a 64-bit number, low word first
+static unsigned long long MakeLong( const unsigned int words[ 2 ] )
+{
+    return static_cast<unsigned long long>( words[ 0 ] ) | ( static_cast<unsigned long long>( words[ 1 ] ) << 32 );
+}
+
+/// <summary>
+/// Defines a request to load a 2D texture. Its mip chain is streamed to the GPU a band of rows at a
+/// time through a pixel buffer, so the driver can copy them into the texture without stalling us.
+/// </summary>
+class TextureRequest : public TypedAssetRequest<Texture2D>
+{
+    std::string _fname;
+    bool _canCompress;
+    Texture2D::MipChain _chain;
+    GLuint _stagingBuffer;
+    unsigned int _uploadedLevel;
+    unsigned int _uploadedRows; // In the level's format's rows, so 4 pixels high for block formats
+
+    // Read the texture's mip chain
+    bool Decode() override
+    {
+        return Texture2D::ReadMipChain( _fname, _canCompress, _chain );
+    }
+
+    // Hand the next band of rows to the GPU
+    bool UploadPiece( size_t maxBytes ) override
+    {
+        if ( !_asset )
+        {
+            const Texture2D::MipLevel& base = _chain.Levels[ 0 ];
+            unsigned int levelCount = static_cast<unsigned int>( _chain.Levels.size() );
+            _asset.reset( new (std::nothrow) Texture2D( base.Width, base.Height, _chain.Format, levelCount ) );
+            glGenBuffers( 1, &_stagingBuffer );
+        }
+
+        // Bands never straddle two levels
+        const Texture2D::MipLevel& mip = _chain.Levels[ _uploadedLevel ];
+        unsigned int rowHeight = TextureCompressor::GetRowHeight( _chain.Format );
+        unsigned int levelRows = ( mip.Height + rowHeight - 1 ) / rowHeight;
+        size_t rowSize = TextureCompressor::GetRowSize( _chain.Format, mip.Width );
+
+        size_t rowCount = std::min<size_t>( levelRows - _uploadedRows, std::max<size_t>( maxBytes / std::max<size_t>( rowSize, 1 ), 1 ) );
+        size_t size = rowCount * rowSize;
+        const char* pixels = _chain.Data + mip.Offset + _uploadedRows * rowSize;
+        unsigned int y = _uploadedRows * rowHeight;
+        unsigned int height = std::min( static_cast<unsigned int>( rowCount ) * rowHeight, mip.Height - y );
+
+        if ( _asset && size > 0 )
+        {
+            // Orphan the last band's storage, so writing this band never waits on the copy of the last
+            glBindBuffer( GL_PIXEL_UNPACK_BUFFER, _stagingBuffer );
+            glBufferData( GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW );
+            void* staging = glMapBufferRange( GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT );
+            if ( staging )
+            {
+                memcpy( staging, pixels, size );
+                glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+
+                // With a pixel buffer bound, the data pointer is an offset into the buffer
+                _asset->UpdateRows( _uploadedLevel, y, height, nullptr, size );
+                glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+            }
+            else
+            {
+                glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+                _asset->UpdateRows( _uploadedLevel, y, height, pixels, size );
+            }
+        }
+
+        _uploadedRows += static_cast<unsigned int>( rowCount );
+        if ( _uploadedRows >= levelRows )
+        {
+            ++_uploadedLevel;
+            _uploadedRows = 0;
+        }
+        if ( _uploadedLevel < _chain.Levels.size() )
+        {
+            return false;
+        }
+
+        // The GPU has its own copy now
+        glDeleteBuffers( 1, &_stagingBuffer );
+        _stagingBuffer = 0;
+        _chain.File.Close();
+        std::vector<char>().swap( _chain.Built );
+        return true;
+    }
+
+public:
+    // Create a new texture request
+    TextureRequest( const std::string& fname, bool canCompress )
+        : _fname( fname )
+        , _canCompress( canCompress )
+        , _stagingBuffer( 0 )
+        , _uploadedLevel( 0 )
+        , _uploadedRows( 0 )
+    {
+    }
+
+    // Destroy this texture request
+    ~TextureRequest()
+    {
+        if ( _stagingBuffer )
+        {
+            glDeleteBuffers( 1, &_stagingBuffer );
+        }
+    }
+};
+
+// Create a new, empty mip chain
+Texture2D::MipChain::MipChain()
+    : Data( nullptr )
+    , Format( TextureFormat::RGBA8 )
+{
+}
 
 // Create an empty texture
 std::shared_ptr<Texture2D> Texture2D::Create( unsigned int width, unsigned int height )
 {
-    return std::shared_ptr<Texture2D>( new (std::nothrow) Texture2D( width, height, nullptr, false ) );
+    return std::shared_ptr<Texture2D>( new (std::nothrow) Texture2D( width, height, TextureFormat::RGBA8, 1 ) );
 }
 
 // Load a texture from a file
 std::shared_ptr<Texture2D> Texture2D::FromFile( const std::string& fname )
 {
+    AssetHandle<Texture2D> handle = FromFileAsync( fname );
+    AssetLoader::Wait( handle );
+    return handle.Get();
+}
+
+// Start loading a texture from a file
+AssetHandle<Texture2D> Texture2D::FromFileAsync( const std::string& fname )
+{
+    std::lock_guard<std::mutex> lock( _cacheMutex );
+
     // We don't need to re-load textures
     auto search = _textureCache.find( fname );
     if ( search != _textureCache.end() )
     {
+        GpuResourceManager::Touch( "Texture2D:", fname );
         return search->second;
     }
 
-    std::shared_ptr<Texture2D> texture;
+    // GLEW is only initialized on the main thread, so ask it about compression here rather than on the worker
+    std::shared_ptr<TextureRequest> request = std::make_shared<TextureRequest>( fname, GLEW_EXT_texture_compression_s3tc != GL_FALSE );
+    AssetHandle<Texture2D> handle( request );
+    _textureCache[ fname ] = handle;
+    GpuResourceManager::AddCachedAsset( "Texture2D:", fname, _textureCache, _cacheMutex );
 
-    // Attempt to load the file as an image
-    Image image;
-    if ( image.LoadFromFile( fname ) )
+    AssetLoader::Load( request );
+    return handle;
+}
+
+// Load a texture from an image
+std::shared_ptr<Texture2D> Texture2D::FromImage( const Image& image )
+{
+    MipChain chain;
+    BuildMipChain( image, TextureFormat::RGBA8, chain );
+    if ( chain.Levels.empty() )
     {
-        texture = Texture2D::FromImage( image );
-        _textureCache[ fname ] = texture;
+        return nullptr;
     }
 
+    unsigned int levelCount = static_cast<unsigned int>( chain.Levels.size() );
+    std::shared_ptr<Texture2D> texture( new (std::nothrow) Texture2D( image.GetWidth(), image.GetHeight(), TextureFormat::RGBA8, levelCount ) );
+    for ( unsigned int level = 0; texture && level < levelCount; ++level )
+    {
+        const MipLevel& mip = chain.Levels[ level ];
+        texture->UpdateRows( level, 0, mip.Height, chain.Data + mip.Offset, mip.Size );
+    }
     return texture;
 }
 
-// Load a texture from an image
-std::shared_ptr<Texture2D> Texture2D::FromImage( const Image& image )
+// Build an image's mip chain
+void Texture2D::BuildMipChain( const Image& image, TextureFormat format, MipChain& chain )
 {
-    unsigned int width  = image.GetWidth();
-    unsigned int height = image.GetHeight();
-    const void*  pixels = image.GetPixels();
-    return std::shared_ptr<Texture2D>( new (std::nothrow) Texture2D( width, height, pixels, true ) );
+    chain.File.Close();
+    chain.Built.clear();
+    chain.Levels.clear();
+    chain.Format = format;
+    chain.Data = nullptr;
+    if ( image.GetWidth() == 0 || image.GetHeight() == 0 )
+    {
+        return;
+    }
+
+    // Each level is filtered down from the one before it, so only two are ever held at once
+    Image mipmaps[ 2 ];
+    const Image* source = &image;
+    for ( unsigned int level = 0; ; ++level )
+    {
+        MipLevel mip;
+        mip.Offset = chain.Built.size();
+        mip.Width = source->GetWidth();
+        mip.Height = source->GetHeight();
+        mip.Size = TextureCompressor::GetImageSize( format, mip.Width, mip.Height );
+        chain.Levels.push_back( mip );
+
+        chain.Built.resize( mip.Offset + mip.Size );
+        TextureCompressor::Compress( *source, format, &chain.Built[ mip.Offset ] );
+
+        Image& next = mipmaps[ level % 2 ];
+        if ( !source->CreateMipmap( next ) )
+        {
+            break;
+        }
+        source = &next;
+    }
+
+    chain.Data = &chain.Built[ 0 ];
+}
+
+// Read an image file's mip chain
+bool Texture2D::ReadMipChain( const std::string& fname, bool canCompress, MipChain& chain )
+{
+    // Uncompressed textures are as big on disk as the image is decoded, so they aren't worth caching
+    Image image;
+    if ( !canCompress )
+    {
+        if ( !image.LoadFromFile( fname ) )
+        {
+            return false;
+        }
+        BuildMipChain( image, TextureFormat::RGBA8, chain );
+        return !chain.Levels.empty();
+    }
+
+    unsigned long long sourceSize = 0;
+    long long sourceTime = 0;
+    bool hasSource = VirtualFileSystem::GetFileInfo( fname, sourceSize, sourceTime );
+
+    // The cached texture is only used if it was made from this exact image
+    std::string cachedName = fname + ".dds";
+    if ( LoadCached( cachedName, hasSource, sourceSize, sourceTime, chain ) )
+    {
+        return true;
+    }
+    if ( !hasSource )
+    {
+        return false;
+    }
+
+    // Only one thread compresses at a time, and an image another thread has just cached doesn't need compressing again
+    std::lock_guard<std::mutex> lock( _cookMutex );
+    if ( LoadCached( cachedName, hasSource, sourceSize, sourceTime, chain ) )
+    {
+        return true;
+    }
+
+    if ( !image.LoadFromFile( fname ) )
+    {
+        return false;
+    }
+    BuildMipChain( image, image.HasAlpha() ? TextureFormat::BC3 : TextureFormat::BC1, chain );
+    if ( chain.Levels.empty() )
+    {
+        return false;
+    }
+
+    SaveCached( cachedName, sourceSize, sourceTime, chain );
+    return true;
+}
+
+// Attempt to map a cached DDS file
+bool Texture2D::LoadCached( const std::string& fname, bool hasSource, unsigned long long sourceSize, long long sourceTime, MipChain& chain )
+{
+    MappedFile& file = chain.File;
+    if ( !file.Open( fname ) || file.GetSize() < sizeof( unsigned int ) + sizeof( DdsHeader ) )
+    {
+        file.Close();
+        return false;
+    }
+
+    // Make sure the texture is ours, is current, and is one of the formats we write
+    unsigned int magic = 0;
+    memcpy( &magic, file.GetData(), sizeof( magic ) );
+    const DdsHeader* header = reinterpret_cast<const DdsHeader*>( file.GetData() + sizeof( magic ) );
+    bool isValid = magic == DDS_MAGIC
+                && header->Size == sizeof( DdsHeader )
+                && header->CacheMagic == TEXTURE_CACHE_MAGIC
+                && header->CacheVersion == TEXTURE_CACHE_VERSION
+                && ( !hasSource || ( MakeLong( header->SourceSize ) == sourceSize && static_cast<long long>( MakeLong( header->SourceTime ) ) == sourceTime ) )
+                && ( header->FourCC == DDS_FOURCC_DXT1 || header->FourCC == DDS_FOURCC_DXT5 )
+                && header->Width > 0 && header->Height > 0;
+
+    // The file has to hold the whole mip chain and nothing else
+    chain.Format = ( header->FourCC == DDS_FOURCC_DXT1 ) ? TextureFormat::BC1 : TextureFormat::BC3;
+    chain.Levels.clear();
+    size_t offset = sizeof( magic ) + sizeof( DdsHeader );
+    unsigned int width = header->Width;
+    unsigned int height = header->Height;
+    while ( isValid )
+    {
+        MipLevel mip;
+        mip.Offset = offset;
+        mip.Width = width;
+        mip.Height = height;
+        mip.Size = TextureCompressor::GetImageSize( chain.Format, width, height );
+        chain.Levels.push_back( mip );
+
+        offset += mip.Size;
+        isValid = offset <= file.GetSize();
+        if ( width == 1 && height == 1 )
+        {
+            break;
+        }
+        width = std::max( width / 2, 1U );
+        height = std::max( height / 2, 1U );
+    }
+    isValid = isValid
+           && header->MipMapCount == chain.Levels.size()
+           && offset == file.GetSize();
+
+    if ( !isValid )
+    {
+        chain.Levels.clear();
+        file.Close();
+        return false;
+    }
+
+    // Page the texture in while we're on a worker, leaving nothing for the upload to wait on
+    file.Prefetch( 0, file.GetSize() );
+    chain.Built.clear();
+    chain.Data = file.GetData();
+    return true;
+}
+
+// Attempt to save a mip chain as a DDS file
+bool Texture2D::SaveCached( const std::string& fname, unsigned long long sourceSize, long long sourceTime, const MipChain& chain )
+{
+    if ( chain.Format == TextureFormat::RGBA8 || chain.Levels.empty() )
+    {
+        return false;
+    }
+
+    DdsHeader header;
+    memset( &header, 0, sizeof( header ) );
+    header.Size = sizeof( header );
+    header.Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+    header.Height = chain.Levels[ 0 ].Height;
+    header.Width = chain.Levels[ 0 ].Width;
+    header.LinearSize = static_cast<unsigned int>( chain.Levels[ 0 ].Size );
+    header.MipMapCount = static_cast<unsigned int>( chain.Levels.size() );
+    header.CacheMagic = TEXTURE_CACHE_MAGIC;
+    header.CacheVersion = TEXTURE_CACHE_VERSION;
+    header.SourceSize[ 0 ] = static_cast<unsigned int>( sourceSize & 0xFFFFFFFF );
+    header.SourceSize[ 1 ] = static_cast<unsigned int>( sourceSize >> 32 );
+    header.SourceTime[ 0 ] = static_cast<unsigned int>( static_cast<unsigned long long>( sourceTime ) & 0xFFFFFFFF );
+    header.SourceTime[ 1 ] = static_cast<unsigned int>( static_cast<unsigned long long>( sourceTime ) >> 32 );
+    header.FormatSize = 32;
+    header.FormatFlags = DDPF_FOURCC;
+    header.FourCC = ( chain.Format == TextureFormat::BC1 ) ? DDS_FOURCC_DXT1 : DDS_FOURCC_DXT5;
+    header.Caps = DDSCAPS_TEXTURE | ( header.MipMapCount > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0 );
+
+    const MipLevel& first = chain.Levels.front();
+    const MipLevel& last = chain.Levels.back();
+    unsigned int magic = DDS_MAGIC;
+
+    // Write to a temporary file first, so nobody ever maps a half-written texture
+    std::string tempName = fname + ".tmp";
+    {
+        std::ofstream file( tempName, std::ios::binary | std::ios::trunc );
+        if ( !file.is_open() )
+        {
+            return false;
+        }
+
+        file.write( reinterpret_cast<const char*>( &magic ), sizeof( magic ) );
+        file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+        file.write( chain.Data + first.Offset, static_cast<std::streamsize>( last.Offset + last.Size - first.Offset ) );
+        if ( !file )
+        {
+            file.close();
+            std::remove( tempName.c_str() );
+            return false;
+        }
+    }
+
+    // Renaming won't replace a file on every platform, so get rid of the stale texture first
+    std::remove( fname.c_str() );
+    if ( std::rename( tempName.c_str(), fname.c_str() ) != 0 )
+    {
+        std::remove( tempName.c_str() );
+        return false;
+    }
+    return true;
 }
 
 // Create an empty 2D texture
-Texture2D::Texture2D( unsigned int width, unsigned int height, const void* data, bool genMipMaps )
-    : _texture( 0 )
+Texture2D::Texture2D( unsigned int width, unsigned int height, TextureFormat format, unsigned int levelCount )
+    : _texture( GpuResourceType::Texture )
     , _width( width )
     , _height( height )
+    , _format( format )
 {
-    glGenTextures( 1, &_texture );
-    glBindTexture( GL_TEXTURE_2D, _texture );
-    
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+    glBindTexture( GL_TEXTURE_2D, _texture.Create() );
+
+    // Allocate every level up front, so the texture is complete however the levels arrive
+    GLenum internalFormat = GetInternalFormat( format );
+    size_t textureSize = 0;
+    for ( unsigned int level = 0; level < levelCount; ++level )
+    {
+        GLsizei levelWidth = static_cast<GLsizei>( std::max( width >> level, 1U ) );
+        GLsizei levelHeight = static_cast<GLsizei>( std::max( height >> level, 1U ) );
+        textureSize += TextureCompressor::GetImageSize( format, levelWidth, levelHeight );
+        if ( format == TextureFormat::RGBA8 )
+        {
+            glTexImage2D( GL_TEXTURE_2D, level, GL_RGBA, levelWidth, levelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+        }
+        else
+        {
+            GLsizei size = static_cast<GLsizei>( TextureCompressor::GetImageSize( format, levelWidth, levelHeight ) );
+            glCompressedTexImage2D( GL_TEXTURE_2D, level, internalFormat, levelWidth, levelHeight, 0, size, nullptr );
+        }
+    }
+    SetSampling( GL_TEXTURE_2D, levelCount );
+    _texture.SetSize( textureSize );
 
     glBindTexture( GL_TEXTURE_2D, 0 );
 }
 
+// Get the GL format a texture format is stored as
+GLenum Texture2D::GetInternalFormat( TextureFormat format )
+{
+    switch ( format )
+    {
+    case TextureFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case TextureFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    default:                 return GL_RGBA8;
+    }
+}
+
+// Set how the bound texture is sampled
+void Texture2D::SetSampling( GLenum target, unsigned int levelCount )
+{
+    glTexParameteri( target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>( levelCount ) - 1 );
+
+    // Mipmapped textures are seen at a distance and at an angle, but font pages are drawn pixel for pixel
+    if ( levelCount > 1 )
+    {
+        glTexParameteri( target, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+        glTexParameteri( target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+        if ( GLEW_EXT_texture_filter_anisotropic )
+        {
+            GLfloat maxAnisotropy = 1.0f;
+            glGetFloatv( GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy );
+            glTexParameterf( target, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min( maxAnisotropy, TEXTURE_MAX_ANISOTROPY ) );
+        }
+    }
+    else
+    {
+        glTexParameteri( target, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+        glTexParameteri( target, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    }
+    glTexParameteri( target, GL_TEXTURE_WRAP_S, GL_REPEAT );
+    glTexParameteri( target, GL_TEXTURE_WRAP_T, GL_REPEAT );
+}
+
 // Destroy this 2D texture
 Texture2D::~Texture2D()
 {
-    glDeleteTextures( 1, &_texture );
+    _texture.Release();
 }
 
 // Gets this texture's handle
@@ -74,13 +501,32 @@ GLuint Texture2D::GetHandle() const
 // Get the texture's height
 unsigned int Texture2D::GetHeight() const
 {
-    return _width;
+    return _height;
 }
 
 // Get the texture's width
 unsigned int Texture2D::GetWidth() const
 {
-    return _height;
+    return _width;
+}
+
+// Updates rows of one level of the texture
+void Texture2D::UpdateRows( unsigned int level, unsigned int y, unsigned int height, const void* data, size_t size )
+{
+    GLsizei width = static_cast<GLsizei>( std::max( _width >> level, 1U ) );
+    GLint yi = static_cast<GLint>( y );
+    GLsizei hi = static_cast<GLsizei>( height );
+
+    glBindTexture( GL_TEXTURE_2D, _texture );
+    if ( _format == TextureFormat::RGBA8 )
+    {
+        glTexSubImage2D( GL_TEXTURE_2D, level, 0, yi, width, hi, GL_RGBA, GL_UNSIGNED_BYTE, data );
+    }
+    else
+    {
+        glCompressedTexSubImage2D( GL_TEXTURE_2D, level, 0, yi, width, hi, GetInternalFormat( _format ), static_cast<GLsizei>( size ), data );
+    }
+    glBindTexture( GL_TEXTURE_2D, 0 );
 }
 
 // Updates the given area of the texture
@@ -1,36 +1,170 @@
 #pragma once
 
 #include "OpenGL.hpp"
+#include "AssetLoader.hpp"
+#include "GpuResourceManager.hpp"
 #include "Image.hpp"
+#include "MappedFile.hpp"
+#include "TextureCompressor.hpp"
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 /// <summary>
-/// Defines a 2D texture.
+/// Defines a 2D texture. Textures loaded from files are block compressed the first time they are
+/// loaded, and their whole mip chain is cached next to them as a DDS file.
 /// </summary>
 class Texture2D
 {
     friend class Font;
     friend class Image;
+    friend class Texture2DArray;
+    friend class TextureArrayRequest;
+    friend class TextureRequest;
 
-    static std::unordered_map<std::string, std::shared_ptr<Texture2D>> _textureCache;
+    /// <summary>
+    /// Defines the header of a DDS file, which follows its "DDS " magic number. The texture loader's
+    /// own magic number, version and source file stamp are kept in the reserved words.
+    /// </summary>
+    struct DdsHeader
+    {
+        unsigned int Size;
+        unsigned int Flags;
+        unsigned int Height;
+        unsigned int Width;
+        unsigned int LinearSize;
+        unsigned int Depth;
+        unsigned int MipMapCount;
+        unsigned int CacheMagic;
+        unsigned int CacheVersion;
+        unsigned int SourceSize[ 2 ];  // The size of the image the texture was cached from, low word first
+        unsigned int SourceTime[ 2 ];  // The modification time of the image the texture was cached from, low word first
+        unsigned int Reserved1[ 5 ];
+        unsigned int FormatSize;
+        unsigned int FormatFlags;
+        unsigned int FourCC;
+        unsigned int RgbBitCount;
+        unsigned int RedMask;
+        unsigned int GreenMask;
+        unsigned int BlueMask;
+        unsigned int AlphaMask;
+        unsigned int Caps;
+        unsigned int Caps2;
+        unsigned int Caps3;
+        unsigned int Caps4;
+        unsigned int Reserved2;
+    };
+
+    /// <summary>
+    /// Defines one level of a mip chain.
+    /// </summary>
+    struct MipLevel
+    {
+        size_t       Offset; // From the start of the chain's data
+        size_t       Size;
+        unsigned int Width;
+        unsigned int Height;
+    };
+
+    /// <summary>
+    /// Defines a texture's mip chain, either mapped straight from a cached DDS file or built in memory.
+    /// </summary>
+    struct MipChain
+    {
+        MappedFile            File;
+        std::vector<char>     Built;
+        const char*           Data;
+        TextureFormat         Format;
+        std::vector<MipLevel> Levels;
+
+        MipChain();
+    };
 
-    GLuint       _texture;
-    unsigned int _width;
-    unsigned int _height;
+    static std::unordered_map<std::string, AssetHandle<Texture2D>> _textureCache;
+    static std::mutex _cacheMutex;
+    static std::mutex _cookMutex;
+
+    GpuResource   _texture;
+    unsigned int  _width;
+    unsigned int  _height;
+    TextureFormat _format;
 
     /// <summary>
-    /// Creates a new 2D texture.
+    /// Creates a new 2D texture, allocating every level of its mip chain.
     /// </summary>
     /// <param name="width">The width of the texture.</param>
     /// <param name="height">The height of the texture.</param>
-    /// <param name="data">The texture's initial data. (NOTE: Assumed to be RGBA.)</param>
-    /// <param name="genMipMaps">True to generate mip maps, false to not.</param>
-    Texture2D( unsigned int width, unsigned int height, const void* data, bool genMipMaps );
+    /// <param name="format">The format of the texture's pixels.</param>
+    /// <param name="levelCount">The number of levels in the texture's mip chain. Textures with more than one are filtered trilinearly.</param>
+    Texture2D( unsigned int width, unsigned int height, TextureFormat format, unsigned int levelCount );
 
     /// <summary>
-    /// Creates a new 2D texture.
+    /// Gets the GL format a texture format is stored as.
+    /// </summary>
+    /// <param name="format">The format.</param>
+    static GLenum GetInternalFormat( TextureFormat format );
+
+    /// <summary>
+    /// Sets how the bound texture is sampled. Mipmapped textures are filtered trilinearly and
+    /// anisotropically, and anything else is sampled pixel for pixel.
+    /// </summary>
+    /// <param name="target">The target the texture is bound to.</param>
+    /// <param name="levelCount">The number of levels in the texture's mip chain.</param>
+    static void SetSampling( GLenum target, unsigned int levelCount );
+
+    /// <summary>
+    /// Builds an image's whole mip chain in memory.
+    /// </summary>
+    /// <param name="image">The image.</param>
+    /// <param name="format">The format to store the levels in.</param>
+    /// <param name="chain">Receives the mip chain.</param>
+    static void BuildMipChain( const Image& image, TextureFormat format, MipChain& chain );
+
+    /// <summary>
+    /// Reads an image file's mip chain, from its cached DDS file if that is current, or by loading the
+    /// image and caching the result if not. Called on a worker thread.
+    /// </summary>
+    /// <param name="fname">The image file name.</param>
+    /// <param name="canCompress">True if the GPU can sample block compressed textures.</param>
+    /// <param name="chain">Receives the mip chain.</param>
+    /// <returns>True if the mip chain was read, false if not.</returns>
+    static bool ReadMipChain( const std::string& fname, bool canCompress, MipChain& chain );
+
+    /// <summary>
+    /// Attempts to map a cached DDS file.
+    /// </summary>
+    /// <param name="fname">The DDS file name.</param>
+    /// <param name="hasSource">True if the image exists, false to trust the file without checking it against the image.</param>
+    /// <param name="sourceSize">The size of the image, to check the file against.</param>
+    /// <param name="sourceTime">The modification time of the image, to check the file against.</param>
+    /// <param name="chain">Receives the mip chain.</param>
+    /// <returns>True if the file was mapped and is current, false if not.</returns>
+    static bool LoadCached( const std::string& fname, bool hasSource, unsigned long long sourceSize, long long sourceTime, MipChain& chain );
+
+    /// <summary>
+    /// Attempts to save a mip chain as a DDS file.
+    /// </summary>
+    /// <param name="fname">The DDS file name.</param>
+    /// <param name="sourceSize">The size of the image the mip chain was built from.</param>
+    /// <param name="sourceTime">The modification time of the image the mip chain was built from.</param>
+    /// <param name="chain">The mip chain.</param>
+    /// <returns>True if the file was saved, false if not.</returns>
+    static bool SaveCached( const std::string& fname, unsigned long long sourceSize, long long sourceTime, const MipChain& chain );
+
+    /// <summary>
+    /// Updates rows of one level of this texture. If a pixel buffer is bound, the data is an offset into it.
+    /// </summary>
+    /// <param name="level">The level.</param>
+    /// <param name="y">The Y coordinate of the first row, which must be a multiple of the format's row height.</param>
+    /// <param name="height">The number of rows.</param>
+    /// <param name="data">The rows, stored in this texture's format.</param>
+    /// <param name="size">The size of the rows.</param>
+    void UpdateRows( unsigned int level, unsigned int y, unsigned int height, const void* data, size_t size );
+
+    /// <summary>
+    /// Updates an area of this texture's first level.
     /// </summary>
     /// <param name="x">The X coordinate of the area to update.</param>
     /// <param name="y">The Y coordinate of the area to update.</param>
@@ -48,11 +182,18 @@ public:
     static std::shared_ptr<Texture2D> Create( unsigned int width, unsigned int height );
 
     /// <summary>
-    /// Loads a 2D texture from a file.
+    /// Loads a 2D texture from a file, waiting for it to finish.
     /// </summary>
     /// <param name="fname">The file to load.</param>
     static std::shared_ptr<Texture2D> FromFile( const std::string& fname );
 
+    /// <summary>
+    /// Starts loading a 2D texture from a file in the background. The file is decoded on a worker
+    /// thread, and the pixels are streamed to the GPU over the next few frames.
+    /// </summary>
+    /// <param name="fname">The file to load.</param>
+    static AssetHandle<Texture2D> FromFileAsync( const std::string& fname );
+
     /// <summary>
     /// Loads a 2D texture from an image.
     /// </summary>
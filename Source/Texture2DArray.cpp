@@ -0,0 +1,284 @@
+#include "Texture2DArray.hpp"
+#include "Texture2D.hpp"
+#include <algorithm>
+#include <cstring>
+
+std::unordered_map<std::string, AssetHandle<Texture2DArray>> Texture2DArray::_arrayCache;
+std::mutex Texture2DArray::_cacheMutex;
+
+/// <summary>
+/// Defines a request to load a 2D texture array. Every layer's mip chain is read the same way a 2D
+/// texture's is, then streamed to the GPU a band of rows at a time through a pixel buffer.
+/// </summary>
+class TextureArrayRequest : public TypedAssetRequest<Texture2DArray>
+{
+    std::vector<std::string> _fnames;
+    bool _canCompress;
+    std::vector<std::unique_ptr<Texture2D::MipChain>> _layers;
+    GLuint _stagingBuffer;
+    unsigned int _uploadedLayer;
+    unsigned int _uploadedLevel;
+    unsigned int _uploadedRows; // In the layer's format's rows, so 4 pixels high for block formats
+
+    // Read every layer's mip chain
+    bool ReadLayers( bool canCompress )
+    {
+        _layers.clear();
+        for ( const std::string& fname : _fnames )
+        {
+            std::unique_ptr<Texture2D::MipChain> chain( new Texture2D::MipChain() );
+            if ( !Texture2D::ReadMipChain( fname, canCompress, *chain ) )
+            {
+                return false;
+            }
+            _layers.push_back( std::move( chain ) );
+        }
+        return true;
+    }
+
+    // Read the array's layers
+    bool Decode() override
+    {
+        if ( _fnames.empty() || !ReadLayers( _canCompress ) )
+        {
+            return false;
+        }
+
+        // Opaque and see-through images are compressed differently, so a mixed set can only be stored uncompressed
+        bool isMixed = false;
+        for ( size_t i = 1; i < _layers.size(); ++i )
+        {
+            isMixed = isMixed || _layers[ i ]->Format != _layers.front()->Format;
+        }
+        if ( isMixed && !ReadLayers( false ) )
+        {
+            return false;
+        }
+
+        // Every layer has to be the same size, which also gives them the same number of levels
+        const Texture2D::MipChain& first = *_layers.front();
+        for ( size_t i = 1; i < _layers.size(); ++i )
+        {
+            if ( _layers[ i ]->Levels[ 0 ].Width != first.Levels[ 0 ].Width || _layers[ i ]->Levels[ 0 ].Height != first.Levels[ 0 ].Height )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Hand the next band of rows to the GPU
+    bool UploadPiece( size_t maxBytes ) override
+    {
+        const Texture2D::MipChain& chain = *_layers[ _uploadedLayer ];
+        if ( !_asset )
+        {
+            const Texture2D::MipLevel& base = chain.Levels[ 0 ];
+            unsigned int layerCount = static_cast<unsigned int>( _layers.size() );
+            unsigned int levelCount = static_cast<unsigned int>( chain.Levels.size() );
+            _asset.reset( new (std::nothrow) Texture2DArray( base.Width, base.Height, layerCount, chain.Format, levelCount ) );
+            glGenBuffers( 1, &_stagingBuffer );
+        }
+
+        // Bands never straddle two levels or two layers
+        const Texture2D::MipLevel& mip = chain.Levels[ _uploadedLevel ];
+        unsigned int rowHeight = TextureCompressor::GetRowHeight( chain.Format );
+        unsigned int levelRows = ( mip.Height + rowHeight - 1 ) / rowHeight;
+        size_t rowSize = TextureCompressor::GetRowSize( chain.Format, mip.Width );
+
+        size_t rowCount = std::min<size_t>( levelRows - _uploadedRows, std::max<size_t>( maxBytes / std::max<size_t>( rowSize, 1 ), 1 ) );
+        size_t size = rowCount * rowSize;
+        const char* pixels = chain.Data + mip.Offset + _uploadedRows * rowSize;
+        unsigned int y = _uploadedRows * rowHeight;
+        unsigned int height = std::min( static_cast<unsigned int>( rowCount ) * rowHeight, mip.Height - y );
+
+        if ( _asset && size > 0 )
+        {
+            // Orphan the last band's storage, so writing this band never waits on the copy of the last
+            glBindBuffer( GL_PIXEL_UNPACK_BUFFER, _stagingBuffer );
+            glBufferData( GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW );
+            void* staging = glMapBufferRange( GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT );
+            if ( staging )
+            {
+                memcpy( staging, pixels, size );
+                glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+
+                // With a pixel buffer bound, the data pointer is an offset into the buffer
+                _asset->UpdateRows( _uploadedLayer, _uploadedLevel, y, height, nullptr, size );
+                glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+            }
+            else
+            {
+                glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+                _asset->UpdateRows( _uploadedLayer, _uploadedLevel, y, height, pixels, size );
+            }
+        }
+
+        _uploadedRows += static_cast<unsigned int>( rowCount );
+        if ( _uploadedRows >= levelRows )
+        {
+            ++_uploadedLevel;
+            _uploadedRows = 0;
+        }
+        if ( _uploadedLevel >= chain.Levels.size() )
+        {
+            // The GPU has its own copy of this layer now
+            _layers[ _uploadedLayer ].reset();
+            ++_uploadedLayer;
+            _uploadedLevel = 0;
+        }
+        if ( _uploadedLayer < _layers.size() )
+        {
+            return false;
+        }
+
+        glDeleteBuffers( 1, &_stagingBuffer );
+        _stagingBuffer = 0;
+        _layers.clear();
+        return true;
+    }
+
+public:
+    // Create a new texture array request
+    TextureArrayRequest( const std::vector<std::string>& fnames, bool canCompress )
+        : _fnames( fnames )
+        , _canCompress( canCompress )
+        , _stagingBuffer( 0 )
+        , _uploadedLayer( 0 )
+        , _uploadedLevel( 0 )
+        , _uploadedRows( 0 )
+    {
+    }
+
+    // Destroy this texture array request
+    ~TextureArrayRequest()
+    {
+        if ( _stagingBuffer )
+        {
+            glDeleteBuffers( 1, &_stagingBuffer );
+        }
+    }
+};
+
+// Load a texture array from a set of files
+std::shared_ptr<Texture2DArray> Texture2DArray::FromFiles( const std::vector<std::string>& fnames )
+{
+    AssetHandle<Texture2DArray> handle = FromFilesAsync( fnames );
+    AssetLoader::Wait( handle );
+    return handle.Get();
+}
+
+// Start loading a texture array from a set of files
+AssetHandle<Texture2DArray> Texture2DArray::FromFilesAsync( const std::vector<std::string>& fnames )
+{
+    std::string key;
+    for ( const std::string& fname : fnames )
+    {
+        key += fname;
+        key += '|';
+    }
+
+    std::lock_guard<std::mutex> lock( _cacheMutex );
+
+    // We don't need to re-load arrays of the same files
+    auto search = _arrayCache.find( key );
+    if ( search != _arrayCache.end() )
+    {
+        GpuResourceManager::Touch( "Texture2DArray:", key );
+        return search->second;
+    }
+
+    // GLEW is only initialized on the main thread, so ask it about compression here rather than on the worker
+    std::shared_ptr<TextureArrayRequest> request = std::make_shared<TextureArrayRequest>( fnames, GLEW_EXT_texture_compression_s3tc != GL_FALSE );
+    AssetHandle<Texture2DArray> handle( request );
+    _arrayCache[ key ] = handle;
+    GpuResourceManager::AddCachedAsset( "Texture2DArray:", key, _arrayCache, _cacheMutex );
+
+    AssetLoader::Load( request );
+    return handle;
+}
+
+// Create an empty 2D texture array
+Texture2DArray::Texture2DArray( unsigned int width, unsigned int height, unsigned int layerCount, TextureFormat format, unsigned int levelCount )
+    : _texture( GpuResourceType::Texture )
+    , _width( width )
+    , _height( height )
+    , _layerCount( layerCount )
+    , _format( format )
+{
+    glBindTexture( GL_TEXTURE_2D_ARRAY, _texture.Create() );
+
+    // Allocate every level of every layer up front, so the array is complete however the layers arrive
+    GLenum internalFormat = Texture2D::GetInternalFormat( format );
+    GLsizei depth = static_cast<GLsizei>( layerCount );
+    size_t textureSize = 0;
+    for ( unsigned int level = 0; level < levelCount; ++level )
+    {
+        GLsizei levelWidth = static_cast<GLsizei>( std::max( width >> level, 1U ) );
+        GLsizei levelHeight = static_cast<GLsizei>( std::max( height >> level, 1U ) );
+        textureSize += TextureCompressor::GetImageSize( format, levelWidth, levelHeight ) * layerCount;
+        if ( format == TextureFormat::RGBA8 )
+        {
+            glTexImage3D( GL_TEXTURE_2D_ARRAY, level, GL_RGBA, levelWidth, levelHeight, depth, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+        }
+        else
+        {
+            GLsizei size = static_cast<GLsizei>( TextureCompressor::GetImageSize( format, levelWidth, levelHeight ) * layerCount );
+            glCompressedTexImage3D( GL_TEXTURE_2D_ARRAY, level, internalFormat, levelWidth, levelHeight, depth, 0, size, nullptr );
+        }
+    }
+    Texture2D::SetSampling( GL_TEXTURE_2D_ARRAY, levelCount );
+    _texture.SetSize( textureSize );
+
+    glBindTexture( GL_TEXTURE_2D_ARRAY, 0 );
+}
+
+// Destroy this 2D texture array
+Texture2DArray::~Texture2DArray()
+{
+    _texture.Release();
+}
+
+// Get this texture array's handle
+GLuint Texture2DArray::GetHandle() const
+{
+    return _texture;
+}
+
+// Get the height of each layer
+unsigned int Texture2DArray::GetHeight() const
+{
+    return _height;
+}
+
+// Get the number of layers
+unsigned int Texture2DArray::GetLayerCount() const
+{
+    return _layerCount;
+}
+
+// Get the width of each layer
+unsigned int Texture2DArray::GetWidth() const
+{
+    return _width;
+}
+
+// Update rows of one level of one layer
+void Texture2DArray::UpdateRows( unsigned int layer, unsigned int level, unsigned int y, unsigned int height, const void* data, size_t size )
+{
+    GLsizei width = static_cast<GLsizei>( std::max( _width >> level, 1U ) );
+    GLint yi = static_cast<GLint>( y );
+    GLint zi = static_cast<GLint>( layer );
+    GLsizei hi = static_cast<GLsizei>( height );
+
+    glBindTexture( GL_TEXTURE_2D_ARRAY, _texture );
+    if ( _format == TextureFormat::RGBA8 )
+    {
+        glTexSubImage3D( GL_TEXTURE_2D_ARRAY, level, 0, yi, zi, width, hi, 1, GL_RGBA, GL_UNSIGNED_BYTE, data );
+    }
+    else
+    {
+        glCompressedTexSubImage3D( GL_TEXTURE_2D_ARRAY, level, 0, yi, zi, width, hi, 1, Texture2D::GetInternalFormat( _format ), static_cast<GLsizei>( size ), data );
+    }
+    glBindTexture( GL_TEXTURE_2D_ARRAY, 0 );
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "OpenGL.hpp"
+#include "AssetLoader.hpp"
+#include "GpuResourceManager.hpp"
+#include "TextureCompressor.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// Defines an array of same-sized 2D textures bound as one. Everything drawn from the same array
+/// shares a single texture binding, picking its image by layer instead.
+/// </summary>
+class Texture2DArray
+{
+    friend class TextureArrayRequest;
+
+    ImplementNonCopyableClass( Texture2DArray );
+    ImplementNonMovableClass( Texture2DArray );
+
+    static std::unordered_map<std::string, AssetHandle<Texture2DArray>> _arrayCache;
+    static std::mutex _cacheMutex;
+
+    GpuResource   _texture;
+    unsigned int  _width;
+    unsigned int  _height;
+    unsigned int  _layerCount;
+    TextureFormat _format;
+
+    /// <summary>
+    /// Creates a new 2D texture array, allocating every level of every layer.
+    /// </summary>
+    /// <param name="width">The width of each layer.</param>
+    /// <param name="height">The height of each layer.</param>
+    /// <param name="layerCount">The number of layers.</param>
+    /// <param name="format">The format of the layers' pixels.</param>
+    /// <param name="levelCount">The number of levels in each layer's mip chain.</param>
+    Texture2DArray( unsigned int width, unsigned int height, unsigned int layerCount, TextureFormat format, unsigned int levelCount );
+
+    /// <summary>
+    /// Updates rows of one level of one layer. If a pixel buffer is bound, the data is an offset into it.
+    /// </summary>
+    /// <param name="layer">The layer.</param>
+    /// <param name="level">The level.</param>
+    /// <param name="y">The Y coordinate of the first row, which must be a multiple of the format's row height.</param>
+    /// <param name="height">The number of rows.</param>
+    /// <param name="data">The rows, stored in this array's format.</param>
+    /// <param name="size">The size of the rows.</param>
+    void UpdateRows( unsigned int layer, unsigned int level, unsigned int y, unsigned int height, const void* data, size_t size );
+
+public:
+    /// <summary>
+    /// Loads a 2D texture array from a set of same-sized image files, waiting for it to finish.
+    /// </summary>
+    /// <param name="fnames">The files to load, one per layer.</param>
+    static std::shared_ptr<Texture2DArray> FromFiles( const std::vector<std::string>& fnames );
+
+    /// <summary>
+    /// Starts loading a 2D texture array from a set of same-sized image files in the background. Each
+    /// file shares its cached mip chain with the 2D texture loaded from it.
+    /// </summary>
+    /// <param name="fnames">The files to load, one per layer.</param>
+    static AssetHandle<Texture2DArray> FromFilesAsync( const std::vector<std::string>& fnames );
+
+    /// <summary>
+    /// Destroys this 2D texture array.
+    /// </summary>
+    ~Texture2DArray();
+
+    /// <summary>
+    /// Gets this texture array's handle.
+    /// </summary>
+    GLuint GetHandle() const;
+
+    /// <summary>
+    /// Gets the height of each layer.
+    /// </summary>
+    unsigned int GetHeight() const;
+
+    /// <summary>
+    /// Gets the number of layers.
+    /// </summary>
+    unsigned int GetLayerCount() const;
+
+    /// <summary>
+    /// Gets the width of each layer.
+    /// </summary>
+    unsigned int GetWidth() const;
+};
@@ -0,0 +1,264 @@
+#include "TextureCompressor.hpp"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#define TEXTURE_BLOCK_POWER_ITERATIONS 8 // Enough for the principal axis of 16 colors to settle
+
+// Packs a color into 5:6:5 bits
+static unsigned short PackColor( const glm::vec3& color )
+{
+    glm::vec3 clamped = glm::clamp( color, glm::vec3( 0.0f ), glm::vec3( 255.0f ) );
+    unsigned int r = static_cast<unsigned int>( clamped.r * 31.0f / 255.0f + 0.5f );
+    unsigned int g = static_cast<unsigned int>( clamped.g * 63.0f / 255.0f + 0.5f );
+    unsigned int b = static_cast<unsigned int>( clamped.b * 31.0f / 255.0f + 0.5f );
+    return static_cast<unsigned short>( ( r << 11 ) | ( g << 5 ) | b );
+}
+
+// Unpacks a 5:6:5 color the way the GPU does
+static glm::vec3 UnpackColor( unsigned short color )
+{
+    unsigned int r = ( color >> 11 ) & 31;
+    unsigned int g = ( color >> 5 ) & 63;
+    unsigned int b = color & 31;
+    return glm::vec3( static_cast<float>( ( r << 3 ) | ( r >> 2 ) ),
+                      static_cast<float>( ( g << 2 ) | ( g >> 4 ) ),
+                      static_cast<float>( ( b << 3 ) | ( b >> 2 ) ) );
+}
+
+// Picks the palette entry nearest each color, returning the total squared error
+static float FitColorIndices( const glm::vec3 colors[ 16 ], unsigned short& color0, unsigned short& color1, unsigned int& indices )
+{
+    // Four-color mode needs the first endpoint to be the larger
+    if ( color0 < color1 )
+    {
+        std::swap( color0, color1 );
+    }
+
+    glm::vec3 palette[ 4 ];
+    palette[ 0 ] = UnpackColor( color0 );
+    palette[ 1 ] = UnpackColor( color1 );
+    palette[ 2 ] = ( palette[ 0 ] * 2.0f + palette[ 1 ] ) / 3.0f;
+    palette[ 3 ] = ( palette[ 0 ] + palette[ 1 ] * 2.0f ) / 3.0f;
+
+    // Equal endpoints would be three-color mode, but every index then picks the first endpoint anyway
+    unsigned int paletteSize = ( color0 == color1 ) ? 1 : 4;
+
+    float error = 0.0f;
+    indices = 0;
+    for ( unsigned int i = 0; i < 16; ++i )
+    {
+        unsigned int best = 0;
+        float bestDistance = glm::dot( colors[ i ] - palette[ 0 ], colors[ i ] - palette[ 0 ] );
+        for ( unsigned int j = 1; j < paletteSize; ++j )
+        {
+            float distance = glm::dot( colors[ i ] - palette[ j ], colors[ i ] - palette[ j ] );
+            if ( distance < bestDistance )
+            {
+                best = j;
+                bestDistance = distance;
+            }
+        }
+
+        indices |= best << ( i * 2 );
+        error += bestDistance;
+    }
+    return error;
+}
+
+// Reads a 4x4 block of pixels from an image
+void TextureCompressor::ReadBlock( const Image& image, unsigned int x, unsigned int y, unsigned char block[ 64 ] )
+{
+    const unsigned char* pixels = image.GetPixels();
+    unsigned int width = image.GetWidth();
+    unsigned int height = image.GetHeight();
+
+    for ( unsigned int row = 0; row < 4; ++row )
+    {
+        unsigned int sourceY = std::min( y + row, height - 1 );
+        for ( unsigned int column = 0; column < 4; ++column )
+        {
+            unsigned int sourceX = std::min( x + column, width - 1 );
+            memcpy( block + ( row * 4 + column ) * 4, pixels + ( sourceY * width + sourceX ) * 4, 4 );
+        }
+    }
+}
+
+// Encodes the colors of a block
+void TextureCompressor::EncodeColors( const unsigned char block[ 64 ], unsigned char* output )
+{
+    glm::vec3 colors[ 16 ];
+    glm::vec3 mean( 0.0f );
+    for ( unsigned int i = 0; i < 16; ++i )
+    {
+        colors[ i ] = glm::vec3( block[ i * 4 ], block[ i * 4 + 1 ], block[ i * 4 + 2 ] );
+        mean += colors[ i ];
+    }
+    mean /= 16.0f;
+
+    // The colors spread out most along the principal axis of their covariance
+    glm::mat3 covariance( 0.0f );
+    glm::vec3 low = colors[ 0 ];
+    glm::vec3 high = colors[ 0 ];
+    for ( unsigned int i = 0; i < 16; ++i )
+    {
+        glm::vec3 offset = colors[ i ] - mean;
+        covariance += glm::outerProduct( offset, offset );
+        low = glm::min( low, colors[ i ] );
+        high = glm::max( high, colors[ i ] );
+    }
+
+    glm::vec3 axis = high - low;
+    for ( unsigned int i = 0; i < TEXTURE_BLOCK_POWER_ITERATIONS && glm::dot( axis, axis ) > 0.0f; ++i )
+    {
+        axis = covariance * axis;
+        float length = glm::length( axis );
+        axis = ( length > 0.0f ) ? axis / length : glm::vec3( 0.0f );
+    }
+
+    // The endpoints start at the colors furthest along the axis
+    float minProjection = 0.0f;
+    float maxProjection = 0.0f;
+    for ( unsigned int i = 0; i < 16; ++i )
+    {
+        float projection = glm::dot( colors[ i ] - mean, axis );
+        minProjection = std::min( minProjection, projection );
+        maxProjection = std::max( maxProjection, projection );
+    }
+
+    unsigned short color0 = PackColor( mean + axis * maxProjection );
+    unsigned short color1 = PackColor( mean + axis * minProjection );
+    unsigned int indices = 0;
+    float error = FitColorIndices( colors, color0, color1, indices );
+
+    // Then move to the least-squares fit for the indices they picked, if that is any closer
+    static const float weights[ 4 ] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    glm::vec3 ax( 0.0f ), bx( 0.0f );
+    for ( unsigned int i = 0; i < 16; ++i )
+    {
+        float a = weights[ ( indices >> ( i * 2 ) ) & 3 ];
+        float b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        ax += colors[ i ] * a;
+        bx += colors[ i ] * b;
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if ( error > 0.0f && determinant > 0.0f )
+    {
+        unsigned short refined0 = PackColor( ( ax * bb - bx * ab ) / determinant );
+        unsigned short refined1 = PackColor( ( bx * aa - ax * ab ) / determinant );
+        unsigned int refinedIndices = 0;
+        if ( FitColorIndices( colors, refined0, refined1, refinedIndices ) < error )
+        {
+            color0 = refined0;
+            color1 = refined1;
+            indices = refinedIndices;
+        }
+    }
+
+    output[ 0 ] = static_cast<unsigned char>( color0 & 0xFF );
+    output[ 1 ] = static_cast<unsigned char>( color0 >> 8 );
+    output[ 2 ] = static_cast<unsigned char>( color1 & 0xFF );
+    output[ 3 ] = static_cast<unsigned char>( color1 >> 8 );
+    for ( unsigned int i = 0; i < 4; ++i )
+    {
+        output[ 4 + i ] = static_cast<unsigned char>( ( indices >> ( i * 8 ) ) & 0xFF );
+    }
+}
+
+// Encodes the alpha of a block
+void TextureCompressor::EncodeAlpha( const unsigned char block[ 64 ], unsigned char* output )
+{
+    unsigned char alpha0 = block[ 3 ];
+    unsigned char alpha1 = block[ 3 ];
+    for ( unsigned int i = 1; i < 16; ++i )
+    {
+        alpha0 = std::max( alpha0, block[ i * 4 + 3 ] );
+        alpha1 = std::min( alpha1, block[ i * 4 + 3 ] );
+    }
+
+    // Eight-value mode spreads six blends evenly between the endpoints
+    int palette[ 8 ] = { alpha0, alpha1 };
+    for ( int i = 1; i < 7; ++i )
+    {
+        palette[ i + 1 ] = ( ( 7 - i ) * alpha0 + i * alpha1 + 3 ) / 7;
+    }
+
+    unsigned long long indices = 0;
+    for ( unsigned int i = 0; i < 16 && alpha0 != alpha1; ++i )
+    {
+        int alpha = block[ i * 4 + 3 ];
+        unsigned long long best = 0;
+        for ( unsigned int j = 1; j < 8; ++j )
+        {
+            if ( std::abs( alpha - palette[ j ] ) < std::abs( alpha - palette[ best ] ) )
+            {
+                best = j;
+            }
+        }
+        indices |= best << ( i * 3 );
+    }
+
+    output[ 0 ] = alpha0;
+    output[ 1 ] = alpha1;
+    for ( unsigned int i = 0; i < 6; ++i )
+    {
+        output[ 2 + i ] = static_cast<unsigned char>( ( indices >> ( i * 8 ) ) & 0xFF );
+    }
+}
+
+// Gets the number of pixel rows stored together in a format
+unsigned int TextureCompressor::GetRowHeight( TextureFormat format )
+{
+    return ( format == TextureFormat::RGBA8 ) ? 1 : 4;
+}
+
+// Gets the size of one row of pixels or blocks
+size_t TextureCompressor::GetRowSize( TextureFormat format, unsigned int width )
+{
+    switch ( format )
+    {
+    case TextureFormat::BC1: return ( ( width + 3 ) / 4 ) * 8;
+    case TextureFormat::BC3: return ( ( width + 3 ) / 4 ) * 16;
+    default:                 return width * 4;
+    }
+}
+
+// Gets the size of an image stored in a format
+size_t TextureCompressor::GetImageSize( TextureFormat format, unsigned int width, unsigned int height )
+{
+    unsigned int rowHeight = GetRowHeight( format );
+    return GetRowSize( format, width ) * ( ( height + rowHeight - 1 ) / rowHeight );
+}
+
+// Stores an image in a format
+void TextureCompressor::Compress( const Image& image, TextureFormat format, char* output )
+{
+    unsigned char* destination = reinterpret_cast<unsigned char*>( output );
+    if ( format == TextureFormat::RGBA8 )
+    {
+        memcpy( destination, image.GetPixels(), GetImageSize( format, image.GetWidth(), image.GetHeight() ) );
+        return;
+    }
+
+    unsigned char block[ 64 ];
+    for ( unsigned int y = 0; y < image.GetHeight(); y += 4 )
+    {
+        for ( unsigned int x = 0; x < image.GetWidth(); x += 4 )
+        {
+            ReadBlock( image, x, y, block );
+            if ( format == TextureFormat::BC3 )
+            {
+                EncodeAlpha( block, destination );
+                destination += 8;
+            }
+            EncodeColors( block, destination );
+            destination += 8;
+        }
+    }
+}
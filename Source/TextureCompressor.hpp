@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Config.hpp"
+#include "Image.hpp"
+
+/// <summary>
+/// Defines the formats a texture's pixels can be stored in.
+/// </summary>
+enum class TextureFormat
+{
+    RGBA8, // Uncompressed
+    BC1,   // DXT1, 4 bits a pixel with no alpha
+    BC3    // DXT5, 8 bits a pixel with smooth alpha
+};
+
+/// <summary>
+/// Defines a static block compressor, used to turn images into textures the GPU can sample without
+/// decompressing them. Each 4x4 block of pixels is stored as two colors and the blend of them every
+/// pixel is nearest to.
+/// </summary>
+class TextureCompressor
+{
+    ImplementStaticClass( TextureCompressor );
+
+    /// <summary>
+    /// Reads a 4x4 block of pixels from an image. Pixels past the image's edge repeat its last pixel.
+    /// </summary>
+    /// <param name="image">The image.</param>
+    /// <param name="x">The X coordinate of the block's first pixel.</param>
+    /// <param name="y">The Y coordinate of the block's first pixel.</param>
+    /// <param name="block">Receives the block's RGBA pixels.</param>
+    static void ReadBlock( const Image& image, unsigned int x, unsigned int y, unsigned char block[ 64 ] );
+
+    /// <summary>
+    /// Encodes the colors of a block into BC1's 8 bytes, always in four-color mode.
+    /// </summary>
+    /// <param name="block">The block's RGBA pixels.</param>
+    /// <param name="output">Receives the encoded colors.</param>
+    static void EncodeColors( const unsigned char block[ 64 ], unsigned char* output );
+
+    /// <summary>
+    /// Encodes the alpha of a block into BC3's 8 bytes, always in eight-value mode.
+    /// </summary>
+    /// <param name="block">The block's RGBA pixels.</param>
+    /// <param name="output">Receives the encoded alpha.</param>
+    static void EncodeAlpha( const unsigned char block[ 64 ], unsigned char* output );
+
+public:
+    /// <summary>
+    /// Gets the number of pixel rows stored together in a format, which is 4 for block formats.
+    /// </summary>
+    /// <param name="format">The format.</param>
+    static unsigned int GetRowHeight( TextureFormat format );
+
+    /// <summary>
+    /// Gets the size of one row of pixels, or of blocks, in a format.
+    /// </summary>
+    /// <param name="format">The format.</param>
+    /// <param name="width">The width of the image.</param>
+    static size_t GetRowSize( TextureFormat format, unsigned int width );
+
+    /// <summary>
+    /// Gets the size of an image stored in a format.
+    /// </summary>
+    /// <param name="format">The format.</param>
+    /// <param name="width">The width of the image.</param>
+    /// <param name="height">The height of the image.</param>
+    static size_t GetImageSize( TextureFormat format, unsigned int width, unsigned int height );
+
+    /// <summary>
+    /// Stores an image in a format.
+    /// </summary>
+    /// <param name="image">The image.</param>
+    /// <param name="format">The format.</param>
+    /// <param name="output">Receives the stored image, which must have room for GetImageSize bytes.</param>
+    static void Compress( const Image& image, TextureFormat format, char* output );
+};
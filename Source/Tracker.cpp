@@ -1,4 +1,5 @@
 #include "Tracker.h"
+#include "Game.hpp"
 
 
 Tracker::Tracker(GameObject* gameObject)
@@ -19,11 +20,13 @@ Tracker::~Tracker()
 void Tracker::SetTarget(Transform* transform)
 {
 	m_TargetTransform = transform;
+	m_TargetHandle = transform ? transform->GetGameObject()->GetHandle() : GameObjectHandle();
 }
 
 void Tracker::Update()
 {
 	float fDeltaTime = Time::GetElapsedTime();
+	m_TargetTransform = Game::GetInstance()->FindTransform(m_TargetTransform, m_TargetHandle);
 
 	if (m_TargetTransform != nullptr && m_pCamera != nullptr)
 	{
@@ -6,11 +6,13 @@
 class Tracker :
 	public Component
 {
+	ImplementComponent(Tracker, Component);
 private:
 	Camera* m_pCamera;
 
 	Transform* m_ObjectTransform;
 	Transform* m_TargetTransform;
+	GameObjectHandle m_TargetHandle;	// Lets us notice when the target's game object is destroyed
 
 	float m_fDamping;
 public:
@@ -1,13 +1,70 @@
 #include "Transform.hpp"
+#include "ComponentPool.hpp"
+#include <cmath>
+#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __SSE__ )
+#   include <xmmintrin.h>
+#   define TRANSFORM_USE_SSE
+#endif
+
+// Create a new identity matrix
+AffineMatrix::AffineMatrix()
+{
+    Rows[ 0 ] = glm::vec4( 1, 0, 0, 0 );
+    Rows[ 1 ] = glm::vec4( 0, 1, 0, 0 );
+    Rows[ 2 ] = glm::vec4( 0, 0, 1, 0 );
+}
+
+// Expand into a full matrix
+glm::mat4 AffineMatrix::ToMatrix() const
+{
+    // GLM matrices are column-major, so our rows become the first three values of each column
+    return glm::mat4( Rows[ 0 ].x, Rows[ 1 ].x, Rows[ 2 ].x, 0.0f,
+                      Rows[ 0 ].y, Rows[ 1 ].y, Rows[ 2 ].y, 0.0f,
+                      Rows[ 0 ].z, Rows[ 1 ].z, Rows[ 2 ].z, 0.0f,
+                      Rows[ 0 ].w, Rows[ 1 ].w, Rows[ 2 ].w, 1.0f );
+}
+
+// Multiply two affine matrices
+void AffineMatrix::Multiply( const AffineMatrix& lhs, const AffineMatrix& rhs, AffineMatrix& result )
+{
+    // Each result row is a weighted sum of the right-hand rows, plus the left-hand translation
+#if defined( TRANSFORM_USE_SSE )
+    const __m128 rhs0 = _mm_loadu_ps( &rhs.Rows[ 0 ].x );
+    const __m128 rhs1 = _mm_loadu_ps( &rhs.Rows[ 1 ].x );
+    const __m128 rhs2 = _mm_loadu_ps( &rhs.Rows[ 2 ].x );
+    const __m128 translationMask = _mm_set_ps( 1.0f, 0.0f, 0.0f, 0.0f );
+
+    for ( int i = 0; i < 3; ++i )
+    {
+        const glm::vec4& row = lhs.Rows[ i ];
+        __m128 sum = _mm_mul_ps( _mm_set1_ps( row.x ), rhs0 );
+        sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( row.y ), rhs1 ) );
+        sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( row.z ), rhs2 ) );
+        sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( row.w ), translationMask ) );
+        _mm_storeu_ps( &result.Rows[ i ].x, sum );
+    }
+#else
+    for ( int i = 0; i < 3; ++i )
+    {
+        const glm::vec4& row = lhs.Rows[ i ];
+        result.Rows[ i ] = row.x * rhs.Rows[ 0 ]
+                         + row.y * rhs.Rows[ 1 ]
+                         + row.z * rhs.Rows[ 2 ]
+                         + glm::vec4( 0, 0, 0, row.w );
+    }
+#endif
+}
 
 // Constructor
 Transform::Transform( GameObject* gameObj )
     : Component( gameObj )
-    , _world( 1.0f )
+    , _orientation( 1, 0, 0, 0 )
     , _position( 0, 0, 0 )
-    , _rotation( 0, 0, 0 )
     , _scale( 1, 1, 1 )
-    , _isWorldDirty( false )
+    , _rotation( 0, 0, 0 )
+    , _parent( nullptr )
+    , _isWorldDirty( true )
+    , _areAxesDirty( true )
 {
 }
 
@@ -34,67 +91,169 @@ glm::vec3 Transform::GetRotation() const
     return _rotation;
 }
 
+// Get the rotation
+glm::quat Transform::GetOrientation() const
+{
+    return _orientation;
+}
+
 // Gets the world matrix
-const glm::mat4& Transform::GetWorldMatrix() const
+glm::mat4 Transform::GetWorldMatrix() const
+{
+    return GetAffineWorldMatrix().ToMatrix();
+}
+
+// Gets the world matrix in its compact form
+const AffineMatrix& Transform::GetAffineWorldMatrix() const
 {
+    // The once-per-frame pass normally gets here first, but changes made since then are caught here
     if ( _isWorldDirty )
     {
-        // Calculate the rotation matrix
-        // TODO - Use a quaternion?
-        glm::mat4 rotationMatrix = glm::rotate( _rotation.x, glm::vec3( 1, 0, 0 ) )
-                                 * glm::rotate( _rotation.y, glm::vec3( 0, 1, 0 ) )
-                                 * glm::rotate( _rotation.z, glm::vec3( 0, 0, 1 ) );
-
-        // Now multiply to get our world matrix
-        _world  = glm::mat4( 1.0f );
-        _world *= glm::translate( _position )
-               *  rotationMatrix
-               *  glm::scale( _scale );
-
-        // Update our flag to show that we don't need to be updated
-        _isWorldDirty = false;
+        if ( _parent )
+        {
+            _parent->GetAffineWorldMatrix();
+        }
+        RebuildWorldMatrix();
     }
-
     return _world;
 }
 
+// Mark this transform and every transform below it as dirty
+void Transform::MarkWorldDirty()
+{
+    // A dirty transform's children are always dirty too, so there's no need to go any further
+    if ( _isWorldDirty )
+    {
+        return;
+    }
+    _isWorldDirty = true;
+
+    auto& children = _gameObject->_children;
+    for ( auto iter = children.begin(); iter != children.end(); ++iter )
+    {
+        iter->get()->_transform->MarkWorldDirty();
+    }
+}
+
+// Rebuild this transform's world matrix
+void Transform::RebuildWorldMatrix() const
+{
+    // Build the local matrix straight from the quaternion, scaling each axis
+    glm::mat3 rotation = glm::mat3_cast( _orientation );
+    AffineMatrix local;
+    for ( int i = 0; i < 3; ++i )
+    {
+        local.Rows[ i ] = glm::vec4( rotation[ 0 ][ i ] * _scale.x,
+                                     rotation[ 1 ][ i ] * _scale.y,
+                                     rotation[ 2 ][ i ] * _scale.z,
+                                     _position[ i ] );
+    }
+
+    if ( _parent )
+    {
+        AffineMatrix::Multiply( _parent->_world, local, _world );
+    }
+    else
+    {
+        _world = local;
+    }
+
+    _isWorldDirty = false;
+    _areAxesDirty = true;
+}
+
+// Rebuild the dirty world matrices of this transform and everything below it
+void Transform::RebuildWorldMatrixTree() const
+{
+    if ( _isWorldDirty )
+    {
+        RebuildWorldMatrix();
+    }
+
+    auto& children = _gameObject->_children;
+    for ( auto iter = children.begin(); iter != children.end(); ++iter )
+    {
+        iter->get()->_transform->RebuildWorldMatrixTree();
+    }
+}
+
 // Set the position
 void Transform::SetPosition( glm::vec3 nPos )
 {
     _position = nPos;
-    _isWorldDirty = true;
+    MarkWorldDirty();
 }
 
 // Set the scale
 void Transform::SetScale( glm::vec3 nSca )
 {
     _scale = nSca;
-    _isWorldDirty = true;
+    MarkWorldDirty();
 }
 
 // Set the rotation
 void Transform::SetRotation( glm::vec3 nRot )
 {
     _rotation = nRot;
-    _isWorldDirty = true;
+    _orientation = glm::angleAxis( nRot.x, glm::vec3( 1, 0, 0 ) )
+                 * glm::angleAxis( nRot.y, glm::vec3( 0, 1, 0 ) )
+                 * glm::angleAxis( nRot.z, glm::vec3( 0, 0, 1 ) );
+    MarkWorldDirty();
 }
 
-// Gets the local coordinate systems
-CoordinateSystem Transform::GetLocalCoordinateSystem() const
+// Set the rotation
+void Transform::SetOrientation( const glm::quat& orientation )
 {
-	// Remove the translation from the world matrix
-	glm::mat4 rotation = _world;
-	rotation[3] = glm::vec4(0, 0, 0, 1);	// Gets the rotation matrix
+    _orientation = orientation;
 
-	// Get the local coordinate axes (we need to normalize in case the matrix scales)
-	CoordinateSystem local;
-	local.XAxis = glm::normalize(TransformVector(rotation, glm::vec3(1, 0, 0)));	// Gives the X-axis
-	local.YAxis = glm::normalize(TransformVector(rotation, glm::vec3(0, 1, 0)));	// Gives the Y-axis
-	local.ZAxis = glm::normalize(TransformVector(rotation, glm::vec3(0, 0, -1)));	// Gives the z-axis
-	return local;
+    // Decompose in the same X * Y * Z order SetRotation composes in, so the angles rebuild this orientation.
+    // The matrix is column-major, so m[ col ][ row ]
+    glm::mat3 m = glm::mat3_cast( orientation );
+    float sinY = glm::clamp( m[ 2 ][ 0 ], -1.0f, 1.0f );
+    _rotation.y = std::asin( sinY );
+    if ( std::abs( sinY ) < 0.99999f )
+    {
+        _rotation.x = std::atan2( -m[ 2 ][ 1 ], m[ 2 ][ 2 ] );
+        _rotation.z = std::atan2( -m[ 1 ][ 0 ], m[ 0 ][ 0 ] );
+    }
+    else
+    {
+        // Gimbal lock, where X and Z turn about the same axis, so put it all on X
+        _rotation.x = std::atan2( m[ 1 ][ 2 ], m[ 1 ][ 1 ] );
+        _rotation.z = 0.0f;
+    }
+    MarkWorldDirty();
+}
+
+// Gets the local coordinate systems
+const CoordinateSystem& Transform::GetLocalCoordinateSystem() const
+{
+	const AffineMatrix& world = GetAffineWorldMatrix();
+	if (_areAxesDirty)
+	{
+		// The axes are the world matrix's columns (we need to normalize in case the matrix scales)
+		_axes.XAxis = glm::normalize(glm::vec3(world.Rows[0].x, world.Rows[1].x, world.Rows[2].x));	// Gives the X-axis
+		_axes.YAxis = glm::normalize(glm::vec3(world.Rows[0].y, world.Rows[1].y, world.Rows[2].y));	// Gives the Y-axis
+		_axes.ZAxis = -glm::normalize(glm::vec3(world.Rows[0].z, world.Rows[1].z, world.Rows[2].z));	// Gives the z-axis
+		_areAxesDirty = false;
+	}
+	return _axes;
 }
 
 // Updates this transform
 void Transform::Update()
 {
 }
+
+// Rebuild every dirty world matrix
+void Transform::UpdateWorldMatrices()
+{
+    // Each hierarchy is only touched by the job that finds its root, so no two jobs share a matrix
+    ComponentPool::GetPool<Transform>()->ParallelForEach<Transform>( []( Transform* transform )
+    {
+        if ( !transform->_parent )
+        {
+            transform->RebuildWorldMatrixTree();
+        }
+    } );
+}
@@ -2,6 +2,7 @@
 
 #include "Component.hpp"
 #include "GameObject.hpp"
+#include <glm/gtc/quaternion.hpp>
 
 /// <summary>
 /// Defines a coordinate system
@@ -30,16 +31,65 @@ struct CoordinateSystem
 };
 
 /// <summary>
-/// Defines a transform.
+/// Defines an affine matrix as the top three rows of a 4x4 matrix, the bottom row always being (0, 0, 0, 1).
+/// </summary>
+struct AffineMatrix
+{
+    glm::vec4 Rows[ 3 ];
+
+    /// <summary>
+    /// Creates a new identity matrix.
+    /// </summary>
+    AffineMatrix();
+
+    /// <summary>
+    /// Expands this matrix into a full 4x4 matrix.
+    /// </summary>
+    glm::mat4 ToMatrix() const;
+
+    /// <summary>
+    /// Multiplies two affine matrices.
+    /// </summary>
+    /// <param name="lhs">The left-hand matrix, applied last.</param>
+    /// <param name="rhs">The right-hand matrix, applied first.</param>
+    /// <param name="result">Receives the product. Must not be either of the inputs.</param>
+    static void Multiply( const AffineMatrix& lhs, const AffineMatrix& rhs, AffineMatrix& result );
+};
+
+/// <summary>
+/// Defines a transform. World matrices are cached, and changing a transform marks it and every
+/// transform below it as needing its world matrix rebuilt.
 /// </summary>
 class Transform : public Component
 {
+    ImplementComponent( Transform, Component );
+    friend class GameObject; // Game objects set up our parent
+
 protected:
-    mutable glm::mat4 _world;
+    mutable AffineMatrix _world;
+    mutable CoordinateSystem _axes;
+    glm::quat _orientation;
     glm::vec3 _position;
     glm::vec3 _scale;
     glm::vec3 _rotation;
+    Transform* _parent;
     mutable bool _isWorldDirty;
+    mutable bool _areAxesDirty;
+
+    /// <summary>
+    /// Marks this transform and every transform below it as needing their world matrices rebuilt.
+    /// </summary>
+    void MarkWorldDirty();
+
+    /// <summary>
+    /// Rebuilds this transform's world matrix, assuming its parent's is already up to date.
+    /// </summary>
+    void RebuildWorldMatrix() const;
+
+    /// <summary>
+    /// Rebuilds the dirty world matrices of this transform and every transform below it, parents first.
+    /// </summary>
+    void RebuildWorldMatrixTree() const;
 
 public:
     /// <summary>
@@ -69,9 +119,19 @@ public:
     glm::vec3 GetRotation() const;
 
     /// <summary>
-    /// Gets the world matrix of this transform.
+    /// Returns the rotation of this transform.
+    /// </summary>
+    glm::quat GetOrientation() const;
+
+    /// <summary>
+    /// Gets the world matrix of this transform, including every parent's transform.
+    /// </summary>
+    glm::mat4 GetWorldMatrix() const;
+
+    /// <summary>
+    /// Gets the world matrix of this transform in its compact form.
     /// </summary>
-    const glm::mat4& GetWorldMatrix() const;
+    const AffineMatrix& GetAffineWorldMatrix() const;
 
     /// <summary>
     /// Sets this transform to the given position.
@@ -86,19 +146,31 @@ public:
     void SetScale( glm::vec3 nSca );
 
     /// <summary>
-    /// Sets this transform to a given rotation in Euler angles.
+    /// Sets this transform to a given rotation in Euler angles, applied in Z, Y, X order.
     /// </summary>
     /// <param name="">The rotation to set this transform to.</param>
     void SetRotation( glm::vec3 nRot );
 
+    /// <summary>
+    /// Sets this transform to a given rotation. Its Euler angles are worked out in the order SetRotation
+    /// uses, so they rebuild the same rotation.
+    /// </summary>
+    /// <param name="orientation">The rotation to set this transform to.</param>
+    void SetOrientation( const glm::quat& orientation );
+
 	/// <summary>
 	/// Gets an array of unit vectors the represent the local coordinate system of the game object
 	/// </summary>
-	CoordinateSystem GetLocalCoordinateSystem() const;
+	const CoordinateSystem& GetLocalCoordinateSystem() const;
 
     /// <summary>
     /// Updates this component.
     /// </summary>
     void Update() override;
-};
 
+    /// <summary>
+    /// Rebuilds every dirty world matrix, one hierarchy per job. Called once per frame after the
+    /// components have been updated, so that drawing and physics only ever read the cache.
+    /// </summary>
+    static void UpdateWorldMatrices();
+};
@@ -0,0 +1,727 @@
+#include "TriangleBvh.hpp"
+#include "MappedFile.hpp"
+#include "MeshLoader.hpp"
+#include "VirtualFileSystem.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#define BVH_CACHE_MAGIC   0x31485642 // "BVH1"
+#define BVH_CACHE_VERSION 1
+#define BVH_BIN_COUNT     12
+#define BVH_MAX_DEPTH     60
+#define BVH_STACK_SIZE    ( BVH_MAX_DEPTH + 4 )
+#define BVH_IGNORE_DOT    0.7071f
+
+std::unordered_map<std::string, std::shared_ptr<TriangleBvh>> TriangleBvh::_bvhCache;
+
+const unsigned int TriangleBvh::MaxLeafSize = 4;
+
+// Gets the surface area of a box
+static float GetSurfaceArea( const glm::vec3& min, const glm::vec3& max )
+{
+    glm::vec3 size = max - min;
+    return 2.0f * ( size.x * size.y + size.y * size.z + size.z * size.x );
+}
+
+// Reads a value from a binary file, moving past it
+template<typename T> static void ReadValue( const char*& data, T& value )
+{
+    memcpy( &value, data, sizeof( T ) );
+    data += sizeof( T );
+}
+
+// Writes a value to a binary file
+template<typename T> static void WriteValue( std::ofstream& file, const T& value )
+{
+    file.write( reinterpret_cast<const char*>( &value ), sizeof( T ) );
+}
+
+// Checks to see if a normal should be ignored
+static bool IsIgnored( const glm::vec3& normal, const glm::vec3& ignoredNormal )
+{
+    return glm::dot( normal, ignoredNormal ) > BVH_IGNORE_DOT;
+}
+
+// Checks to see if a sphere overlaps a box
+static bool SphereOverlapsBox( const glm::vec3& center, float radius, const glm::vec3& min, const glm::vec3& max )
+{
+    glm::vec3 fromBox = center - glm::clamp( center, min, max );
+    return glm::dot( fromBox, fromBox ) <= radius * radius;
+}
+
+// Finds the closest point on a triangle to the given point (see Real-Time Collision Detection, 5.1.5)
+static glm::vec3 ClosestPointOnTriangle( const glm::vec3& point, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c )
+{
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+
+    // Vertex region A
+    glm::vec3 ap = point - a;
+    float d1 = glm::dot( ab, ap );
+    float d2 = glm::dot( ac, ap );
+    if ( d1 <= 0.0f && d2 <= 0.0f )
+    {
+        return a;
+    }
+
+    // Vertex region B
+    glm::vec3 bp = point - b;
+    float d3 = glm::dot( ab, bp );
+    float d4 = glm::dot( ac, bp );
+    if ( d3 >= 0.0f && d4 <= d3 )
+    {
+        return b;
+    }
+
+    // Edge region AB
+    float vc = d1 * d4 - d3 * d2;
+    if ( vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f )
+    {
+        return a + ab * ( d1 / ( d1 - d3 ) );
+    }
+
+    // Vertex region C
+    glm::vec3 cp = point - c;
+    float d5 = glm::dot( ab, cp );
+    float d6 = glm::dot( ac, cp );
+    if ( d6 >= 0.0f && d5 <= d6 )
+    {
+        return c;
+    }
+
+    // Edge region AC
+    float vb = d5 * d2 - d1 * d6;
+    if ( vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f )
+    {
+        return a + ac * ( d2 / ( d2 - d6 ) );
+    }
+
+    // Edge region BC
+    float va = d3 * d6 - d5 * d4;
+    if ( va <= 0.0f && ( d4 - d3 ) >= 0.0f && ( d5 - d6 ) >= 0.0f )
+    {
+        return b + ( c - b ) * ( ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) ) );
+    }
+
+    // Face region
+    float denominator = 1.0f / ( va + vb + vc );
+    return a + ab * ( vb * denominator ) + ac * ( vc * denominator );
+}
+
+// Sweeps a sphere against a point, ignoring points the sphere starts out touching
+static bool SweepSpherePoint( const glm::vec3& start, const glm::vec3& delta, float radius, const glm::vec3& point, float& time )
+{
+    glm::vec3 fromPoint = start - point;
+    float c = glm::dot( fromPoint, fromPoint ) - radius * radius;
+    float b = glm::dot( fromPoint, delta );
+    float a = glm::dot( delta, delta );
+    if ( c < 0.0f || b >= 0.0f || a <= 0.0f )
+    {
+        return false;
+    }
+
+    float discriminant = b * b - a * c;
+    if ( discriminant < 0.0f )
+    {
+        return false;
+    }
+
+    time = ( -b - glm::sqrt( discriminant ) ) / a;
+    return time <= 1.0f;
+}
+
+// Sweeps a sphere against an edge, ignoring edges the sphere starts out touching
+static bool SweepSphereEdge( const glm::vec3& start, const glm::vec3& delta, float radius, const glm::vec3& a, const glm::vec3& b, float& time, glm::vec3& point )
+{
+    glm::vec3 edge = b - a;
+    glm::vec3 fromA = start - a;
+    float edgeLength2 = glm::dot( edge, edge );
+    float fromAOnEdge = glm::dot( fromA, edge );
+    float deltaOnEdge = glm::dot( delta, edge );
+
+    // Intersect the swept center with the infinite cylinder around the edge
+    float qa = edgeLength2 * glm::dot( delta, delta ) - deltaOnEdge * deltaOnEdge;
+    float qb = edgeLength2 * glm::dot( fromA, delta ) - deltaOnEdge * fromAOnEdge;
+    float qc = edgeLength2 * ( glm::dot( fromA, fromA ) - radius * radius ) - fromAOnEdge * fromAOnEdge;
+    if ( edgeLength2 <= 0.0f || qa <= 0.0f || qc < 0.0f )
+    {
+        return false;
+    }
+
+    float discriminant = qb * qb - qa * qc;
+    if ( discriminant < 0.0f )
+    {
+        return false;
+    }
+
+    time = ( -qb - glm::sqrt( discriminant ) ) / qa;
+    if ( time < 0.0f || time > 1.0f )
+    {
+        return false;
+    }
+
+    // Past either end of the edge it's the vertices' job
+    float along = ( fromAOnEdge + time * deltaOnEdge ) / edgeLength2;
+    if ( along < 0.0f || along > 1.0f )
+    {
+        return false;
+    }
+
+    point = a + edge * along;
+    return true;
+}
+
+// Sweeps a sphere against a triangle, keeping the hit if it is earlier than the given hit
+static bool SweepSphereTriangle( const glm::vec3& start, const glm::vec3& delta, float radius, const glm::vec3& ignoredNormal,
+                                 const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, BvhSweepHit& hit )
+{
+    glm::vec3 faceNormal = glm::cross( b - a, c - a );
+    float faceLength = glm::length( faceNormal );
+    if ( faceLength <= 0.0f )
+    {
+        return false;
+    }
+    faceNormal /= faceLength;
+
+    // Face the triangle towards the start of the sweep
+    glm::vec3 normal = faceNormal;
+    float distance = glm::dot( start - a, normal );
+    if ( distance < 0.0f )
+    {
+        normal = -normal;
+        distance = -distance;
+    }
+
+    // The first place the sphere can touch the face is where it reaches the plane
+    float approach = glm::dot( delta, normal );
+    if ( distance >= radius && approach < 0.0f )
+    {
+        float time = ( radius - distance ) / approach;
+        if ( time > hit.Time )
+        {
+            return false;
+        }
+
+        glm::vec3 point = start + delta * time - normal * radius;
+        bool isInside = glm::dot( glm::cross( b - a, point - a ), faceNormal ) >= 0.0f
+                     && glm::dot( glm::cross( c - b, point - b ), faceNormal ) >= 0.0f
+                     && glm::dot( glm::cross( a - c, point - c ), faceNormal ) >= 0.0f;
+        if ( isInside )
+        {
+            if ( IsIgnored( normal, ignoredNormal ) )
+            {
+                return false;
+            }
+
+            hit.Time = time;
+            hit.Point = point;
+            hit.Normal = normal;
+            return true;
+        }
+    }
+
+    // Otherwise the sphere can only touch the triangle's edges (the first three passes) or corners (the last three)
+    const glm::vec3* corners[] = { &a, &b, &c };
+    bool isHit = false;
+    for ( int i = 0; i < 6; ++i )
+    {
+        const glm::vec3& from = *corners[ i % 3 ];
+        const glm::vec3& to = *corners[ ( i + 1 ) % 3 ];
+
+        float time = 0.0f;
+        glm::vec3 point = from;
+        bool isCandidate = ( i < 3 ) ? SweepSphereEdge( start, delta, radius, from, to, time, point )
+                                     : SweepSpherePoint( start, delta, radius, from, time );
+        if ( !isCandidate || time > hit.Time )
+        {
+            continue;
+        }
+
+        // A ray has no radius to find the normal with, so it uses the face instead
+        glm::vec3 toCenter = start + delta * time - point;
+        float toCenterLength = glm::length( toCenter );
+        glm::vec3 hitNormal = ( toCenterLength > 0.0f ) ? toCenter / toCenterLength : normal;
+        if ( IsIgnored( hitNormal, ignoredNormal ) )
+        {
+            continue;
+        }
+
+        hit.Time = time;
+        hit.Point = point;
+        hit.Normal = hitNormal;
+        isHit = true;
+    }
+
+    return isHit;
+}
+
+// Creates a new, empty bounding volume hierarchy
+TriangleBvh::TriangleBvh()
+{
+}
+
+// Destroys this bounding volume hierarchy
+TriangleBvh::~TriangleBvh()
+{
+}
+
+// Loads the hierarchy for a model
+std::shared_ptr<TriangleBvh> TriangleBvh::FromFile( const std::string& fname )
+{
+    // We don't need to re-load hierarchies
+    auto search = _bvhCache.find( fname );
+    if ( search != _bvhCache.end() )
+    {
+        return search->second;
+    }
+
+    std::shared_ptr<TriangleBvh> bvh;
+    unsigned long long sourceSize = 0;
+    long long sourceTime = 0;
+    if ( !VirtualFileSystem::GetFileInfo( fname, sourceSize, sourceTime ) )
+    {
+        return bvh;
+    }
+
+    std::cout << "Loading BVH for " << fname << "... ";
+
+    // The cache is only used if it was built from this exact model
+    bvh = std::make_shared<TriangleBvh>();
+    std::string cacheName = fname + ".bvh";
+    if ( bvh->LoadCache( cacheName, sourceSize, sourceTime ) )
+    {
+        std::cout << "Done." << std::endl;
+    }
+    else
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<unsigned int> indices;
+        if ( !MeshLoader::LoadGeometry( fname, positions, indices ) )
+        {
+            std::cout << "Failed ;_;" << std::endl;
+            return std::shared_ptr<TriangleBvh>();
+        }
+
+        bvh->Build( positions, indices );
+        bvh->SaveCache( cacheName, sourceSize, sourceTime );
+        std::cout << "Built " << bvh->GetNodeCount() << " nodes." << std::endl;
+    }
+
+    _bvhCache[ fname ] = bvh;
+    return bvh;
+}
+
+// Builds this hierarchy over the given triangles
+void TriangleBvh::Build( const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices )
+{
+    _nodes.clear();
+    _triangles.clear();
+
+    std::vector<Triangle> triangles;
+    std::vector<glm::vec3> centroids;
+    triangles.reserve( indices.size() / 3 );
+    centroids.reserve( indices.size() / 3 );
+
+    for ( size_t i = 0; i + 2 < indices.size(); i += 3 )
+    {
+        if ( indices[ i ] >= positions.size() || indices[ i + 1 ] >= positions.size() || indices[ i + 2 ] >= positions.size() )
+        {
+            continue;
+        }
+
+        Triangle triangle = { positions[ indices[ i ] ], positions[ indices[ i + 1 ] ], positions[ indices[ i + 2 ] ] };
+        triangles.push_back( triangle );
+        centroids.push_back( ( triangle.A + triangle.B + triangle.C ) / 3.0f );
+    }
+
+    if ( triangles.empty() )
+    {
+        return;
+    }
+
+    _nodes.reserve( triangles.size() * 2 );
+    BuildNode( triangles, centroids, 0, static_cast<unsigned int>( triangles.size() ), 0 );
+    _triangles.swap( triangles );
+}
+
+// Recursively builds the node covering the given range of triangles
+unsigned int TriangleBvh::BuildNode( std::vector<Triangle>& triangles, std::vector<glm::vec3>& centroids, unsigned int start, unsigned int end, unsigned int depth )
+{
+    unsigned int index = static_cast<unsigned int>( _nodes.size() );
+    _nodes.push_back( Node() );
+
+    // Get the bounds of the triangles and of their centroids
+    glm::vec3 min( FLT_MAX ), max( -FLT_MAX );
+    glm::vec3 centroidMin( FLT_MAX ), centroidMax( -FLT_MAX );
+    for ( unsigned int i = start; i < end; ++i )
+    {
+        const Triangle& triangle = triangles[ i ];
+        min = glm::min( min, glm::min( triangle.A, glm::min( triangle.B, triangle.C ) ) );
+        max = glm::max( max, glm::max( triangle.A, glm::max( triangle.B, triangle.C ) ) );
+        centroidMin = glm::min( centroidMin, centroids[ i ] );
+        centroidMax = glm::max( centroidMax, centroids[ i ] );
+    }
+
+    // Start off as a leaf
+    Node& node = _nodes[ index ];
+    node.Min = min;
+    node.Max = max;
+    node.Start = start;
+    node.Count = end - start;
+
+    unsigned int count = end - start;
+    if ( count <= MaxLeafSize || depth >= BVH_MAX_DEPTH )
+    {
+        return index;
+    }
+
+    // Find the cheapest split by binning the centroids along each axis
+    struct Bin
+    {
+        glm::vec3    Min;
+        glm::vec3    Max;
+        unsigned int Count;
+    };
+
+    float bestCost = GetSurfaceArea( min, max ) * count;
+    int bestAxis = -1;
+    int bestSplit = 0;
+
+    for ( int axis = 0; axis < 3; ++axis )
+    {
+        float extent = centroidMax[ axis ] - centroidMin[ axis ];
+        if ( extent <= 0.0f )
+        {
+            continue;
+        }
+
+        Bin bins[ BVH_BIN_COUNT ];
+        for ( int i = 0; i < BVH_BIN_COUNT; ++i )
+        {
+            bins[ i ].Min = glm::vec3( FLT_MAX );
+            bins[ i ].Max = glm::vec3( -FLT_MAX );
+            bins[ i ].Count = 0;
+        }
+
+        float scale = BVH_BIN_COUNT / extent;
+        for ( unsigned int i = start; i < end; ++i )
+        {
+            const Triangle& triangle = triangles[ i ];
+            int bin = std::min( BVH_BIN_COUNT - 1, static_cast<int>( ( centroids[ i ][ axis ] - centroidMin[ axis ] ) * scale ) );
+            bins[ bin ].Min = glm::min( bins[ bin ].Min, glm::min( triangle.A, glm::min( triangle.B, triangle.C ) ) );
+            bins[ bin ].Max = glm::max( bins[ bin ].Max, glm::max( triangle.A, glm::max( triangle.B, triangle.C ) ) );
+            bins[ bin ].Count++;
+        }
+
+        // Sweep in from the left, then from the right, to price every split between two bins
+        float leftCosts[ BVH_BIN_COUNT - 1 ];
+        glm::vec3 sweepMin( FLT_MAX ), sweepMax( -FLT_MAX );
+        unsigned int sweepCount = 0;
+        for ( int i = 0; i < BVH_BIN_COUNT - 1; ++i )
+        {
+            sweepMin = glm::min( sweepMin, bins[ i ].Min );
+            sweepMax = glm::max( sweepMax, bins[ i ].Max );
+            sweepCount += bins[ i ].Count;
+            leftCosts[ i ] = ( sweepCount > 0 ) ? GetSurfaceArea( sweepMin, sweepMax ) * sweepCount : 0.0f;
+        }
+
+        sweepMin = glm::vec3( FLT_MAX );
+        sweepMax = glm::vec3( -FLT_MAX );
+        sweepCount = 0;
+        for ( int i = BVH_BIN_COUNT - 1; i > 0; --i )
+        {
+            sweepMin = glm::min( sweepMin, bins[ i ].Min );
+            sweepMax = glm::max( sweepMax, bins[ i ].Max );
+            sweepCount += bins[ i ].Count;
+            if ( sweepCount == 0 || sweepCount == count )
+            {
+                continue;
+            }
+
+            float cost = leftCosts[ i - 1 ] + GetSurfaceArea( sweepMin, sweepMax ) * sweepCount;
+            if ( cost < bestCost )
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i;
+            }
+        }
+    }
+
+    // Stay a leaf if no split is cheaper than testing every triangle
+    if ( bestAxis < 0 )
+    {
+        return index;
+    }
+
+    // Move everything left of the split to the front of the range
+    float scale = BVH_BIN_COUNT / ( centroidMax[ bestAxis ] - centroidMin[ bestAxis ] );
+    unsigned int middle = start;
+    for ( unsigned int i = start; i < end; ++i )
+    {
+        int bin = std::min( BVH_BIN_COUNT - 1, static_cast<int>( ( centroids[ i ][ bestAxis ] - centroidMin[ bestAxis ] ) * scale ) );
+        if ( bin < bestSplit )
+        {
+            std::swap( triangles[ i ], triangles[ middle ] );
+            std::swap( centroids[ i ], centroids[ middle ] );
+            ++middle;
+        }
+    }
+
+    if ( middle == start || middle == end )
+    {
+        return index;
+    }
+
+    // The left child always directly follows its parent
+    BuildNode( triangles, centroids, start, middle, depth + 1 );
+    unsigned int right = BuildNode( triangles, centroids, middle, end, depth + 1 );
+    _nodes[ index ].Start = right;
+    _nodes[ index ].Count = 0;
+    return index;
+}
+
+// Attempts to load a cached hierarchy from disk
+bool TriangleBvh::LoadCache( const std::string& fname, unsigned long long sourceSize, long long sourceTime )
+{
+    unsigned int magic = 0, version = 0, nodeCount = 0, triangleCount = 0;
+    unsigned long long cachedSize = 0;
+    long long cachedTime = 0;
+    size_t headerSize = sizeof( magic ) + sizeof( version ) + sizeof( cachedSize ) + sizeof( cachedTime ) + sizeof( nodeCount ) + sizeof( triangleCount );
+
+    MappedFile file;
+    if ( !file.Open( fname ) || file.GetSize() < headerSize )
+    {
+        return false;
+    }
+
+    const char* data = file.GetData();
+    ReadValue( data, magic );
+    ReadValue( data, version );
+    ReadValue( data, cachedSize );
+    ReadValue( data, cachedTime );
+    ReadValue( data, nodeCount );
+    ReadValue( data, triangleCount );
+
+    // Make sure the cache is ours, is current, and isn't obviously broken
+    if ( magic != BVH_CACHE_MAGIC
+      || version != BVH_CACHE_VERSION
+      || cachedSize != sourceSize
+      || cachedTime != sourceTime
+      || triangleCount == 0
+      || nodeCount == 0
+      || nodeCount > triangleCount * 2
+      || file.GetSize() != headerSize + sizeof( Node ) * nodeCount + sizeof( Triangle ) * triangleCount )
+    {
+        return false;
+    }
+
+    _nodes.resize( nodeCount );
+    _triangles.resize( triangleCount );
+    memcpy( &_nodes[ 0 ], data, sizeof( Node ) * nodeCount );
+    memcpy( &_triangles[ 0 ], data + sizeof( Node ) * nodeCount, sizeof( Triangle ) * triangleCount );
+
+    // Every node has to point somewhere valid, and no deeper than the traversal stacks allow. Children
+    // always come after their parent, so one pass in order finds every node's depth
+    std::vector<unsigned int> depths( nodeCount, 0 );
+    bool isValid = true;
+    for ( unsigned int i = 0; isValid && i < nodeCount; ++i )
+    {
+        const Node& node = _nodes[ i ];
+        isValid = ( node.Count > 0 )
+                ? ( node.Start < triangleCount && node.Count <= triangleCount - node.Start )
+                : ( node.Start > i + 1 && node.Start < nodeCount && depths[ i ] < BVH_MAX_DEPTH );
+
+        if ( isValid && node.Count == 0 )
+        {
+            depths[ i + 1 ] = std::max( depths[ i + 1 ], depths[ i ] + 1 );
+            depths[ node.Start ] = std::max( depths[ node.Start ], depths[ i ] + 1 );
+        }
+    }
+
+    if ( !isValid )
+    {
+        _nodes.clear();
+        _triangles.clear();
+    }
+    return isValid;
+}
+
+// Attempts to save this hierarchy to disk
+bool TriangleBvh::SaveCache( const std::string& fname, unsigned long long sourceSize, long long sourceTime ) const
+{
+    if ( _nodes.empty() )
+    {
+        return false;
+    }
+
+    std::ofstream file( fname, std::ios::binary | std::ios::trunc );
+    if ( !file.is_open() )
+    {
+        return false;
+    }
+
+    WriteValue( file, static_cast<unsigned int>( BVH_CACHE_MAGIC ) );
+    WriteValue( file, static_cast<unsigned int>( BVH_CACHE_VERSION ) );
+    WriteValue( file, sourceSize );
+    WriteValue( file, sourceTime );
+    WriteValue( file, static_cast<unsigned int>( _nodes.size() ) );
+    WriteValue( file, static_cast<unsigned int>( _triangles.size() ) );
+    file.write( reinterpret_cast<const char*>( &_nodes[ 0 ] ), sizeof( Node ) * _nodes.size() );
+    file.write( reinterpret_cast<const char*>( &_triangles[ 0 ] ), sizeof( Triangle ) * _triangles.size() );
+
+    return static_cast<bool>( file );
+}
+
+// Finds the closest point where a sphere touches this mesh
+bool TriangleBvh::FindSphereContact( const glm::vec3& center, float radius, const glm::vec3& ignoredNormal, BvhContact& contact ) const
+{
+    if ( _nodes.empty() )
+    {
+        return false;
+    }
+
+    unsigned int stack[ BVH_STACK_SIZE ];
+    int stackSize = 0;
+    stack[ stackSize++ ] = 0;
+
+    float bestDistance2 = radius * radius;
+    bool isTouching = false;
+
+    while ( stackSize > 0 )
+    {
+        unsigned int index = stack[ --stackSize ];
+        const Node& node = _nodes[ index ];
+        if ( !SphereOverlapsBox( center, radius, node.Min, node.Max ) )
+        {
+            continue;
+        }
+
+        if ( node.Count == 0 )
+        {
+            stack[ stackSize++ ] = node.Start;
+            stack[ stackSize++ ] = index + 1;
+            continue;
+        }
+
+        for ( unsigned int i = node.Start; i < node.Start + node.Count; ++i )
+        {
+            const Triangle& triangle = _triangles[ i ];
+            glm::vec3 point = ClosestPointOnTriangle( center, triangle.A, triangle.B, triangle.C );
+            glm::vec3 toCenter = center - point;
+            float distance2 = glm::dot( toCenter, toCenter );
+            if ( distance2 > bestDistance2 || ( isTouching && distance2 == bestDistance2 ) )
+            {
+                continue;
+            }
+
+            // A center lying on the triangle is pushed out along the face
+            glm::vec3 normal;
+            float distance = glm::sqrt( distance2 );
+            if ( distance > 0.0f )
+            {
+                normal = toCenter / distance;
+            }
+            else
+            {
+                normal = glm::cross( triangle.B - triangle.A, triangle.C - triangle.A );
+                float length = glm::length( normal );
+                if ( length <= 0.0f )
+                {
+                    continue;
+                }
+                normal /= length;
+            }
+
+            if ( IsIgnored( normal, ignoredNormal ) )
+            {
+                continue;
+            }
+
+            contact.Point = point;
+            contact.Normal = normal;
+            contact.Distance = distance;
+            bestDistance2 = distance2;
+            isTouching = true;
+        }
+    }
+
+    return isTouching;
+}
+
+// Gets the maximum point of this mesh
+glm::vec3 TriangleBvh::GetMaxPoint() const
+{
+    return _nodes.empty() ? glm::vec3( 0 ) : _nodes[ 0 ].Max;
+}
+
+// Gets the minimum point of this mesh
+glm::vec3 TriangleBvh::GetMinPoint() const
+{
+    return _nodes.empty() ? glm::vec3( 0 ) : _nodes[ 0 ].Min;
+}
+
+// Gets the number of nodes in this hierarchy
+size_t TriangleBvh::GetNodeCount() const
+{
+    return _nodes.size();
+}
+
+// Gets the number of triangles in this hierarchy
+size_t TriangleBvh::GetTriangleCount() const
+{
+    return _triangles.size();
+}
+
+// Sweeps a sphere through this mesh
+bool TriangleBvh::SweepSphere( const glm::vec3& start, const glm::vec3& end, float radius, const glm::vec3& ignoredNormal, BvhSweepHit& hit ) const
+{
+    if ( _nodes.empty() )
+    {
+        return false;
+    }
+
+    unsigned int stack[ BVH_STACK_SIZE ];
+    int stackSize = 0;
+    stack[ stackSize++ ] = 0;
+
+    glm::vec3 delta = end - start;
+    glm::vec3 padding( radius );
+    bool isHit = false;
+    hit.Time = 1.0f;
+
+    while ( stackSize > 0 )
+    {
+        unsigned int index = stack[ --stackSize ];
+        const Node& node = _nodes[ index ];
+
+        // Skip anything the sphere can't reach before the closest hit so far
+        float entry = 0.0f;
+        int axis = 0;
+        if ( !IntersectSegmentBox( start, delta, node.Min - padding, node.Max + padding, entry, axis ) || entry > hit.Time )
+        {
+            continue;
+        }
+
+        if ( node.Count == 0 )
+        {
+            stack[ stackSize++ ] = node.Start;
+            stack[ stackSize++ ] = index + 1;
+            continue;
+        }
+
+        for ( unsigned int i = node.Start; i < node.Start + node.Count; ++i )
+        {
+            const Triangle& triangle = _triangles[ i ];
+            if ( SweepSphereTriangle( start, delta, radius, ignoredNormal, triangle.A, triangle.B, triangle.C, hit ) )
+            {
+                isHit = true;
+            }
+        }
+    }
+
+    return isHit;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "Config.hpp"
+#include "Math.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// Defines the closest point where a sphere touches a triangle mesh.
+/// </summary>
+struct BvhContact
+{
+    glm::vec3 Point;    // The closest point on the mesh to the sphere's center
+    glm::vec3 Normal;   // Points from the mesh towards the sphere's center
+    float     Distance; // The distance from the sphere's center to the mesh
+};
+
+/// <summary>
+/// Defines the first point where a moving sphere hits a triangle mesh.
+/// </summary>
+struct BvhSweepHit
+{
+    glm::vec3 Point;  // The point on the mesh that was hit
+    glm::vec3 Normal; // Points from the mesh towards the sphere's center at the time of impact
+    float     Time;   // How far along the sweep, from 0 to 1, the sphere hit the mesh
+};
+
+/// <summary>
+/// Defines a bounding volume hierarchy over a triangle mesh, built with the surface area heuristic.
+/// </summary>
+class TriangleBvh
+{
+    ImplementNonCopyableClass( TriangleBvh );
+    ImplementNonMovableClass( TriangleBvh );
+
+    /// <summary>
+    /// Defines a node in the hierarchy. A node's left child always directly follows it.
+    /// </summary>
+    struct Node
+    {
+        glm::vec3    Min;
+        unsigned int Start; // The first triangle for a leaf, or the right child for an inner node
+        glm::vec3    Max;
+        unsigned int Count; // The number of triangles for a leaf, or zero for an inner node
+    };
+
+    /// <summary>
+    /// Defines a triangle.
+    /// </summary>
+    struct Triangle
+    {
+        glm::vec3 A;
+        glm::vec3 B;
+        glm::vec3 C;
+    };
+
+    static std::unordered_map<std::string, std::shared_ptr<TriangleBvh>> _bvhCache;
+
+    std::vector<Node> _nodes;
+    std::vector<Triangle> _triangles;
+
+    /// <summary>
+    /// Recursively builds the node covering the given range of triangles.
+    /// </summary>
+    /// <param name="triangles">The triangles, which are re-ordered as they are split.</param>
+    /// <param name="centroids">The centroids of the triangles, kept in the same order.</param>
+    /// <param name="start">The first triangle in the range.</param>
+    /// <param name="end">One past the last triangle in the range.</param>
+    /// <param name="depth">The depth of the new node.</param>
+    /// <returns>The index of the new node.</returns>
+    unsigned int BuildNode( std::vector<Triangle>& triangles, std::vector<glm::vec3>& centroids, unsigned int start, unsigned int end, unsigned int depth );
+
+    /// <summary>
+    /// Attempts to load a cached hierarchy from disk.
+    /// </summary>
+    /// <param name="fname">The cache's file name.</param>
+    /// <param name="sourceSize">The size of the model the cache must have been built from.</param>
+    /// <param name="sourceTime">The modification time of the model the cache must have been built from.</param>
+    bool LoadCache( const std::string& fname, unsigned long long sourceSize, long long sourceTime );
+
+    /// <summary>
+    /// Attempts to save this hierarchy to disk.
+    /// </summary>
+    /// <param name="fname">The cache's file name.</param>
+    /// <param name="sourceSize">The size of the model this hierarchy was built from.</param>
+    /// <param name="sourceTime">The modification time of the model this hierarchy was built from.</param>
+    bool SaveCache( const std::string& fname, unsigned long long sourceSize, long long sourceTime ) const;
+
+public:
+    /// <summary>
+    /// The most triangles that will be kept in a single leaf.
+    /// </summary>
+    static const unsigned int MaxLeafSize;
+
+    /// <summary>
+    /// Creates a new, empty bounding volume hierarchy.
+    /// </summary>
+    TriangleBvh();
+
+    /// <summary>
+    /// Destroys this bounding volume hierarchy.
+    /// </summary>
+    ~TriangleBvh();
+
+    /// <summary>
+    /// Loads the hierarchy for a model, using the cache next to the model when it is up to date and
+    /// building (and caching) the hierarchy when it is not.
+    /// </summary>
+    /// <param name="fname">The model's file name.</param>
+    static std::shared_ptr<TriangleBvh> FromFile( const std::string& fname );
+
+    /// <summary>
+    /// Builds this hierarchy over the given triangles.
+    /// </summary>
+    /// <param name="positions">The vertex positions.</param>
+    /// <param name="indices">The triangle indices, three per triangle.</param>
+    void Build( const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices );
+
+    /// <summary>
+    /// Finds the closest point where a sphere touches this mesh.
+    /// </summary>
+    /// <param name="center">The sphere's center.</param>
+    /// <param name="radius">The sphere's radius.</param>
+    /// <param name="ignoredNormal">Contacts whose normals are within 45 degrees of this direction are skipped. Zero to keep every contact.</param>
+    /// <param name="contact">Receives the contact.</param>
+    /// <returns>True if the sphere touches the mesh, false if not.</returns>
+    bool FindSphereContact( const glm::vec3& center, float radius, const glm::vec3& ignoredNormal, BvhContact& contact ) const;
+
+    /// <summary>
+    /// Gets the maximum point of this mesh.
+    /// </summary>
+    glm::vec3 GetMaxPoint() const;
+
+    /// <summary>
+    /// Gets the minimum point of this mesh.
+    /// </summary>
+    glm::vec3 GetMinPoint() const;
+
+    /// <summary>
+    /// Gets the number of nodes in this hierarchy.
+    /// </summary>
+    size_t GetNodeCount() const;
+
+    /// <summary>
+    /// Gets the number of triangles in this hierarchy.
+    /// </summary>
+    size_t GetTriangleCount() const;
+
+    /// <summary>
+    /// Sweeps a sphere through this mesh, finding the first point it hits. Contacts the sphere
+    /// starts out touching are left to FindSphereContact. A radius of zero casts a ray.
+    /// </summary>
+    /// <param name="start">The sphere's starting center.</param>
+    /// <param name="end">The sphere's ending center.</param>
+    /// <param name="radius">The sphere's radius.</param>
+    /// <param name="ignoredNormal">Hits whose normals are within 45 degrees of this direction are skipped. Zero to keep every hit.</param>
+    /// <param name="hit">Receives the hit.</param>
+    /// <returns>True if the sphere hits the mesh, false if not.</returns>
+    bool SweepSphere( const glm::vec3& start, const glm::vec3& end, float radius, const glm::vec3& ignoredNormal, BvhSweepHit& hit ) const;
+};
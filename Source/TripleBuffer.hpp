@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Config.hpp"
+#include <atomic>
+
+/// <summary>
+/// Defines three copies of a value shared by one writing thread and one reading thread. The writer
+/// fills the back copy and swaps it into the middle, the reader swaps the middle into the front
+/// when it has been written, and neither of them ever waits on the other.
+/// </summary>
+template<class T> class TripleBuffer
+{
+    ImplementNonCopyableClass( TripleBuffer );
+    ImplementNonMovableClass( TripleBuffer );
+
+    static const unsigned int IndexMask = 3;
+    static const unsigned int FreshBit = 4; // Set on the middle index while it holds a copy the reader hasn't seen
+
+    T _buffers[ 3 ];
+    std::atomic<unsigned int> _middle;
+    unsigned int _back;  // Only touched by the writer
+    unsigned int _front; // Only touched by the reader
+
+public:
+    /// <summary>
+    /// Creates a new triple buffer.
+    /// </summary>
+    TripleBuffer();
+
+    /// <summary>
+    /// Swaps the newest copy into the front, if one has been published since the last call. Only call
+    /// this from the reading thread.
+    /// </summary>
+    /// <returns>True if the front copy changed, false if nothing new has been published.</returns>
+    bool Acquire();
+
+    /// <summary>
+    /// Gets the copy being written. Only call this from the writing thread.
+    /// </summary>
+    T& GetBack();
+
+    /// <summary>
+    /// Gets the copy being read. Only call this from the reading thread.
+    /// </summary>
+    const T& GetFront() const;
+
+    /// <summary>
+    /// Publishes the back copy, taking the middle copy as the new back copy. Only call this from the
+    /// writing thread.
+    /// </summary>
+    /// <returns>True if the new back copy was never read, which means it still holds the last copy published.</returns>
+    bool Publish();
+};
+
+#include "TripleBuffer.inl"
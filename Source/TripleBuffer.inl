@@ -0,0 +1,41 @@
+// Create a new triple buffer
+template<class T> TripleBuffer<T>::TripleBuffer()
+    : _middle( 1 )
+    , _back( 0 )
+    , _front( 2 )
+{
+}
+
+// Swap the newest copy into the front
+template<class T> bool TripleBuffer<T>::Acquire()
+{
+    if ( ( _middle.load( std::memory_order_acquire ) & FreshBit ) == 0 )
+    {
+        return false;
+    }
+
+    // Our old front copy goes into the middle as already read
+    unsigned int middle = _middle.exchange( _front, std::memory_order_acq_rel );
+    _front = middle & IndexMask;
+    return true;
+}
+
+// Get the copy being written
+template<class T> T& TripleBuffer<T>::GetBack()
+{
+    return _buffers[ _back ];
+}
+
+// Get the copy being read
+template<class T> const T& TripleBuffer<T>::GetFront() const
+{
+    return _buffers[ _front ];
+}
+
+// Publish the back copy
+template<class T> bool TripleBuffer<T>::Publish()
+{
+    unsigned int middle = _middle.exchange( _back | FreshBit, std::memory_order_acq_rel );
+    _back = middle & IndexMask;
+    return ( middle & FreshBit ) != 0;
+}
@@ -1,6 +1,18 @@
 #pragma once
 
 #include "Math.hpp"
+#include <glm/gtc/type_precision.hpp>
+
+/// <summary>
+/// Defines the layouts a loaded mesh's vertices can be stored in. Every layout starts with its
+/// position as three floats.
+/// </summary>
+enum class VertexLayout
+{
+    Full,   // Vertex
+    Packed, // PackedVertex
+    Compact // CompactVertex
+};
 
 /// <summary>
 /// Defines a vertex.
@@ -13,6 +25,28 @@ struct Vertex
     glm::vec2 UV;
 };
 
+/// <summary>
+/// Defines a vertex with its normal and tangent packed into octahedral snorm16 pairs, and its UV into
+/// unorm16s spanning the mesh's UV range. Shaders read them as vertPackedNormal and vertPackedTangent.
+/// </summary>
+struct PackedVertex
+{
+    glm::vec3    Position;
+    glm::i16vec2 Normal;
+    glm::i16vec2 Tangent;
+    glm::u16vec2 UV;
+};
+
+/// <summary>
+/// Defines a vertex with just a position and a UV packed into unorm16s spanning the mesh's UV range,
+/// for materials that don't use normals or tangents.
+/// </summary>
+struct CompactVertex
+{
+    glm::vec3    Position;
+    glm::u16vec2 UV;
+};
+
 /// <summary>
 /// Defines a vertex used when rendering text.
 /// </summary>
@@ -33,7 +67,23 @@ struct TextVertex
     }
 };
 
+/// <summary>
+/// Defines a vertex used when rendering lines.
+/// </summary>
 struct LineVertex
 {
-    glm::vec2 Position;
+    glm::vec3 Position;
+    glm::vec4 Color;
+
+    LineVertex()
+        : Position( 0, 0, 0 )
+        , Color( 1, 1, 1, 1 )
+    {
+    }
+
+    LineVertex( const glm::vec3& position, const glm::vec4& color )
+        : Position( position )
+        , Color( color )
+    {
+    }
 };
@@ -0,0 +1,375 @@
+#include "VirtualFileSystem.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined( _WIN32 )
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <Windows.h>
+#else
+#   include <dirent.h>
+#endif
+
+#define ARCHIVE_MAGIC     0x314B4150 // "PAK1"
+#define ARCHIVE_VERSION   1
+#define ARCHIVE_ALIGNMENT 16         // Packed files start on this boundary, so their headers can be read in place
+
+MappedFile                              VirtualFileSystem::_archive;
+const VirtualFileSystem::ArchiveEntry*  VirtualFileSystem::_entries = nullptr;
+unsigned int                            VirtualFileSystem::_entryCount = 0;
+const char*                             VirtualFileSystem::_paths = nullptr;
+unsigned int                            VirtualFileSystem::_pathSize = 0;
+
+/// <summary>
+/// Defines a file found while packing a directory.
+/// </summary>
+struct PackedFile
+{
+    std::string        Path;     // Normalized, relative to the directory being packed
+    std::string        FileName; // As it can be opened
+    unsigned long long PathHash;
+    unsigned long long Size;
+    long long          Time;
+};
+
+// Checks to see if a file name ends with a suffix
+static bool EndsWith( const std::string& fname, const char* suffix )
+{
+    size_t length = strlen( suffix );
+    return fname.size() >= length && fname.compare( fname.size() - length, length, suffix ) == 0;
+}
+
+// Lists every file under a directory
+static void ListFiles( const std::string& directory, const std::string& prefix, bool isRoot, std::vector<PackedFile>& files )
+{
+    std::vector<std::string> names;
+    std::vector<std::string> subdirectories;
+
+#if defined( _WIN32 )
+    WIN32_FIND_DATAA found;
+    HANDLE search = FindFirstFileA( ( directory + "\\*" ).c_str(), &found );
+    if ( search == INVALID_HANDLE_VALUE )
+    {
+        return;
+    }
+    do
+    {
+        std::string name = found.cFileName;
+
+        // Hidden files and directories, such as source control's, are never content
+        if ( name[ 0 ] == '.' )
+        {
+            continue;
+        }
+        ( ( found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) ? subdirectories : names ).push_back( name );
+    } while ( FindNextFileA( search, &found ) );
+    FindClose( search );
+#else
+    DIR* search = opendir( directory.c_str() );
+    if ( !search )
+    {
+        return;
+    }
+    while ( dirent* found = readdir( search ) )
+    {
+        std::string name = found->d_name;
+        struct stat info;
+
+        // Hidden files and directories, such as source control's, are never content
+        if ( name[ 0 ] == '.' || stat( ( directory + "/" + name ).c_str(), &info ) != 0 )
+        {
+            continue;
+        }
+        ( S_ISDIR( info.st_mode ) ? subdirectories : names ).push_back( name );
+    }
+    closedir( search );
+#endif
+
+    // Files at the top are the game's own, so only subdirectories are packed
+    for ( const std::string& name : names )
+    {
+        PackedFile file;
+        file.FileName = directory + "/" + name;
+        file.Path = prefix + name;
+        struct stat info;
+        if ( isRoot || EndsWith( name, ".tmp" ) || stat( file.FileName.c_str(), &info ) != 0 )
+        {
+            continue;
+        }
+
+        file.PathHash = 0;
+        file.Size = static_cast<unsigned long long>( info.st_size );
+        file.Time = static_cast<long long>( info.st_mtime );
+        files.push_back( file );
+    }
+    for ( const std::string& name : subdirectories )
+    {
+        ListFiles( directory + "/" + name, prefix + name + "/", false, files );
+    }
+}
+
+// Finds a file's entry in the mounted archive
+const VirtualFileSystem::ArchiveEntry* VirtualFileSystem::FindEntry( const std::string& fname )
+{
+    if ( !_entries )
+    {
+        return nullptr;
+    }
+
+    std::string path = NormalizePath( fname );
+    unsigned long long hash = HashPath( path );
+    const ArchiveEntry* entry = std::lower_bound( _entries, _entries + _entryCount, hash, []( const ArchiveEntry& entry, unsigned long long hash )
+    {
+        return entry.PathHash < hash;
+    } );
+
+    // Different paths can share a hash, so check the path itself
+    for ( ; entry != _entries + _entryCount && entry->PathHash == hash; ++entry )
+    {
+        if ( path == _paths + entry->Path )
+        {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+// Gets a file's size and modification time
+bool VirtualFileSystem::GetFileInfo( const std::string& fname, unsigned long long& size, long long& time )
+{
+    const ArchiveEntry* entry = FindEntry( fname );
+    if ( entry )
+    {
+        size = entry->Size;
+        time = entry->SourceTime;
+        return true;
+    }
+
+    struct stat info;
+    if ( stat( fname.c_str(), &info ) != 0 )
+    {
+        return false;
+    }
+
+    size = static_cast<unsigned long long>( info.st_size );
+    time = static_cast<long long>( info.st_mtime );
+    return true;
+}
+
+// Hashes a normalized path with 64-bit FNV-1a
+unsigned long long VirtualFileSystem::HashPath( const std::string& path )
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for ( char ch : path )
+    {
+        hash ^= static_cast<unsigned char>( ch );
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Checks to see if an archive is mounted
+bool VirtualFileSystem::IsMounted()
+{
+    return _entries != nullptr;
+}
+
+// Mounts an archive
+bool VirtualFileSystem::Mount( const std::string& fname )
+{
+    Unmount();
+    if ( !_archive.Open( fname ) || _archive.GetSize() < sizeof( ArchiveHeader ) )
+    {
+        _archive.Close();
+        return false;
+    }
+
+    // Make sure the archive is ours and that its index fits
+    const char* data = _archive.GetData();
+    unsigned long long archiveSize = _archive.GetSize();
+    const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>( data );
+    unsigned long long indexSize = sizeof( ArchiveHeader ) + sizeof( ArchiveEntry ) * static_cast<unsigned long long>( header->EntryCount ) + header->PathSize;
+    bool isValid = header->Magic == ARCHIVE_MAGIC
+                && header->Version == ARCHIVE_VERSION
+                && indexSize <= archiveSize
+                && ( header->PathSize == 0 || data[ indexSize - 1 ] == '\0' );
+
+    // Every entry has to be in order, and has to point somewhere valid
+    const ArchiveEntry* entries = reinterpret_cast<const ArchiveEntry*>( header + 1 );
+    for ( unsigned int i = 0; isValid && i < header->EntryCount; ++i )
+    {
+        const ArchiveEntry& entry = entries[ i ];
+        isValid = ( i == 0 || entries[ i - 1 ].PathHash <= entry.PathHash )
+               && entry.Path < header->PathSize
+               && entry.Offset >= indexSize
+               && entry.Offset <= archiveSize
+               && entry.Size <= archiveSize - entry.Offset;
+    }
+
+    if ( !isValid )
+    {
+        std::cout << "Content archive '" << fname << "' is out of date or broken, so it won't be used." << std::endl;
+        _archive.Close();
+        return false;
+    }
+
+    _entries = entries;
+    _entryCount = header->EntryCount;
+    _paths = reinterpret_cast<const char*>( entries + header->EntryCount );
+    _pathSize = header->PathSize;
+    return true;
+}
+
+// Normalizes a path
+std::string VirtualFileSystem::NormalizePath( const std::string& fname )
+{
+    std::string path;
+    path.reserve( fname.size() );
+    for ( char ch : fname )
+    {
+        // Paths are written Windows-style, which doesn't care about case or which slash is used
+        ch = ( ch == '\\' ) ? '/' : static_cast<char>( tolower( static_cast<unsigned char>( ch ) ) );
+        if ( ch == '/' && ( path.empty() || path.back() == '/' ) )
+        {
+            continue;
+        }
+        path.push_back( ch );
+    }
+
+    // Paths relative to the current directory are the same paths without it
+    while ( path.compare( 0, 2, "./" ) == 0 )
+    {
+        path.erase( 0, 2 );
+    }
+    return path;
+}
+
+// Packs a directory into an archive
+bool VirtualFileSystem::Pack( const std::string& directory, const std::string& fname )
+{
+    std::vector<PackedFile> files;
+    ListFiles( directory, "", true, files );
+    for ( PackedFile& file : files )
+    {
+        file.Path = NormalizePath( file.Path );
+        file.PathHash = HashPath( file.Path );
+    }
+    std::sort( files.begin(), files.end(), []( const PackedFile& a, const PackedFile& b )
+    {
+        return a.PathHash < b.PathHash || ( a.PathHash == b.PathHash && a.Path < b.Path );
+    } );
+
+    // Lay out the index, then every file after it
+    std::vector<ArchiveEntry> entries( files.size() );
+    std::string paths;
+    for ( size_t i = 0; i < files.size(); ++i )
+    {
+        entries[ i ].PathHash = files[ i ].PathHash;
+        entries[ i ].Size = files[ i ].Size;
+        entries[ i ].SourceTime = files[ i ].Time;
+        entries[ i ].Compression = Stored;
+        entries[ i ].Path = static_cast<unsigned int>( paths.size() );
+        paths += files[ i ].Path;
+        paths.push_back( '\0' );
+    }
+
+    unsigned long long offset = sizeof( ArchiveHeader ) + sizeof( ArchiveEntry ) * entries.size() + paths.size();
+    for ( ArchiveEntry& entry : entries )
+    {
+        offset = ( offset + ARCHIVE_ALIGNMENT - 1 ) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+        entry.Offset = offset;
+        offset += entry.Size;
+    }
+
+    ArchiveHeader header;
+    memset( &header, 0, sizeof( header ) );
+    header.Magic = ARCHIVE_MAGIC;
+    header.Version = ARCHIVE_VERSION;
+    header.EntryCount = static_cast<unsigned int>( entries.size() );
+    header.PathSize = static_cast<unsigned int>( paths.size() );
+
+    // Write to a temporary file first, so nobody ever mounts a half-written archive
+    std::string tempName = fname + ".tmp";
+    {
+        std::ofstream archive( tempName, std::ios::binary | std::ios::trunc );
+        if ( !archive.is_open() )
+        {
+            std::cout << "Failed to create '" << tempName << "'." << std::endl;
+            return false;
+        }
+
+        archive.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+        if ( !entries.empty() )
+        {
+            archive.write( reinterpret_cast<const char*>( &entries[ 0 ] ), sizeof( ArchiveEntry ) * entries.size() );
+        }
+        archive.write( paths.data(), paths.size() );
+
+        std::vector<char> contents;
+        for ( size_t i = 0; archive && i < files.size(); ++i )
+        {
+            // Pad up to where the file starts
+            static const char padding[ ARCHIVE_ALIGNMENT ] = {};
+            archive.write( padding, static_cast<std::streamsize>( entries[ i ].Offset - static_cast<unsigned long long>( archive.tellp() ) ) );
+
+            std::ifstream file( files[ i ].FileName, std::ios::binary );
+            contents.resize( static_cast<size_t>( files[ i ].Size ) );
+            if ( !file.is_open() || ( !contents.empty() && !file.read( &contents[ 0 ], contents.size() ) ) )
+            {
+                std::cout << "Failed to read '" << files[ i ].FileName << "'." << std::endl;
+                archive.setstate( std::ios::failbit );
+                break;
+            }
+            archive.write( contents.data(), contents.size() );
+        }
+
+        if ( !archive )
+        {
+            archive.close();
+            std::remove( tempName.c_str() );
+            return false;
+        }
+    }
+
+    // Renaming won't replace a file on every platform, so get rid of the old archive first
+    std::remove( fname.c_str() );
+    if ( std::rename( tempName.c_str(), fname.c_str() ) != 0 )
+    {
+        std::remove( tempName.c_str() );
+        return false;
+    }
+
+    std::cout << "Packed " << files.size() << " files into '" << fname << "'." << std::endl;
+    return true;
+}
+
+// Reads a packed file in place
+bool VirtualFileSystem::ReadPacked( const std::string& fname, const char*& data, size_t& size )
+{
+    // Only stored files can be read in place
+    const ArchiveEntry* entry = FindEntry( fname );
+    if ( !entry || entry->Compression != Stored )
+    {
+        return false;
+    }
+
+    data = _archive.GetData() + entry->Offset;
+    size = static_cast<size_t>( entry->Size );
+    return true;
+}
+
+// Unmounts the mounted archive
+void VirtualFileSystem::Unmount()
+{
+    _archive.Close();
+    _entries = nullptr;
+    _entryCount = 0;
+    _paths = nullptr;
+    _pathSize = 0;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Config.hpp"
+#include "MappedFile.hpp"
+#include <string>
+
+/// <summary>
+/// Defines a static virtual file system. Content can be packed into a single archive, which is mapped
+/// into memory once, so loading a packed file costs a lookup instead of opening it. Files the archive
+/// doesn't have are read from disk as usual.
+/// </summary>
+class VirtualFileSystem
+{
+    ImplementStaticClass( VirtualFileSystem );
+
+    /// <summary>
+    /// Defines the ways a packed file can be stored.
+    /// </summary>
+    enum Compression
+    {
+        Stored = 0 // Not compressed, so the file can be read in place
+    };
+
+    /// <summary>
+    /// Defines the start of an archive. The entries follow it, sorted by path hash, then the paths,
+    /// then the files themselves.
+    /// </summary>
+    struct ArchiveHeader
+    {
+        unsigned int Magic;
+        unsigned int Version;
+        unsigned int EntryCount;
+        unsigned int PathSize;  // The size of the paths, which are null-terminated and normalized
+    };
+
+    /// <summary>
+    /// Defines a packed file in an archive's index.
+    /// </summary>
+    struct ArchiveEntry
+    {
+        unsigned long long PathHash;
+        unsigned long long Offset;       // From the start of the archive
+        unsigned long long Size;         // The size of the file as stored
+        long long          SourceTime;   // The modification time of the file that was packed
+        unsigned int       Compression;
+        unsigned int       Path;         // The offset of the file's path in the paths
+    };
+
+    static MappedFile          _archive;
+    static const ArchiveEntry* _entries;
+    static unsigned int        _entryCount;
+    static const char*         _paths;
+    static unsigned int        _pathSize;
+
+    /// <summary>
+    /// Finds a file's entry in the mounted archive.
+    /// </summary>
+    /// <param name="fname">The file name.</param>
+    /// <returns>The entry, or null if the file isn't packed.</returns>
+    static const ArchiveEntry* FindEntry( const std::string& fname );
+
+    /// <summary>
+    /// Hashes a normalized path.
+    /// </summary>
+    /// <param name="path">The path.</param>
+    static unsigned long long HashPath( const std::string& path );
+
+    /// <summary>
+    /// Normalizes a path, so every spelling of it is packed and found the same way.
+    /// </summary>
+    /// <param name="fname">The file name.</param>
+    static std::string NormalizePath( const std::string& fname );
+
+public:
+    /// <summary>
+    /// Gets a file's size and modification time. Packed files report the size and time they were packed with.
+    /// </summary>
+    /// <param name="fname">The file name.</param>
+    /// <param name="size">Receives the file's size.</param>
+    /// <param name="time">Receives the file's modification time.</param>
+    /// <returns>True if the file exists, false if not.</returns>
+    static bool GetFileInfo( const std::string& fname, unsigned long long& size, long long& time );
+
+    /// <summary>
+    /// Checks to see if an archive is mounted.
+    /// </summary>
+    static bool IsMounted();
+
+    /// <summary>
+    /// Mounts an archive, unmounting any archive that was already mounted. Call this before anything
+    /// is loaded, since files that are open when an archive is unmounted can no longer be read.
+    /// </summary>
+    /// <param name="fname">The archive's file name.</param>
+    /// <returns>True if the archive was mounted, false if not.</returns>
+    static bool Mount( const std::string& fname );
+
+    /// <summary>
+    /// Packs every file in a directory's subdirectories into an archive. Files directly in the
+    /// directory, such as the game itself, are left out, as are temporary files.
+    /// </summary>
+    /// <param name="directory">The directory.</param>
+    /// <param name="fname">The archive's file name.</param>
+    /// <returns>True if the archive was written, false if not.</returns>
+    static bool Pack( const std::string& directory, const std::string& fname );
+
+    /// <summary>
+    /// Reads a packed file in place.
+    /// </summary>
+    /// <param name="fname">The file name.</param>
+    /// <param name="data">Receives the file's contents, which stay valid until the archive is unmounted.</param>
+    /// <param name="size">Receives the size of the file.</param>
+    /// <returns>True if the file is packed, false if it has to be read from disk.</returns>
+    static bool ReadPacked( const std::string& fname, const char*& data, size_t& size );
+
+    /// <summary>
+    /// Unmounts the mounted archive.
+    /// </summary>
+    static void Unmount();
+};
@@ -1,4 +1,7 @@
 #include "Mesh.hpp"
+#include <algorithm>
+
+#define MESH_LOD_PIXEL_ERROR 1.0f // The most pixels a level of detail is allowed to stray from the full mesh
 
 // Create new mesh data
 Mesh::MeshData::MeshData()
@@ -7,26 +10,121 @@ Mesh::MeshData::MeshData()
     , IndexCount( 0 )
     , VertexCount( 0 )
     , VertexStride( 0 )
+    , IndexType( GL_UNSIGNED_INT )
+    , IndexOffset( 0 )
+    , UVOffset( 0.0f )
+    , UVScale( 1.0f )
 {
 }
 
 // Destroy this mesh
 Mesh::~Mesh()
 {
+    _vertexBuffer.Release();
+    _indexBuffer.Release();
+}
+
+// Fills part of this mesh's vertex buffer
+void Mesh::UploadVertices( size_t first, size_t count, const void* vertices )
+{
+    if ( count )
+    {
+        glBindBuffer( GL_ARRAY_BUFFER, _data.VBO );
+        glBufferSubData( GL_ARRAY_BUFFER, first * _data.VertexStride, count * _data.VertexStride, vertices );
+        glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    }
+}
+
+// Fills part of this mesh's index buffer
+void Mesh::UploadIndices( size_t first, size_t count, const void* indices )
+{
+    if ( count )
+    {
+        size_t indexSize = ( _data.IndexType == GL_UNSIGNED_SHORT ) ? sizeof( unsigned short ) : sizeof( unsigned );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _data.IBO );
+        glBufferSubData( GL_ELEMENT_ARRAY_BUFFER, first * indexSize, count * indexSize, indices );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    }
+}
+
+// Get the smallest corner of this mesh's bounding box
+const glm::vec3& Mesh::GetBoundsMin() const
+{
+    return _boundsMin;
+}
+
+// Get the largest corner of this mesh's bounding box
+const glm::vec3& Mesh::GetBoundsMax() const
+{
+    return _boundsMax;
+}
+
+// Set this mesh's bounding box
+void Mesh::SetBounds( const glm::vec3& min, const glm::vec3& max )
+{
+    _boundsMin = min;
+    _boundsMax = max;
+}
+
+// Set the range this mesh's quantized UVs span
+void Mesh::SetUVRange( const glm::vec2& offset, const glm::vec2& scale )
+{
+    _data.UVOffset = offset;
+    _data.UVScale = scale;
+}
+
+// Get the number of levels of detail this mesh has
+size_t Mesh::GetLodCount() const
+{
+    return std::max<size_t>( _lods.size(), 1 );
+}
+
+// Get the coarsest level of detail that strays from the full mesh by less than a pixel
+size_t Mesh::GetLodForRadius( float projectedRadius ) const
+{
+    float radius = glm::length( _boundsMax - _boundsMin ) * 0.5f;
+    if ( _lods.size() < 2 || radius <= 0.0f )
+    {
+        return 0;
+    }
+
+    float pixelsPerUnit = projectedRadius / radius;
+    size_t lod = 0;
+    while ( lod + 1 < _lods.size() && _lods[ lod + 1 ].Error * pixelsPerUnit < MESH_LOD_PIXEL_ERROR )
+    {
+        ++lod;
+    }
+    return lod;
+}
+
+// Set this mesh's levels of detail
+void Mesh::SetLods( const std::vector<MeshLod>& lods )
+{
+    _lods = lods;
 }
 
 // Draw this mesh
-void Mesh::Draw( Material* const material )
+void Mesh::Draw( Material* const material, size_t lod )
 {
+    // Levels of detail just draw a different range of the same buffers
+    MeshData data = _data;
+    if ( lod < _lods.size() )
+    {
+        size_t indexSize = ( _data.IndexType == GL_UNSIGNED_SHORT ) ? sizeof( unsigned short ) : sizeof( unsigned );
+        data.IndexOffset = static_cast<unsigned int>( _lods[ lod ].FirstIndex * indexSize );
+        data.IndexCount = _lods[ lod ].IndexCount;
+    }
+
     glUseProgram( material->GetProgramID() );
     material->SendValuesToShader();
+    material->SetUVRange( _data.UVOffset, _data.UVScale );
 
     // Bind the buffers
     glBindBuffer( GL_ARRAY_BUFFER, _data.VBO );
     glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _data.IBO );
 
 
-    _drawCallback( _data, material );
+    _drawCallback( data, material );
 
 
     // Un-bind the buffers